@@ -4,6 +4,21 @@
 
 #include <benchmark/benchmark.h>
 
+/**
+ * @brief Runs a benchmark once for each execution engine.
+ * Use with BENCHMARK_REGISTER_F(...)->Apply(EngineArguments). The engine is passed as the first argument.
+ */
+inline void EngineArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("engine")
+        ->Arg(PROJECTM_EVAL_ENGINE_TREE)
+        ->Arg(PROJECTM_EVAL_ENGINE_BYTECODE)
+        ->Arg(PROJECTM_EVAL_ENGINE_REGISTER);
+#ifdef PRJM_EVAL_ENABLE_JIT
+    benchmark->Arg(PROJECTM_EVAL_ENGINE_JIT);
+#endif
+}
+
 /**
  * @brief Fixture that creates a context and an empty gmegabuf to run the benchmark.
  */
@@ -23,6 +38,24 @@ public:
     }
 
 protected:
+    /**
+     * @brief Compiles the code and selects the engine passed as the first benchmark argument.
+     * @param state The benchmark state.
+     * @param code The code to compile.
+     * @return The compiled code handle.
+     */
+    projectm_eval_code* CompileCode(benchmark::State& state, const char* code)
+    {
+        auto codeHandle = projectm_eval_code_compile(m_context, code);
+        if (!codeHandle ||
+            !projectm_eval_code_set_engine(codeHandle, static_cast<projectm_eval_engine>(state.range(0))))
+        {
+            state.SkipWithError("Code could not be compiled for the requested engine.");
+        }
+
+        return codeHandle;
+    }
+
     PRJM_EVAL_F (*m_globals)[100]{};
     projectm_eval_context* m_context{nullptr};
     projectm_eval_mem_buffer m_gmegabuf{nullptr};
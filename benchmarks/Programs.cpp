@@ -1,15 +1,19 @@
 #include "BenchmarkFixture.hpp"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 class ProgramBenchmarks : public BenchmarkFixture
 {};
 
 
-BENCHMARK_F(ProgramBenchmarks, Mandelbrot128x128)(benchmark::State& st)
+BENCHMARK_DEFINE_F(ProgramBenchmarks, Mandelbrot128x128)(benchmark::State& st)
 {
     // Calculates a Mandelbrot "image" with 128x128 pixels resolution, stored in megabuf.
     // This is the worst Mandelbrot implementation using lots of multiplications.
     // The inner loop code executes about 4.6 million times.
-    auto code = projectm_eval_code_compile(m_context, R"(
+    auto code = CompileCode(st, R"(
         size_x = 128;
         size_y = 128;
         pos_x = 0;
@@ -39,3 +43,273 @@ BENCHMARK_F(ProgramBenchmarks, Mandelbrot128x128)(benchmark::State& st)
         projectm_eval_code_execute(code);
     }
 }
+BENCHMARK_REGISTER_F(ProgramBenchmarks, Mandelbrot128x128)->Apply(EngineArguments);
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, WaveformLoop)(benchmark::State& st)
+{
+    // Fills megabuf with a custom waveform, as done in per-frame code. Most of the loop body only depends on
+    // per-frame values and is computed once in front of the loop by the compiler.
+    auto code = CompileCode(st, R"(
+        i = 0;
+        loop(4096,
+            megabuf(i) = sin(time * 0.7 + 1) * (bass * 0.5 + 0.5) + i * (1 / 4096) * cos(time * 0.3);
+            i += 1
+        );
+    )");
+
+    auto* time = projectm_eval_context_register_variable(m_context, "time");
+    *projectm_eval_context_register_variable(m_context, "bass") = 1.2;
+
+    for (auto _ : st)
+    {
+        *time += 0.016;
+        projectm_eval_code_execute(code);
+    }
+
+    st.counters["samples"] = benchmark::Counter(4096, benchmark::Counter::kIsIterationInvariantRate);
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, WaveformLoop)->Apply(EngineArguments);
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, BufferSmoothing)(benchmark::State& st)
+{
+    // Blends a buffer of samples into a smoothed copy, reading and writing memory at consecutive indices.
+    auto code = CompileCode(st, R"(
+        i = 0;
+        loop(4096,
+            megabuf(i) = megabuf(i) * 0.9 + megabuf(i + 4096) * 0.1;
+            i += 1
+        );
+    )");
+
+    for (auto _ : st)
+    {
+        projectm_eval_code_execute(code);
+    }
+
+    st.counters["samples"] = benchmark::Counter(4096, benchmark::Counter::kIsIterationInvariantRate);
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, BufferSmoothing)->Apply(EngineArguments);
+
+/**
+ * @brief Loops over 4096 buffer elements without dependencies between the iterations: fill, scale and blend.
+ */
+static const char* bufferLoopCode[]{
+    "i = 0; loop(4096, megabuf(i) = sin(i * 0.01) * 0.5 + 0.5; i += 1)",
+    "i = 0; loop(4096, megabuf(i) *= 0.98; i += 1)",
+    "i = 0; loop(4096, megabuf(i) = megabuf(i) * 0.9 + megabuf(i + 4096) * 0.1; i += 1)"
+};
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, BufferLoops)(benchmark::State& st)
+{
+    // The second argument enables loop vectorization, the third one selects the loop from bufferLoopCode.
+    projectm_eval_context_set_loop_vectorization(m_context, static_cast<int>(st.range(1)));
+    auto code = CompileCode(st, bufferLoopCode[st.range(2)]);
+
+    for (auto _ : st)
+    {
+        projectm_eval_code_execute(code);
+    }
+
+    st.counters["elements"] = benchmark::Counter(4096, benchmark::Counter::kIsIterationInvariantRate);
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, BufferLoops)
+    ->ArgNames({"engine", "vectorize", "loop"})
+    ->ArgsProduct({{PROJECTM_EVAL_ENGINE_REGISTER,
+#ifdef PRJM_EVAL_ENABLE_JIT
+                    PROJECTM_EVAL_ENGINE_JIT
+#endif
+                   },
+                   {0, 1},
+                   {0, 1, 2}});
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, SmallConstantLoops)(benchmark::State& st)
+{
+    // Per-frame code with short loops over a few values, e.g. smoothing eight band levels. Loops with literal counts
+    // are unrolled by the compiler.
+    auto code = CompileCode(st, R"(
+        i = 0;
+        loop(8,
+            megabuf(i) = megabuf(i) * 0.9 + bass * 0.1;
+            i += 1
+        );
+        sum = 0;
+        i = 0;
+        loop(8,
+            sum += megabuf(i);
+            i += 1
+        );
+        average = sum / 8;
+    )");
+
+    *projectm_eval_context_register_variable(m_context, "bass") = 1.2;
+
+    for (auto _ : st)
+    {
+        projectm_eval_code_execute(code);
+    }
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, SmallConstantLoops)->Apply(EngineArguments);
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, ManyProgramsBackToBack)(benchmark::State& st)
+{
+    // Executes the per-pixel code of many presets in a row, as done when rendering preset transitions or
+    // multiple visualizations at once. Each program is compiled while other allocations are made in between,
+    // as it happens during preset loading.
+    const int programCount = 64;
+    std::vector<projectm_eval_code*> programs;
+    std::vector<std::unique_ptr<char[]>> heapNoise;
+
+    for (int program = 0; program < programCount; program++)
+    {
+        std::string code = "zoom = zoom + 0.05 * sin(rad * " + std::to_string(program + 1) + " + time);"
+                           "rot = rot + 0.02 * cos(ang * 3 - time * 0." + std::to_string(program % 10) + ");"
+                           "dx = dx + if(rad < 0.5, 0.01 * cos(ang), -0.01 * cos(ang));"
+                           "dy = dy + if(rad < 0.5, 0.01 * sin(ang), -0.01 * sin(ang));"
+                           "sx = sx * 0.99 + 0.01 * bass; sy = sy * 0.99 + 0.01 * mid;"
+                           "warp = warp * 0.8 + if(above(treb, 1.2), 0.3, 0.1);";
+
+        auto codeHandle = CompileCode(st, code.c_str());
+        if (!codeHandle)
+        {
+            return;
+        }
+        programs.push_back(codeHandle);
+
+        heapNoise.emplace_back(new char[96]);
+        heapNoise.emplace_back(new char[48]);
+    }
+
+    auto* time = projectm_eval_context_register_variable(m_context, "time");
+
+    for (auto _ : st)
+    {
+        *time += 0.016;
+        for (auto* program : programs)
+        {
+            benchmark::DoNotOptimize(projectm_eval_code_execute(program));
+        }
+    }
+
+    st.counters["programs"] = benchmark::Counter(programCount, benchmark::Counter::kIsIterationInvariantRate);
+
+    for (auto* program : programs)
+    {
+        projectm_eval_code_destroy(program);
+    }
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, ManyProgramsBackToBack)->Apply(EngineArguments);
+
+/**
+ * @brief Per-pixel code of a typical preset, executed for each point of a 48x36 mesh.
+ */
+static const char* perPixelCode = R"(
+    zoom = zoom + 0.05 * sin(rad * 6 + time);
+    rot = rot + 0.02 * cos(ang * 3 - time * 0.5);
+    dx = dx + if(rad < 0.5, 0.01 * cos(ang), -0.01 * cos(ang));
+    dy = dy + if(rad < 0.5, 0.01 * sin(ang), -0.01 * sin(ang));
+    warp = warp * 0.8 + if(above(treb, 1.2), 0.3, 0.1);
+)";
+
+static constexpr int meshSize = 48 * 36;
+
+static const char* meshVariableNames[]{"x", "y", "rad", "ang", "zoom", "rot", "dx", "dy", "warp"};
+static constexpr int meshVariableCount = sizeof(meshVariableNames) / sizeof(meshVariableNames[0]);
+
+/**
+ * @brief Fills the mesh point values, with x, y, rad and ang varying per point and the motion values at rest.
+ */
+static void InitializeMesh(std::vector<std::vector<PRJM_EVAL_F>>& values)
+{
+    values.assign(meshVariableCount, std::vector<PRJM_EVAL_F>(meshSize, 1.0));
+    for (int point = 0; point < meshSize; point++)
+    {
+        values[0][point] = (point % 48) / 47.0;
+        values[1][point] = (point / 48) / 35.0;
+        values[2][point] = (point % 97) / 97.0;
+        values[3][point] = (point % 61) / 10.0;
+    }
+}
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, PerPixelMesh)(benchmark::State& st)
+{
+    // Loads, executes and stores each mesh point one after the other, as done by the host without batch execution.
+    auto code = CompileCode(st, perPixelCode);
+
+    std::vector<std::vector<PRJM_EVAL_F>> values;
+    InitializeMesh(values);
+
+    PRJM_EVAL_F* variables[meshVariableCount];
+    for (int variable = 0; variable < meshVariableCount; variable++)
+    {
+        variables[variable] = projectm_eval_context_register_variable(m_context, meshVariableNames[variable]);
+    }
+
+    for (auto _ : st)
+    {
+        for (int point = 0; point < meshSize; point++)
+        {
+            for (int variable = 0; variable < meshVariableCount; variable++)
+            {
+                *variables[variable] = values[variable][point];
+            }
+            projectm_eval_code_execute(code);
+            for (int variable = 0; variable < meshVariableCount; variable++)
+            {
+                values[variable][point] = *variables[variable];
+            }
+        }
+    }
+
+    st.counters["points"] = benchmark::Counter(meshSize, benchmark::Counter::kIsIterationInvariantRate);
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, PerPixelMesh)->Apply(EngineArguments);
+
+BENCHMARK_DEFINE_F(ProgramBenchmarks, PerPixelMeshBatch)(benchmark::State& st)
+{
+    // Executes all mesh points with a single batch call. The selected engine isn't used by batch execution, the
+    // second argument selects the batch precision. If the third argument is 1, the per-frame variables are marked
+    // as uniform, so computations only depending on them are executed once per call.
+    auto code = CompileCode(st, perPixelCode);
+    projectm_eval_code_set_batch_precision(code, static_cast<projectm_eval_precision>(st.range(1)));
+
+    if (st.range(2))
+    {
+        PRJM_EVAL_F* uniformVariables[]{projectm_eval_context_register_variable(m_context, "time"),
+                                        projectm_eval_context_register_variable(m_context, "treb")};
+        projectm_eval_code_set_uniform_variables(code, uniformVariables, 2);
+    }
+
+    std::vector<std::vector<PRJM_EVAL_F>> values;
+    InitializeMesh(values);
+
+    std::vector<projectm_eval_lane_variable> laneVariables;
+    for (int variable = 0; variable < meshVariableCount; variable++)
+    {
+        laneVariables.push_back({projectm_eval_context_register_variable(m_context, meshVariableNames[variable]),
+                                 values[variable].data()});
+    }
+
+    for (auto _ : st)
+    {
+        projectm_eval_code_execute_batch(code, laneVariables.data(), meshVariableCount, meshSize, nullptr);
+    }
+
+    st.counters["points"] = benchmark::Counter(meshSize, benchmark::Counter::kIsIterationInvariantRate);
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(ProgramBenchmarks, PerPixelMeshBatch)
+    ->ArgNames({"engine", "precision", "uniform"})
+    ->ArgsProduct({{PROJECTM_EVAL_ENGINE_TREE},
+                   {PROJECTM_EVAL_PRECISION_DEFAULT, PROJECTM_EVAL_PRECISION_FLOAT},
+                   {0, 1}});
@@ -0,0 +1,130 @@
+#include "BenchmarkFixture.hpp"
+
+extern "C"
+{
+#include <projectm-eval/CompilerTypes.h>
+#include <projectm-eval/TreeFunctions.h>
+}
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Compares the tree interpreter with and without superinstruction fusion.
+ * The first benchmark argument enables (1) or disables (0) fusion.
+ */
+class SuperinstructionBenchmarks : public BenchmarkFixture
+{
+protected:
+    projectm_eval_code* CompileTree(benchmark::State& state, const char* code)
+    {
+        m_context->fuse_superinstructions = state.range(0) != 0;
+
+        auto codeHandle = projectm_eval_code_compile(m_context, code);
+        if (!codeHandle || !projectm_eval_code_set_engine(codeHandle, PROJECTM_EVAL_ENGINE_TREE))
+        {
+            state.SkipWithError("Code could not be compiled.");
+        }
+
+        return codeHandle;
+    }
+
+    /**
+     * @brief Counts the nodes evaluated in one execution of a tree without loops.
+     * Only the larger branch of each "if" is counted.
+     */
+    static int64_t CountExecutedNodes(const prjm_eval_exptreenode_t* node)
+    {
+        auto func = prjm_eval_generic_function(node->func);
+        int64_t count = 1;
+        int branchArg = -1;
+
+        if (func == prjm_eval_func_if)
+        {
+            branchArg = 1;
+        }
+#define COMPARE_SELECT_BRANCHES(name, condition) \
+        else if (func == prjm_eval_func_if_ ## name) \
+        { \
+            branchArg = 2; \
+        }
+        PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(COMPARE_SELECT_BRANCHES)
+#undef COMPARE_SELECT_BRANCHES
+
+        for (int arg = 0; node->args && node->args[arg]; arg++)
+        {
+            if (arg == branchArg)
+            {
+                count += std::max(CountExecutedNodes(node->args[arg]), CountExecutedNodes(node->args[arg + 1]));
+                arg++;
+                continue;
+            }
+            count += CountExecutedNodes(node->args[arg]);
+        }
+
+        return count;
+    }
+};
+
+BENCHMARK_DEFINE_F(SuperinstructionBenchmarks, PerPixelMesh)(benchmark::State& st)
+{
+    // Typical Milkdrop per-pixel equations, executed for each point of a 48x36 mesh.
+    auto code = CompileTree(st, R"(
+        zoom = zoom + 0.05 * sin(rad * 6 + time);
+        rot = rot + 0.02 * cos(ang * 3 - time * 0.5);
+        dx = dx + if(rad < 0.5, 0.01 * cos(ang), -0.01 * cos(ang));
+        dy = dy + if(rad < 0.5, 0.01 * sin(ang), -0.01 * sin(ang));
+        sx = sx * 0.99 + 0.01 * bass;
+        sy = sy * 0.99 + 0.01 * mid;
+        warp = warp * 0.8 + if(above(treb, 1.2), 0.3, 0.1);
+        cx = 0.5 + 0.1 * sin(time * 0.3);
+        cy = 0.5 + 0.1 * cos(time * 0.4);
+        index = floor(x * 32) + floor(y * 32) * 32;
+        megabuf(index) = megabuf(index) * 0.9 + zoom * 0.1;
+    )");
+
+    if (!code)
+    {
+        return;
+    }
+
+    auto* x = projectm_eval_context_register_variable(m_context, "x");
+    auto* y = projectm_eval_context_register_variable(m_context, "y");
+    auto* rad = projectm_eval_context_register_variable(m_context, "rad");
+    auto* ang = projectm_eval_context_register_variable(m_context, "ang");
+    auto* zoom = projectm_eval_context_register_variable(m_context, "zoom");
+    auto* rot = projectm_eval_context_register_variable(m_context, "rot");
+    auto* time = projectm_eval_context_register_variable(m_context, "time");
+    *projectm_eval_context_register_variable(m_context, "bass") = 1.1;
+    *projectm_eval_context_register_variable(m_context, "mid") = 0.9;
+    *projectm_eval_context_register_variable(m_context, "treb") = 1.3;
+
+    const int meshWidth = 48;
+    const int meshHeight = 36;
+
+    for (auto _ : st)
+    {
+        *time += 0.016;
+        for (int meshY = 0; meshY < meshHeight; meshY++)
+        {
+            for (int meshX = 0; meshX < meshWidth; meshX++)
+            {
+                *x = static_cast<PRJM_EVAL_F>(meshX) / (meshWidth - 1);
+                *y = static_cast<PRJM_EVAL_F>(meshY) / (meshHeight - 1);
+                *rad = sqrt((*x - 0.5) * (*x - 0.5) + (*y - 0.5) * (*y - 0.5));
+                *ang = atan2(*y - 0.5, *x - 0.5);
+                *zoom = 1.0;
+                *rot = 0.0;
+                projectm_eval_code_execute(code);
+            }
+        }
+    }
+
+    auto program = reinterpret_cast<prjm_eval_program_t*>(code)->program;
+    st.counters["nodes"] = static_cast<double>(CountExecutedNodes(program));
+    st.counters["pixels"] = benchmark::Counter(static_cast<double>(meshWidth * meshHeight),
+                                               benchmark::Counter::kIsIterationInvariantRate);
+
+    projectm_eval_code_destroy(code);
+}
+BENCHMARK_REGISTER_F(SuperinstructionBenchmarks, PerPixelMesh)->ArgName("fused")->Arg(0)->Arg(1);
@@ -0,0 +1,162 @@
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <benchmark/benchmark.h>
+
+extern "C"
+{
+#include <projectm-eval/IntrinsicMath.h>
+#include <projectm-eval/VectorMath.h>
+}
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Measures elements per second of the vector math kernels and the equivalent scalar loops.
+ * The first benchmark argument is the array size, e.g. 16 for a single batch or 1728 for a 48x36 mesh. The kernel
+ * benchmarks are run for each CPU level passed as the second argument.
+ */
+class VectorMathBenchmarks : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State& state) override
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        m_previousLevel = projectm_eval_get_cpu_level();
+
+        std::mt19937 generator(1234);
+        std::uniform_real_distribution<double> distribution(0.01, 10.0);
+
+        m_arguments1.resize(count);
+        m_arguments2.resize(count);
+        m_results.resize(count);
+        for (size_t index = 0; index < count; index++)
+        {
+            m_arguments1[index] = static_cast<PRJM_EVAL_F>(distribution(generator));
+            m_arguments2[index] = static_cast<PRJM_EVAL_F>(distribution(generator) - 5.0);
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override
+    {
+        projectm_eval_set_cpu_level(m_previousLevel);
+    }
+
+protected:
+    /**
+     * @brief Selects the CPU level passed as the second benchmark argument.
+     * @return false if the CPU doesn't support the level.
+     */
+    bool SelectLevel(benchmark::State& state)
+    {
+        auto level = static_cast<projectm_eval_cpu_level>(state.range(1));
+        if (!projectm_eval_set_cpu_level(level))
+        {
+            state.SkipWithError("CPU level not supported.");
+            return false;
+        }
+        if (projectm_eval_get_cpu_level() != level)
+        {
+            state.SkipWithError("No kernels were built for this CPU level.");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Runs a unary kernel and reports the processed elements.
+     */
+    void RunKernel(benchmark::State& state, void (*kernel)(PRJM_EVAL_F*, const PRJM_EVAL_F*, int))
+    {
+        if (!SelectLevel(state))
+        {
+            return;
+        }
+
+        for (auto _ : state)
+        {
+            kernel(m_results.data(), m_arguments1.data(), static_cast<int>(m_results.size()));
+            benchmark::DoNotOptimize(m_results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(m_results.size()));
+    }
+
+    /**
+     * @brief Runs a binary kernel and reports the processed elements.
+     */
+    void RunKernel(benchmark::State& state,
+                   void (*kernel)(PRJM_EVAL_F*, const PRJM_EVAL_F*, const PRJM_EVAL_F*, int))
+    {
+        if (!SelectLevel(state))
+        {
+            return;
+        }
+
+        for (auto _ : state)
+        {
+            kernel(m_results.data(), m_arguments1.data(), m_arguments2.data(), static_cast<int>(m_results.size()));
+            benchmark::DoNotOptimize(m_results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(m_results.size()));
+    }
+
+    /**
+     * @brief Applies a scalar function to each element, as the register engine does.
+     * Each result is passed to DoNotOptimize(), so the compiler can't vectorize the loop with libmvec functions.
+     */
+    template<typename Function>
+    void RunScalar(benchmark::State& state, Function function)
+    {
+        for (auto _ : state)
+        {
+            for (size_t index = 0; index < m_results.size(); index++)
+            {
+                m_results[index] = function(m_arguments1[index], m_arguments2[index]);
+                benchmark::DoNotOptimize(m_results[index]);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(m_results.size()));
+    }
+
+    std::vector<PRJM_EVAL_F> m_arguments1;
+    std::vector<PRJM_EVAL_F> m_arguments2;
+    std::vector<PRJM_EVAL_F> m_results;
+    projectm_eval_cpu_level m_previousLevel{PROJECTM_EVAL_CPU_GENERIC};
+};
+
+/**
+ * @brief Runs a kernel benchmark for each array size and CPU level.
+ */
+inline void KernelArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"count", "cpu"})
+        ->ArgsProduct({{16, 1728}, {PROJECTM_EVAL_CPU_GENERIC, PROJECTM_EVAL_CPU_AVX2, PROJECTM_EVAL_CPU_AVX512}});
+}
+
+/**
+ * @brief Defines a benchmark pair for a kernel and its scalar counterpart.
+ */
+#define VECTOR_MATH_BENCHMARK(name, kernel, scalar_expression)                        \
+    BENCHMARK_DEFINE_F(VectorMathBenchmarks, name##Vector)(benchmark::State & st)     \
+    {                                                                                 \
+        RunKernel(st, kernel);                                                        \
+    }                                                                                 \
+    BENCHMARK_REGISTER_F(VectorMathBenchmarks, name##Vector)->Apply(KernelArguments); \
+    BENCHMARK_DEFINE_F(VectorMathBenchmarks, name##Scalar)(benchmark::State & st)     \
+    {                                                                                 \
+        RunScalar(st, [](PRJM_EVAL_F a, PRJM_EVAL_F b) -> PRJM_EVAL_F {               \
+            (void) b;                                                                 \
+            return scalar_expression;                                                 \
+        });                                                                           \
+    }                                                                                 \
+    BENCHMARK_REGISTER_F(VectorMathBenchmarks, name##Scalar)->ArgName("count")->Arg(16)->Arg(1728);
+
+VECTOR_MATH_BENCHMARK(Sin, prjm_eval_vector_sin, std::sin(a))
+VECTOR_MATH_BENCHMARK(Cos, prjm_eval_vector_cos, std::cos(a))
+VECTOR_MATH_BENCHMARK(Exp, prjm_eval_vector_exp, std::exp(a))
+VECTOR_MATH_BENCHMARK(Log, prjm_eval_vector_log, prjm_eval_math_log(a))
+VECTOR_MATH_BENCHMARK(Sqrt, prjm_eval_vector_sqrt, std::sqrt(std::fabs(a)))
+VECTOR_MATH_BENCHMARK(InvSqrt, prjm_eval_vector_invsqrt, prjm_eval_math_invsqrt(a))
+VECTOR_MATH_BENCHMARK(Pow, prjm_eval_vector_pow, prjm_eval_math_pow(a, b))
+VECTOR_MATH_BENCHMARK(Atan2, prjm_eval_vector_atan2, std::atan2(a, b))
@@ -0,0 +1,49 @@
+# Provides the projectm_eval_add_precompiled_code() function, which translates expression code to C at build time
+# using the projectm-eval-transpile tool. Requires the BUILD_TRANSPILER option.
+#
+# projectm_eval_add_precompiled_code(<target> SYMBOL <name> SOURCE <file>)
+#
+# Adds the generated source file to <target> and the directory containing the generated header "<name>.h" to its
+# private include directories. The header declares the projectm_eval_native_program <name>, which is passed to
+# projectm_eval_code_create_native(). The generated code includes internal headers of the library, so <target>
+# must link against the projectM::Eval target of the same build.
+
+function(projectm_eval_add_precompiled_code target)
+    cmake_parse_arguments(PARSE_ARGV 1 _PRECOMPILED "" "SYMBOL;SOURCE" "")
+
+    if(NOT _PRECOMPILED_SYMBOL OR NOT _PRECOMPILED_SOURCE)
+        message(FATAL_ERROR "projectm_eval_add_precompiled_code() requires the SYMBOL and SOURCE arguments.")
+    endif()
+
+    if(NOT TARGET projectm-eval-transpile)
+        message(FATAL_ERROR "projectm_eval_add_precompiled_code() requires the BUILD_TRANSPILER option.")
+    endif()
+
+    get_filename_component(_input_file "${_PRECOMPILED_SOURCE}" ABSOLUTE)
+    set(_output_dir "${CMAKE_CURRENT_BINARY_DIR}/projectm-eval-precompiled")
+    set(_output_source "${_output_dir}/${_PRECOMPILED_SYMBOL}.c")
+    set(_output_header "${_output_dir}/${_PRECOMPILED_SYMBOL}.h")
+
+    add_custom_command(OUTPUT "${_output_source}" "${_output_header}"
+                       COMMAND ${CMAKE_COMMAND} -E make_directory "${_output_dir}"
+                       COMMAND projectm-eval-transpile
+                       "${_input_file}"
+                       "${_output_source}"
+                       "${_output_header}"
+                       ${_PRECOMPILED_SYMBOL}
+                       DEPENDS "${_input_file}" projectm-eval-transpile
+                       COMMENT "Translating ${_PRECOMPILED_SOURCE} to C"
+                       VERBATIM
+                       )
+
+    target_sources(${target}
+                   PRIVATE
+                   "${_output_source}"
+                   "${_output_header}"
+                   )
+
+    target_include_directories(${target}
+                               PRIVATE
+                               "${_output_dir}"
+                               )
+endfunction()
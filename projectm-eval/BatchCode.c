@@ -0,0 +1,769 @@
+/**
+ * @file BatchCode.c
+ * @brief Creates batch code and moves the lane values in and out of the lane frame.
+ *
+ * The lanes are executed by the interpreter in BatchExecute.c, using the variant selected for the CPU. In single
+ * precision, the float interpreter in BatchExecuteFloat.c is used with the float frame.
+ */
+#include "BatchCode.h"
+
+#include "CpuDispatch.h"
+#include "TreeFunctions.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Allocates the lane frames and the register code's scalar frame for the given number of slots and fills in the
+ * constants. Keeps the current frames if an allocation fails.
+ */
+static bool allocate_frames(prjm_eval_batch_code_t* code, int32_t frame_size)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+
+    PRJM_EVAL_F* scalar_frame = calloc(frame_size + 1, sizeof(PRJM_EVAL_F));
+    PRJM_EVAL_F* frame = calloc((frame_size + 1) * PRJM_EVAL_BATCH_WIDTH, sizeof(PRJM_EVAL_F));
+    float* float_frame = calloc((frame_size + 1) * PRJM_EVAL_BATCH_FLOAT_WIDTH, sizeof(float));
+
+    if (!scalar_frame || !frame || !float_frame)
+    {
+        free(scalar_frame);
+        free(frame);
+        free(float_frame);
+        return false;
+    }
+
+    /* Constants have the same value in all lanes. */
+    memcpy(scalar_frame, register_code->frame, register_code->constant_count * sizeof(PRJM_EVAL_F));
+    for (int32_t slot = 0; slot < register_code->constant_count; slot++)
+    {
+        PRJM_EVAL_F* lanes = lane_slot(slot);
+        for (int lane = 0; lane < PRJM_EVAL_BATCH_WIDTH; lane++)
+        {
+            lanes[lane] = scalar_frame[slot];
+        }
+
+        float* float_lanes = float_lane_slot(slot);
+        for (int lane = 0; lane < PRJM_EVAL_BATCH_FLOAT_WIDTH; lane++)
+        {
+            float_lanes[lane] = (float) scalar_frame[slot];
+        }
+    }
+
+    free(register_code->frame);
+    free(code->frame);
+    free(code->float_frame);
+    register_code->frame = scalar_frame;
+    register_code->frame_size = frame_size;
+    code->frame = frame;
+    code->float_frame = float_frame;
+
+    return true;
+}
+
+prjm_eval_batch_code_t* prjm_eval_batch_code_create(prjm_eval_exptreenode_t* tree)
+{
+    /* Memory cursors follow the accesses of a single execution, which lanes can't share. */
+    prjm_eval_register_code_t* register_code = prjm_eval_register_code_create(tree, 0);
+    if (!register_code)
+    {
+        return NULL;
+    }
+
+    prjm_eval_batch_code_t* code = calloc(1, sizeof(prjm_eval_batch_code_t));
+    if (!code)
+    {
+        prjm_eval_register_code_destroy(register_code);
+        return NULL;
+    }
+
+    code->code = register_code;
+    code->instructions = register_code->instructions;
+    code->base_frame_size = register_code->frame_size;
+    code->refs = calloc((register_code->ref_count + 1) * PRJM_EVAL_BATCH_WIDTH, sizeof(PRJM_EVAL_F*));
+    code->lane_values = calloc(register_code->variable_count + 1, sizeof(PRJM_EVAL_F*));
+    code->initial_values = calloc(register_code->variable_count + 1, sizeof(PRJM_EVAL_F));
+    code->lane_pc = calloc(PRJM_EVAL_BATCH_FLOAT_WIDTH, sizeof(int32_t));
+    code->float_refs = calloc((register_code->ref_count + 1) * PRJM_EVAL_BATCH_FLOAT_WIDTH, sizeof(float*));
+    code->memory_refs = calloc((register_code->ref_count + 1) * PRJM_EVAL_BATCH_FLOAT_WIDTH, sizeof(PRJM_EVAL_F*));
+
+    if (!code->refs || !code->lane_values || !code->initial_values || !code->lane_pc || !code->float_refs ||
+        !code->memory_refs || !allocate_frames(code, register_code->frame_size))
+    {
+        prjm_eval_batch_code_destroy(code);
+        return NULL;
+    }
+
+    return code;
+}
+
+void prjm_eval_batch_code_destroy(prjm_eval_batch_code_t* code)
+{
+    if (!code)
+    {
+        return;
+    }
+
+    prjm_eval_register_code_destroy(code->code);
+    free(code->frame);
+    free(code->refs);
+    free(code->lane_values);
+    free(code->initial_values);
+    free(code->lane_pc);
+    free(code->float_frame);
+    free(code->float_refs);
+    free(code->memory_refs);
+    free(code->body);
+    free(code->prologue);
+    free(code->uniform_variables);
+    free(code);
+}
+
+/**
+ * Checks if the instruction computes its dst slot only from its source slots, without side effects.
+ */
+static bool is_pure_operation(prjm_eval_register_opcode_t opcode)
+{
+    return opcode >= PRJM_EVAL_REG_BOOL && opcode != PRJM_EVAL_REG_RAND;
+}
+
+/**
+ * Checks if the opcode is a jump with a target instruction.
+ */
+static bool has_target(prjm_eval_register_opcode_t opcode)
+{
+    return opcode == PRJM_EVAL_REG_JUMP ||
+           opcode == PRJM_EVAL_REG_JUMP_IF_ZERO ||
+           opcode == PRJM_EVAL_REG_AND_TEST ||
+           opcode == PRJM_EVAL_REG_OR_TEST ||
+           opcode == PRJM_EVAL_REG_LOOP_NEXT ||
+           opcode == PRJM_EVAL_REG_WHILE_NEXT;
+}
+
+/**
+ * Checks if the instruction only writes its dst slot, after reading all sources.
+ */
+static bool writes_dst_slot(prjm_eval_register_opcode_t opcode)
+{
+    return opcode == PRJM_EVAL_REG_MOV ||
+           opcode == PRJM_EVAL_REG_LOAD_REF ||
+           opcode == PRJM_EVAL_REG_MEM_LOAD ||
+           opcode == PRJM_EVAL_REG_CALL_NODE ||
+           opcode >= PRJM_EVAL_REG_BOOL;
+}
+
+/**
+ * Checks if the instruction may read the given slot. Fields holding reference registers are counted as well.
+ */
+static bool may_read_slot(const prjm_eval_register_instruction_t* ip, int32_t slot)
+{
+    return ip->src1 == slot || ip->src2 == slot || (ip->dst == slot && !writes_dst_slot(ip->opcode));
+}
+
+/**
+ * Checks if the given tree contains the variable, e.g. in a function executed via CALL_NODE.
+ */
+static bool tree_uses_variable(const prjm_eval_exptreenode_t* node, const PRJM_EVAL_F* var)
+{
+    if (node->func == prjm_eval_func_var && node->var == var)
+    {
+        return true;
+    }
+
+    if (node->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            if (tree_uses_variable(*arg, var))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Checks if the program may change the value of the variable slot, which means its lanes can diverge.
+ */
+static bool variable_is_changed(const prjm_eval_register_code_t* register_code, const prjm_eval_register_variable_t* variable)
+{
+    int32_t slot = variable->slot;
+
+    for (int32_t index = 0; index < register_code->instruction_count; index++)
+    {
+        const prjm_eval_register_instruction_t* ip = &register_code->instructions[index];
+        prjm_eval_register_opcode_t opcode = ip->opcode;
+
+        if ((writes_dst_slot(opcode) ||
+             opcode == PRJM_EVAL_REG_AND_TEST ||
+             opcode == PRJM_EVAL_REG_OR_TEST ||
+             opcode == PRJM_EVAL_REG_LOOP_INIT) && ip->dst == slot)
+        {
+            return true;
+        }
+        if ((opcode == PRJM_EVAL_REG_SLOT_REF || opcode == PRJM_EVAL_REG_LOOP_NEXT) && ip->src1 == slot)
+        {
+            return true;
+        }
+        if ((opcode == PRJM_EVAL_REG_CALL_NODE || opcode == PRJM_EVAL_REG_CALL_NODE_REF) &&
+            tree_uses_variable(ip->node, variable->var))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Returns the slot holding the same value as the given slot in all lanes, or -1 if the lanes may differ.
+ */
+static int32_t uniform_source(const int32_t* alias, const bool* uniform, int32_t slot)
+{
+    if (alias[slot] >= 0)
+    {
+        return alias[slot];
+    }
+
+    return uniform[slot] ? slot : -1;
+}
+
+/**
+ * Replaces a read slot with the slot holding the same uniform value.
+ */
+static void rewrite_source(const int32_t* alias, int32_t* slot)
+{
+    if (alias[*slot] >= 0)
+    {
+        *slot = alias[*slot];
+    }
+}
+
+/**
+ * Removes a move into a temporary slot if the slot is overwritten in the same basic block before being read.
+ * Moves of hoisted values are mostly followed by reads which were redirected to the hoisted slot.
+ */
+static bool is_dead_move(const prjm_eval_register_code_t* register_code,
+                         const prjm_eval_register_instruction_t* body,
+                         const bool* leader,
+                         const bool* escaped,
+                         int32_t index)
+{
+    int32_t slot = body[index].dst;
+    if (body[index].opcode != PRJM_EVAL_REG_MOV ||
+        slot < register_code->constant_count + register_code->variable_count ||
+        slot == register_code->result ||
+        escaped[slot])
+    {
+        return false;
+    }
+
+    for (int32_t next = index + 1; next < register_code->instruction_count && !leader[next]; next++)
+    {
+        const prjm_eval_register_instruction_t* ip = &body[next];
+        if (may_read_slot(ip, slot))
+        {
+            return false;
+        }
+        if ((writes_dst_slot(ip->opcode) && ip->dst == slot) || ip->opcode == PRJM_EVAL_REG_HALT)
+        {
+            return true;
+        }
+        if (has_target(ip->opcode))
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+int prjm_eval_batch_code_set_uniforms(prjm_eval_batch_code_t* code, PRJM_EVAL_F* const* variables, int variable_count)
+{
+    assert(code);
+
+    prjm_eval_register_code_t* register_code = code->code;
+    const prjm_eval_register_instruction_t* instructions = register_code->instructions;
+    int32_t instruction_count = register_code->instruction_count;
+    int32_t frame_size = code->base_frame_size;
+
+    int32_t* alias = malloc((frame_size + 1) * sizeof(int32_t));
+    bool* uniform = calloc(frame_size + 1, sizeof(bool));
+    bool* escaped = calloc(frame_size + 1, sizeof(bool));
+    bool* leader = calloc(instruction_count + 1, sizeof(bool));
+    int32_t* new_index = malloc((instruction_count + 1) * sizeof(int32_t));
+    prjm_eval_register_instruction_t* body = malloc(instruction_count * sizeof(prjm_eval_register_instruction_t));
+    prjm_eval_register_instruction_t* prologue = malloc(instruction_count * sizeof(prjm_eval_register_instruction_t));
+    PRJM_EVAL_F** uniform_variables = malloc((register_code->variable_count + 1) * sizeof(PRJM_EVAL_F*));
+    int32_t uniform_variable_count = 0;
+    int32_t prologue_length = 0;
+    int result = -1;
+
+    if (!alias || !uniform || !escaped || !leader || !new_index || !body || !prologue || !uniform_variables)
+    {
+        goto cleanup;
+    }
+
+    /* Constants and unchanged uniform variables are the same in all lanes. */
+    for (int32_t slot = 0; slot < register_code->constant_count; slot++)
+    {
+        uniform[slot] = true;
+    }
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        const prjm_eval_register_variable_t* variable = &register_code->variables[index];
+        for (int uniform_index = 0; uniform_index < variable_count; uniform_index++)
+        {
+            if (variables[uniform_index] == variable->var && !variable_is_changed(register_code, variable))
+            {
+                uniform[variable->slot] = true;
+                uniform_variables[uniform_variable_count++] = variable->var;
+                break;
+            }
+        }
+    }
+
+    /* Slots written via references keep their moves and are never replaced. Basic blocks start at jump targets. */
+    leader[0] = true;
+    for (int32_t index = 0; index < instruction_count; index++)
+    {
+        const prjm_eval_register_instruction_t* ip = &instructions[index];
+        if (ip->opcode == PRJM_EVAL_REG_SLOT_REF || ip->opcode == PRJM_EVAL_REG_CALL_NODE_REF)
+        {
+            escaped[ip->src1] = true;
+        }
+        else if (ip->opcode == PRJM_EVAL_REG_MEM_REF)
+        {
+            escaped[ip->src2] = true;
+        }
+        if (has_target(ip->opcode))
+        {
+            leader[ip->target] = true;
+            leader[index + 1] = true;
+        }
+    }
+
+    /* Within each basic block, track which slots hold uniform values. Pure operations on uniform values are moved
+     * into the prologue, leaving a move of the hoisted value, and later reads use the hoisted slot directly. */
+    int32_t hoisted_slot = frame_size;
+    for (int32_t index = 0; index < instruction_count; index++)
+    {
+        if (leader[index])
+        {
+            for (int32_t slot = 0; slot < frame_size; slot++)
+            {
+                alias[slot] = -1;
+            }
+        }
+
+        prjm_eval_register_instruction_t* ip = &body[index];
+        *ip = instructions[index];
+        prjm_eval_register_opcode_t opcode = ip->opcode;
+
+        if (is_pure_operation(opcode) || opcode == PRJM_EVAL_REG_MOV)
+        {
+            bool binary = opcode >= PRJM_EVAL_REG_EQUAL;
+            int32_t src1 = uniform_source(alias, uniform, ip->src1);
+            int32_t src2 = binary ? uniform_source(alias, uniform, ip->src2) : 0;
+
+            if (src1 >= 0 && src2 >= 0)
+            {
+                if (opcode != PRJM_EVAL_REG_MOV)
+                {
+                    prjm_eval_register_instruction_t* hoisted = &prologue[prologue_length++];
+                    memset(hoisted, 0, sizeof(prjm_eval_register_instruction_t));
+                    hoisted->opcode = opcode;
+                    hoisted->dst = hoisted_slot;
+                    hoisted->src1 = src1;
+                    hoisted->src2 = src2;
+
+                    ip->opcode = PRJM_EVAL_REG_MOV;
+                    src1 = hoisted_slot++;
+                }
+
+                ip->src1 = src1;
+                ip->src2 = 0;
+                alias[ip->dst] = escaped[ip->dst] ? -1 : src1;
+                continue;
+            }
+        }
+
+        switch (opcode)
+        {
+            case PRJM_EVAL_REG_MEM_STORE:
+                rewrite_source(alias, &ip->src2);
+                rewrite_source(alias, &ip->src1);
+                break;
+
+            case PRJM_EVAL_REG_MOV:
+            case PRJM_EVAL_REG_JUMP_IF_ZERO:
+            case PRJM_EVAL_REG_AND_TEST:
+            case PRJM_EVAL_REG_OR_TEST:
+            case PRJM_EVAL_REG_LOOP_INIT:
+            case PRJM_EVAL_REG_WHILE_NEXT:
+            case PRJM_EVAL_REG_STORE_REF:
+            case PRJM_EVAL_REG_MEM_LOAD:
+            case PRJM_EVAL_REG_MEM_REF:
+            case PRJM_EVAL_REG_FREEMBUF:
+                rewrite_source(alias, &ip->src1);
+                break;
+
+            default:
+                if (opcode >= PRJM_EVAL_REG_BOOL)
+                {
+                    rewrite_source(alias, &ip->src1);
+                    if (opcode >= PRJM_EVAL_REG_EQUAL)
+                    {
+                        rewrite_source(alias, &ip->src2);
+                    }
+                }
+                break;
+        }
+
+        /* Tree nodes and stores via references may change any variable. */
+        if (opcode == PRJM_EVAL_REG_CALL_NODE ||
+            opcode == PRJM_EVAL_REG_CALL_NODE_REF ||
+            opcode == PRJM_EVAL_REG_STORE_REF)
+        {
+            for (int32_t slot = 0; slot < frame_size; slot++)
+            {
+                alias[slot] = -1;
+            }
+        }
+        else
+        {
+            /* Reference register indices in dst can exceed the frame size. */
+            const prjm_eval_register_instruction_t* original = &instructions[index];
+            if (original->dst < frame_size)
+            {
+                alias[original->dst] = -1;
+            }
+            if (opcode == PRJM_EVAL_REG_LOOP_NEXT)
+            {
+                alias[original->src1] = -1;
+            }
+            if (opcode == PRJM_EVAL_REG_WHILE_NEXT || opcode == PRJM_EVAL_REG_MEM_REF)
+            {
+                alias[original->src2] = -1;
+            }
+        }
+    }
+
+    if (prologue_length == 0)
+    {
+        uniform_variable_count = 0;
+        frame_size = code->base_frame_size;
+    }
+    else
+    {
+        frame_size = hoisted_slot;
+
+        /* Remove the moves made obsolete and update the jump targets. */
+        int32_t length = 0;
+        for (int32_t index = 0; index < instruction_count; index++)
+        {
+            new_index[index] = length;
+            if (!is_dead_move(register_code, body, leader, escaped, index))
+            {
+                body[length++] = body[index];
+            }
+        }
+        new_index[instruction_count] = length;
+
+        for (int32_t index = 0; index < length; index++)
+        {
+            if (has_target(body[index].opcode))
+            {
+                body[index].target = new_index[body[index].target];
+            }
+        }
+    }
+
+    if (frame_size != register_code->frame_size && !allocate_frames(code, frame_size))
+    {
+        goto cleanup;
+    }
+
+    free(code->body);
+    free(code->prologue);
+    free(code->uniform_variables);
+
+    if (prologue_length > 0)
+    {
+        code->body = body;
+        code->prologue = prologue;
+        code->uniform_variables = uniform_variables;
+        body = NULL;
+        prologue = NULL;
+        uniform_variables = NULL;
+    }
+    else
+    {
+        code->body = NULL;
+        code->prologue = NULL;
+        code->uniform_variables = NULL;
+    }
+    code->prologue_length = prologue_length;
+    code->uniform_variable_count = uniform_variable_count;
+    result = prologue_length;
+
+cleanup:
+    free(alias);
+    free(uniform);
+    free(escaped);
+    free(leader);
+    free(new_index);
+    free(body);
+    free(prologue);
+    free(uniform_variables);
+
+    return result;
+}
+
+/**
+ * Computes the hoisted values once and copies them into all lanes of their slots.
+ */
+static void execute_prologue(prjm_eval_batch_code_t* code, bool single_precision)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+
+    prjm_eval_register_code_load_variables(register_code);
+    for (int32_t index = 0; index < code->prologue_length; index++)
+    {
+        prjm_eval_register_code_execute_instruction(register_code, &code->prologue[index]);
+    }
+
+    for (int32_t slot = code->base_frame_size; slot < register_code->frame_size; slot++)
+    {
+        PRJM_EVAL_F value = register_code->frame[slot];
+        if (single_precision)
+        {
+            float* float_frame = code->float_frame;
+            float* lanes = float_lane_slot(slot);
+            for (int lane = 0; lane < PRJM_EVAL_BATCH_FLOAT_WIDTH; lane++)
+            {
+                lanes[lane] = (float) value;
+            }
+        }
+        else
+        {
+            PRJM_EVAL_F* frame = code->frame;
+            PRJM_EVAL_F* lanes = lane_slot(slot);
+            for (int lane = 0; lane < PRJM_EVAL_BATCH_WIDTH; lane++)
+            {
+                lanes[lane] = value;
+            }
+        }
+    }
+}
+
+/**
+ * Loads the variables of the lanes starting at first_lane into the double precision frame.
+ */
+static void load_lane_values(prjm_eval_batch_code_t* code, int first_lane, int count)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+    PRJM_EVAL_F* frame = code->frame;
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        PRJM_EVAL_F* lanes = lane_slot(register_code->variables[index].slot);
+        if (code->lane_values[index])
+        {
+            memcpy(lanes, code->lane_values[index] + first_lane, count * sizeof(PRJM_EVAL_F));
+        }
+        else
+        {
+            for (int lane = 0; lane < count; lane++)
+            {
+                lanes[lane] = code->initial_values[index];
+            }
+        }
+    }
+}
+
+/**
+ * Stores the lane variables of the double precision frame.
+ */
+static void store_lane_values(prjm_eval_batch_code_t* code, int first_lane, int count)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+    PRJM_EVAL_F* frame = code->frame;
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        if (code->lane_values[index])
+        {
+            memcpy(code->lane_values[index] + first_lane, lane_slot(register_code->variables[index].slot),
+                   count * sizeof(PRJM_EVAL_F));
+        }
+    }
+}
+
+/**
+ * Loads the variables of the lanes starting at first_lane into the single precision frame.
+ */
+static void load_float_lane_values(prjm_eval_batch_code_t* code, int first_lane, int count)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+    float* float_frame = code->float_frame;
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        float* lanes = float_lane_slot(register_code->variables[index].slot);
+        if (code->lane_values[index])
+        {
+            const PRJM_EVAL_F* values = code->lane_values[index] + first_lane;
+            for (int lane = 0; lane < count; lane++)
+            {
+                lanes[lane] = (float) values[lane];
+            }
+        }
+        else
+        {
+            for (int lane = 0; lane < count; lane++)
+            {
+                lanes[lane] = (float) code->initial_values[index];
+            }
+        }
+    }
+}
+
+/**
+ * Stores the lane variables of the single precision frame. Values the lane didn't change keep their full precision.
+ */
+static void store_float_lane_values(prjm_eval_batch_code_t* code, int first_lane, int count)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+    float* float_frame = code->float_frame;
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        if (code->lane_values[index])
+        {
+            PRJM_EVAL_F* values = code->lane_values[index] + first_lane;
+            const float* lanes = float_lane_slot(register_code->variables[index].slot);
+            for (int lane = 0; lane < count; lane++)
+            {
+                values[lane] = lanes[lane] != (float) values[lane] ? lanes[lane] : values[lane];
+            }
+        }
+    }
+}
+
+void prjm_eval_batch_code_execute(prjm_eval_batch_code_t* code,
+                                  projectm_eval_precision precision,
+                                  const projectm_eval_lane_variable* lane_variables,
+                                  int lane_variable_count,
+                                  int lane_count,
+                                  PRJM_EVAL_F* results)
+{
+    assert(code);
+
+    prjm_eval_register_code_t* register_code = code->code;
+    const prjm_eval_register_variable_t* variables = register_code->variables;
+    bool single_precision = precision == PROJECTM_EVAL_PRECISION_FLOAT;
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        code->lane_values[index] = NULL;
+        code->initial_values[index] = *variables[index].var;
+
+        for (int lane_variable = 0; lane_variable < lane_variable_count; lane_variable++)
+        {
+            if (lane_variables[lane_variable].variable == variables[index].var)
+            {
+                code->lane_values[index] = lane_variables[lane_variable].values;
+            }
+        }
+    }
+
+    /* The hoisted values are only valid if no uniform variable has different values per lane. */
+    bool hoisted = code->body != NULL;
+    for (int32_t index = 0; index < code->uniform_variable_count && hoisted; index++)
+    {
+        for (int lane_variable = 0; lane_variable < lane_variable_count; lane_variable++)
+        {
+            if (lane_variables[lane_variable].variable == code->uniform_variables[index])
+            {
+                hoisted = false;
+            }
+        }
+    }
+
+    code->instructions = hoisted ? code->body : register_code->instructions;
+    if (hoisted)
+    {
+        execute_prologue(code, single_precision);
+    }
+
+    const prjm_eval_cpu_kernels_t* kernels = prjm_eval_cpu_kernels();
+
+    int batch_width = single_precision ? PRJM_EVAL_BATCH_FLOAT_WIDTH : PRJM_EVAL_BATCH_WIDTH;
+
+    int last_lane = 0;
+    for (int first_lane = 0; first_lane < lane_count; first_lane += batch_width)
+    {
+        int count = lane_count - first_lane;
+        if (count > batch_width)
+        {
+            count = batch_width;
+        }
+
+        if (single_precision)
+        {
+            load_float_lane_values(code, first_lane, count);
+            kernels->batch_execute_float_lanes(code, count);
+            store_float_lane_values(code, first_lane, count);
+
+            if (results)
+            {
+                float* float_frame = code->float_frame;
+                const float* result_lanes = float_lane_slot(register_code->result);
+                for (int lane = 0; lane < count; lane++)
+                {
+                    results[first_lane + lane] = result_lanes[lane];
+                }
+            }
+        }
+        else
+        {
+            load_lane_values(code, first_lane, count);
+            kernels->batch_execute_lanes(code, count);
+            store_lane_values(code, first_lane, count);
+
+            if (results)
+            {
+                PRJM_EVAL_F* frame = code->frame;
+                memcpy(results + first_lane, lane_slot(register_code->result), count * sizeof(PRJM_EVAL_F));
+            }
+        }
+
+        last_lane = count - 1;
+    }
+
+    /* Variables without lane values keep the value of the last lane, as if the lanes were executed one by one. */
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        if (code->lane_values[index])
+        {
+            continue;
+        }
+
+        if (single_precision)
+        {
+            float* float_frame = code->float_frame;
+            float value = float_lane_slot(variables[index].slot)[last_lane];
+            *variables[index].var = value != (float) code->initial_values[index] ? value : code->initial_values[index];
+        }
+        else
+        {
+            PRJM_EVAL_F* frame = code->frame;
+            *variables[index].var = lane_slot(variables[index].slot)[last_lane];
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file BatchCode.h
+ * @brief Executes register code for many lanes at once.
+ *
+ * The batch interpreter runs the same register code for up to PRJM_EVAL_BATCH_WIDTH lanes in lockstep. Each frame slot
+ * and reference register is stored as an array with one entry per lane (structure of arrays), so each instruction is
+ * a loop over all lanes the compiler can vectorize. Conditional jumps are evaluated per lane. If the lanes take
+ * different paths, the interpreter continues with the lanes at the lowest instruction index, using a lane mask, until
+ * all lanes arrive at the same instruction again.
+ *
+ * Batch code can also execute the lanes in single precision. It then uses a second lane frame holding floats, which
+ * is filled from and written back to the variables and lane arrays when a batch starts and ends. As a vector holds
+ * twice as many floats, single precision batches contain PRJM_EVAL_BATCH_FLOAT_WIDTH lanes.
+ *
+ * If the host marks variables as uniform, i.e. having the same value in all lanes, instructions computing values only
+ * from constants and uniform variables are moved into a prologue. The prologue is executed once per call and its
+ * results are copied into all lanes of additional frame slots, which the remaining instructions read instead.
+ */
+#pragma once
+
+#include "RegisterCode.h"
+
+/**
+ * @brief Number of lanes executed together.
+ */
+#define PRJM_EVAL_BATCH_WIDTH 16
+
+/**
+ * @brief Number of lanes executed together in single precision.
+ */
+#define PRJM_EVAL_BATCH_FLOAT_WIDTH 32
+
+/**
+ * @brief Returns the lane array of the given frame slot. Expects the lane frame in a local variable named frame.
+ */
+#define lane_slot(slot) (frame + (slot) * PRJM_EVAL_BATCH_WIDTH)
+
+/**
+ * @brief Returns the lane array of the given reference register. Expects the registers in a local variable named refs.
+ */
+#define lane_ref(ref) (refs + (ref) * PRJM_EVAL_BATCH_WIDTH)
+
+/**
+ * @brief Returns the lane array of the given slot in the single precision frame, expected in a variable named
+ *        float_frame.
+ */
+#define float_lane_slot(slot) (float_frame + (slot) * PRJM_EVAL_BATCH_FLOAT_WIDTH)
+
+/**
+ * @brief A program in register code, with a frame for PRJM_EVAL_BATCH_WIDTH lanes.
+ */
+typedef struct prjm_eval_batch_code
+{
+    prjm_eval_register_code_t* code; /*!< The register code, only its instructions and constants are used. */
+    PRJM_EVAL_F* frame; /*!< The lane frame, slot-major: the value of slot s for lane l is at s * width + l. */
+    PRJM_EVAL_F** refs; /*!< Reference registers, stored like the frame slots. */
+    PRJM_EVAL_F** lane_values; /*!< Per variable, the host's lane value array or NULL if the variable isn't bound. */
+    PRJM_EVAL_F* initial_values; /*!< Per variable, the value of unbound variables when the batch started. */
+    int32_t* lane_pc; /*!< Instruction index of each lane, while the lanes take different paths. */
+    float* float_frame; /*!< The lane frame for PRJM_EVAL_BATCH_FLOAT_WIDTH lanes in single precision. */
+    float** float_refs; /*!< Reference registers pointing into the single precision frame. */
+    PRJM_EVAL_F** memory_refs; /*!< In single precision, the referenced value outside of the lane frame, e.g. in
+                                    memory, stored like float_refs. NULL if the float_refs entry is used instead. */
+    const prjm_eval_register_instruction_t* instructions; /*!< The instructions executed for the lanes. */
+    int32_t base_frame_size; /*!< Number of frame slots used by the register code, without hoisted values. */
+    prjm_eval_register_instruction_t* body; /*!< The instructions without the hoisted ones, or NULL. */
+    prjm_eval_register_instruction_t* prologue; /*!< Instructions computing the hoisted values into scalar slots. */
+    int32_t prologue_length; /*!< Number of prologue instructions. */
+    PRJM_EVAL_F** uniform_variables; /*!< The uniform variables the body relies on. */
+    int32_t uniform_variable_count; /*!< Number of entries in uniform_variables. */
+} prjm_eval_batch_code_t;
+
+/**
+ * @brief Translates an expression tree into batch code.
+ * The tree must stay valid as long as the batch code is used, as functions without a register code
+ * representation are executed by calling their tree node function for each lane.
+ * @param tree The root node of the program tree.
+ * @return The batch code or NULL if the tree is empty or an allocation failed.
+ */
+prjm_eval_batch_code_t* prjm_eval_batch_code_create(prjm_eval_exptreenode_t* tree);
+
+/**
+ * @brief Frees the given batch code.
+ * @param code The batch code to free.
+ */
+void prjm_eval_batch_code_destroy(prjm_eval_batch_code_t* code);
+
+/**
+ * @brief Marks variables as having the same value in all lanes and hoists the computations depending only on them.
+ * Instructions which only depend on constants and uniform variables the program never changes are executed once per
+ * call in a prologue. Replaces the uniform variables of a previous call.
+ * @param code The batch code to change.
+ * @param variables The uniform variables. Variables not used by the program are ignored.
+ * @param variable_count Number of entries in variables, 0 to execute all instructions per lane again.
+ * @return The number of hoisted instructions, or -1 if an allocation failed. The code is unchanged then.
+ */
+int prjm_eval_batch_code_set_uniforms(prjm_eval_batch_code_t* code, PRJM_EVAL_F* const* variables, int variable_count);
+
+/**
+ * @brief Executes the program once per lane.
+ * Variables with lane values are loaded from and stored to their lane arrays. All other variables start with their
+ * current value in each lane and receive the value of the last lane after execution.
+ * With PROJECTM_EVAL_PRECISION_FLOAT, the lanes are executed in single precision. Variable and lane values which were
+ * not changed by the program are not overwritten then, so they don't lose precision.
+ * The hoisted instructions are only used if none of the uniform variables is bound to lane values.
+ * @param code The batch code to execute.
+ * @param precision The arithmetic precision to use.
+ * @param lane_variables The variables with per-lane values.
+ * @param lane_variable_count Number of entries in lane_variables.
+ * @param lane_count Number of lanes to execute.
+ * @param results If not NULL, receives the program's return value for each lane.
+ */
+void prjm_eval_batch_code_execute(prjm_eval_batch_code_t* code,
+                                  projectm_eval_precision precision,
+                                  const projectm_eval_lane_variable* lane_variables,
+                                  int lane_variable_count,
+                                  int lane_count,
+                                  PRJM_EVAL_F* results);
@@ -0,0 +1,696 @@
+/**
+ * @file BatchExecute.c
+ * @brief Implements the lane-parallel register code interpreter.
+ *
+ * While all lanes execute the same instruction, the lanes run "converged" and only a single instruction index is
+ * tracked. A conditional jump which sends the lanes to different instructions switches to per-lane instruction
+ * indices. The interpreter then always continues with the lanes at the lowest index and masks out all others. As the
+ * register code only jumps backwards to repeat loops, the lanes waiting at higher indices are reached again by the
+ * others, which also makes the lanes converge again after each "if" and loop.
+ *
+ * This file is compiled once for each CPU variant, see CpuDispatch.h. BatchExecuteFloat.c compiles it again with
+ * PRJM_EVAL_BATCH_FLOAT_LANES defined, which executes the lanes of the float frame in single precision.
+ */
+#include "BatchCode.h"
+
+#include "CpuDispatch.h"
+#include "IntrinsicMath.h"
+#include "MemoryBuffer.h"
+
+#include <assert.h>
+#include <float.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef PRJM_EVAL_BATCH_FLOAT_LANES
+
+/* Math functions like sin() called with float operands use the float implementation, e.g. sinf(). */
+#include <tgmath.h>
+
+typedef float lane_value_t;
+
+#define LANE_WIDTH PRJM_EVAL_BATCH_FLOAT_WIDTH
+#define lane_frame(code) ((code)->float_frame)
+#define lane_refs(code) ((code)->float_refs)
+#define PRJM_EVAL_BATCH_EXECUTE_LANES batch_execute_float_lanes
+
+/*
+ * Compare against the thresholds in single precision. close_factor_low would round to zero, which makes every "equal"
+ * or "not" test fail. FLT_MIN only differs for subnormal floats, which -ffast-math builds flush to zero anyway.
+ */
+#define close_factor ((lane_value_t) close_factor)
+#define close_factor_low FLT_MIN
+
+/* With -ffast-math, vectorized float divisions use an approximate reciprocal. prjm_eval_math_div() divides in
+ * PRJM_EVAL_F precision and rounds like the other engines, its zero check never applies to DIV_NONZERO operands. */
+#define prjm_eval_math_div_nonzero prjm_eval_math_div
+
+/**
+ * Returns the memory reference array of the given reference register. Expects the batch code in a variable named code.
+ */
+#define lane_memory_ref(ref) (code->memory_refs + (ref) * LANE_WIDTH)
+
+#else
+
+typedef PRJM_EVAL_F lane_value_t;
+
+#define LANE_WIDTH PRJM_EVAL_BATCH_WIDTH
+#define lane_frame(code) ((code)->frame)
+#define lane_refs(code) ((code)->refs)
+#define PRJM_EVAL_BATCH_EXECUTE_LANES batch_execute_lanes
+
+#endif
+
+/* Larger distances between the memory indices of two lanes never stay within a memory block. */
+#define PRJM_EVAL_BATCH_MAX_MEMORY_STRIDE 65536
+
+/* The frame and reference registers store LANE_WIDTH values per slot. */
+#undef lane_slot
+#undef lane_ref
+#define lane_slot(slot) (frame + (slot) * LANE_WIDTH)
+#define lane_ref(ref) (refs + (ref) * LANE_WIDTH)
+
+/**
+ * Sets a lane's reference register to a lane slot or, if slot is NULL, to a value outside of the frame.
+ */
+static inline void set_lane_ref(prjm_eval_batch_code_t* code, int32_t ref, int lane,
+                                lane_value_t* slot, PRJM_EVAL_F* value)
+{
+    lane_value_t** refs = lane_refs(code);
+#ifdef PRJM_EVAL_BATCH_FLOAT_LANES
+    lane_ref(ref)[lane] = slot;
+    lane_memory_ref(ref)[lane] = slot ? NULL : value;
+#else
+    lane_ref(ref)[lane] = slot ? slot : value;
+#endif
+}
+
+static inline lane_value_t load_lane_ref(prjm_eval_batch_code_t* code, int32_t ref, int lane)
+{
+    lane_value_t** refs = lane_refs(code);
+#ifdef PRJM_EVAL_BATCH_FLOAT_LANES
+    if (lane_memory_ref(ref)[lane])
+    {
+        return (lane_value_t) *lane_memory_ref(ref)[lane];
+    }
+#endif
+    return *lane_ref(ref)[lane];
+}
+
+static inline void store_lane_ref(prjm_eval_batch_code_t* code, int32_t ref, int lane, lane_value_t value)
+{
+    lane_value_t** refs = lane_refs(code);
+#ifdef PRJM_EVAL_BATCH_FLOAT_LANES
+    if (lane_memory_ref(ref)[lane])
+    {
+        *lane_memory_ref(ref)[lane] = value;
+        return;
+    }
+#endif
+    *lane_ref(ref)[lane] = value;
+}
+
+/**
+ * Runs the statement for each active lane. If all lanes are active, the loop has no conditions, so the compiler can
+ * vectorize it.
+ */
+#define for_each_lane(statement) \
+    if (full)                    \
+    {                            \
+        for (int lane = 0; lane < LANE_WIDTH; lane++) \
+        {                        \
+            statement            \
+        }                        \
+    }                            \
+    else                         \
+    {                            \
+        for (int lane = 0; lane < LANE_WIDTH; lane++) \
+        {                        \
+            if (active[lane])    \
+            {                    \
+                statement        \
+            }                    \
+        }                        \
+    }
+
+/**
+ * Copies the results of an operation into the active lanes of the destination slot.
+ */
+static inline void store_lanes(lane_value_t* dst, const lane_value_t* result, const bool* active, bool full)
+{
+    if (full)
+    {
+        memcpy(dst, result, LANE_WIDTH * sizeof(lane_value_t));
+        return;
+    }
+
+    for (int lane = 0; lane < LANE_WIDTH; lane++)
+    {
+        if (active[lane])
+        {
+            dst[lane] = result[lane];
+        }
+    }
+}
+
+static inline lane_value_t loop_count(lane_value_t count)
+{
+    PRJM_EVAL_I loop_count_int = (PRJM_EVAL_I) count;
+    /* Limit execution count */
+    if (loop_count_int > MAX_LOOP_COUNT)
+    {
+        loop_count_int = MAX_LOOP_COUNT;
+    }
+    return (lane_value_t) loop_count_int;
+}
+
+/**
+ * Checks if all lanes access memory items in the same block at a constant distance, like the iterations of a
+ * vectorized loop.
+ * @param stride Receives the distance of the items accessed by two neighboring lanes.
+ * @return The address of the first lane's item, or NULL if each lane must look up its address.
+ */
+static PRJM_EVAL_F* find_strided_address(projectm_eval_mem_buffer memory_buffer,
+                                         const lane_value_t* indices,
+                                         int32_t* stride)
+{
+    lane_value_t first = indices[0];
+    lane_value_t step = indices[1] - first;
+    if (first < 0 || first != floor(first) || step != floor(step) || fabs(step) > PRJM_EVAL_BATCH_MAX_MEMORY_STRIDE)
+    {
+        return NULL;
+    }
+
+    bool strided = true;
+    for (int lane = 2; lane < LANE_WIDTH; lane++)
+    {
+        strided &= indices[lane] == first + lane * step;
+    }
+
+    int32_t first_index = prjm_eval_math_mem_index(first);
+    *stride = (int32_t) step;
+    if (!strided || prjm_eval_memory_block_run(first_index, *stride) < LANE_WIDTH - 1)
+    {
+        return NULL;
+    }
+
+    return prjm_eval_memory_allocate(memory_buffer, first_index);
+}
+
+/**
+ * Executes a tree node for a single lane. The node accesses the context variables directly, so the lane's
+ * variable values are copied into them before and read back afterwards.
+ */
+static void call_node(prjm_eval_batch_code_t* code, const prjm_eval_register_instruction_t* ip, int lane)
+{
+    prjm_eval_register_code_t* register_code = code->code;
+    lane_value_t* frame = lane_frame(code);
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        *register_code->variables[index].var = lane_slot(register_code->variables[index].slot)[lane];
+    }
+
+    if (ip->opcode == PRJM_EVAL_REG_CALL_NODE)
+    {
+        lane_slot(ip->dst)[lane] = ip->node->value_func(ip->node);
+    }
+    else
+    {
+        PRJM_EVAL_F value = .0;
+        PRJM_EVAL_F* value_ptr = &value;
+        ip->node->func(ip->node, &value_ptr);
+
+        /* Plain values are kept in the scratch slot, references to context variables are replaced by a reference to
+         * the lane's slot. */
+        lane_value_t* slot_ptr = NULL;
+        if (value_ptr == &value)
+        {
+            slot_ptr = &lane_slot(ip->src1)[lane];
+            *slot_ptr = value;
+        }
+        for (int32_t index = 0; index < register_code->variable_count && !slot_ptr; index++)
+        {
+            if (register_code->variables[index].var == value_ptr)
+            {
+                slot_ptr = &lane_slot(register_code->variables[index].slot)[lane];
+            }
+        }
+        set_lane_ref(code, ip->dst, lane, slot_ptr, value_ptr);
+    }
+
+    for (int32_t index = 0; index < register_code->variable_count; index++)
+    {
+        lane_slot(register_code->variables[index].slot)[lane] = *register_code->variables[index].var;
+    }
+}
+
+/**
+ * Executes transcendental operations with the array math kernels if all lanes are active. Other operations, like
+ * invsqrt, vectorize well enough in the generic lane loop. The kernels compute in double precision, so single
+ * precision lanes are converted before and after the kernel call.
+ * @return true if the instruction was executed.
+ */
+static bool execute_vector_operation(prjm_eval_batch_code_t* code, const prjm_eval_register_instruction_t* ip)
+{
+    void (* unary_kernel)(PRJM_EVAL_F*, const PRJM_EVAL_F*, int) = NULL;
+    void (* binary_kernel)(PRJM_EVAL_F*, const PRJM_EVAL_F*, const PRJM_EVAL_F*, int) = NULL;
+
+    switch (ip->opcode)
+    {
+        case PRJM_EVAL_REG_SIN:
+            unary_kernel = PRJM_EVAL_CPU_KERNEL(vector_sin);
+            break;
+
+        case PRJM_EVAL_REG_COS:
+            unary_kernel = PRJM_EVAL_CPU_KERNEL(vector_cos);
+            break;
+
+        case PRJM_EVAL_REG_EXP:
+            unary_kernel = PRJM_EVAL_CPU_KERNEL(vector_exp);
+            break;
+
+        case PRJM_EVAL_REG_LOG:
+            unary_kernel = PRJM_EVAL_CPU_KERNEL(vector_log);
+            break;
+
+#ifndef PRJM_EVAL_BATCH_FLOAT_LANES
+        /* The float square root is a single instruction. */
+        case PRJM_EVAL_REG_SQRT:
+            unary_kernel = PRJM_EVAL_CPU_KERNEL(vector_sqrt);
+            break;
+#endif
+
+        case PRJM_EVAL_REG_POW:
+            binary_kernel = PRJM_EVAL_CPU_KERNEL(vector_pow);
+            break;
+
+        case PRJM_EVAL_REG_ATAN2:
+            binary_kernel = PRJM_EVAL_CPU_KERNEL(vector_atan2);
+            break;
+
+        default:
+            return false;
+    }
+
+    lane_value_t* frame = lane_frame(code);
+
+#ifdef PRJM_EVAL_BATCH_FLOAT_LANES
+    PRJM_EVAL_F dst[LANE_WIDTH];
+    PRJM_EVAL_F src1[LANE_WIDTH];
+    PRJM_EVAL_F src2[LANE_WIDTH];
+    const lane_value_t* src1_lanes = lane_slot(ip->src1);
+    const lane_value_t* src2_lanes = lane_slot(ip->src2);
+    for (int lane = 0; lane < LANE_WIDTH; lane++)
+    {
+        src1[lane] = src1_lanes[lane];
+        src2[lane] = src2_lanes[lane];
+    }
+#else
+    PRJM_EVAL_F* dst = lane_slot(ip->dst);
+    const PRJM_EVAL_F* src1 = lane_slot(ip->src1);
+    const PRJM_EVAL_F* src2 = lane_slot(ip->src2);
+#endif
+
+    if (unary_kernel)
+    {
+        unary_kernel(dst, src1, LANE_WIDTH);
+    }
+    else
+    {
+        binary_kernel(dst, src1, src2, LANE_WIDTH);
+    }
+
+#ifdef PRJM_EVAL_BATCH_FLOAT_LANES
+    lane_value_t* dst_lanes = lane_slot(ip->dst);
+    for (int lane = 0; lane < LANE_WIDTH; lane++)
+    {
+        dst_lanes[lane] = (lane_value_t) dst[lane];
+    }
+#endif
+
+    return true;
+}
+
+/**
+ * Executes an instruction which doesn't change the control flow for all active lanes.
+ */
+static void execute_instruction(prjm_eval_batch_code_t* code, const prjm_eval_register_instruction_t* ip,
+                                const bool* active, bool full)
+{
+    lane_value_t* frame = lane_frame(code);
+    lane_value_t result[LANE_WIDTH];
+
+    if (full && execute_vector_operation(code, ip))
+    {
+        return;
+    }
+
+    switch (ip->opcode)
+    {
+        case PRJM_EVAL_REG_MOV:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            for_each_lane(result[lane] = src1[lane];)
+            store_lanes(lane_slot(ip->dst), result, active, full);
+            break;
+        }
+
+        case PRJM_EVAL_REG_LOOP_INIT:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            for_each_lane(result[lane] = loop_count(src1[lane]);)
+            store_lanes(lane_slot(ip->dst), result, active, full);
+            break;
+        }
+
+        case PRJM_EVAL_REG_CALL_NODE:
+        case PRJM_EVAL_REG_CALL_NODE_REF:
+            for_each_lane(call_node(code, ip, lane);)
+            break;
+
+        case PRJM_EVAL_REG_SLOT_REF:
+        {
+            lane_value_t* src1 = lane_slot(ip->src1);
+            for_each_lane(set_lane_ref(code, ip->dst, lane, &src1[lane], NULL);)
+            break;
+        }
+
+        case PRJM_EVAL_REG_LOAD_REF:
+            for_each_lane(result[lane] = load_lane_ref(code, ip->src1, lane);)
+            store_lanes(lane_slot(ip->dst), result, active, full);
+            break;
+
+        case PRJM_EVAL_REG_STORE_REF:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            for_each_lane(store_lane_ref(code, ip->dst, lane, src1[lane]);)
+            break;
+        }
+
+        /* Memory accesses gather and scatter the values of each lane individually, unless the lanes access items at a
+         * constant distance in the same block. */
+        case PRJM_EVAL_REG_MEM_LOAD:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            int32_t stride;
+            PRJM_EVAL_F* address = full ? find_strided_address(ip->memory_buffer, src1, &stride) : NULL;
+            if (address)
+            {
+                for (int lane = 0; lane < LANE_WIDTH; lane++)
+                {
+                    result[lane] = (lane_value_t) address[lane * stride];
+                }
+                store_lanes(lane_slot(ip->dst), result, active, full);
+                break;
+            }
+
+            for_each_lane(
+                PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                                  prjm_eval_math_mem_index(src1[lane]));
+                result[lane] = mem_addr ? *mem_addr : .0;
+            )
+            store_lanes(lane_slot(ip->dst), result, active, full);
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_STORE:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            const lane_value_t* src2 = lane_slot(ip->src2);
+            int32_t stride;
+            PRJM_EVAL_F* address = full ? find_strided_address(ip->memory_buffer, src1, &stride) : NULL;
+            if (address)
+            {
+                for (int lane = 0; lane < LANE_WIDTH; lane++)
+                {
+                    address[lane * stride] = src2[lane];
+                }
+                break;
+            }
+
+            for_each_lane(
+                PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                                  prjm_eval_math_mem_index(src1[lane]));
+                if (mem_addr)
+                {
+                    *mem_addr = src2[lane];
+                }
+            )
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_REF:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            lane_value_t* src2 = lane_slot(ip->src2);
+            int32_t stride;
+            PRJM_EVAL_F* address = full ? find_strided_address(ip->memory_buffer, src1, &stride) : NULL;
+            if (address)
+            {
+                for (int lane = 0; lane < LANE_WIDTH; lane++)
+                {
+                    set_lane_ref(code, ip->dst, lane, NULL, address + lane * stride);
+                }
+                break;
+            }
+
+            for_each_lane(
+                PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                                  prjm_eval_math_mem_index(src1[lane]));
+                if (mem_addr)
+                {
+                    set_lane_ref(code, ip->dst, lane, NULL, mem_addr);
+                }
+                else
+                {
+                    src2[lane] = .0;
+                    set_lane_ref(code, ip->dst, lane, &src2[lane], NULL);
+                }
+            )
+            break;
+        }
+
+        case PRJM_EVAL_REG_FREEMBUF:
+        {
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            for_each_lane(prjm_eval_memory_free_block(ip->memory_buffer, prjm_eval_math_mem_index(src1[lane]));)
+            break;
+        }
+
+        /* The memory functions take their arguments by reference, so they get copies in the storage precision. */
+        case PRJM_EVAL_REG_MEMCPY:
+        {
+            const lane_value_t* dst = lane_slot(ip->dst);
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            const lane_value_t* src2 = lane_slot(ip->src2);
+            for_each_lane(
+                PRJM_EVAL_F dest = dst[lane];
+                PRJM_EVAL_F src = src1[lane];
+                PRJM_EVAL_F len = src2[lane];
+                prjm_eval_memory_copy(ip->memory_buffer, &dest, &src, &len);
+            )
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEMSET:
+        {
+            const lane_value_t* dst = lane_slot(ip->dst);
+            const lane_value_t* src1 = lane_slot(ip->src1);
+            const lane_value_t* src2 = lane_slot(ip->src2);
+            for_each_lane(
+                PRJM_EVAL_F dest = dst[lane];
+                PRJM_EVAL_F value = src1[lane];
+                PRJM_EVAL_F len = src2[lane];
+                prjm_eval_memory_set(ip->memory_buffer, &dest, &value, &len);
+            )
+            break;
+        }
+
+#define PRJM_EVAL_BATCH_UNARY_CASE(name, expr)                 \
+        case PRJM_EVAL_REG_ ## name:                           \
+        {                                                      \
+            const lane_value_t* src1 = lane_slot(ip->src1);     \
+            for_each_lane(                                     \
+                lane_value_t a = src1[lane];                   \
+                result[lane] = (expr);                         \
+            )                                                  \
+            store_lanes(lane_slot(ip->dst), result, active, full); \
+            break;                                             \
+        }
+
+#define PRJM_EVAL_BATCH_BINARY_CASE(name, expr)                \
+        case PRJM_EVAL_REG_ ## name:                           \
+        {                                                      \
+            const lane_value_t* src1 = lane_slot(ip->src1);     \
+            const lane_value_t* src2 = lane_slot(ip->src2);     \
+            for_each_lane(                                     \
+                lane_value_t a = src1[lane];                   \
+                lane_value_t b = src2[lane];                   \
+                result[lane] = (expr);                         \
+            )                                                  \
+            store_lanes(lane_slot(ip->dst), result, active, full); \
+            break;                                             \
+        }
+
+        PRJM_EVAL_REGISTER_UNARY_OPERATIONS(PRJM_EVAL_BATCH_UNARY_CASE)
+        PRJM_EVAL_REGISTER_BINARY_OPERATIONS(PRJM_EVAL_BATCH_BINARY_CASE)
+
+#undef PRJM_EVAL_BATCH_UNARY_CASE
+#undef PRJM_EVAL_BATCH_BINARY_CASE
+
+        default:
+            /* Control flow instructions are handled by execute_lanes(). */
+            assert(false);
+            break;
+    }
+}
+
+static bool is_jump(prjm_eval_register_opcode_t opcode)
+{
+    return opcode == PRJM_EVAL_REG_JUMP ||
+           opcode == PRJM_EVAL_REG_JUMP_IF_ZERO ||
+           opcode == PRJM_EVAL_REG_AND_TEST ||
+           opcode == PRJM_EVAL_REG_OR_TEST ||
+           opcode == PRJM_EVAL_REG_LOOP_NEXT ||
+           opcode == PRJM_EVAL_REG_WHILE_NEXT;
+}
+
+/**
+ * Executes a jump instruction for a single lane, see prjm_eval_register_code_execute().
+ * @return true if the lane jumps to the instruction's target.
+ */
+static bool lane_takes_jump(prjm_eval_batch_code_t* code, const prjm_eval_register_instruction_t* ip, int lane)
+{
+    lane_value_t* frame = lane_frame(code);
+
+    switch (ip->opcode)
+    {
+        case PRJM_EVAL_REG_JUMP_IF_ZERO:
+            return lane_slot(ip->src1)[lane] == 0;
+
+        case PRJM_EVAL_REG_AND_TEST:
+            if (fabs(lane_slot(ip->src1)[lane]) > close_factor_low)
+            {
+                return false;
+            }
+            lane_slot(ip->dst)[lane] = 0.0;
+            return true;
+
+        case PRJM_EVAL_REG_OR_TEST:
+            if (fabs(lane_slot(ip->src1)[lane]) < close_factor_low)
+            {
+                return false;
+            }
+            lane_slot(ip->dst)[lane] = 1.0;
+            return true;
+
+        case PRJM_EVAL_REG_LOOP_NEXT:
+            if (lane_slot(ip->src1)[lane] <= 0)
+            {
+                return true;
+            }
+            lane_slot(ip->src1)[lane] -= 1;
+            return false;
+
+        case PRJM_EVAL_REG_WHILE_NEXT:
+            return fabs(lane_slot(ip->src1)[lane]) > close_factor_low && (lane_slot(ip->src2)[lane] -= 1) != 0;
+
+        default:
+            return true;
+    }
+}
+
+/**
+ * Executes the register code for the first lane_count lanes of the frame. This is batch_execute_lanes() or, in single
+ * precision, batch_execute_float_lanes().
+ */
+void PRJM_EVAL_CPU_KERNEL(PRJM_EVAL_BATCH_EXECUTE_LANES)(prjm_eval_batch_code_t* code, int lane_count)
+{
+    const prjm_eval_register_instruction_t* instructions = code->instructions;
+    int32_t* lane_pc = code->lane_pc;
+
+    bool active[LANE_WIDTH];
+    for (int lane = 0; lane < LANE_WIDTH; lane++)
+    {
+        active[lane] = lane < lane_count;
+    }
+
+    int32_t pc = 0;
+    bool converged = true;
+    bool full = lane_count == LANE_WIDTH;
+
+    for (;;)
+    {
+        if (!converged)
+        {
+            /* Continue with the lanes at the lowest instruction index. */
+            pc = lane_pc[0];
+            for (int lane = 1; lane < lane_count; lane++)
+            {
+                if (lane_pc[lane] < pc)
+                {
+                    pc = lane_pc[lane];
+                }
+            }
+
+            converged = true;
+            for (int lane = 0; lane < lane_count; lane++)
+            {
+                active[lane] = lane_pc[lane] == pc;
+                converged = converged && active[lane];
+            }
+            full = converged && lane_count == LANE_WIDTH;
+        }
+
+        const prjm_eval_register_instruction_t* ip = instructions + pc;
+
+        /* The program ends with the only HALT instruction, so all lanes have arrived there. */
+        if (ip->opcode == PRJM_EVAL_REG_HALT)
+        {
+            return;
+        }
+
+        if (!is_jump(ip->opcode))
+        {
+            execute_instruction(code, ip, active, full);
+
+            if (converged)
+            {
+                pc++;
+            }
+            else
+            {
+                for (int lane = 0; lane < lane_count; lane++)
+                {
+                    lane_pc[lane] += active[lane];
+                }
+            }
+            continue;
+        }
+
+        if (converged && ip->opcode == PRJM_EVAL_REG_JUMP)
+        {
+            pc = ip->target;
+            continue;
+        }
+
+        for (int lane = 0; lane < lane_count; lane++)
+        {
+            if (active[lane])
+            {
+                lane_pc[lane] = lane_takes_jump(code, ip, lane) ? ip->target : pc + 1;
+            }
+        }
+
+        if (converged)
+        {
+            /* All lanes were active, check if they still continue at the same instruction. */
+            for (int lane = 1; lane < lane_count && converged; lane++)
+            {
+                converged = lane_pc[lane] == lane_pc[0];
+            }
+            pc = lane_pc[0];
+        }
+    }
+}
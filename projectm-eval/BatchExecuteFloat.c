@@ -0,0 +1,9 @@
+/**
+ * @file BatchExecuteFloat.c
+ * @brief Compiles the batch interpreter for lanes in single precision.
+ *
+ * Like BatchExecute.c, this file is compiled once for each CPU variant, see CpuDispatch.h.
+ */
+#define PRJM_EVAL_BATCH_FLOAT_LANES
+
+#include "BatchExecute.c"
@@ -0,0 +1,1176 @@
+/**
+ * @file Bytecode.c
+ * @brief Implements the bytecode generator and the stack machine interpreter.
+ *
+ * The machine uses two stacks: a value stack for numbers and a reference stack for pointers to variables or memory
+ * locations. References are only generated if the consuming function needs an lvalue, e.g. the left operand of an
+ * assignment. Functions which cannot be expressed in bytecode are executed by calling the tree node function.
+ */
+#include "Bytecode.h"
+
+#include "ExpressionTree.h"
+#include "IntrinsicMath.h"
+#include "MemoryBuffer.h"
+#include "TreeFunctions.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @brief Declares the three opcodes for a compound assignment operator.
+ * The order is important, as the code generator uses the VAR opcode as the base for the other two.
+ */
+#define PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, name) \
+    OP(name ## _ASSIGN_VAR) /* Applies the operator to a variable, leaves the result on the stack. */ \
+    OP(name ## _ASSIGN_REF) /* Applies the operator to a popped reference, leaves the result on the stack. */ \
+    OP(name ## _ASSIGN_REF_KEEP) /* Applies the operator to the top reference and pops the value. */
+
+/**
+ * @brief List of all opcodes.
+ * Used to declare the opcode enum and the dispatch table of the interpreter.
+ */
+#define PRJM_EVAL_BYTECODE_OPCODES(OP) \
+    /* Stack and control flow operations */ \
+    OP(HALT) /* Ends execution, returns the top value. */ \
+    OP(CONST) /* Pushes a constant value. */ \
+    OP(VAR) /* Pushes the value of a variable. */ \
+    OP(PUSH_REF) /* Pushes a variable reference. */ \
+    OP(TO_REF) /* Moves the top value into a temporary slot and pushes a reference to it. */ \
+    OP(LOAD_REF_UNDER) /* Pops a reference and inserts its value below the top value. */ \
+    OP(POP) /* Discards the top value. */ \
+    OP(JUMP) /* Jumps unconditionally. */ \
+    OP(JUMP_IF_ZERO) /* Pops a value and jumps if it is exactly zero. */ \
+    OP(AND_TEST) /* Short-circuit "&&": keeps 0 and jumps if the top value is false, pops it otherwise. */ \
+    OP(OR_TEST) /* Short-circuit "||": keeps 1 and jumps if the top value is true, pops it otherwise. */ \
+    OP(LOOP_PREP) /* Pushes the clamped loop counter for the count value on top. */ \
+    OP(LOOP_TEST) /* Jumps if the counter is depleted, decrements it otherwise. */ \
+    OP(LOOP_STORE) /* Pops the body result and stores it as the loop result below the counter. */ \
+    OP(WHILE_TEST) /* Pops the condition and jumps back if true and the counter is not depleted. */ \
+    OP(CALL_NODE) /* Executes a tree node and pushes its value. */ \
+    OP(CALL_NODE_REF) /* Executes a tree node and pushes the returned reference. */ \
+    \
+    /* Assignments */ \
+    OP(STORE_VAR) /* Stores the top value in a variable. */ \
+    OP(STORE_VAR_POP) /* Pops the top value and stores it in a variable. */ \
+    OP(STORE_REF) /* Stores the top value at a popped reference. */ \
+    OP(STORE_REF_KEEP) /* Stores a popped value at the top reference. */ \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, ADD) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, SUB) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, MUL) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, DIV) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, MOD) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, BITWISE_OR) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, BITWISE_AND) \
+    PRJM_EVAL_BYTECODE_ASSIGN_OPS(OP, POW) \
+    \
+    /* Memory access */ \
+    OP(MEM_LOAD) /* Replaces the top index with the value stored in the memory buffer. */ \
+    OP(MEM_REF) /* Pops an index and pushes a reference into the memory buffer. */ \
+    OP(FREEMBUF) /* Frees the memory block at the top index. */ \
+    OP(MEMCPY) /* Pops count and source index, copies memory to the destination index on top. */ \
+    OP(MEMSET) /* Pops count and value, sets memory starting at the destination index on top. */ \
+    \
+    /* Unary operators and functions */ \
+    OP(BOOL) /* Converts the top value to 0.0 or 1.0. */ \
+    OP(BNOT) \
+    OP(NEG) \
+    OP(SIN) \
+    OP(COS) \
+    OP(TAN) \
+    OP(ASIN) \
+    OP(ACOS) \
+    OP(ATAN) \
+    OP(SQRT) \
+    OP(EXP) \
+    OP(LOG) \
+    OP(LOG10) \
+    OP(FLOOR) \
+    OP(CEIL) \
+    OP(SQR) \
+    OP(ABS) \
+    OP(SIGN) \
+    OP(RAND) \
+    OP(INVSQRT) \
+    \
+    /* Binary operators and functions */ \
+    OP(EQUAL) \
+    OP(NOTEQUAL) \
+    OP(BELOW) \
+    OP(ABOVE) \
+    OP(BELOWEQ) \
+    OP(ABOVEEQ) \
+    OP(ADD) \
+    OP(SUB) \
+    OP(MUL) \
+    OP(DIV) \
+    OP(DIV_NONZERO) \
+    OP(MOD) \
+    OP(BITWISE_OR) \
+    OP(BITWISE_AND) \
+    OP(BOOLEAN_AND) \
+    OP(BOOLEAN_OR) \
+    OP(POW) \
+    OP(ATAN2) \
+    OP(MIN) \
+    OP(MAX) \
+    OP(SIGMOID)
+
+#define PRJM_EVAL_BYTECODE_ENUM(name) PRJM_EVAL_OP_ ## name,
+
+typedef enum prjm_eval_bytecode_opcode
+{
+    PRJM_EVAL_BYTECODE_OPCODES(PRJM_EVAL_BYTECODE_ENUM)
+} prjm_eval_bytecode_opcode_t;
+
+typedef struct prjm_eval_bytecode_instruction
+{
+    prjm_eval_bytecode_opcode_t opcode; /*!< The operation to execute. */
+    int32_t operand; /*!< Jump target or temporary slot index, depending on the opcode. */
+    union
+    {
+        PRJM_EVAL_F value; /*!< Constant value. */
+        PRJM_EVAL_F* var; /*!< Variable reference. */
+        projectm_eval_mem_buffer memory_buffer; /*!< megabuf/gmegabuf memory block. */
+        prjm_eval_exptreenode_t* node; /*!< Tree node executed by the CALL_NODE opcodes. */
+    };
+} prjm_eval_bytecode_instruction_t;
+
+struct prjm_eval_bytecode
+{
+    prjm_eval_bytecode_instruction_t* code; /*!< The instruction array. */
+    PRJM_EVAL_F* value_stack; /*!< Value stack, large enough for the deepest expression. */
+    PRJM_EVAL_F** ref_stack; /*!< Reference stack, large enough for the deepest expression. */
+    PRJM_EVAL_F* temps; /*!< Temporary values referenced by the stack. */
+};
+
+typedef enum prjm_eval_bytecode_mode
+{
+    PRJM_EVAL_BYTECODE_MODE_VALUE, /*!< The expression pushes its value. */
+    PRJM_EVAL_BYTECODE_MODE_REF, /*!< The expression pushes a reference. */
+    PRJM_EVAL_BYTECODE_MODE_DISCARD /*!< The expression result is not needed. */
+} prjm_eval_bytecode_mode_t;
+
+typedef struct prjm_eval_bytecode_builder
+{
+    prjm_eval_bytecode_instruction_t* code;
+    int32_t length;
+    int32_t capacity;
+    int32_t depth;
+    int32_t max_depth;
+    int32_t ref_depth;
+    int32_t max_ref_depth;
+    int32_t temp_count;
+    bool failed;
+} prjm_eval_bytecode_builder_t;
+
+typedef struct prjm_eval_bytecode_func_map
+{
+    prjm_eval_expr_func_t* func;
+    prjm_eval_bytecode_opcode_t opcode;
+} prjm_eval_bytecode_func_map_t;
+
+static const prjm_eval_bytecode_func_map_t unary_functions[] = {
+    { prjm_eval_func_bnot,    PRJM_EVAL_OP_BNOT },
+    { prjm_eval_func_neg,     PRJM_EVAL_OP_NEG },
+    { prjm_eval_func_sin,     PRJM_EVAL_OP_SIN },
+    { prjm_eval_func_cos,     PRJM_EVAL_OP_COS },
+    { prjm_eval_func_tan,     PRJM_EVAL_OP_TAN },
+    { prjm_eval_func_asin,    PRJM_EVAL_OP_ASIN },
+    { prjm_eval_func_acos,    PRJM_EVAL_OP_ACOS },
+    { prjm_eval_func_atan,    PRJM_EVAL_OP_ATAN },
+    { prjm_eval_func_sqrt,    PRJM_EVAL_OP_SQRT },
+    { prjm_eval_func_exp,     PRJM_EVAL_OP_EXP },
+    { prjm_eval_func_log,     PRJM_EVAL_OP_LOG },
+    { prjm_eval_func_log10,   PRJM_EVAL_OP_LOG10 },
+    { prjm_eval_func_floor,   PRJM_EVAL_OP_FLOOR },
+    { prjm_eval_func_ceil,    PRJM_EVAL_OP_CEIL },
+    { prjm_eval_func_sqr,     PRJM_EVAL_OP_SQR },
+    { prjm_eval_func_abs,     PRJM_EVAL_OP_ABS },
+    { prjm_eval_func_sign,    PRJM_EVAL_OP_SIGN },
+    { prjm_eval_func_rand,    PRJM_EVAL_OP_RAND },
+    { prjm_eval_func_invsqrt, PRJM_EVAL_OP_INVSQRT }
+};
+
+static const prjm_eval_bytecode_func_map_t binary_functions[] = {
+    { prjm_eval_func_equal,            PRJM_EVAL_OP_EQUAL },
+    { prjm_eval_func_notequal,         PRJM_EVAL_OP_NOTEQUAL },
+    { prjm_eval_func_below,            PRJM_EVAL_OP_BELOW },
+    { prjm_eval_func_above,            PRJM_EVAL_OP_ABOVE },
+    { prjm_eval_func_beloweq,          PRJM_EVAL_OP_BELOWEQ },
+    { prjm_eval_func_aboveeq,          PRJM_EVAL_OP_ABOVEEQ },
+    { prjm_eval_func_add,              PRJM_EVAL_OP_ADD },
+    { prjm_eval_func_sub,              PRJM_EVAL_OP_SUB },
+    { prjm_eval_func_mul,              PRJM_EVAL_OP_MUL },
+    { prjm_eval_func_div,              PRJM_EVAL_OP_DIV },
+    { prjm_eval_func_div_nonzero,      PRJM_EVAL_OP_DIV_NONZERO },
+    { prjm_eval_func_mod,              PRJM_EVAL_OP_MOD },
+    { prjm_eval_func_bitwise_or,       PRJM_EVAL_OP_BITWISE_OR },
+    { prjm_eval_func_bitwise_and,      PRJM_EVAL_OP_BITWISE_AND },
+    { prjm_eval_func_boolean_and_func, PRJM_EVAL_OP_BOOLEAN_AND },
+    { prjm_eval_func_boolean_or_func,  PRJM_EVAL_OP_BOOLEAN_OR },
+    { prjm_eval_func_pow,              PRJM_EVAL_OP_POW },
+    { prjm_eval_func_atan2,            PRJM_EVAL_OP_ATAN2 },
+    { prjm_eval_func_min,              PRJM_EVAL_OP_MIN },
+    { prjm_eval_func_max,              PRJM_EVAL_OP_MAX },
+    { prjm_eval_func_sigmoid,          PRJM_EVAL_OP_SIGMOID }
+};
+
+/* Fused compare-and-select functions and their comparison opcode. */
+static const prjm_eval_bytecode_func_map_t select_functions[] = {
+    { prjm_eval_func_if_equal,    PRJM_EVAL_OP_EQUAL },
+    { prjm_eval_func_if_notequal, PRJM_EVAL_OP_NOTEQUAL },
+    { prjm_eval_func_if_below,    PRJM_EVAL_OP_BELOW },
+    { prjm_eval_func_if_above,    PRJM_EVAL_OP_ABOVE },
+    { prjm_eval_func_if_beloweq,  PRJM_EVAL_OP_BELOWEQ },
+    { prjm_eval_func_if_aboveeq,  PRJM_EVAL_OP_ABOVEEQ }
+};
+
+static const prjm_eval_bytecode_func_map_t assign_functions[] = {
+    { prjm_eval_func_add_op,         PRJM_EVAL_OP_ADD_ASSIGN_VAR },
+    { prjm_eval_func_sub_op,         PRJM_EVAL_OP_SUB_ASSIGN_VAR },
+    { prjm_eval_func_mul_op,         PRJM_EVAL_OP_MUL_ASSIGN_VAR },
+    { prjm_eval_func_div_op,         PRJM_EVAL_OP_DIV_ASSIGN_VAR },
+    { prjm_eval_func_mod_op,         PRJM_EVAL_OP_MOD_ASSIGN_VAR },
+    { prjm_eval_func_bitwise_or_op,  PRJM_EVAL_OP_BITWISE_OR_ASSIGN_VAR },
+    { prjm_eval_func_bitwise_and_op, PRJM_EVAL_OP_BITWISE_AND_ASSIGN_VAR },
+    { prjm_eval_func_pow_op,         PRJM_EVAL_OP_POW_ASSIGN_VAR }
+};
+
+#define PRJM_EVAL_BYTECODE_MAP_SIZE(map) ((int) (sizeof(map) / sizeof(prjm_eval_bytecode_func_map_t)))
+
+static const prjm_eval_bytecode_func_map_t* find_function(const prjm_eval_bytecode_func_map_t* map,
+                                                          int count,
+                                                          prjm_eval_expr_func_t* func)
+{
+    for (int index = 0; index < count; index++)
+    {
+        if (map[index].func == func)
+        {
+            return &map[index];
+        }
+    }
+
+    return NULL;
+}
+
+static bool is_memory_function(prjm_eval_expr_func_t* func)
+{
+    return func == prjm_eval_func_mem ||
+           func == prjm_eval_func_freembuf ||
+           func == prjm_eval_func_memcpy ||
+           func == prjm_eval_func_memset;
+}
+
+static int32_t emit(prjm_eval_bytecode_builder_t* builder,
+                    prjm_eval_bytecode_opcode_t opcode,
+                    int32_t value_delta,
+                    int32_t ref_delta)
+{
+    if (builder->length == builder->capacity)
+    {
+        int32_t new_capacity = builder->capacity ? builder->capacity * 2 : 64;
+        prjm_eval_bytecode_instruction_t* new_code = realloc(builder->code,
+                                                             new_capacity * sizeof(prjm_eval_bytecode_instruction_t));
+        if (!new_code)
+        {
+            builder->failed = true;
+            return 0;
+        }
+        builder->code = new_code;
+        builder->capacity = new_capacity;
+    }
+
+    prjm_eval_bytecode_instruction_t* instr = &builder->code[builder->length];
+    instr->opcode = opcode;
+    instr->operand = 0;
+    instr->value = .0;
+
+    builder->depth += value_delta;
+    builder->ref_depth += ref_delta;
+    assert(builder->depth >= 0);
+    assert(builder->ref_depth >= 0);
+
+    if (builder->depth > builder->max_depth)
+    {
+        builder->max_depth = builder->depth;
+    }
+    if (builder->ref_depth > builder->max_ref_depth)
+    {
+        builder->max_ref_depth = builder->ref_depth;
+    }
+
+    return builder->length++;
+}
+
+static void emit_with_temp(prjm_eval_bytecode_builder_t* builder,
+                           prjm_eval_bytecode_opcode_t opcode,
+                           int32_t value_delta,
+                           int32_t ref_delta)
+{
+    int32_t index = emit(builder, opcode, value_delta, ref_delta);
+    if (!builder->failed)
+    {
+        builder->code[index].operand = builder->temp_count++;
+    }
+}
+
+static void emit_var(prjm_eval_bytecode_builder_t* builder,
+                     prjm_eval_bytecode_opcode_t opcode,
+                     PRJM_EVAL_F* var,
+                     int32_t value_delta,
+                     int32_t ref_delta)
+{
+    int32_t index = emit(builder, opcode, value_delta, ref_delta);
+    if (!builder->failed)
+    {
+        builder->code[index].var = var;
+    }
+}
+
+static void emit_memory(prjm_eval_bytecode_builder_t* builder,
+                        prjm_eval_bytecode_opcode_t opcode,
+                        projectm_eval_mem_buffer memory_buffer,
+                        int32_t value_delta,
+                        int32_t ref_delta)
+{
+    int32_t index = emit(builder, opcode, value_delta, ref_delta);
+    if (!builder->failed)
+    {
+        builder->code[index].memory_buffer = memory_buffer;
+    }
+}
+
+static void emit_mem_ref(prjm_eval_bytecode_builder_t* builder, projectm_eval_mem_buffer memory_buffer)
+{
+    int32_t index = emit(builder, PRJM_EVAL_OP_MEM_REF, -1, 1);
+    if (!builder->failed)
+    {
+        builder->code[index].memory_buffer = memory_buffer;
+        builder->code[index].operand = builder->temp_count++;
+    }
+}
+
+static void emit_call_node(prjm_eval_bytecode_builder_t* builder,
+                           prjm_eval_exptreenode_t* node,
+                           prjm_eval_bytecode_mode_t mode)
+{
+    int32_t index;
+    if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        index = emit(builder, PRJM_EVAL_OP_CALL_NODE_REF, 0, 1);
+        if (!builder->failed)
+        {
+            builder->code[index].operand = builder->temp_count++;
+        }
+    }
+    else
+    {
+        index = emit(builder, PRJM_EVAL_OP_CALL_NODE, 1, 0);
+    }
+
+    if (!builder->failed)
+    {
+        builder->code[index].node = node;
+    }
+
+    if (mode == PRJM_EVAL_BYTECODE_MODE_DISCARD)
+    {
+        emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+    }
+}
+
+static void patch_jump(prjm_eval_bytecode_builder_t* builder, int32_t index)
+{
+    if (!builder->failed)
+    {
+        builder->code[index].operand = builder->length;
+    }
+}
+
+/**
+ * @brief Converts a pushed value into the requested result mode.
+ */
+static void finish_value(prjm_eval_bytecode_builder_t* builder, prjm_eval_bytecode_mode_t mode)
+{
+    if (mode == PRJM_EVAL_BYTECODE_MODE_DISCARD)
+    {
+        emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+    }
+    else if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        emit_with_temp(builder, PRJM_EVAL_OP_TO_REF, -1, 1);
+    }
+}
+
+static void compile_node(prjm_eval_bytecode_builder_t* builder,
+                         prjm_eval_exptreenode_t* node,
+                         prjm_eval_bytecode_mode_t mode);
+
+/**
+ * @brief Compiles an assignment target, which is then followed by the assigned value.
+ * Returns true if the target is a plain variable, which can be accessed directly by the opcode.
+ */
+static bool compile_assignment_target(prjm_eval_bytecode_builder_t* builder, prjm_eval_exptreenode_t* target)
+{
+    if (target->func == prjm_eval_func_var)
+    {
+        return true;
+    }
+
+    compile_node(builder, target, PRJM_EVAL_BYTECODE_MODE_REF);
+    return false;
+}
+
+static void compile_set(prjm_eval_bytecode_builder_t* builder,
+                        prjm_eval_exptreenode_t* node,
+                        prjm_eval_bytecode_mode_t mode)
+{
+    prjm_eval_exptreenode_t* target = node->args[0];
+
+    if (node->func == prjm_eval_func_mem_set)
+    {
+        /* The fused memory store has the index as its first argument. */
+        compile_node(builder, target, PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit_mem_ref(builder, node->memory_buffer);
+    }
+    else if (compile_assignment_target(builder, target))
+    {
+        compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        if (mode == PRJM_EVAL_BYTECODE_MODE_VALUE)
+        {
+            emit_var(builder, PRJM_EVAL_OP_STORE_VAR, target->var, 0, 0);
+            return;
+        }
+
+        emit_var(builder, PRJM_EVAL_OP_STORE_VAR_POP, target->var, -1, 0);
+        if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+        {
+            emit_var(builder, PRJM_EVAL_OP_PUSH_REF, target->var, 0, 1);
+        }
+        return;
+    }
+
+    compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        emit(builder, PRJM_EVAL_OP_STORE_REF_KEEP, -1, 0);
+        return;
+    }
+
+    emit(builder, PRJM_EVAL_OP_STORE_REF, 0, -1);
+    if (mode == PRJM_EVAL_BYTECODE_MODE_DISCARD)
+    {
+        emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+    }
+}
+
+static void compile_compound_assignment(prjm_eval_bytecode_builder_t* builder,
+                                        prjm_eval_exptreenode_t* node,
+                                        prjm_eval_bytecode_opcode_t var_opcode,
+                                        prjm_eval_bytecode_mode_t mode)
+{
+    prjm_eval_exptreenode_t* target = node->args[0];
+
+    if (compile_assignment_target(builder, target))
+    {
+        compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit_var(builder, var_opcode, target->var, 0, 0);
+        if (mode != PRJM_EVAL_BYTECODE_MODE_VALUE)
+        {
+            emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+        }
+        if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+        {
+            emit_var(builder, PRJM_EVAL_OP_PUSH_REF, target->var, 0, 1);
+        }
+        return;
+    }
+
+    compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        emit(builder, var_opcode + 2, -1, 0);
+        return;
+    }
+
+    emit(builder, var_opcode + 1, 0, -1);
+    if (mode == PRJM_EVAL_BYTECODE_MODE_DISCARD)
+    {
+        emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+    }
+}
+
+static void compile_binary(prjm_eval_bytecode_builder_t* builder,
+                           prjm_eval_exptreenode_t* node,
+                           prjm_eval_bytecode_opcode_t opcode,
+                           prjm_eval_bytecode_mode_t mode);
+
+static void compile_if(prjm_eval_bytecode_builder_t* builder,
+                       prjm_eval_exptreenode_t* node,
+                       prjm_eval_bytecode_mode_t mode)
+{
+    /* Fused compare-and-select nodes take the two compared values instead of the condition. */
+    const prjm_eval_bytecode_func_map_t* mapping = find_function(select_functions,
+                                                                 PRJM_EVAL_BYTECODE_MAP_SIZE(select_functions),
+                                                                 node->func);
+    prjm_eval_exptreenode_t** branches = node->args + 1;
+    if (mapping)
+    {
+        compile_binary(builder, node, mapping->opcode, PRJM_EVAL_BYTECODE_MODE_VALUE);
+        branches++;
+    }
+    else
+    {
+        compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    }
+
+    int32_t jump_to_else = emit(builder, PRJM_EVAL_OP_JUMP_IF_ZERO, -1, 0);
+
+    int32_t depth = builder->depth;
+    int32_t ref_depth = builder->ref_depth;
+
+    compile_node(builder, branches[0], mode);
+    int32_t jump_to_end = emit(builder, PRJM_EVAL_OP_JUMP, 0, 0);
+
+    /* Both branches start with the same stack layout. */
+    builder->depth = depth;
+    builder->ref_depth = ref_depth;
+
+    patch_jump(builder, jump_to_else);
+    compile_node(builder, branches[1], mode);
+    patch_jump(builder, jump_to_end);
+}
+
+static void compile_short_circuit(prjm_eval_bytecode_builder_t* builder,
+                                  prjm_eval_exptreenode_t* node,
+                                  prjm_eval_bytecode_opcode_t test_opcode,
+                                  prjm_eval_bytecode_mode_t mode)
+{
+    compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    int32_t jump_to_end = emit(builder, test_opcode, -1, 0);
+    compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    emit(builder, PRJM_EVAL_OP_BOOL, 0, 0);
+    patch_jump(builder, jump_to_end);
+
+    finish_value(builder, mode);
+}
+
+static void compile_loop(prjm_eval_bytecode_builder_t* builder,
+                         prjm_eval_exptreenode_t* node,
+                         prjm_eval_bytecode_mode_t mode)
+{
+    /* If the body is never executed, the loop returns the count value. */
+    compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    emit(builder, PRJM_EVAL_OP_LOOP_PREP, 1, 0);
+
+    int32_t loop_start = builder->length;
+    int32_t jump_to_end = emit(builder, PRJM_EVAL_OP_LOOP_TEST, 0, 0);
+
+    if (mode == PRJM_EVAL_BYTECODE_MODE_VALUE)
+    {
+        compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit(builder, PRJM_EVAL_OP_LOOP_STORE, -1, 0);
+    }
+    else
+    {
+        compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_DISCARD);
+    }
+
+    int32_t jump_to_start = emit(builder, PRJM_EVAL_OP_JUMP, 0, 0);
+    if (!builder->failed)
+    {
+        builder->code[jump_to_start].operand = loop_start;
+    }
+
+    patch_jump(builder, jump_to_end);
+
+    /* Remove the loop counter */
+    emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+
+    if (mode == PRJM_EVAL_BYTECODE_MODE_DISCARD)
+    {
+        emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+    }
+}
+
+static void compile_while(prjm_eval_bytecode_builder_t* builder,
+                          prjm_eval_exptreenode_t* node,
+                          prjm_eval_bytecode_mode_t mode)
+{
+    int32_t counter = emit(builder, PRJM_EVAL_OP_CONST, 1, 0);
+    if (!builder->failed)
+    {
+        builder->code[counter].value = MAX_LOOP_COUNT;
+    }
+
+    int32_t loop_start = builder->length;
+    compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+
+    int32_t jump_to_start = emit(builder, PRJM_EVAL_OP_WHILE_TEST, -1, 0);
+    if (!builder->failed)
+    {
+        builder->code[jump_to_start].operand = loop_start;
+    }
+
+    if (mode == PRJM_EVAL_BYTECODE_MODE_DISCARD)
+    {
+        emit(builder, PRJM_EVAL_OP_POP, -1, 0);
+    }
+}
+
+static void compile_binary(prjm_eval_bytecode_builder_t* builder,
+                           prjm_eval_exptreenode_t* node,
+                           prjm_eval_bytecode_opcode_t opcode,
+                           prjm_eval_bytecode_mode_t mode)
+{
+    /*
+     * Tree functions dereference their first argument only after the second one was evaluated. If the first
+     * argument returns a reference and the second one changes the referenced value, the new value is used.
+     */
+    if (!prjm_eval_exptreenode_returns_value(node->args[0]) && prjm_eval_exptreenode_has_side_effects(node->args[1]))
+    {
+        compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_REF);
+        compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit(builder, PRJM_EVAL_OP_LOAD_REF_UNDER, 1, -1);
+    }
+    else
+    {
+        compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    }
+
+    emit(builder, opcode, -1, 0);
+    finish_value(builder, mode);
+}
+
+static void compile_memory_function(prjm_eval_bytecode_builder_t* builder,
+                                    prjm_eval_exptreenode_t* node,
+                                    prjm_eval_bytecode_mode_t mode)
+{
+    if (node->func == prjm_eval_func_mem)
+    {
+        compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+        {
+            emit_mem_ref(builder, node->memory_buffer);
+            return;
+        }
+
+        emit_memory(builder, PRJM_EVAL_OP_MEM_LOAD, node->memory_buffer, 0, 0);
+        finish_value(builder, mode);
+        return;
+    }
+
+    /* The remaining memory functions return references to their arguments. */
+    if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        emit_call_node(builder, node, mode);
+        return;
+    }
+
+    if (node->func == prjm_eval_func_freembuf)
+    {
+        compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit_memory(builder, PRJM_EVAL_OP_FREEMBUF, node->memory_buffer, 0, 0);
+        finish_value(builder, mode);
+        return;
+    }
+
+    /*
+     * memcpy/memset read their argument references after all arguments were evaluated. The result references the
+     * destination argument, which may be overwritten by the function itself.
+     */
+    bool reads_late = (!prjm_eval_exptreenode_returns_value(node->args[0]) ||
+                       !prjm_eval_exptreenode_returns_value(node->args[1])) &&
+                      (prjm_eval_exptreenode_has_side_effects(node->args[1]) ||
+                       prjm_eval_exptreenode_has_side_effects(node->args[2]));
+    bool returns_destination = mode == PRJM_EVAL_BYTECODE_MODE_VALUE &&
+                               node->args[0]->func != prjm_eval_func_var &&
+                               !prjm_eval_exptreenode_returns_value(node->args[0]);
+    if (reads_late || returns_destination)
+    {
+        emit_call_node(builder, node, mode);
+        return;
+    }
+
+    compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    compile_node(builder, node->args[1], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    compile_node(builder, node->args[2], PRJM_EVAL_BYTECODE_MODE_VALUE);
+    emit_memory(builder,
+                node->func == prjm_eval_func_memcpy ? PRJM_EVAL_OP_MEMCPY : PRJM_EVAL_OP_MEMSET,
+                node->memory_buffer, -2, 0);
+    finish_value(builder, mode);
+}
+
+static void compile_node(prjm_eval_bytecode_builder_t* builder,
+                         prjm_eval_exptreenode_t* node,
+                         prjm_eval_bytecode_mode_t mode)
+{
+    assert(node);
+    assert(node->func);
+
+    if (builder->failed)
+    {
+        return;
+    }
+
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+    const prjm_eval_bytecode_func_map_t* mapping;
+
+    if (func == prjm_eval_func_const)
+    {
+        if (mode != PRJM_EVAL_BYTECODE_MODE_DISCARD)
+        {
+            int32_t index = emit(builder, PRJM_EVAL_OP_CONST, 1, 0);
+            if (!builder->failed)
+            {
+                builder->code[index].value = node->value;
+            }
+            finish_value(builder, mode);
+        }
+    }
+    else if (func == prjm_eval_func_var)
+    {
+        if (mode == PRJM_EVAL_BYTECODE_MODE_VALUE)
+        {
+            emit_var(builder, PRJM_EVAL_OP_VAR, node->var, 1, 0);
+        }
+        else if (mode == PRJM_EVAL_BYTECODE_MODE_REF)
+        {
+            emit_var(builder, PRJM_EVAL_OP_PUSH_REF, node->var, 0, 1);
+        }
+    }
+    else if (prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        /* The tree function passes result locations between its arguments, which the stack can't represent. */
+        emit_call_node(builder, node, mode);
+    }
+    else if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        prjm_eval_exptreenode_t** arg = node->args;
+        for (; *(arg + 1); arg++)
+        {
+            compile_node(builder, *arg, PRJM_EVAL_BYTECODE_MODE_DISCARD);
+        }
+        compile_node(builder, *arg, mode);
+    }
+    else if (func == prjm_eval_func_if ||
+             find_function(select_functions, PRJM_EVAL_BYTECODE_MAP_SIZE(select_functions), func))
+    {
+        compile_if(builder, node, mode);
+    }
+    else if (func == prjm_eval_func_execute_loop && mode != PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        compile_loop(builder, node, mode);
+    }
+    else if (func == prjm_eval_func_execute_while && mode != PRJM_EVAL_BYTECODE_MODE_REF)
+    {
+        compile_while(builder, node, mode);
+    }
+    else if (func == prjm_eval_func_boolean_and_op)
+    {
+        compile_short_circuit(builder, node, PRJM_EVAL_OP_AND_TEST, mode);
+    }
+    else if (func == prjm_eval_func_boolean_or_op)
+    {
+        compile_short_circuit(builder, node, PRJM_EVAL_OP_OR_TEST, mode);
+    }
+    else if (func == prjm_eval_func_set || func == prjm_eval_func_mem_set)
+    {
+        compile_set(builder, node, mode);
+    }
+    else if (func == prjm_eval_func_mul_add)
+    {
+        /* The product is calculated before the addend is evaluated. */
+        compile_binary(builder, node, PRJM_EVAL_OP_MUL, PRJM_EVAL_BYTECODE_MODE_VALUE);
+        compile_node(builder, node->args[2], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit(builder, PRJM_EVAL_OP_ADD, -1, 0);
+        finish_value(builder, mode);
+    }
+    else if ((mapping = find_function(assign_functions, PRJM_EVAL_BYTECODE_MAP_SIZE(assign_functions), func)))
+    {
+        compile_compound_assignment(builder, node, mapping->opcode, mode);
+    }
+    else if (is_memory_function(func))
+    {
+        compile_memory_function(builder, node, mode);
+    }
+    else if ((mapping = find_function(unary_functions, PRJM_EVAL_BYTECODE_MAP_SIZE(unary_functions), func)))
+    {
+        compile_node(builder, node->args[0], PRJM_EVAL_BYTECODE_MODE_VALUE);
+        emit(builder, mapping->opcode, 0, 0);
+        finish_value(builder, mode);
+    }
+    else if ((mapping = find_function(binary_functions, PRJM_EVAL_BYTECODE_MAP_SIZE(binary_functions), func)))
+    {
+        compile_binary(builder, node, mapping->opcode, mode);
+    }
+    else
+    {
+        /* No bytecode equivalent, let the tree node do the work. */
+        emit_call_node(builder, node, mode);
+    }
+}
+
+prjm_eval_bytecode_t* prjm_eval_bytecode_create(prjm_eval_exptreenode_t* tree)
+{
+    if (!tree)
+    {
+        return NULL;
+    }
+
+    prjm_eval_bytecode_builder_t builder = { 0 };
+
+    compile_node(&builder, tree, PRJM_EVAL_BYTECODE_MODE_VALUE);
+    emit(&builder, PRJM_EVAL_OP_HALT, 0, 0);
+
+    if (builder.failed)
+    {
+        free(builder.code);
+        return NULL;
+    }
+
+    assert(builder.depth == 1);
+    assert(builder.ref_depth == 0);
+
+    prjm_eval_bytecode_t* bytecode = calloc(1, sizeof(prjm_eval_bytecode_t));
+    if (!bytecode)
+    {
+        free(builder.code);
+        return NULL;
+    }
+
+    bytecode->code = builder.code;
+    bytecode->value_stack = calloc(builder.max_depth + 1, sizeof(PRJM_EVAL_F));
+    bytecode->ref_stack = calloc(builder.max_ref_depth + 1, sizeof(PRJM_EVAL_F*));
+    bytecode->temps = calloc(builder.temp_count + 1, sizeof(PRJM_EVAL_F));
+
+    if (!bytecode->value_stack || !bytecode->ref_stack || !bytecode->temps)
+    {
+        prjm_eval_bytecode_destroy(bytecode);
+        return NULL;
+    }
+
+    return bytecode;
+}
+
+void prjm_eval_bytecode_destroy(prjm_eval_bytecode_t* bytecode)
+{
+    if (!bytecode)
+    {
+        return;
+    }
+
+    free(bytecode->code);
+    free(bytecode->value_stack);
+    free(bytecode->ref_stack);
+    free(bytecode->temps);
+    free(bytecode);
+}
+
+/*
+ * Instruction dispatch. GCC and Clang support computed gotos, which give each opcode its own indirect jump and thus
+ * make branch prediction a lot more accurate than a single switch statement. Other compilers use the switch.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BYTECODE_DISPATCH_BEGIN goto *dispatch_table[ip->opcode];
+#define BYTECODE_DISPATCH_END
+#define BYTECODE_CASE(name) op_ ## name:
+#define BYTECODE_DISPATCH() goto *dispatch_table[ip->opcode]
+#else
+#define BYTECODE_DISPATCH_BEGIN for (;;) { switch (ip->opcode) {
+#define BYTECODE_DISPATCH_END } }
+#define BYTECODE_CASE(name) case PRJM_EVAL_OP_ ## name:
+#define BYTECODE_DISPATCH() continue
+#endif
+
+#define BYTECODE_NEXT() \
+    ip++;               \
+    BYTECODE_DISPATCH()
+
+#define BYTECODE_JUMP(target) \
+    ip = code + (target);     \
+    BYTECODE_DISPATCH()
+
+/* Opcode implementation helpers. "sp" points to the next free value stack entry, "rp" to the next free reference. */
+#define BYTECODE_UNARY(name, expr) \
+    BYTECODE_CASE(name)            \
+    {                              \
+        PRJM_EVAL_F a = sp[-1];    \
+        sp[-1] = (expr);           \
+        BYTECODE_NEXT();           \
+    }
+
+#define BYTECODE_BINARY(name, expr) \
+    BYTECODE_CASE(name)             \
+    {                               \
+        PRJM_EVAL_F a = sp[-2];     \
+        PRJM_EVAL_F b = sp[-1];     \
+        sp[-2] = (expr);            \
+        sp--;                       \
+        BYTECODE_NEXT();            \
+    }
+
+#define BYTECODE_ASSIGN(name, expr)             \
+    BYTECODE_CASE(name ## _ASSIGN_VAR)          \
+    {                                           \
+        PRJM_EVAL_F* target = ip->var;          \
+        PRJM_EVAL_F a = *target;                \
+        PRJM_EVAL_F b = sp[-1];                 \
+        *target = (expr);                       \
+        sp[-1] = *target;                       \
+        BYTECODE_NEXT();                        \
+    }                                           \
+    BYTECODE_CASE(name ## _ASSIGN_REF)          \
+    {                                           \
+        PRJM_EVAL_F* target = *--rp;            \
+        PRJM_EVAL_F a = *target;                \
+        PRJM_EVAL_F b = sp[-1];                 \
+        *target = (expr);                       \
+        sp[-1] = *target;                       \
+        BYTECODE_NEXT();                        \
+    }                                           \
+    BYTECODE_CASE(name ## _ASSIGN_REF_KEEP)     \
+    {                                           \
+        PRJM_EVAL_F* target = rp[-1];           \
+        PRJM_EVAL_F a = *target;                \
+        PRJM_EVAL_F b = *--sp;                  \
+        *target = (expr);                       \
+        BYTECODE_NEXT();                        \
+    }
+
+PRJM_EVAL_F prjm_eval_bytecode_execute(prjm_eval_bytecode_t* bytecode)
+{
+    assert(bytecode);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PRJM_EVAL_BYTECODE_LABEL(name) &&op_ ## name,
+    static const void* dispatch_table[] = {
+        PRJM_EVAL_BYTECODE_OPCODES(PRJM_EVAL_BYTECODE_LABEL)
+    };
+#undef PRJM_EVAL_BYTECODE_LABEL
+#endif
+
+    const prjm_eval_bytecode_instruction_t* code = bytecode->code;
+    const prjm_eval_bytecode_instruction_t* ip = code;
+    PRJM_EVAL_F* sp = bytecode->value_stack;
+    PRJM_EVAL_F** rp = bytecode->ref_stack;
+    PRJM_EVAL_F* temps = bytecode->temps;
+
+    BYTECODE_DISPATCH_BEGIN
+
+    BYTECODE_CASE(HALT)
+        return sp[-1];
+
+    BYTECODE_CASE(CONST)
+        *sp++ = ip->value;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(VAR)
+        *sp++ = *ip->var;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(PUSH_REF)
+        *rp++ = ip->var;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(TO_REF)
+        temps[ip->operand] = *--sp;
+        *rp++ = &temps[ip->operand];
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(LOAD_REF_UNDER)
+        sp[0] = sp[-1];
+        sp[-1] = **--rp;
+        sp++;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(POP)
+        sp--;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(JUMP)
+        BYTECODE_JUMP(ip->operand);
+
+    BYTECODE_CASE(JUMP_IF_ZERO)
+        if (*--sp == 0)
+        {
+            BYTECODE_JUMP(ip->operand);
+        }
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(AND_TEST)
+        if (fabs(sp[-1]) > close_factor_low)
+        {
+            sp--;
+            BYTECODE_NEXT();
+        }
+        sp[-1] = 0.0;
+        BYTECODE_JUMP(ip->operand);
+
+    BYTECODE_CASE(OR_TEST)
+        if (fabs(sp[-1]) < close_factor_low)
+        {
+            sp--;
+            BYTECODE_NEXT();
+        }
+        sp[-1] = 1.0;
+        BYTECODE_JUMP(ip->operand);
+
+    BYTECODE_CASE(LOOP_PREP)
+    {
+        PRJM_EVAL_I loop_count_int = (PRJM_EVAL_I) sp[-1];
+        /* Limit execution count */
+        if (loop_count_int > MAX_LOOP_COUNT)
+        {
+            loop_count_int = MAX_LOOP_COUNT;
+        }
+        *sp++ = (PRJM_EVAL_F) loop_count_int;
+        BYTECODE_NEXT();
+    }
+
+    BYTECODE_CASE(LOOP_TEST)
+        if (sp[-1] <= 0)
+        {
+            BYTECODE_JUMP(ip->operand);
+        }
+        sp[-1] -= 1;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(LOOP_STORE)
+        sp[-3] = sp[-1];
+        sp--;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(WHILE_TEST)
+        if (fabs(sp[-1]) > close_factor_low && (sp[-2] -= 1) != 0)
+        {
+            sp--;
+            BYTECODE_JUMP(ip->operand);
+        }
+        sp[-2] = sp[-1];
+        sp--;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(CALL_NODE)
+    {
+        *sp++ = ip->node->value_func(ip->node);
+        BYTECODE_NEXT();
+    }
+
+    BYTECODE_CASE(CALL_NODE_REF)
+    {
+        PRJM_EVAL_F* value_ptr = &temps[ip->operand];
+        *value_ptr = .0;
+        ip->node->func(ip->node, &value_ptr);
+        *rp++ = value_ptr;
+        BYTECODE_NEXT();
+    }
+
+    BYTECODE_CASE(STORE_VAR)
+        *ip->var = sp[-1];
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(STORE_VAR_POP)
+        *ip->var = *--sp;
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(STORE_REF)
+        **--rp = sp[-1];
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(STORE_REF_KEEP)
+        *rp[-1] = *--sp;
+        BYTECODE_NEXT();
+
+    BYTECODE_ASSIGN(ADD, a + b)
+    BYTECODE_ASSIGN(SUB, a - b)
+    BYTECODE_ASSIGN(MUL, a * b)
+    BYTECODE_ASSIGN(DIV, prjm_eval_math_div(a, b))
+    BYTECODE_ASSIGN(MOD, prjm_eval_math_mod(a, b))
+    BYTECODE_ASSIGN(BITWISE_OR, prjm_eval_math_bitwise_or(a, b))
+    BYTECODE_ASSIGN(BITWISE_AND, prjm_eval_math_bitwise_and(a, b))
+    BYTECODE_ASSIGN(POW, prjm_eval_math_pow(a, b))
+
+    BYTECODE_CASE(MEM_LOAD)
+    {
+        PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer, prjm_eval_math_mem_index(sp[-1]));
+        sp[-1] = mem_addr ? *mem_addr : .0;
+        BYTECODE_NEXT();
+    }
+
+    BYTECODE_CASE(MEM_REF)
+    {
+        PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer, prjm_eval_math_mem_index(*--sp));
+        if (!mem_addr)
+        {
+            mem_addr = &temps[ip->operand];
+            *mem_addr = .0;
+        }
+        *rp++ = mem_addr;
+        BYTECODE_NEXT();
+    }
+
+    BYTECODE_CASE(FREEMBUF)
+        prjm_eval_memory_free_block(ip->memory_buffer, prjm_eval_math_mem_index(sp[-1]));
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(MEMCPY)
+        sp -= 2;
+        prjm_eval_memory_copy(ip->memory_buffer, &sp[-1], &sp[0], &sp[1]);
+        BYTECODE_NEXT();
+
+    BYTECODE_CASE(MEMSET)
+        sp -= 2;
+        prjm_eval_memory_set(ip->memory_buffer, &sp[-1], &sp[0], &sp[1]);
+        BYTECODE_NEXT();
+
+    BYTECODE_UNARY(BOOL, fabs(a) > close_factor_low ? 1.0 : 0.0)
+    BYTECODE_UNARY(BNOT, fabs(a) < close_factor_low ? 1.0 : 0.0)
+    BYTECODE_UNARY(NEG, -a)
+    BYTECODE_UNARY(SIN, sin(a))
+    BYTECODE_UNARY(COS, cos(a))
+    BYTECODE_UNARY(TAN, tan(a))
+    BYTECODE_UNARY(ASIN, prjm_eval_math_asin(a))
+    BYTECODE_UNARY(ACOS, prjm_eval_math_acos(a))
+    BYTECODE_UNARY(ATAN, atan(a))
+    BYTECODE_UNARY(SQRT, sqrt(fabs(a)))
+    BYTECODE_UNARY(EXP, exp(a))
+    BYTECODE_UNARY(LOG, prjm_eval_math_log(a))
+    BYTECODE_UNARY(LOG10, prjm_eval_math_log10(a))
+    BYTECODE_UNARY(FLOOR, floor(a))
+    BYTECODE_UNARY(CEIL, ceil(a))
+    BYTECODE_UNARY(SQR, a * a)
+    BYTECODE_UNARY(ABS, fabs(a))
+    BYTECODE_UNARY(SIGN, prjm_eval_math_sign(a))
+    BYTECODE_UNARY(RAND, prjm_eval_math_rand(a))
+    BYTECODE_UNARY(INVSQRT, prjm_eval_math_invsqrt(a))
+
+    BYTECODE_BINARY(EQUAL, fabs(a - b) < close_factor_low ? 1.0 : 0.0)
+    BYTECODE_BINARY(NOTEQUAL, fabs(a - b) > close_factor_low ? 1.0 : 0.0)
+    BYTECODE_BINARY(BELOW, a < b ? 1.0 : 0.0)
+    BYTECODE_BINARY(ABOVE, a > b ? 1.0 : 0.0)
+    BYTECODE_BINARY(BELOWEQ, a <= b ? 1.0 : 0.0)
+    BYTECODE_BINARY(ABOVEEQ, a >= b ? 1.0 : 0.0)
+    BYTECODE_BINARY(ADD, a + b)
+    BYTECODE_BINARY(SUB, a - b)
+    BYTECODE_BINARY(MUL, a * b)
+    BYTECODE_BINARY(DIV, prjm_eval_math_div(a, b))
+    BYTECODE_BINARY(DIV_NONZERO, a / b)
+    BYTECODE_BINARY(MOD, prjm_eval_math_mod(a, b))
+    BYTECODE_BINARY(BITWISE_OR, prjm_eval_math_bitwise_or(a, b))
+    BYTECODE_BINARY(BITWISE_AND, prjm_eval_math_bitwise_and(a, b))
+    BYTECODE_BINARY(BOOLEAN_AND, fabs(a) > close_factor && fabs(b) > close_factor ? 1.0 : 0.0)
+    BYTECODE_BINARY(BOOLEAN_OR, fabs(a) > close_factor || fabs(b) > close_factor ? 1.0 : 0.0)
+    BYTECODE_BINARY(POW, prjm_eval_math_pow(a, b))
+    BYTECODE_BINARY(ATAN2, atan2(a, b))
+    BYTECODE_BINARY(MIN, a < b ? a : b)
+    BYTECODE_BINARY(MAX, a > b ? a : b)
+    BYTECODE_BINARY(SIGMOID, prjm_eval_math_sigmoid(a, b))
+
+    BYTECODE_DISPATCH_END
+
+    /* Not reached, all programs end with a HALT instruction. */
+    return .0;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file Bytecode.h
+ * @brief Flat bytecode representation of a compiled program and the stack machine executing it.
+ *
+ * The bytecode is generated from a finished expression tree. Instead of recursing through the tree nodes via their
+ * function pointers, all instructions are stored in a single contiguous array and executed in a dispatch loop.
+ */
+#pragma once
+
+#include "CompilerTypes.h"
+
+struct prjm_eval_bytecode;
+typedef struct prjm_eval_bytecode prjm_eval_bytecode_t;
+
+/**
+ * @brief Lowers an expression tree into bytecode.
+ * The tree must stay valid as long as the bytecode is used, as functions without a bytecode
+ * representation are executed by calling their tree node function.
+ * @param tree The root node of the program tree.
+ * @return A new bytecode program or NULL if the tree is empty or an allocation failed.
+ */
+prjm_eval_bytecode_t* prjm_eval_bytecode_create(prjm_eval_exptreenode_t* tree);
+
+/**
+ * @brief Frees the given bytecode program.
+ * @param bytecode The bytecode to free.
+ */
+void prjm_eval_bytecode_destroy(prjm_eval_bytecode_t* bytecode);
+
+/**
+ * @brief Executes a bytecode program.
+ * @param bytecode The bytecode to execute.
+ * @return The value of the last executed top-level expression.
+ */
+PRJM_EVAL_F prjm_eval_bytecode_execute(prjm_eval_bytecode_t* bytecode);
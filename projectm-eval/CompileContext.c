@@ -1,12 +1,23 @@
 #include "CompileContext.h"
 
 #include "Scanner.h"
+#include "BatchCode.h"
+#include "Bytecode.h"
 #include "Compiler.h"
+#include "CompilerFunctions.h"
+#include "CompilerOptimizations.h"
+#include "CpuDispatch.h"
 #include "ExpressionTree.h"
+#ifdef PRJM_EVAL_ENABLE_JIT
+#include "Jit.h"
+#endif
 #include "MemoryBuffer.h"
+#include "RegisterCode.h"
 #include "TreeFunctions.h"
+#include "TreeVariables.h"
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -15,6 +26,9 @@ prjm_eval_compiler_context_t* prjm_eval_create_compile_context(projectm_eval_mem
 {
     prjm_eval_compiler_context_t* cctx = calloc(1, sizeof(prjm_eval_compiler_context_t));
 
+    /* Select the kernel variant for this CPU once, before any code is executed. */
+    prjm_eval_cpu_kernels();
+
     prjm_eval_intrinsic_function_list intrinsics;
     uint32_t intrinsics_count = 0;
     prjm_eval_intrinsic_functions(&intrinsics, &intrinsics_count);
@@ -48,6 +62,16 @@ prjm_eval_compiler_context_t* prjm_eval_create_compile_context(projectm_eval_mem
 
     cctx->global_variables = global_variables;
 
+    cctx->fuse_superinstructions = true;
+    cctx->prune_branches = true;
+    cctx->eliminate_common_subexpressions = true;
+    cctx->simplify_expressions = false;
+    cctx->hoist_loop_invariants = true;
+    cctx->vectorize_loops = false;
+    cctx->specialize_value_ranges = true;
+    cctx->unroll_limit = PRJM_EVAL_DEFAULT_UNROLL_LIMIT;
+    cctx->tiering_threshold = PRJM_EVAL_DEFAULT_TIERING_THRESHOLD;
+
     return cctx;
 }
 
@@ -79,13 +103,18 @@ void prjm_eval_destroy_compile_context(prjm_eval_compiler_context_t* cctx)
 
     prjm_eval_destroy_exptreenode(cctx->compile_result);
     prjm_eval_memory_destroy_buffer(cctx->memory);
+    free(cctx->output_variables);
 
     free(cctx->error.error);
 
     free(cctx);
 }
 
-prjm_eval_program_t* prjm_eval_compile_code(prjm_eval_compiler_context_t* cctx, const char* code)
+/**
+ * Parses the code into cctx->compile_result.
+ * @return false on a parse error.
+ */
+static bool parse_code(prjm_eval_compiler_context_t* cctx, const char* code)
 {
     yyscan_t scanner;
 
@@ -104,17 +133,260 @@ prjm_eval_program_t* prjm_eval_compile_code(prjm_eval_compiler_context_t* cctx,
     {
         prjm_eval_destroy_exptreenode(cctx->compile_result);
         cctx->compile_result = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Optimizes the parsed tree in cctx->compile_result and packs it into a single block.
+ * @param cctx The context holding the parsed tree.
+ * @param program The program the tree is compiled for. Its pass options select the applied passes, and it receives the
+ *                optimization statistics.
+ * @return false if an allocation failed.
+ */
+static bool prepare_tree(prjm_eval_compiler_context_t* cctx, prjm_eval_program_t* program)
+{
+    program->removed_store_count = 0;
+    program->eliminated_subexpression_count = 0;
+    program->simplified_expression_count = 0;
+    program->pruned_branch_count = 0;
+    program->hoisted_expression_count = 0;
+    program->unrolled_loop_count = 0;
+    program->specialized_operation_count = 0;
+
+    if (!cctx->compile_result)
+    {
+        return true;
+    }
+
+    const prjm_eval_pass_options_t* options = &program->pass_options;
+    if (options->prune_branches)
+    {
+        program->pruned_branch_count = prjm_eval_compiler_prune_branches(cctx, &cctx->compile_result);
+    }
+    if (program->output_variables)
+    {
+        program->removed_store_count = prjm_eval_compiler_eliminate_dead_stores(cctx, &cctx->compile_result,
+                                                                                program->output_variables,
+                                                                                program->output_variable_count);
+    }
+    if (options->simplify_expressions)
+    {
+        program->simplified_expression_count = prjm_eval_compiler_simplify_expressions(&cctx->compile_result);
+    }
+    if (options->eliminate_common_subexpressions)
+    {
+        program->eliminated_subexpression_count = prjm_eval_compiler_eliminate_common_subexpressions(cctx,
+                                                                                                     &cctx->compile_result);
+    }
+    if (options->hoist_loop_invariants)
+    {
+        program->hoisted_expression_count = prjm_eval_compiler_hoist_loop_invariants(cctx, &cctx->compile_result);
+    }
+    program->unrolled_loop_count = prjm_eval_compiler_unroll_loops(&cctx->compile_result, options->unroll_limit);
+    if (options->specialize_value_ranges)
+    {
+        program->specialized_operation_count = prjm_eval_compiler_specialize_value_ranges(&cctx->compile_result);
+    }
+    if (options->fuse_superinstructions)
+    {
+        prjm_eval_compiler_fuse_superinstructions(cctx->compile_result);
+    }
+    prjm_eval_exptreenode_specialize(cctx->compile_result);
+    prjm_eval_exptreenode_assign_value_functions(cctx->compile_result);
+
+    prjm_eval_exptreenode_t* packed = prjm_eval_exptreenode_pack(cctx->compile_result);
+    if (!packed)
+    {
+        prjm_eval_destroy_exptreenode(cctx->compile_result);
+        cctx->compile_result = NULL;
+        return false;
+    }
+    cctx->compile_result = packed;
+
+    return true;
+}
+
+static void add_unique_variable(PRJM_EVAL_F*** variables, int* count, PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < *count; index++)
+    {
+        if ((*variables)[index] == var)
+        {
+            return;
+        }
+    }
+
+    PRJM_EVAL_F** new_variables = realloc(*variables, (*count + 1) * sizeof(PRJM_EVAL_F*));
+    if (new_variables)
+    {
+        new_variables[(*count)++] = var;
+        *variables = new_variables;
+    }
+}
+
+/**
+ * Collects the variables read by a parsed tree and the variables it may assign. Anything on the left side of an
+ * assignment counts as assigned, except for memory indices. Arguments receiving the location exec3 or while store into
+ * count as assigned as well, as a variable there decides which location is written.
+ */
+static void collect_variables(const prjm_eval_exptreenode_t* node,
+                              bool assigned,
+                              PRJM_EVAL_F*** read,
+                              int* read_count,
+                              PRJM_EVAL_F*** written,
+                              int* written_count)
+{
+    if (node->func == prjm_eval_func_var)
+    {
+        if (assigned)
+        {
+            add_unique_variable(written, written_count, node->var);
+        }
+        else
+        {
+            add_unique_variable(read, read_count, node->var);
+        }
+        return;
+    }
+
+    if (!node->args)
+    {
+        return;
+    }
+
+    for (int index = 0; node->args[index]; index++)
+    {
+        bool arg_assigned = (assigned && node->func != prjm_eval_func_mem) ||
+                            (index == 0 && (prjm_eval_exptreenode_is_assignment(node) ||
+                                            prjm_eval_exptreenode_is_indirect_store(node))) ||
+                            prjm_eval_exptreenode_receives_reference(node, index);
+        collect_variables(node->args[index], arg_assigned, read, read_count, written, written_count);
+    }
+}
+
+/**
+ * Remembers which variables the program could be specialized for, i.e. all variables it reads but never assigns.
+ */
+static void find_freeze_candidates(prjm_eval_program_t* program, const prjm_eval_exptreenode_t* tree, const char* code)
+{
+    PRJM_EVAL_F** read = NULL;
+    int read_count = 0;
+    PRJM_EVAL_F** written = NULL;
+    int written_count = 0;
+
+    collect_variables(tree, false, &read, &read_count, &written, &written_count);
+
+    int candidate_count = 0;
+    for (int index = 0; index < read_count; index++)
+    {
+        bool is_written = false;
+        for (int written_index = 0; written_index < written_count && !is_written; written_index++)
+        {
+            is_written = written[written_index] == read[index];
+        }
+        if (!is_written)
+        {
+            read[candidate_count++] = read[index];
+        }
+    }
+
+    free(written);
+
+    if (candidate_count == 0 || !(program->source = strdup(code)))
+    {
+        free(read);
+        return;
+    }
+
+    program->freeze_candidates = read;
+    program->freeze_candidate_count = candidate_count;
+}
+
+prjm_eval_program_t* prjm_eval_compile_code(prjm_eval_compiler_context_t* cctx, const char* code)
+{
+    if (!parse_code(cctx, code))
+    {
+        return NULL;
+    }
+
+    prjm_eval_program_t* program = calloc(1, sizeof(prjm_eval_program_t));
+    if (cctx->compile_result)
+    {
+        find_freeze_candidates(program, cctx->compile_result, code);
+    }
+
+    if (cctx->output_variables)
+    {
+        program->output_variables = malloc((cctx->output_variable_count + 1) * sizeof(PRJM_EVAL_F*));
+        if (!program->output_variables)
+        {
+            prjm_eval_destroy_code(program);
+            return NULL;
+        }
+        memcpy(program->output_variables, cctx->output_variables,
+               cctx->output_variable_count * sizeof(PRJM_EVAL_F*));
+        program->output_variable_count = cctx->output_variable_count;
+    }
+
+    /* Kept for specializing the program again, as the context options may change in between. */
+    program->pass_options.fuse_superinstructions = cctx->fuse_superinstructions;
+    program->pass_options.prune_branches = cctx->prune_branches;
+    program->pass_options.eliminate_common_subexpressions = cctx->eliminate_common_subexpressions;
+    program->pass_options.simplify_expressions = cctx->simplify_expressions;
+    program->pass_options.hoist_loop_invariants = cctx->hoist_loop_invariants;
+    program->pass_options.specialize_value_ranges = cctx->specialize_value_ranges;
+    program->pass_options.unroll_limit = cctx->unroll_limit;
+
+    if (!prepare_tree(cctx, program))
+    {
+        prjm_eval_destroy_code(program);
         return NULL;
     }
 
-    prjm_eval_program_t* program = malloc(sizeof(prjm_eval_program_t));
     program->cctx = cctx;
     program->program = cctx->compile_result;
+    program->engine = PROJECTM_EVAL_ENGINE_TREE;
+    program->tiering_threshold = cctx->tiering_threshold;
+    program->vectorize_loops = cctx->vectorize_loops;
+    program->frozen_generation = -1;
     cctx->compile_result = NULL;
 
     return program;
 }
 
+prjm_eval_program_t* prjm_eval_create_native_code(prjm_eval_compiler_context_t* cctx,
+                                                  const projectm_eval_native_program* native)
+{
+    assert(cctx);
+    assert(native);
+    assert(native->function);
+
+    if (native->float_size != PRJM_F_SIZE)
+    {
+        return NULL;
+    }
+
+    prjm_eval_program_t* program = calloc(1, sizeof(prjm_eval_program_t));
+    program->cctx = cctx;
+    program->native = native;
+    program->engine = PROJECTM_EVAL_ENGINE_NATIVE;
+
+    if (native->variable_count > 0)
+    {
+        program->native_variables = malloc(native->variable_count * sizeof(PRJM_EVAL_F*));
+        program->native_batch_values = malloc(native->variable_count * sizeof(PRJM_EVAL_F));
+        for (int index = 0; index < native->variable_count; index++)
+        {
+            program->native_variables[index] = prjm_eval_register_variable(cctx, native->variable_names[index]);
+        }
+    }
+
+    return program;
+}
+
 void prjm_eval_destroy_code(prjm_eval_program_t* program)
 {
     if (!program)
@@ -122,10 +394,473 @@ void prjm_eval_destroy_code(prjm_eval_program_t* program)
         return;
     }
 
-    prjm_eval_destroy_exptreenode(program->program);
+    prjm_eval_bytecode_destroy(program->bytecode);
+    prjm_eval_register_code_destroy(program->register_code);
+    prjm_eval_batch_code_destroy(program->batch_code);
+#ifdef PRJM_EVAL_ENABLE_JIT
+    prjm_eval_jit_code_destroy(program->jit_code);
+#endif
+    /* The program tree was packed into a single block by prjm_eval_compile_code(). */
+    free(program->program);
+    free(program->native_variables);
+    free(program->native_batch_values);
+    free(program->uniform_variables);
+    free(program->source);
+    free(program->freeze_candidates);
+    free(program->frozen_values);
+    free(program->output_variables);
     free(program);
 }
 
+/**
+ * Returns the options for the register code of the given program, which is also translated by the JIT.
+ */
+static int register_code_options(const prjm_eval_program_t* program)
+{
+    return PRJM_EVAL_REGISTER_USE_CURSORS |
+           (program->vectorize_loops ? PRJM_EVAL_REGISTER_VECTORIZE_LOOPS : 0);
+}
+
+int prjm_eval_set_code_engine(prjm_eval_program_t* program, projectm_eval_engine engine)
+{
+    assert(program);
+
+    /* Precompiled programs have no tree which could be translated. */
+    if (program->native)
+    {
+        return engine == PROJECTM_EVAL_ENGINE_NATIVE;
+    }
+
+    switch (engine)
+    {
+        case PROJECTM_EVAL_ENGINE_TREE:
+            break;
+
+        case PROJECTM_EVAL_ENGINE_BYTECODE:
+            /* Empty programs are executed without any engine. */
+            if (program->program && !program->bytecode)
+            {
+                program->bytecode = prjm_eval_bytecode_create(program->program);
+                if (!program->bytecode)
+                {
+                    return 0;
+                }
+            }
+            break;
+
+        case PROJECTM_EVAL_ENGINE_REGISTER:
+            if (program->program && !program->register_code)
+            {
+                program->register_code = prjm_eval_register_code_create(program->program,
+                                                                        register_code_options(program));
+                if (!program->register_code)
+                {
+                    return 0;
+                }
+            }
+            break;
+
+#ifdef PRJM_EVAL_ENABLE_JIT
+        case PROJECTM_EVAL_ENGINE_JIT:
+            if (program->program && !program->jit_code)
+            {
+                program->jit_code = prjm_eval_jit_code_create(program->program, register_code_options(program));
+                if (!program->jit_code)
+                {
+                    return 0;
+                }
+            }
+            break;
+#endif
+
+        default:
+            return 0;
+    }
+
+    program->engine = engine;
+
+    /* An engine selected by the caller is kept. */
+    program->tiering_threshold = 0;
+
+    return 1;
+}
+
+int prjm_eval_set_code_batch_precision(prjm_eval_program_t* program, projectm_eval_precision precision)
+{
+    assert(program);
+
+    if (program->native && precision != PROJECTM_EVAL_PRECISION_DEFAULT)
+    {
+        return 0;
+    }
+
+    switch (precision)
+    {
+        case PROJECTM_EVAL_PRECISION_DEFAULT:
+        case PROJECTM_EVAL_PRECISION_FLOAT:
+            program->batch_precision = precision;
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Creates the batch code of a program and hoists the computations using the program's uniform variables.
+ * @return The number of hoisted instructions, or -1 if an allocation failed.
+ */
+static int create_batch_code(prjm_eval_program_t* program)
+{
+    if (!program->batch_code)
+    {
+        program->batch_code = prjm_eval_batch_code_create(program->program);
+        if (!program->batch_code)
+        {
+            return -1;
+        }
+    }
+
+    return prjm_eval_batch_code_set_uniforms(program->batch_code, program->uniform_variables,
+                                             program->uniform_variable_count);
+}
+
+int prjm_eval_set_code_uniform_variables(prjm_eval_program_t* program,
+                                         PRJM_EVAL_F* const* variables,
+                                         int variable_count)
+{
+    assert(program);
+
+    if (program->native || !program->program)
+    {
+        return 0;
+    }
+
+    PRJM_EVAL_F** uniform_variables = malloc((variable_count + 1) * sizeof(PRJM_EVAL_F*));
+    if (!uniform_variables)
+    {
+        return -1;
+    }
+    if (variable_count > 0)
+    {
+        memcpy(uniform_variables, variables, variable_count * sizeof(PRJM_EVAL_F*));
+    }
+
+    free(program->uniform_variables);
+    program->uniform_variables = uniform_variables;
+    program->uniform_variable_count = variable_count;
+
+    return create_batch_code(program);
+}
+
+int prjm_eval_set_output_variables(prjm_eval_compiler_context_t* cctx,
+                                   PRJM_EVAL_F* const* variables,
+                                   int variable_count)
+{
+    assert(cctx);
+
+    PRJM_EVAL_F** output_variables = NULL;
+    if (variables)
+    {
+        output_variables = malloc((variable_count + 1) * sizeof(PRJM_EVAL_F*));
+        if (!output_variables)
+        {
+            return 0;
+        }
+        if (variable_count > 0)
+        {
+            memcpy(output_variables, variables, variable_count * sizeof(PRJM_EVAL_F*));
+        }
+    }
+
+    free(cctx->output_variables);
+    cctx->output_variables = output_variables;
+    cctx->output_variable_count = variables ? variable_count : 0;
+
+    return 1;
+}
+
+int prjm_eval_set_variable_frozen(prjm_eval_compiler_context_t* cctx, PRJM_EVAL_F* var, bool frozen)
+{
+    assert(cctx);
+
+    prjm_eval_variable_def_t* variable = prjm_eval_find_variable(cctx, var);
+    if (!variable)
+    {
+        return 0;
+    }
+
+    if (variable->frozen != frozen)
+    {
+        variable->frozen = frozen;
+        cctx->frozen_generation++;
+    }
+
+    return 1;
+}
+
+/**
+ * Replaces the tree of a program, translating it again for the selected engine.
+ */
+static void replace_tree(prjm_eval_program_t* program, prjm_eval_exptreenode_t* tree)
+{
+    prjm_eval_bytecode_destroy(program->bytecode);
+    prjm_eval_register_code_destroy(program->register_code);
+    prjm_eval_batch_code_destroy(program->batch_code);
+#ifdef PRJM_EVAL_ENABLE_JIT
+    prjm_eval_jit_code_destroy(program->jit_code);
+    program->jit_code = NULL;
+#endif
+    program->bytecode = NULL;
+    program->register_code = NULL;
+    program->batch_code = NULL;
+
+    free(program->program);
+    program->program = tree;
+
+    /* The batch code is created again on the next batch execution. */
+    int tiering_threshold = program->tiering_threshold;
+    if (!prjm_eval_set_code_engine(program, program->engine))
+    {
+        program->engine = PROJECTM_EVAL_ENGINE_TREE;
+    }
+    program->tiering_threshold = tiering_threshold;
+}
+
+/**
+ * Compiles the program again, replacing the given frozen variables with their values.
+ * @return false if the compilation failed.
+ */
+static bool specialize_code(prjm_eval_program_t* program, prjm_eval_frozen_value_t* frozen_values, int frozen_value_count)
+{
+    prjm_eval_compiler_context_t* cctx = program->cctx;
+
+    /* The error of the last compilation requested by the application stays available. */
+    prjm_eval_compiler_error_t error = cctx->error;
+    cctx->error.error = NULL;
+
+    cctx->frozen_values = frozen_values;
+    cctx->frozen_value_count = frozen_value_count;
+    bool success = parse_code(cctx, program->source) && prepare_tree(cctx, program);
+    cctx->frozen_values = NULL;
+    cctx->frozen_value_count = 0;
+
+    free(cctx->error.error);
+    cctx->error = error;
+
+    if (!success)
+    {
+        return false;
+    }
+
+    replace_tree(program, cctx->compile_result);
+    cctx->compile_result = NULL;
+
+    free(program->frozen_values);
+    program->frozen_values = frozen_values;
+    program->frozen_value_count = frozen_value_count;
+
+    return true;
+}
+
+/**
+ * Specializes the program again if variables were frozen or unfrozen since the last execution, or if a frozen variable
+ * has a different value now.
+ */
+static void update_frozen_values(prjm_eval_program_t* program)
+{
+    prjm_eval_compiler_context_t* cctx = program->cctx;
+
+    bool changed = program->frozen_generation != cctx->frozen_generation;
+    for (int index = 0; index < program->frozen_value_count && !changed; index++)
+    {
+        changed = memcmp(program->frozen_values[index].var, &program->frozen_values[index].value,
+                         sizeof(PRJM_EVAL_F)) != 0;
+    }
+    if (!changed)
+    {
+        return;
+    }
+
+    program->frozen_generation = cctx->frozen_generation;
+
+    prjm_eval_frozen_value_t* frozen_values = malloc((program->freeze_candidate_count + 1) *
+                                                     sizeof(prjm_eval_frozen_value_t));
+    if (!frozen_values)
+    {
+        return;
+    }
+
+    int frozen_value_count = 0;
+    for (int index = 0; index < program->freeze_candidate_count; index++)
+    {
+        PRJM_EVAL_F* var = program->freeze_candidates[index];
+        prjm_eval_variable_def_t* variable = prjm_eval_find_variable(cctx, var);
+        if (variable && variable->frozen)
+        {
+            frozen_values[frozen_value_count].var = var;
+            frozen_values[frozen_value_count].value = *var;
+            frozen_value_count++;
+        }
+    }
+
+    /* Nothing to do if a change in the context doesn't affect this program. */
+    if (frozen_value_count == program->frozen_value_count &&
+        memcmp(frozen_values, program->frozen_values, frozen_value_count * sizeof(prjm_eval_frozen_value_t)) == 0)
+    {
+        free(frozen_values);
+        return;
+    }
+
+    if (!specialize_code(program, frozen_values, frozen_value_count))
+    {
+        free(frozen_values);
+
+        /* Fall back to the unspecialized program instead of keeping outdated values. */
+        if (program->frozen_value_count > 0)
+        {
+            specialize_code(program, NULL, 0);
+        }
+    }
+}
+
+/**
+ * Moves a frequently executed program to the fastest engine it can be translated for.
+ */
+static void promote_code(prjm_eval_program_t* program)
+{
+#ifdef PRJM_EVAL_ENABLE_JIT
+    if (prjm_eval_set_code_engine(program, PROJECTM_EVAL_ENGINE_JIT))
+    {
+        return;
+    }
+#endif
+
+    prjm_eval_set_code_engine(program, PROJECTM_EVAL_ENGINE_REGISTER);
+
+    /* Keep the tree engine if the translation failed. */
+    program->tiering_threshold = 0;
+}
+
+PRJM_EVAL_F prjm_eval_execute_code(prjm_eval_program_t* program)
+{
+    assert(program);
+
+    if (program->native)
+    {
+        return program->native->function(program->native_variables, program->cctx->memory,
+                                         program->cctx->global_memory);
+    }
+
+    if (program->freeze_candidates)
+    {
+        update_frozen_values(program);
+    }
+
+    // Empty program.
+    if (!program->program)
+    {
+        return 0.0;
+    }
+
+    if (program->tiering_threshold > 0 && ++program->execution_count >= program->tiering_threshold)
+    {
+        promote_code(program);
+    }
+
+    if (program->engine == PROJECTM_EVAL_ENGINE_BYTECODE)
+    {
+        return prjm_eval_bytecode_execute(program->bytecode);
+    }
+
+    if (program->engine == PROJECTM_EVAL_ENGINE_REGISTER)
+    {
+        return prjm_eval_register_code_execute(program->register_code);
+    }
+
+#ifdef PRJM_EVAL_ENABLE_JIT
+    if (program->engine == PROJECTM_EVAL_ENGINE_JIT)
+    {
+        return prjm_eval_jit_code_execute(program->jit_code);
+    }
+#endif
+
+    return program->program->value_func(program->program);
+}
+
+void prjm_eval_execute_code_batch(prjm_eval_program_t* program,
+                                  const projectm_eval_lane_variable* lane_variables,
+                                  int lane_variable_count,
+                                  int lane_count,
+                                  PRJM_EVAL_F* results)
+{
+    assert(program);
+
+    if (lane_count <= 0)
+    {
+        return;
+    }
+
+    if (program->freeze_candidates)
+    {
+        update_frozen_values(program);
+    }
+
+    if (!program->native && program->program && !program->batch_code)
+    {
+        create_batch_code(program);
+    }
+
+    if (program->batch_code)
+    {
+        prjm_eval_batch_code_execute(program->batch_code, program->batch_precision, lane_variables,
+                                     lane_variable_count, lane_count, results);
+    }
+    else
+    {
+        /*
+         * Precompiled and empty programs have no batch code, execute them once per lane instead. Like in the batch
+         * code, each lane starts with the values the variables had before the batch.
+         */
+        int variable_count = program->native ? program->native->variable_count : 0;
+        for (int index = 0; index < variable_count; index++)
+        {
+            program->native_batch_values[index] = *program->native_variables[index];
+        }
+
+        for (int lane = 0; lane < lane_count; lane++)
+        {
+            for (int index = 0; index < variable_count; index++)
+            {
+                *program->native_variables[index] = program->native_batch_values[index];
+            }
+
+            for (int index = 0; index < lane_variable_count; index++)
+            {
+                *lane_variables[index].variable = lane_variables[index].values[lane];
+            }
+
+            PRJM_EVAL_F result = prjm_eval_execute_code(program);
+
+            for (int index = 0; index < lane_variable_count; index++)
+            {
+                lane_variables[index].values[lane] = *lane_variables[index].variable;
+            }
+
+            if (results)
+            {
+                results[lane] = result;
+            }
+        }
+    }
+
+    /* Bound variables not used by the program weren't touched by the batch code. */
+    for (int index = 0; index < lane_variable_count; index++)
+    {
+        *lane_variables[index].variable = lane_variables[index].values[lane_count - 1];
+    }
+}
+
 void prjm_eval_reset_context_vars(prjm_eval_compiler_context_t* cctx)
 {
     assert(cctx);
@@ -2,6 +2,17 @@
 
 #include "CompilerTypes.h"
 
+/**
+ * @brief Default number of executions after which a program is moved from the tree interpreter to a faster engine.
+ * Tiering is opt-in, the default of 0 keeps programs with the tree interpreter.
+ */
+#define PRJM_EVAL_DEFAULT_TIERING_THRESHOLD 0
+
+/**
+ * @brief Default maximum number of nodes of loop bodies copied when unrolling loops with constant counts.
+ */
+#define PRJM_EVAL_DEFAULT_UNROLL_LIMIT 64
+
 /**
  * @brief Creates an empty compile context.
  * @param global_memory An optional pointer to a memory buffer to use as global memory (gmegabuf).
@@ -27,12 +38,100 @@ void prjm_eval_destroy_compile_context(prjm_eval_compiler_context_t* cctx);
  */
 prjm_eval_program_t* prjm_eval_compile_code(prjm_eval_compiler_context_t* cctx, const char* code);
 
+/**
+ * @brief Creates a program executing a function precompiled by the transpiler.
+ * Registers all variables used by the precompiled function in the context.
+ * @param cctx The context to associate the program with.
+ * @param native The precompiled program description.
+ * @return The program or NULL if the precompiled program uses a different float size.
+ */
+prjm_eval_program_t* prjm_eval_create_native_code(prjm_eval_compiler_context_t* cctx,
+                                                  const projectm_eval_native_program* native);
+
 /**
  * @brief Destroys a previously compiled program.
  * @param program The program to destroy.
  */
 void prjm_eval_destroy_code(prjm_eval_program_t* program);
 
+/**
+ * @brief Changes the execution engine of a program.
+ * Translates the program for the requested engine if not done before. A successfully selected engine is kept, the
+ * program won't be promoted to another engine afterwards.
+ * @param program The program to change.
+ * @param engine The new engine.
+ * @return 1 on success, 0 if the program couldn't be translated. The engine is left unchanged in this case.
+ */
+int prjm_eval_set_code_engine(prjm_eval_program_t* program, projectm_eval_engine engine);
+
+/**
+ * @brief Changes the arithmetic precision used for batch execution of a program.
+ * @param program The program to change.
+ * @param precision The new precision.
+ * @return 1 on success, 0 if the program is precompiled and can only use the default precision.
+ */
+int prjm_eval_set_code_batch_precision(prjm_eval_program_t* program, projectm_eval_precision precision);
+
+/**
+ * @brief Marks variables as uniform for batch execution of a program and hoists the computations depending on them.
+ * Creates the batch code if it doesn't exist yet.
+ * @param program The program to change.
+ * @param variables The uniform variables.
+ * @param variable_count Number of entries in variables.
+ * @return The number of hoisted instructions, 0 for precompiled or empty programs and -1 if an allocation failed.
+ */
+int prjm_eval_set_code_uniform_variables(prjm_eval_program_t* program,
+                                         PRJM_EVAL_F* const* variables,
+                                         int variable_count);
+
+/**
+ * @brief Declares the variables read after programs compiled in the context are executed.
+ * Assignments to other variables are removed from programs compiled afterwards if the program doesn't read them later.
+ * @param cctx The context to change.
+ * @param variables The output variables, or NULL to consider all variables as outputs again.
+ * @param variable_count Number of entries in variables.
+ * @return 1 on success, 0 if an allocation failed.
+ */
+int prjm_eval_set_output_variables(prjm_eval_compiler_context_t* cctx,
+                                   PRJM_EVAL_F* const* variables,
+                                   int variable_count);
+
+/**
+ * @brief Freezes or unfreezes a context variable.
+ * Programs reading but never assigning a frozen variable are specialized for its current value on their next
+ * execution, and again each time the value changes.
+ * @param cctx The context the variable belongs to.
+ * @param var The variable, as returned by prjm_eval_register_variable().
+ * @param frozen true to freeze the variable, false to unfreeze it.
+ * @return 1 on success, 0 if var isn't a variable of the context.
+ */
+int prjm_eval_set_variable_frozen(prjm_eval_compiler_context_t* cctx, PRJM_EVAL_F* var, bool frozen);
+
+/**
+ * @brief Executes a program using its currently selected engine.
+ * Counts the executions of programs still using the initial engine and moves them to the fastest available engine
+ * once the tiering threshold is reached.
+ * @param program The program to execute.
+ * @return The value of the last top-level expression.
+ */
+PRJM_EVAL_F prjm_eval_execute_code(prjm_eval_program_t* program);
+
+/**
+ * @brief Executes a program once for each lane, see projectm_eval_code_execute_batch().
+ * Runs the lanes in parallel using batch code, which is created on the first call. Precompiled programs are executed
+ * one lane after the other.
+ * @param program The program to execute.
+ * @param lane_variables The variables with per-lane values.
+ * @param lane_variable_count Number of entries in lane_variables.
+ * @param lane_count Number of lanes to execute.
+ * @param results If not NULL, receives the return value of each lane.
+ */
+void prjm_eval_execute_code_batch(prjm_eval_program_t* program,
+                                  const projectm_eval_lane_variable* lane_variables,
+                                  int lane_variable_count,
+                                  int lane_count,
+                                  PRJM_EVAL_F* results);
+
 /**
  * @brief Resets all internal variable values to 0.
  * Externally registered variables are not changed.
@@ -265,6 +265,16 @@ prjm_eval_compiler_node_t* prjm_eval_compiler_create_variable(prjm_eval_compiler
     /* Find existing variable or create a new one */
     PRJM_EVAL_F* var = prjm_eval_register_variable(cctx, name);
 
+    /* While specializing a program, frozen variables are replaced by their value, so expressions using them can be
+     * evaluated at compile time. */
+    for (int index = 0; index < cctx->frozen_value_count; index++)
+    {
+        if (cctx->frozen_values[index].var == var)
+        {
+            return prjm_eval_compiler_create_constant(cctx, cctx->frozen_values[index].value);
+        }
+    }
+
     prjm_eval_function_def_t* var_func = prjm_eval_compiler_get_function(cctx, "/*var*/");
     prjm_eval_compiler_node_t* node = prjm_eval_compiler_create_expression_empty(var_func);
 
@@ -302,9 +312,8 @@ prjm_eval_compiler_node_t* prjm_eval_compiler_add_instruction(prjm_eval_compiler
         prjm_eval_function_def_t* list_func = prjm_eval_compiler_get_function(cctx, "/*list*/");
 
         prjm_eval_compiler_node_t* new_node = prjm_eval_compiler_create_expression_empty(list_func);
-        new_node->tree_node->list = malloc(sizeof(prjm_eval_exptreenode_list_item_t));
-        new_node->tree_node->list->expr = list->tree_node;
-        new_node->tree_node->list->next = NULL;
+        new_node->tree_node->args = calloc(2, sizeof(prjm_eval_exptreenode_t*));
+        new_node->tree_node->args[0] = list->tree_node;
         new_node->type = PRJM_EVAL_NODE_FUNC_INSTRUCTIONLIST;
         new_node->instr_is_const_expr = list->instr_is_const_expr;
         new_node->instr_is_state_changing = list->instr_is_state_changing;
@@ -318,26 +327,27 @@ prjm_eval_compiler_node_t* prjm_eval_compiler_add_instruction(prjm_eval_compiler
 
     assert(node);
     assert(node->tree_node);
-    assert(node->tree_node->list);
+    assert(node->tree_node->args);
 
-    prjm_eval_exptreenode_list_item_t* item = node->tree_node->list;
-    while (item->next)
+    prjm_eval_exptreenode_t** instructions = node->tree_node->args;
+    int count = 0;
+    while (instructions[count])
     {
-        /* If last expression in the existing list is not state-changing, we can remove it as it won't do
-         * anything useful. Only the last expression's value may be of interest. */
-        if (!node->instr_is_state_changing && !item->next->next)
-        {
-            prjm_eval_destroy_exptreenode(item->next->expr);
-            free(item->next);
-            break;
-        }
+        count++;
+    }
 
-        item = item->next;
+    /* If last expression in the existing list is not state-changing, we can remove it as it won't do
+     * anything useful. Only the last expression's value may be of interest. */
+    if (!node->instr_is_state_changing && count > 1)
+    {
+        prjm_eval_destroy_exptreenode(instructions[count - 1]);
+        count--;
     }
 
-    item->next = malloc(sizeof(prjm_eval_exptreenode_list_item_t));
-    item->next->expr = instruction->tree_node;
-    item->next->next = NULL;
+    instructions = realloc(instructions, (count + 2) * sizeof(prjm_eval_exptreenode_t*));
+    instructions[count] = instruction->tree_node;
+    instructions[count + 1] = NULL;
+    node->tree_node->args = instructions;
 
     /* Update const/state flags of node and list with last expression */
     node->instr_is_const_expr = instruction->list_is_const_expr;
@@ -348,4 +358,240 @@ prjm_eval_compiler_node_t* prjm_eval_compiler_add_instruction(prjm_eval_compiler
     free(instruction);
 
     return node;
-}
\ No newline at end of file
+}
+
+/* Superinstruction fusion */
+
+typedef struct prjm_eval_compiler_fused_function
+{
+    prjm_eval_expr_func_t* func; /*!< The function of the replaced node. */
+    prjm_eval_expr_func_t* fused_func; /*!< The fused function replacing it. */
+    bool commutative; /*!< If true, the operands of func may be swapped. */
+} prjm_eval_compiler_fused_function_t;
+
+/* "x = x op y" is fused into "x op= y". */
+static const prjm_eval_compiler_fused_function_t compound_assignments[] = {
+    { prjm_eval_func_add,         prjm_eval_func_add_op,         true },
+    { prjm_eval_func_sub,         prjm_eval_func_sub_op,         false },
+    { prjm_eval_func_mul,         prjm_eval_func_mul_op,         true },
+    { prjm_eval_func_div,         prjm_eval_func_div_op,         false },
+    { prjm_eval_func_mod,         prjm_eval_func_mod_op,         false },
+    { prjm_eval_func_bitwise_or,  prjm_eval_func_bitwise_or_op,  true },
+    { prjm_eval_func_bitwise_and, prjm_eval_func_bitwise_and_op, true },
+    { prjm_eval_func_pow,         prjm_eval_func_pow_op,         false }
+};
+
+/* "if(a cmp b, then, else)" is fused into "if_cmp(a, b, then, else)". */
+#define COMPARE_SELECT_ENTRY(name, condition) { prjm_eval_func_ ## name, prjm_eval_func_if_ ## name, false },
+
+static const prjm_eval_compiler_fused_function_t compare_selects[] = {
+    PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(COMPARE_SELECT_ENTRY)
+};
+
+#undef COMPARE_SELECT_ENTRY
+
+static const prjm_eval_compiler_fused_function_t* find_fused_function(const prjm_eval_compiler_fused_function_t* table,
+                                                                      size_t count,
+                                                                      prjm_eval_expr_func_t* func)
+{
+    for (size_t index = 0; index < count; index++)
+    {
+        if (table[index].func == func)
+        {
+            return &table[index];
+        }
+    }
+
+    return NULL;
+}
+
+static bool is_same_variable(const prjm_eval_exptreenode_t* expr1, const prjm_eval_exptreenode_t* expr2)
+{
+    return expr1->func == prjm_eval_func_var &&
+           expr2->func == prjm_eval_func_var &&
+           expr1->var == expr2->var;
+}
+
+static bool is_leaf(const prjm_eval_exptreenode_t* expr)
+{
+    return expr->func == prjm_eval_func_var || expr->func == prjm_eval_func_const;
+}
+
+/**
+ * @brief Frees a node which was merged into a fused node, except for the arguments taken over by it.
+ * The taken arguments must be set to NULL in the merged node, they are skipped when destroying it.
+ */
+static void destroy_merged_node(prjm_eval_exptreenode_t* expr, int arg_count)
+{
+    for (int index = 0; index < arg_count; index++)
+    {
+        prjm_eval_destroy_exptreenode(expr->args[index]);
+    }
+
+    free(expr->args);
+    free(expr);
+}
+
+/**
+ * @brief Replaces the argument list of a node with a new one, built from the given arguments.
+ * @return false if the allocation failed. The node is unchanged in this case.
+ */
+static bool replace_args(prjm_eval_exptreenode_t* expr, prjm_eval_exptreenode_t** args, int count)
+{
+    prjm_eval_exptreenode_t** new_args = calloc(count + 1, sizeof(prjm_eval_exptreenode_t*));
+    if (!new_args)
+    {
+        return false;
+    }
+
+    memcpy(new_args, args, count * sizeof(prjm_eval_exptreenode_t*));
+    free(expr->args);
+    expr->args = new_args;
+
+    return true;
+}
+
+static bool fuse_compound_assignment(prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_exptreenode_t* target = expr->args[0];
+    prjm_eval_exptreenode_t* value = expr->args[1];
+
+    const prjm_eval_compiler_fused_function_t* fused = find_fused_function(compound_assignments,
+                                                                          sizeof(compound_assignments) / sizeof(prjm_eval_compiler_fused_function_t),
+                                                                          value->func);
+    if (!fused)
+    {
+        return false;
+    }
+
+    /*
+     * Both the operator and the compound assignment read the variable after evaluating the other operand,
+     * so swapping the operands of commutative operators is safe.
+     */
+    int operand_index;
+    if (is_same_variable(target, value->args[0]))
+    {
+        operand_index = 1;
+    }
+    else if (fused->commutative && is_same_variable(target, value->args[1]))
+    {
+        operand_index = 0;
+    }
+    else
+    {
+        return false;
+    }
+
+    expr->func = fused->fused_func;
+    expr->args[1] = value->args[operand_index];
+    value->args[operand_index] = NULL;
+    destroy_merged_node(value, 2);
+
+    return true;
+}
+
+static bool fuse_mem_set(prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_exptreenode_t* target = expr->args[0];
+
+    if (target->func != prjm_eval_func_mem)
+    {
+        return false;
+    }
+
+    expr->func = prjm_eval_func_mem_set;
+    expr->memory_buffer = target->memory_buffer;
+    expr->args[0] = target->args[0];
+    target->args[0] = NULL;
+    destroy_merged_node(target, 1);
+
+    return true;
+}
+
+static bool fuse_mul_add(prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_exptreenode_t* product;
+    prjm_eval_exptreenode_t* addend;
+
+    if (expr->args[0]->func == prjm_eval_func_mul)
+    {
+        product = expr->args[0];
+        addend = expr->args[1];
+    }
+    /*
+     * The fused function evaluates the addend last. A variable or constant addend is read after the product was
+     * calculated anyway, other expressions must be evaluated first.
+     */
+    else if (expr->args[1]->func == prjm_eval_func_mul && is_leaf(expr->args[0]))
+    {
+        product = expr->args[1];
+        addend = expr->args[0];
+    }
+    else
+    {
+        return false;
+    }
+
+    prjm_eval_exptreenode_t* args[3] = { product->args[0], product->args[1], addend };
+    if (!replace_args(expr, args, 3))
+    {
+        return false;
+    }
+
+    expr->func = prjm_eval_func_mul_add;
+    product->args[0] = NULL;
+    product->args[1] = NULL;
+    destroy_merged_node(product, 2);
+
+    return true;
+}
+
+static bool fuse_compare_select(prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_exptreenode_t* condition = expr->args[0];
+
+    const prjm_eval_compiler_fused_function_t* fused = find_fused_function(compare_selects,
+                                                                          sizeof(compare_selects) / sizeof(prjm_eval_compiler_fused_function_t),
+                                                                          condition->func);
+    if (!fused)
+    {
+        return false;
+    }
+
+    prjm_eval_exptreenode_t* args[4] = { condition->args[0], condition->args[1], expr->args[1], expr->args[2] };
+    if (!replace_args(expr, args, 4))
+    {
+        return false;
+    }
+
+    expr->func = fused->fused_func;
+    condition->args[0] = NULL;
+    condition->args[1] = NULL;
+    destroy_merged_node(condition, 2);
+
+    return true;
+}
+
+int prjm_eval_compiler_fuse_superinstructions(prjm_eval_exptreenode_t* expr)
+{
+    int fused_count = 0;
+
+    if (!expr->args)
+    {
+        return fused_count;
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        fused_count += prjm_eval_compiler_fuse_superinstructions(*arg);
+    }
+
+    if ((expr->func == prjm_eval_func_set && (fuse_compound_assignment(expr) || fuse_mem_set(expr))) ||
+        (expr->func == prjm_eval_func_add && fuse_mul_add(expr)) ||
+        (expr->func == prjm_eval_func_if && fuse_compare_select(expr)))
+    {
+        fused_count++;
+    }
+
+    return fused_count;
+}
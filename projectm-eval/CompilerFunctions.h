@@ -107,4 +107,12 @@ prjm_eval_compiler_node_t* prjm_eval_compiler_create_constant(prjm_eval_compiler
 
 prjm_eval_compiler_node_t* prjm_eval_compiler_add_instruction(prjm_eval_compiler_context_t* cctx,
                                                              prjm_eval_compiler_node_t* list,
-                                                             prjm_eval_compiler_node_t* instruction);
\ No newline at end of file
+                                                             prjm_eval_compiler_node_t* instruction);
+/**
+ * @brief Replaces common statement patterns in the given tree with fused functions.
+ * Fused patterns are "x = x op y" (compound assignment), "a * b + c" (mul_add), "if(a < b, ...)" and other
+ * comparisons (if_below etc.) and "megabuf(i) = y" (mem_set). Must be called before the tree is specialized.
+ * @param expr The root node of the tree.
+ * @return The number of fused subtrees.
+ */
+int prjm_eval_compiler_fuse_superinstructions(prjm_eval_exptreenode_t* expr);
@@ -0,0 +1,2877 @@
+#include "CompilerOptimizations.h"
+
+#include "ExpressionTree.h"
+#include "IntrinsicMath.h"
+#include "TreeFunctions.h"
+#include "TreeVariables.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Common subexpression elimination */
+
+/* Minimum cost of an expression to be worth storing in a hidden variable, see expression_cost(). */
+#define CSE_MIN_COST 2
+
+typedef struct prjm_eval_cse_entry
+{
+    prjm_eval_exptreenode_t* expr; /*!< The first occurrence of the expression. */
+    prjm_eval_exptreenode_t** slot; /*!< The argument slot holding the first occurrence. */
+    PRJM_EVAL_F* temp; /*!< The hidden variable storing the value, NULL until a second occurrence is found. */
+    uint32_t hash; /*!< Hash of the expression, see expression_hash(). */
+    bool available; /*!< If false, the stored value may be outdated or not computed at all. */
+} prjm_eval_cse_entry_t;
+
+typedef struct prjm_eval_cse_state
+{
+    prjm_eval_compiler_context_t* cctx;
+    prjm_eval_cse_entry_t* entries;
+    int entry_count;
+    int replaced_count;
+} prjm_eval_cse_state_t;
+
+static const prjm_eval_function_def_t* find_function(prjm_eval_compiler_context_t* cctx, prjm_eval_expr_func_t* func)
+{
+    for (prjm_eval_function_list_item_t* item = cctx->functions.first; item; item = item->next)
+    {
+        if (item->function->func == func)
+        {
+            return item->function;
+        }
+    }
+
+    return NULL;
+}
+
+static prjm_eval_cse_entry_t* find_temp_entry(prjm_eval_cse_state_t* state, const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < state->entry_count; index++)
+    {
+        if (state->entries[index].temp == var)
+        {
+            return &state->entries[index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns the expression a node stands for, skipping the stores and reads of hidden variables added by this pass.
+ */
+static const prjm_eval_exptreenode_t* canonical_node(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    for (;;)
+    {
+        prjm_eval_cse_entry_t* entry = NULL;
+        if (expr->func == prjm_eval_func_set && expr->args[0]->func == prjm_eval_func_var)
+        {
+            entry = find_temp_entry(state, expr->args[0]->var);
+        }
+        else if (expr->func == prjm_eval_func_var)
+        {
+            entry = find_temp_entry(state, expr->var);
+        }
+
+        if (!entry)
+        {
+            return expr;
+        }
+        expr = entry->expr;
+    }
+}
+
+static bool is_pure(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    expr = canonical_node(state, expr);
+
+    if (expr->func != prjm_eval_func_var)
+    {
+        const prjm_eval_function_def_t* function = find_function(state->cctx, expr->func);
+        if (!function || !function->is_const_eval || function->is_state_changing)
+        {
+            return false;
+        }
+    }
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            if (!is_pure(state, *arg))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Estimates the cost of evaluating an expression. Additions, subtractions and multiplications count 1, other
+ * functions 2. Variables and constants are free.
+ */
+static int expression_cost(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    expr = canonical_node(state, expr);
+
+    if (expr->func == prjm_eval_func_var || expr->func == prjm_eval_func_const)
+    {
+        return 0;
+    }
+
+    int cost = expr->func == prjm_eval_func_add ||
+               expr->func == prjm_eval_func_sub ||
+               expr->func == prjm_eval_func_mul ||
+               expr->func == prjm_eval_func_neg ? 1 : 2;
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            cost += expression_cost(state, *arg);
+        }
+    }
+
+    return cost;
+}
+
+static uint32_t hash_combine(uint32_t hash, uint64_t value)
+{
+    /* FNV-1a over the 8 bytes of the value. */
+    for (int byte = 0; byte < 8; byte++)
+    {
+        hash = (hash ^ (uint32_t) ((value >> (byte * 8)) & 0xff)) * 16777619u;
+    }
+
+    return hash;
+}
+
+static uint32_t expression_hash(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    expr = canonical_node(state, expr);
+
+    uint32_t hash = hash_combine(2166136261u, (uint64_t) (uintptr_t) expr->func);
+    if (expr->func == prjm_eval_func_var)
+    {
+        hash = hash_combine(hash, (uint64_t) (uintptr_t) expr->var);
+    }
+    else if (expr->func == prjm_eval_func_const)
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, &expr->value, sizeof(expr->value));
+        hash = hash_combine(hash, bits);
+    }
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            hash = hash_combine(hash, expression_hash(state, *arg));
+        }
+    }
+
+    return hash;
+}
+
+static bool is_same_expression(prjm_eval_cse_state_t* state,
+                               const prjm_eval_exptreenode_t* expr1,
+                               const prjm_eval_exptreenode_t* expr2)
+{
+    expr1 = canonical_node(state, expr1);
+    expr2 = canonical_node(state, expr2);
+
+    if (expr1 == expr2)
+    {
+        return true;
+    }
+
+    if (expr1->func != expr2->func ||
+        (expr1->func == prjm_eval_func_var && expr1->var != expr2->var) ||
+        (expr1->func == prjm_eval_func_const && memcmp(&expr1->value, &expr2->value, sizeof(expr1->value)) != 0) ||
+        !expr1->args != !expr2->args)
+    {
+        return false;
+    }
+
+    if (expr1->args)
+    {
+        int index = 0;
+        for (; expr1->args[index] && expr2->args[index]; index++)
+        {
+            if (!is_same_expression(state, expr1->args[index], expr2->args[index]))
+            {
+                return false;
+            }
+        }
+        if (expr1->args[index] || expr2->args[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool reads_variable(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* expr, const PRJM_EVAL_F* var)
+{
+    expr = canonical_node(state, expr);
+
+    if (expr->func == prjm_eval_func_var)
+    {
+        return expr->var == var;
+    }
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            if (reads_variable(state, *arg, var))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Marks the values of all expressions reading the given variable as outdated.
+ */
+static void invalidate_variable(prjm_eval_cse_state_t* state, const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < state->entry_count; index++)
+    {
+        if (state->entries[index].available && reads_variable(state, state->entries[index].expr, var))
+        {
+            state->entries[index].available = false;
+        }
+    }
+}
+
+/**
+ * Checks if a node may return a reference to the value of the given argument, which is assigned if the node is an
+ * assignment target.
+ */
+static bool may_return_argument(const prjm_eval_exptreenode_t* expr, int index)
+{
+    if (prjm_eval_exptreenode_is_assignment(expr))
+    {
+        return index == 0;
+    }
+
+    if (expr->func == prjm_eval_func_if)
+    {
+        return index > 0;
+    }
+
+    if (expr->func == prjm_eval_func_exec2 ||
+        expr->func == prjm_eval_func_exec3 ||
+        expr->func == prjm_eval_func_execute_list)
+    {
+        return !expr->args[index + 1];
+    }
+
+    return expr->func != prjm_eval_func_mem && !prjm_eval_exptreenode_returns_value(expr);
+}
+
+/**
+ * Invalidates the variables written by an assignment target.
+ */
+static void invalidate_target(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* target)
+{
+    if (target->func == prjm_eval_func_var)
+    {
+        invalidate_variable(state, target->var);
+        return;
+    }
+
+    if (!target->args)
+    {
+        return;
+    }
+
+    for (int index = 0; target->args[index]; index++)
+    {
+        if (may_return_argument(target, index))
+        {
+            invalidate_target(state, target->args[index]);
+        }
+    }
+}
+
+/**
+ * Invalidates all variables assigned anywhere in the given tree.
+ */
+static void invalidate_assigned_variables(prjm_eval_cse_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    if (!expr->args)
+    {
+        return;
+    }
+
+    if (prjm_eval_exptreenode_is_assignment(expr) || prjm_eval_exptreenode_is_indirect_store(expr))
+    {
+        invalidate_target(state, expr->args[0]);
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        invalidate_assigned_variables(state, *arg);
+    }
+}
+
+static prjm_eval_exptreenode_t* create_variable_node(PRJM_EVAL_F* var)
+{
+    prjm_eval_exptreenode_t* expr = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    if (expr)
+    {
+        expr->func = prjm_eval_func_var;
+        expr->var = var;
+    }
+
+    return expr;
+}
+
+/**
+ * Wraps the first occurrence of an expression into an assignment to a new hidden variable.
+ * @return false if an allocation failed.
+ */
+static bool store_first_occurrence(prjm_eval_cse_state_t* state, prjm_eval_cse_entry_t* entry)
+{
+    /* The names can't be used in code and are shared by all programs of the context. Each program writes the hidden
+     * variables before reading them. */
+    char name[16];
+    int temp_index = 0;
+    for (int index = 0; index < state->entry_count; index++)
+    {
+        temp_index += state->entries[index].temp ? 1 : 0;
+    }
+    snprintf(name, sizeof(name), "$cse%d", temp_index);
+
+    PRJM_EVAL_F* temp = prjm_eval_register_variable(state->cctx, name);
+    prjm_eval_exptreenode_t* store = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    prjm_eval_exptreenode_t** args = calloc(3, sizeof(prjm_eval_exptreenode_t*));
+    prjm_eval_exptreenode_t* target = temp ? create_variable_node(temp) : NULL;
+    if (!store || !args || !target)
+    {
+        free(store);
+        free(args);
+        free(target);
+        return false;
+    }
+
+    args[0] = target;
+    args[1] = entry->expr;
+    store->func = prjm_eval_func_set;
+    store->args = args;
+
+    *entry->slot = store;
+    entry->temp = temp;
+
+    return true;
+}
+
+/**
+ * Replaces a later occurrence of an available expression with a read of its hidden variable.
+ */
+static void replace_occurrence(prjm_eval_cse_state_t* state, prjm_eval_cse_entry_t* entry, prjm_eval_exptreenode_t** slot)
+{
+    if (!entry->temp && !store_first_occurrence(state, entry))
+    {
+        return;
+    }
+
+    prjm_eval_exptreenode_t* read = create_variable_node(entry->temp);
+    if (!read)
+    {
+        return;
+    }
+
+    prjm_eval_destroy_exptreenode(*slot);
+    *slot = read;
+    state->replaced_count++;
+}
+
+static void add_entry(prjm_eval_cse_state_t* state, prjm_eval_exptreenode_t** slot, uint32_t hash)
+{
+    prjm_eval_cse_entry_t* entries = realloc(state->entries, (state->entry_count + 1) * sizeof(prjm_eval_cse_entry_t));
+    if (!entries)
+    {
+        return;
+    }
+
+    entries[state->entry_count].expr = *slot;
+    entries[state->entry_count].slot = slot;
+    entries[state->entry_count].temp = NULL;
+    entries[state->entry_count].hash = hash;
+    entries[state->entry_count].available = true;
+
+    state->entries = entries;
+    state->entry_count++;
+}
+
+static void eliminate_in_tree(prjm_eval_cse_state_t* state, prjm_eval_exptreenode_t** slot, bool is_target);
+
+/**
+ * Processes an argument which isn't evaluated on each execution of its parent, or more than once.
+ * Values computed inside can't be used after the argument, and values computed before can only be used inside if
+ * the argument is repeated and doesn't change the variables they read.
+ */
+static void eliminate_in_branch(prjm_eval_cse_state_t* state, prjm_eval_exptreenode_t** slot, bool is_repeated)
+{
+    int entry_count = state->entry_count;
+
+    if (is_repeated)
+    {
+        invalidate_assigned_variables(state, *slot);
+    }
+
+    eliminate_in_tree(state, slot, false);
+
+    for (int index = entry_count; index < state->entry_count; index++)
+    {
+        state->entries[index].available = false;
+    }
+}
+
+static void eliminate_in_args(prjm_eval_cse_state_t* state, prjm_eval_exptreenode_t* expr, bool is_target)
+{
+    if (!expr->args)
+    {
+        return;
+    }
+
+    prjm_eval_expr_func_t* func = expr->func;
+    bool is_assignment = prjm_eval_exptreenode_is_assignment(expr);
+    bool is_indirect_store = prjm_eval_exptreenode_is_indirect_store(expr);
+
+    for (int index = 0; expr->args[index]; index++)
+    {
+        prjm_eval_exptreenode_t** arg = &expr->args[index];
+
+        if ((func == prjm_eval_func_if && index > 0) ||
+            ((func == prjm_eval_func_boolean_and_op || func == prjm_eval_func_boolean_or_op) && index == 1))
+        {
+            eliminate_in_branch(state, arg, false);
+        }
+        else if ((func == prjm_eval_func_execute_loop && index == 1) || func == prjm_eval_func_execute_while)
+        {
+            eliminate_in_branch(state, arg, true);
+        }
+        else
+        {
+            /* Assignment targets must keep their variables, and values stored by exec3 must stay values. */
+            bool arg_is_target = (is_target && may_return_argument(expr, index)) ||
+                                 (is_assignment && index == 0) ||
+                                 (is_indirect_store && index < 2);
+            eliminate_in_tree(state, arg, arg_is_target);
+        }
+    }
+
+    if (is_assignment || is_indirect_store)
+    {
+        invalidate_target(state, expr->args[0]);
+    }
+}
+
+static void eliminate_in_tree(prjm_eval_cse_state_t* state, prjm_eval_exptreenode_t** slot, bool is_target)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+
+    bool is_candidate = !is_target &&
+                        expr->args &&
+                        prjm_eval_exptreenode_returns_value(expr) &&
+                        is_pure(state, expr) &&
+                        expression_cost(state, expr) >= CSE_MIN_COST;
+    if (!is_candidate)
+    {
+        eliminate_in_args(state, expr, is_target);
+        return;
+    }
+
+    uint32_t hash = expression_hash(state, expr);
+    for (int index = 0; index < state->entry_count; index++)
+    {
+        prjm_eval_cse_entry_t* entry = &state->entries[index];
+        if (entry->available && entry->hash == hash && is_same_expression(state, entry->expr, expr))
+        {
+            replace_occurrence(state, entry, slot);
+            return;
+        }
+    }
+
+    /* Subexpressions may also be used on their own later. */
+    eliminate_in_args(state, expr, false);
+    add_entry(state, slot, hash);
+}
+
+int prjm_eval_compiler_eliminate_common_subexpressions(prjm_eval_compiler_context_t* cctx,
+                                                       prjm_eval_exptreenode_t** expr)
+{
+    prjm_eval_cse_state_t state = { cctx, NULL, 0, 0 };
+
+    eliminate_in_tree(&state, expr, false);
+
+    free(state.entries);
+
+    return state.replaced_count;
+}
+
+/* Dead store elimination */
+
+typedef struct prjm_eval_live_set
+{
+    PRJM_EVAL_F** vars;
+    int count;
+} prjm_eval_live_set_t;
+
+typedef struct prjm_eval_dse_state
+{
+    prjm_eval_compiler_context_t* cctx;
+    int removed_count;
+    bool failed; /*!< If true, a live set is incomplete and no more stores may be removed. */
+} prjm_eval_dse_state_t;
+
+static bool live_set_contains(const prjm_eval_live_set_t* live, const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < live->count; index++)
+    {
+        if (live->vars[index] == var)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void live_set_add(prjm_eval_dse_state_t* state, prjm_eval_live_set_t* live, PRJM_EVAL_F* var)
+{
+    if (live_set_contains(live, var))
+    {
+        return;
+    }
+
+    PRJM_EVAL_F** vars = realloc(live->vars, (live->count + 1) * sizeof(PRJM_EVAL_F*));
+    if (!vars)
+    {
+        state->failed = true;
+        return;
+    }
+
+    vars[live->count++] = var;
+    live->vars = vars;
+}
+
+static void live_set_remove(prjm_eval_live_set_t* live, const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < live->count; index++)
+    {
+        if (live->vars[index] == var)
+        {
+            live->vars[index] = live->vars[--live->count];
+            return;
+        }
+    }
+}
+
+/**
+ * Adds all variables of the source set to the destination set.
+ * @return true if the destination set changed.
+ */
+static bool live_set_merge(prjm_eval_dse_state_t* state, prjm_eval_live_set_t* live, const prjm_eval_live_set_t* source)
+{
+    int count = live->count;
+    for (int index = 0; index < source->count; index++)
+    {
+        live_set_add(state, live, source->vars[index]);
+    }
+
+    return live->count != count;
+}
+
+static prjm_eval_live_set_t live_set_copy(prjm_eval_dse_state_t* state, const prjm_eval_live_set_t* live)
+{
+    prjm_eval_live_set_t copy = { NULL, 0 };
+    live_set_merge(state, &copy, live);
+
+    return copy;
+}
+
+static void live_set_add_tree(prjm_eval_dse_state_t* state, prjm_eval_live_set_t* live, const prjm_eval_exptreenode_t* expr)
+{
+    if (expr->func == prjm_eval_func_var)
+    {
+        live_set_add(state, live, expr->var);
+        return;
+    }
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            live_set_add_tree(state, live, *arg);
+        }
+    }
+}
+
+static bool is_global_variable(prjm_eval_dse_state_t* state, const PRJM_EVAL_F* var)
+{
+    PRJM_EVAL_F (* global_variables)[100] = state->cctx->global_variables;
+
+    return global_variables && var >= *global_variables && var < *global_variables + 100;
+}
+
+static void eliminate_stores(prjm_eval_dse_state_t* state,
+                             prjm_eval_exptreenode_t** slot,
+                             prjm_eval_live_set_t* live,
+                             bool discarded,
+                             bool modify);
+
+/**
+ * Computes the variables live before a repeated argument, i.e. a loop body. The argument is analyzed until its own live
+ * variables don't change anymore, as they are also live after the previous iteration.
+ * @param live The variables live after the last iteration. Receives the variables live before the first one, including
+ *             the variables live after the last iteration.
+ */
+static void eliminate_stores_in_loop(prjm_eval_dse_state_t* state,
+                                     prjm_eval_exptreenode_t** slot,
+                                     prjm_eval_live_set_t* live,
+                                     bool discarded,
+                                     bool modify)
+{
+    bool changed = true;
+    while (changed && !state->failed)
+    {
+        prjm_eval_live_set_t iteration = live_set_copy(state, live);
+        eliminate_stores(state, slot, &iteration, discarded, false);
+        changed = live_set_merge(state, live, &iteration);
+        free(iteration.vars);
+    }
+
+    if (modify)
+    {
+        prjm_eval_live_set_t iteration = live_set_copy(state, live);
+        eliminate_stores(state, slot, &iteration, discarded, true);
+        free(iteration.vars);
+    }
+}
+
+static void eliminate_stores_in_assignment(prjm_eval_dse_state_t* state,
+                                           prjm_eval_exptreenode_t** slot,
+                                           prjm_eval_live_set_t* live,
+                                           bool discarded,
+                                           bool modify)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_exptreenode_t* target = expr->args[0];
+
+    /* Memory and other targets are kept, all their variables are considered read. */
+    if (target->func != prjm_eval_func_var)
+    {
+        eliminate_stores(state, &expr->args[1], live, false, modify);
+        live_set_add_tree(state, live, target);
+        return;
+    }
+
+    bool is_live = state->failed || live_set_contains(live, target->var) || is_global_variable(state, target->var);
+    if (!is_live && discarded)
+    {
+        /* Neither the variable nor the value is used, only the side effects of the value are kept. */
+        if (modify)
+        {
+            *slot = expr->args[1];
+            expr->args[1] = NULL;
+            prjm_eval_destroy_exptreenode(expr);
+            state->removed_count++;
+        }
+        else
+        {
+            slot = &expr->args[1];
+        }
+
+        eliminate_stores(state, slot, live, true, modify);
+        return;
+    }
+
+    if (expr->func == prjm_eval_func_set)
+    {
+        live_set_remove(live, target->var);
+    }
+    else
+    {
+        live_set_add(state, live, target->var);
+    }
+
+    eliminate_stores(state, &expr->args[1], live, false, modify);
+}
+
+/**
+ * Processes an instruction list, exec2 or exec3. Only the last value is used, earlier ones are removed if they have no
+ * side effects.
+ */
+static void eliminate_stores_in_sequence(prjm_eval_dse_state_t* state,
+                                         prjm_eval_exptreenode_t** slot,
+                                         prjm_eval_live_set_t* live,
+                                         bool discarded,
+                                         bool modify)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+
+    int count = 0;
+    while (expr->args[count])
+    {
+        count++;
+    }
+
+    bool is_indirect_store = prjm_eval_exptreenode_is_indirect_store(expr);
+    for (int index = count - 1; index >= 0; index--)
+    {
+        bool is_last = index == count - 1;
+        /* exec3 stores into the location the first argument returns, so its assignments must stay in place. */
+        bool is_used = is_last ? !discarded : is_indirect_store && index < 2;
+        eliminate_stores(state, &expr->args[index], live, !is_used, modify);
+
+        if (is_last || !modify || state->failed || prjm_eval_exptreenode_has_side_effects(expr->args[index]))
+        {
+            continue;
+        }
+
+        /* Both arguments are needed to store the second one into the first one. */
+        if (index < 2 && is_indirect_store)
+        {
+            continue;
+        }
+
+        if (expr->func == prjm_eval_func_execute_list)
+        {
+            prjm_eval_destroy_exptreenode(expr->args[index]);
+            memmove(&expr->args[index], &expr->args[index + 1], (count - index) * sizeof(prjm_eval_exptreenode_t*));
+            count--;
+        }
+        else if (expr->args[index]->func != prjm_eval_func_const)
+        {
+            /* exec2 and exec3 have a fixed argument count. */
+            prjm_eval_exptreenode_t* constant = calloc(1, sizeof(prjm_eval_exptreenode_t));
+            if (constant)
+            {
+                constant->func = prjm_eval_func_const;
+                prjm_eval_destroy_exptreenode(expr->args[index]);
+                expr->args[index] = constant;
+            }
+        }
+    }
+}
+
+/**
+ * Removes assignments to variables which aren't read afterwards, walking the tree backwards.
+ * @param slot The argument slot of the node to process. The node may be replaced.
+ * @param live The variables read after the node. Receives the variables read before it.
+ * @param discarded If true, the value of the node isn't used.
+ * @param modify If false, only the live variables are computed.
+ */
+static void eliminate_stores(prjm_eval_dse_state_t* state,
+                             prjm_eval_exptreenode_t** slot,
+                             prjm_eval_live_set_t* live,
+                             bool discarded,
+                             bool modify)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_expr_func_t* func = expr->func;
+
+    /* Unused values without side effects don't need any variable. */
+    if (discarded && !prjm_eval_exptreenode_has_side_effects(expr))
+    {
+        return;
+    }
+
+    if (func == prjm_eval_func_var)
+    {
+        live_set_add(state, live, expr->var);
+        return;
+    }
+
+    if (!expr->args)
+    {
+        return;
+    }
+
+    if (prjm_eval_exptreenode_is_assignment(expr))
+    {
+        eliminate_stores_in_assignment(state, slot, live, discarded, modify);
+    }
+    else if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        eliminate_stores_in_sequence(state, slot, live, discarded, modify);
+    }
+    else if (func == prjm_eval_func_if)
+    {
+        prjm_eval_live_set_t else_live = live_set_copy(state, live);
+        eliminate_stores(state, &expr->args[1], live, discarded, modify);
+        eliminate_stores(state, &expr->args[2], &else_live, discarded, modify);
+        live_set_merge(state, live, &else_live);
+        free(else_live.vars);
+
+        eliminate_stores(state, &expr->args[0], live, false, modify);
+    }
+    else if (func == prjm_eval_func_boolean_and_op || func == prjm_eval_func_boolean_or_op)
+    {
+        prjm_eval_live_set_t right_live = live_set_copy(state, live);
+        eliminate_stores(state, &expr->args[1], &right_live, discarded, modify);
+        live_set_merge(state, live, &right_live);
+        free(right_live.vars);
+
+        eliminate_stores(state, &expr->args[0], live, false, modify);
+    }
+    else if (func == prjm_eval_func_execute_loop)
+    {
+        /* The body may not be executed at all, the variables live after the loop stay live. */
+        eliminate_stores_in_loop(state, &expr->args[1], live, discarded, modify);
+        eliminate_stores(state, &expr->args[0], live, false, modify);
+    }
+    else if (func == prjm_eval_func_execute_while)
+    {
+        eliminate_stores_in_loop(state, &expr->args[0], live, false, modify);
+    }
+    else
+    {
+        int count = 0;
+        while (expr->args[count])
+        {
+            count++;
+        }
+
+        /* References returned by earlier arguments are read after the later arguments were evaluated. */
+        for (int index = 0; index < count - 1; index++)
+        {
+            if (!prjm_eval_exptreenode_returns_value(expr->args[index]))
+            {
+                live_set_add_tree(state, live, expr->args[index]);
+            }
+        }
+
+        for (int index = count - 1; index >= 0; index--)
+        {
+            eliminate_stores(state, &expr->args[index], live, false, modify);
+        }
+    }
+}
+
+int prjm_eval_compiler_eliminate_dead_stores(prjm_eval_compiler_context_t* cctx,
+                                             prjm_eval_exptreenode_t** expr,
+                                             PRJM_EVAL_F* const* output_variables,
+                                             int output_variable_count)
+{
+    prjm_eval_dse_state_t state = { cctx, 0, false };
+
+    prjm_eval_live_set_t live = { NULL, 0 };
+    for (int index = 0; index < output_variable_count; index++)
+    {
+        live_set_add(&state, &live, output_variables[index]);
+    }
+
+    /* The program is executed repeatedly, so variables read before they are assigned are also live at the end. */
+    eliminate_stores_in_loop(&state, expr, &live, false, true);
+
+    free(live.vars);
+
+    return state.removed_count;
+}
+
+/* Algebraic simplification */
+
+static bool is_constant(const prjm_eval_exptreenode_t* expr, PRJM_EVAL_F value)
+{
+    return expr->func == prjm_eval_func_const && expr->value == value;
+}
+
+static bool is_same_variable(const prjm_eval_exptreenode_t* expr1, const prjm_eval_exptreenode_t* expr2)
+{
+    return expr1->func == prjm_eval_func_var && expr2->func == prjm_eval_func_var && expr1->var == expr2->var;
+}
+
+/**
+ * Checks if a parent reads the value of an argument before anything else can change it. If so, the argument may be
+ * replaced by a node returning a reference, e.g. a variable, without changing the result.
+ */
+static bool reads_argument_immediately(const prjm_eval_exptreenode_t* expr, int index)
+{
+    if (prjm_eval_exptreenode_is_assignment(expr))
+    {
+        return index == 1;
+    }
+
+    if (!prjm_eval_exptreenode_returns_value(expr))
+    {
+        return false;
+    }
+
+    for (prjm_eval_exptreenode_t* const* arg = &expr->args[index + 1]; *arg; arg++)
+    {
+        if (prjm_eval_exptreenode_has_side_effects(*arg))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Removes an argument from the list of a node and returns it.
+ */
+static prjm_eval_exptreenode_t* detach_argument(prjm_eval_exptreenode_t* expr, int index)
+{
+    prjm_eval_exptreenode_t* arg = expr->args[index];
+    for (int next = index; expr->args[next]; next++)
+    {
+        expr->args[next] = expr->args[next + 1];
+    }
+
+    return arg;
+}
+
+/**
+ * Replaces the node in the slot with one of its arguments.
+ */
+static void replace_with_argument(prjm_eval_exptreenode_t** slot, int index)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_exptreenode_t* arg = detach_argument(expr, index);
+    prjm_eval_destroy_exptreenode(expr);
+    *slot = arg;
+}
+
+/**
+ * Replaces an argument of a unary function node with its own first argument, e.g. abs(-x) becomes abs(x).
+ */
+static void unwrap_argument(prjm_eval_exptreenode_t* expr, int index)
+{
+    prjm_eval_exptreenode_t* arg = expr->args[index];
+    expr->args[index] = detach_argument(arg, 0);
+    prjm_eval_destroy_exptreenode(arg);
+}
+
+static prjm_eval_exptreenode_t* create_unary_node(prjm_eval_expr_func_t* func, prjm_eval_exptreenode_t* arg)
+{
+    prjm_eval_exptreenode_t* expr = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    prjm_eval_exptreenode_t** args = calloc(2, sizeof(prjm_eval_exptreenode_t*));
+    if (!expr || !args)
+    {
+        free(expr);
+        free(args);
+        return NULL;
+    }
+
+    args[0] = arg;
+    expr->func = func;
+    expr->args = args;
+
+    return expr;
+}
+
+/**
+ * pow(x, c) and x ^= c with small integer exponents.
+ */
+static bool simplify_power(prjm_eval_exptreenode_t** slot, bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_exptreenode_t* base = expr->args[0];
+    prjm_eval_exptreenode_t* exponent = expr->args[1];
+
+    if (exponent->func != prjm_eval_func_const)
+    {
+        return false;
+    }
+
+    if (expr->func == prjm_eval_func_pow_op)
+    {
+        /* x ^= 2 -> x *= x */
+        if (base->func != prjm_eval_func_var || exponent->value != 2.0)
+        {
+            return false;
+        }
+
+        expr->func = prjm_eval_func_mul_op;
+        exponent->func = prjm_eval_func_var;
+        exponent->var = base->var;
+        exponent->value = .0;
+        return true;
+    }
+
+    if (exponent->value == 2.0)
+    {
+        /* pow(x, 2) -> sqr(x) */
+        prjm_eval_destroy_exptreenode(detach_argument(expr, 1));
+        expr->func = prjm_eval_func_sqr;
+        return true;
+    }
+
+    if (exponent->value == 1.0 && (allow_reference || prjm_eval_exptreenode_returns_value(base)))
+    {
+        /* pow(x, 1) -> x */
+        replace_with_argument(slot, 0);
+        return true;
+    }
+
+    if (exponent->value == 0.0 && base->func == prjm_eval_func_var)
+    {
+        /* pow(x, 0) -> 1 */
+        detach_argument(expr, 1);
+        prjm_eval_destroy_exptreenode(expr);
+        exponent->value = 1.0;
+        *slot = exponent;
+        return true;
+    }
+
+    if (exponent->value == -1.0)
+    {
+        /* pow(x, -1) -> 1 / x, both return 0 for the same small values of x. */
+        exponent->value = 1.0;
+        expr->args[0] = exponent;
+        expr->args[1] = base;
+        expr->func = prjm_eval_func_div;
+        return true;
+    }
+
+    if (exponent->value == 3.0 && base->func == prjm_eval_func_var)
+    {
+        /* pow(x, 3) -> sqr(x) * x */
+        prjm_eval_exptreenode_t* square = create_unary_node(prjm_eval_func_sqr, base);
+        if (!square)
+        {
+            return false;
+        }
+
+        expr->args[0] = square;
+        exponent->func = prjm_eval_func_var;
+        exponent->var = base->var;
+        exponent->value = .0;
+        expr->func = prjm_eval_func_mul;
+        return true;
+    }
+
+    if (exponent->value == 4.0)
+    {
+        /* pow(x, 4) -> sqr(sqr(x)) */
+        prjm_eval_exptreenode_t* square = create_unary_node(prjm_eval_func_sqr, base);
+        if (!square)
+        {
+            return false;
+        }
+
+        expr->args[0] = square;
+        prjm_eval_destroy_exptreenode(detach_argument(expr, 1));
+        expr->func = prjm_eval_func_sqr;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * x / c -> x * (1 / c) and x /= c -> x *= (1 / c) if the division by c never returns 0 because of its zero check.
+ */
+static bool simplify_division(prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_exptreenode_t* divisor = expr->args[1];
+    if (divisor->func != prjm_eval_func_const || fabs(divisor->value) < close_factor_low)
+    {
+        return false;
+    }
+
+    PRJM_EVAL_F reciprocal = (PRJM_EVAL_F) 1.0 / divisor->value;
+    if (!isnormal(reciprocal))
+    {
+        return false;
+    }
+
+    divisor->value = reciprocal;
+    expr->func = expr->func == prjm_eval_func_div ? prjm_eval_func_mul : prjm_eval_func_mul_op;
+    return true;
+}
+
+static bool simplify_multiplication(prjm_eval_exptreenode_t** slot, bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_exptreenode_t* factor1 = expr->args[0];
+    prjm_eval_exptreenode_t* factor2 = expr->args[1];
+
+    for (int index = 0; index < 2; index++)
+    {
+        prjm_eval_exptreenode_t* other = expr->args[1 - index];
+
+        if (is_constant(expr->args[index], 1.0) && (allow_reference || prjm_eval_exptreenode_returns_value(other)))
+        {
+            /* x * 1 -> x */
+            replace_with_argument(slot, 1 - index);
+            return true;
+        }
+
+        if (is_constant(expr->args[index], -1.0))
+        {
+            /* x * -1 -> -x */
+            prjm_eval_destroy_exptreenode(detach_argument(expr, index));
+            expr->func = prjm_eval_func_neg;
+            return true;
+        }
+    }
+
+    if (factor1->func == prjm_eval_func_sqrt && factor2->func == prjm_eval_func_sqrt &&
+        is_same_variable(factor1->args[0], factor2->args[0]))
+    {
+        /* sqrt(x) * sqrt(x) -> abs(x) */
+        prjm_eval_destroy_exptreenode(detach_argument(expr, 1));
+        unwrap_argument(expr, 0);
+        expr->func = prjm_eval_func_abs;
+        return true;
+    }
+
+    return false;
+}
+
+static bool simplify_addition(prjm_eval_exptreenode_t** slot, bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+
+    if (is_constant(expr->args[1], 0.0) &&
+        (allow_reference || prjm_eval_exptreenode_returns_value(expr->args[0])))
+    {
+        /* x + 0 -> x, x - 0 -> x */
+        replace_with_argument(slot, 0);
+        return true;
+    }
+
+    if (is_constant(expr->args[0], 0.0))
+    {
+        if (expr->func == prjm_eval_func_sub)
+        {
+            /* 0 - x -> -x */
+            prjm_eval_destroy_exptreenode(detach_argument(expr, 0));
+            expr->func = prjm_eval_func_neg;
+            return true;
+        }
+
+        if (allow_reference || prjm_eval_exptreenode_returns_value(expr->args[1]))
+        {
+            /* 0 + x -> x */
+            replace_with_argument(slot, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Negation, abs(), sqr() and sqrt() of other sign-related functions.
+ */
+static bool simplify_unary(prjm_eval_exptreenode_t** slot, bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_exptreenode_t* arg = expr->args[0];
+
+    if (expr->func == prjm_eval_func_neg)
+    {
+        if (arg->func == prjm_eval_func_neg &&
+            (allow_reference || prjm_eval_exptreenode_returns_value(arg->args[0])))
+        {
+            /* --x -> x */
+            prjm_eval_exptreenode_t* inner = detach_argument(arg, 0);
+            prjm_eval_destroy_exptreenode(expr);
+            *slot = inner;
+            return true;
+        }
+
+        return false;
+    }
+
+    if (expr->func == prjm_eval_func_abs && arg->func == prjm_eval_func_sqr)
+    {
+        /* abs(sqr(x)) -> sqr(x) */
+        replace_with_argument(slot, 0);
+        return true;
+    }
+
+    if (expr->func == prjm_eval_func_sqr && arg->func == prjm_eval_func_sqrt)
+    {
+        /* sqr(sqrt(x)) -> abs(x) */
+        unwrap_argument(expr, 0);
+        expr->func = prjm_eval_func_abs;
+        return true;
+    }
+
+    /* The sign of the argument doesn't matter: abs(-x), abs(abs(x)), sqr(-x), sqr(abs(x)), sqrt(-x), sqrt(abs(x)) */
+    if (arg->func == prjm_eval_func_neg || arg->func == prjm_eval_func_abs)
+    {
+        unwrap_argument(expr, 0);
+        return true;
+    }
+
+    return false;
+}
+
+static bool simplify_node(prjm_eval_exptreenode_t** slot, bool allow_reference)
+{
+    prjm_eval_expr_func_t* func = (*slot)->func;
+
+    if (func == prjm_eval_func_pow || func == prjm_eval_func_pow_op)
+    {
+        return simplify_power(slot, allow_reference);
+    }
+    if (func == prjm_eval_func_div || func == prjm_eval_func_div_op)
+    {
+        return simplify_division(*slot);
+    }
+    if (func == prjm_eval_func_mul)
+    {
+        return simplify_multiplication(slot, allow_reference);
+    }
+    if (func == prjm_eval_func_add || func == prjm_eval_func_sub)
+    {
+        return simplify_addition(slot, allow_reference);
+    }
+    if (func == prjm_eval_func_neg || func == prjm_eval_func_abs || func == prjm_eval_func_sqr ||
+        func == prjm_eval_func_sqrt)
+    {
+        return simplify_unary(slot, allow_reference);
+    }
+
+    return false;
+}
+
+/**
+ * Simplifies a subtree bottom-up.
+ * @param allow_reference If false, the node must not be replaced by a node returning a reference.
+ * @return The number of applied rewrite rules.
+ */
+static int simplify_tree(prjm_eval_exptreenode_t** slot, bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    int rewrite_count = 0;
+
+    if (expr->args)
+    {
+        for (int index = 0; expr->args[index]; index++)
+        {
+            rewrite_count += simplify_tree(&expr->args[index], reads_argument_immediately(expr, index));
+        }
+    }
+
+    if (!simplify_node(slot, allow_reference))
+    {
+        return rewrite_count;
+    }
+
+    /* The rewritten node may allow further rewrites, also in its new arguments. */
+    return rewrite_count + 1 + simplify_tree(slot, allow_reference);
+}
+
+int prjm_eval_compiler_simplify_expressions(prjm_eval_exptreenode_t** expr)
+{
+    return simplify_tree(expr, false);
+}
+
+/* Branch pruning */
+
+typedef struct prjm_eval_prune_state
+{
+    prjm_eval_compiler_context_t* cctx;
+    int pruned_count;
+} prjm_eval_prune_state_t;
+
+static bool replace_with_constant(prjm_eval_exptreenode_t** slot, PRJM_EVAL_F value)
+{
+    prjm_eval_exptreenode_t* constant = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    if (!constant)
+    {
+        return false;
+    }
+
+    constant->func = prjm_eval_func_const;
+    constant->value = value;
+
+    prjm_eval_destroy_exptreenode(*slot);
+    *slot = constant;
+
+    return true;
+}
+
+/**
+ * Turns a && or || node with one constant argument into "value != 0", which && and || return for the other argument.
+ * @param value_index The index of the argument which is kept.
+ */
+static void convert_to_truth_value(prjm_eval_exptreenode_t* expr, int value_index)
+{
+    prjm_eval_exptreenode_t* value = expr->args[value_index];
+    prjm_eval_exptreenode_t* zero = expr->args[1 - value_index];
+
+    zero->value = .0;
+    expr->args[0] = value;
+    expr->args[1] = zero;
+    expr->func = prjm_eval_func_notequal;
+}
+
+/**
+ * Removes arguments without side effects from exec2, exec3 and instruction lists, except for the last one which is
+ * returned.
+ */
+static bool prune_sequence(prjm_eval_exptreenode_t** slot, bool receives_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    bool pruned = false;
+
+    /* The first argument is an assignment target here. */
+    if (prjm_eval_exptreenode_is_indirect_store(expr))
+    {
+        return false;
+    }
+
+    int index = 0;
+    while (expr->args[index] && expr->args[index + 1])
+    {
+        if (prjm_eval_exptreenode_has_side_effects(expr->args[index]))
+        {
+            index++;
+            continue;
+        }
+
+        prjm_eval_destroy_exptreenode(detach_argument(expr, index));
+        pruned = true;
+    }
+
+    if (index == 0 && (expr->func != prjm_eval_func_execute_list || !receives_reference))
+    {
+        replace_with_argument(slot, 0);
+        return true;
+    }
+
+    if (expr->func == prjm_eval_func_exec3 && index == 1)
+    {
+        expr->func = prjm_eval_func_exec2;
+    }
+
+    return pruned;
+}
+
+/**
+ * Evaluates a pure node whose arguments became constant by pruning, as the parser does for constant arguments.
+ */
+static bool fold_constant_node(prjm_eval_prune_state_t* state, prjm_eval_exptreenode_t** slot)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    if (!expr->args || !expr->args[0])
+    {
+        return false;
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        if ((*arg)->func != prjm_eval_func_const)
+        {
+            return false;
+        }
+    }
+
+    const prjm_eval_function_def_t* function = find_function(state->cctx, expr->func);
+    if (!function || !function->is_const_eval || function->is_state_changing)
+    {
+        return false;
+    }
+
+    PRJM_EVAL_F value = .0;
+    PRJM_EVAL_F* value_ptr = &value;
+    expr->func(expr, &value_ptr);
+
+    return replace_with_constant(slot, *value_ptr);
+}
+
+static bool prune_node(prjm_eval_prune_state_t* state, prjm_eval_exptreenode_t** slot, bool receives_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+
+    if (expr->func == prjm_eval_func_if && expr->args[0]->func == prjm_eval_func_const)
+    {
+        /* if(1, a, b) -> a, if(0, a, b) -> b */
+        replace_with_argument(slot, expr->args[0]->value != 0 ? 1 : 2);
+        return true;
+    }
+
+    if (expr->func == prjm_eval_func_execute_loop && expr->args[0]->func == prjm_eval_func_const &&
+        !receives_reference)
+    {
+        /* The count is truncated, so loop(0.5, body) also doesn't execute the body, and loop(1.5, body) once. */
+        PRJM_EVAL_F count = expr->args[0]->value;
+        if (count < 1.0)
+        {
+            /* Without iterations, the loop returns the count it has read. */
+            replace_with_argument(slot, 0);
+            return true;
+        }
+        if (count < 2.0)
+        {
+            replace_with_argument(slot, 1);
+            return true;
+        }
+        return false;
+    }
+
+    if (expr->func == prjm_eval_func_execute_while && expr->args[0]->func == prjm_eval_func_const &&
+        !receives_reference)
+    {
+        /* A constant body only changes how often the loop runs, but never the result. */
+        replace_with_argument(slot, 0);
+        return true;
+    }
+
+    if (expr->func == prjm_eval_func_boolean_and_op)
+    {
+        if (expr->args[0]->func == prjm_eval_func_const)
+        {
+            /* 0 && x -> 0, 1 && x -> x != 0 */
+            if (fabs(expr->args[0]->value) > close_factor_low)
+            {
+                convert_to_truth_value(expr, 1);
+                return true;
+            }
+            return replace_with_constant(slot, .0);
+        }
+        if (expr->args[1]->func == prjm_eval_func_const)
+        {
+            /* x && 1 -> x != 0, x && 0 -> 0 if x has no side effects */
+            if (fabs(expr->args[1]->value) > close_factor_low)
+            {
+                convert_to_truth_value(expr, 0);
+                return true;
+            }
+            if (!prjm_eval_exptreenode_has_side_effects(expr->args[0]))
+            {
+                return replace_with_constant(slot, .0);
+            }
+        }
+        return false;
+    }
+
+    if (expr->func == prjm_eval_func_boolean_or_op)
+    {
+        if (expr->args[0]->func == prjm_eval_func_const)
+        {
+            /* 1 || x -> 1, 0 || x -> x != 0 */
+            if (fabs(expr->args[0]->value) < close_factor_low)
+            {
+                convert_to_truth_value(expr, 1);
+                return true;
+            }
+            return replace_with_constant(slot, 1.0);
+        }
+        if (expr->args[1]->func == prjm_eval_func_const &&
+            fabs(expr->args[1]->value) > close_factor_low &&
+            !prjm_eval_exptreenode_has_side_effects(expr->args[0]))
+        {
+            /* x || 1 -> 1 if x has no side effects */
+            return replace_with_constant(slot, 1.0);
+        }
+        return false;
+    }
+
+    if (expr->func == prjm_eval_func_exec2 ||
+        expr->func == prjm_eval_func_exec3 ||
+        expr->func == prjm_eval_func_execute_list)
+    {
+        return prune_sequence(slot, receives_reference);
+    }
+
+    return fold_constant_node(state, slot);
+}
+
+/**
+ * Checks if the tree function passes its own result location on to the argument.
+ */
+static bool passes_result_location(const prjm_eval_exptreenode_t* expr, int index)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    if (func == prjm_eval_func_if)
+    {
+        return index > 0;
+    }
+    if (func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        return !expr->args[index + 1];
+    }
+
+    return index == 0 && (func == prjm_eval_func_freembuf || prjm_eval_exptreenode_is_assignment(expr));
+}
+
+/**
+ * @param receives_reference True if the result location passed to the node may point to a variable or memory. Lists
+ *                           and loops ignore it, so they aren't replaced by an argument which would write to it.
+ */
+static void prune_tree(prjm_eval_prune_state_t* state, prjm_eval_exptreenode_t** slot, bool receives_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    if (expr->args)
+    {
+        for (int index = 0; expr->args[index]; index++)
+        {
+            prune_tree(state, &expr->args[index],
+                       prjm_eval_exptreenode_receives_reference(expr, index) ||
+                       (receives_reference && passes_result_location(expr, index)));
+        }
+    }
+
+    /* The remaining node may be prunable as well, e.g. a list whose only statement with side effects was removed. */
+    while (prune_node(state, slot, receives_reference))
+    {
+        state->pruned_count++;
+    }
+}
+
+int prjm_eval_compiler_prune_branches(prjm_eval_compiler_context_t* cctx, prjm_eval_exptreenode_t** expr)
+{
+    prjm_eval_prune_state_t state = { cctx, 0 };
+
+    prune_tree(&state, expr, false);
+
+    return state.pruned_count;
+}
+
+/* Loop-invariant code motion */
+
+/* Minimum cost of an invariant expression to be moved out of a loop, see expression_cost(). */
+#define LICM_MIN_COST 1
+
+typedef struct prjm_eval_licm_state
+{
+    prjm_eval_cse_state_t cse; /*!< Without entries, only used for the expression helpers above. */
+    PRJM_EVAL_F** written; /*!< Variables assigned by the loop currently processed. */
+    int written_count;
+    prjm_eval_exptreenode_t** stores; /*!< Assignments of hidden variables to be executed in front of the loop. */
+    int store_count;
+    int temp_count; /*!< Number of hidden variables used by the program so far. */
+    int hoisted_count;
+    bool failed; /*!< If true, the written variables are incomplete and nothing may be moved. */
+} prjm_eval_licm_state_t;
+
+static void add_written_variable(prjm_eval_licm_state_t* state, PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < state->written_count; index++)
+    {
+        if (state->written[index] == var)
+        {
+            return;
+        }
+    }
+
+    PRJM_EVAL_F** written = realloc(state->written, (state->written_count + 1) * sizeof(PRJM_EVAL_F*));
+    if (!written)
+    {
+        state->failed = true;
+        return;
+    }
+
+    written[state->written_count++] = var;
+    state->written = written;
+}
+
+static void add_written_target(prjm_eval_licm_state_t* state, const prjm_eval_exptreenode_t* target)
+{
+    if (target->func == prjm_eval_func_var)
+    {
+        add_written_variable(state, target->var);
+        return;
+    }
+
+    if (!target->args)
+    {
+        return;
+    }
+
+    for (int index = 0; target->args[index]; index++)
+    {
+        if (may_return_argument(target, index))
+        {
+            add_written_target(state, target->args[index]);
+        }
+    }
+}
+
+static void collect_written_variables(prjm_eval_licm_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    if (!expr->args)
+    {
+        return;
+    }
+
+    if (prjm_eval_exptreenode_is_assignment(expr) || prjm_eval_exptreenode_is_indirect_store(expr))
+    {
+        add_written_target(state, expr->args[0]);
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        collect_written_variables(state, *arg);
+    }
+}
+
+static bool is_loop_invariant(prjm_eval_licm_state_t* state, const prjm_eval_exptreenode_t* expr)
+{
+    for (int index = 0; index < state->written_count; index++)
+    {
+        if (reads_variable(&state->cse, expr, state->written[index]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Replaces an invariant expression with a read of a hidden variable, which is assigned in front of the loop.
+ */
+static void hoist_expression(prjm_eval_licm_state_t* state, prjm_eval_exptreenode_t** slot)
+{
+    PRJM_EVAL_F* temp = NULL;
+    for (int index = 0; index < state->store_count && !temp; index++)
+    {
+        if (is_same_expression(&state->cse, state->stores[index]->args[1], *slot))
+        {
+            temp = state->stores[index]->args[0]->var;
+        }
+    }
+
+    if (temp)
+    {
+        prjm_eval_exptreenode_t* read = create_variable_node(temp);
+        if (!read)
+        {
+            return;
+        }
+
+        prjm_eval_destroy_exptreenode(*slot);
+        *slot = read;
+        state->hoisted_count++;
+        return;
+    }
+
+    /* Like the CSE variables, the names can't be used in code and are assigned before they are read. */
+    char name[16];
+    snprintf(name, sizeof(name), "$licm%d", state->temp_count);
+
+    temp = prjm_eval_register_variable(state->cse.cctx, name);
+
+    /* The stores become the argument list of the instruction list replacing the loop, which is appended later. */
+    prjm_eval_exptreenode_t** stores = realloc(state->stores, (state->store_count + 3) * sizeof(prjm_eval_exptreenode_t*));
+    if (!stores)
+    {
+        return;
+    }
+    state->stores = stores;
+
+    prjm_eval_exptreenode_t* store = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    prjm_eval_exptreenode_t** args = calloc(3, sizeof(prjm_eval_exptreenode_t*));
+    prjm_eval_exptreenode_t* target = temp ? create_variable_node(temp) : NULL;
+    prjm_eval_exptreenode_t* read = temp ? create_variable_node(temp) : NULL;
+    if (!store || !args || !target || !read)
+    {
+        free(store);
+        free(args);
+        free(target);
+        free(read);
+        return;
+    }
+
+    args[0] = target;
+    args[1] = *slot;
+    store->func = prjm_eval_func_set;
+    store->args = args;
+
+    stores[state->store_count++] = store;
+    *slot = read;
+    state->temp_count++;
+    state->hoisted_count++;
+}
+
+static void hoist_invariants(prjm_eval_licm_state_t* state, prjm_eval_exptreenode_t** slot, bool is_target)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+
+    if (!is_target &&
+        expr->args &&
+        prjm_eval_exptreenode_returns_value(expr) &&
+        is_pure(&state->cse, expr) &&
+        expression_cost(&state->cse, expr) >= LICM_MIN_COST &&
+        is_loop_invariant(state, expr))
+    {
+        hoist_expression(state, slot);
+        return;
+    }
+
+    if (!expr->args)
+    {
+        return;
+    }
+
+    bool is_assignment = prjm_eval_exptreenode_is_assignment(expr);
+    bool is_indirect_store = prjm_eval_exptreenode_is_indirect_store(expr);
+    for (int index = 0; expr->args[index]; index++)
+    {
+        /* Assignment targets must keep their variables, and values stored by exec3 must stay values. */
+        bool arg_is_target = (is_target && may_return_argument(expr, index)) ||
+                             (is_assignment && index == 0) ||
+                             (is_indirect_store && index < 2);
+        hoist_invariants(state, &expr->args[index], arg_is_target);
+    }
+}
+
+static void hoist_in_loops(prjm_eval_licm_state_t* state, prjm_eval_exptreenode_t** slot);
+
+/**
+ * Moves the invariant expressions of a loop body in front of the loop, then processes nested loops. Outer loops are
+ * processed first, so invariants of nested loops are moved as far out as possible.
+ */
+static void hoist_loop(prjm_eval_licm_state_t* state, prjm_eval_exptreenode_t** slot)
+{
+    prjm_eval_exptreenode_t* loop = *slot;
+
+    prjm_eval_exptreenode_t* list = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    if (list)
+    {
+        /* The count of loop() is evaluated before the body, and may assign variables as well. */
+        state->written_count = 0;
+        state->failed = false;
+        collect_written_variables(state, loop);
+
+        /* The body's value is returned by the loop, which may be an assignment target. */
+        state->store_count = 0;
+        if (!state->failed)
+        {
+            hoist_invariants(state, &loop->args[loop->func == prjm_eval_func_execute_loop ? 1 : 0], true);
+        }
+    }
+
+    if (list && state->store_count > 0)
+    {
+        state->stores[state->store_count] = loop;
+        state->stores[state->store_count + 1] = NULL;
+        list->func = prjm_eval_func_execute_list;
+        list->args = state->stores;
+        *slot = list;
+
+        state->stores = NULL;
+        state->store_count = 0;
+    }
+    else
+    {
+        free(list);
+    }
+
+    for (prjm_eval_exptreenode_t** arg = loop->args; *arg; arg++)
+    {
+        hoist_in_loops(state, arg);
+    }
+}
+
+static void hoist_in_loops(prjm_eval_licm_state_t* state, prjm_eval_exptreenode_t** slot)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+
+    if (expr->func == prjm_eval_func_execute_loop || expr->func == prjm_eval_func_execute_while)
+    {
+        hoist_loop(state, slot);
+        return;
+    }
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            hoist_in_loops(state, arg);
+        }
+    }
+}
+
+int prjm_eval_compiler_hoist_loop_invariants(prjm_eval_compiler_context_t* cctx, prjm_eval_exptreenode_t** expr)
+{
+    prjm_eval_licm_state_t state = { { cctx, NULL, 0, 0 }, NULL, 0, NULL, 0, 0, 0, false };
+
+    hoist_in_loops(&state, expr);
+
+    free(state.written);
+    free(state.stores);
+
+    return state.hoisted_count;
+}
+
+/* Loop unrolling */
+
+/* Body copies per iteration of partially unrolled loops, largest first. */
+static const int unroll_factors[] = { 8, 4, 2 };
+
+static int count_nodes(const prjm_eval_exptreenode_t* expr)
+{
+    int count = 1;
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            count += count_nodes(*arg);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Destroys a list created by create_repeated_list(), except for the first node.
+ */
+static void destroy_repeated_list(prjm_eval_exptreenode_t* list)
+{
+    for (prjm_eval_exptreenode_t** arg = list->args + 1; *arg; arg++)
+    {
+        prjm_eval_destroy_exptreenode(*arg);
+    }
+    free(list->args);
+    free(list);
+}
+
+/**
+ * Creates an instruction list executing the first node, followed by the given number of copies of the body. The first
+ * node is moved into the list, nothing is changed if an allocation fails.
+ */
+static prjm_eval_exptreenode_t* create_repeated_list(prjm_eval_exptreenode_t* first,
+                                                     const prjm_eval_exptreenode_t* body,
+                                                     PRJM_EVAL_I copies)
+{
+    prjm_eval_exptreenode_t* list = calloc(1, sizeof(prjm_eval_exptreenode_t));
+    prjm_eval_exptreenode_t** args = calloc(copies + 2, sizeof(prjm_eval_exptreenode_t*));
+    if (!list || !args)
+    {
+        free(list);
+        free(args);
+        return NULL;
+    }
+
+    list->func = prjm_eval_func_execute_list;
+    list->args = args;
+
+    for (PRJM_EVAL_I index = 1; index <= copies; index++)
+    {
+        args[index] = prjm_eval_exptreenode_copy(body);
+        if (!args[index])
+        {
+            destroy_repeated_list(list);
+            return NULL;
+        }
+    }
+
+    args[0] = first;
+
+    return list;
+}
+
+/**
+ * Replaces a loop with a constant count by copies of its body, or by a loop over several body copies followed by the
+ * remaining iterations if the body is too large to be copied for all iterations.
+ */
+static bool unroll_loop(prjm_eval_exptreenode_t** slot, int node_limit)
+{
+    prjm_eval_exptreenode_t* loop = *slot;
+    prjm_eval_exptreenode_t* count_node = loop->args[0];
+    prjm_eval_exptreenode_t* body = loop->args[1];
+
+    /* Loops running zero times return the count value, these are left to branch pruning. */
+    if (count_node->func != prjm_eval_func_const || !(count_node->value >= 1))
+    {
+        return false;
+    }
+
+    /* The count is truncated and clamped here, so the engines never need to limit it. */
+    PRJM_EVAL_I count = count_node->value > MAX_LOOP_COUNT ? MAX_LOOP_COUNT : (PRJM_EVAL_I) count_node->value;
+    count_node->value = (PRJM_EVAL_F) count;
+
+    int body_size = count_nodes(body);
+    if (count <= node_limit / body_size)
+    {
+        prjm_eval_exptreenode_t* list = create_repeated_list(body, body, count - 1);
+        if (!list)
+        {
+            return false;
+        }
+
+        loop->args[1] = NULL;
+        prjm_eval_destroy_exptreenode(loop);
+        *slot = list;
+        return true;
+    }
+
+    for (size_t index = 0; index < sizeof(unroll_factors) / sizeof(unroll_factors[0]); index++)
+    {
+        int factor = unroll_factors[index];
+        PRJM_EVAL_I remainder = count % factor;
+        if (factor + remainder > node_limit / body_size)
+        {
+            continue;
+        }
+
+        prjm_eval_exptreenode_t* repeated_body = create_repeated_list(body, body, factor - 1);
+        if (!repeated_body)
+        {
+            return false;
+        }
+
+        /* The remaining iterations follow the loop. */
+        prjm_eval_exptreenode_t* list = NULL;
+        if (remainder > 0)
+        {
+            list = create_repeated_list(loop, body, remainder);
+            if (!list)
+            {
+                destroy_repeated_list(repeated_body);
+                return false;
+            }
+            *slot = list;
+        }
+
+        loop->args[1] = repeated_body;
+        count_node->value = (PRJM_EVAL_F) (count / factor);
+        return true;
+    }
+
+    return false;
+}
+
+static int unroll_in_tree(prjm_eval_exptreenode_t** slot, int node_limit)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    int unrolled_count = 0;
+
+    /* Nested loops are unrolled first, so their size is known when unrolling the outer loop. */
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            unrolled_count += unroll_in_tree(arg, node_limit);
+        }
+    }
+
+    if (expr->func == prjm_eval_func_execute_loop && unroll_loop(slot, node_limit))
+    {
+        unrolled_count++;
+    }
+
+    return unrolled_count;
+}
+
+int prjm_eval_compiler_unroll_loops(prjm_eval_exptreenode_t** expr, int node_limit)
+{
+    if (node_limit <= 0)
+    {
+        return 0;
+    }
+
+    return unroll_in_tree(expr, node_limit);
+}
+
+/* Value range inference */
+
+/* Maximum number of variables with a known range at the same time, further variables are treated as unknown. */
+#define RANGE_MAX_VARIABLES 32
+
+/* Larger bounds are dropped, so calculating new bounds never overflows. */
+#define RANGE_MAX_BOUND 1e15
+
+/* Relative amount each calculated bound is widened by. Covers the rounding differences between the engines, including
+ * single precision batches. */
+#define RANGE_TOLERANCE 1e-6
+
+/**
+ * @brief Facts known about all values an expression may return. The bounds don't apply to NaN.
+ */
+typedef struct prjm_eval_value_range
+{
+    bool has_min; /*!< If true, no value is below min. */
+    bool has_max; /*!< If true, no value is above max. */
+    PRJM_EVAL_F min;
+    PRJM_EVAL_F max;
+    bool integer; /*!< If true, no value is a finite number with a fractional part. */
+    bool boolean; /*!< If true, each value is exactly +0.0 or 1.0. */
+    bool nonzero; /*!< If true, no absolute value is below close_factor_low. */
+} prjm_eval_value_range_t;
+
+typedef struct prjm_eval_variable_range
+{
+    PRJM_EVAL_F* var;
+    prjm_eval_value_range_t range;
+} prjm_eval_variable_range_t;
+
+/**
+ * @brief The known ranges of variables at the current point of execution.
+ */
+typedef struct prjm_eval_range_table
+{
+    prjm_eval_variable_range_t entries[RANGE_MAX_VARIABLES];
+    int count;
+} prjm_eval_range_table_t;
+
+typedef struct prjm_eval_range_state
+{
+    prjm_eval_intrinsic_function_list intrinsics;
+    uint32_t intrinsic_count;
+    int specialized_count;
+} prjm_eval_range_state_t;
+
+static const prjm_eval_value_range_t unknown_range = { 0 };
+
+static void set_min(prjm_eval_value_range_t* range, PRJM_EVAL_F min, PRJM_EVAL_F magnitude)
+{
+    range->has_min = fabs(min) <= RANGE_MAX_BOUND;
+    range->min = min - magnitude * RANGE_TOLERANCE;
+}
+
+static void set_max(prjm_eval_value_range_t* range, PRJM_EVAL_F max, PRJM_EVAL_F magnitude)
+{
+    range->has_max = fabs(max) <= RANGE_MAX_BOUND;
+    range->max = max + magnitude * RANGE_TOLERANCE;
+}
+
+static bool is_unknown(const prjm_eval_value_range_t* range)
+{
+    return !range->has_min && !range->has_max && !range->integer && !range->boolean && !range->nonzero;
+}
+
+/**
+ * Checks if a divisor never hits the zero check of prjm_eval_math_div(). Bounds only count if they are far enough from
+ * zero to stay nonzero in single precision.
+ */
+static bool is_nonzero(const prjm_eval_value_range_t* range)
+{
+    return range->nonzero ||
+           (range->has_min && range->min > close_factor) ||
+           (range->has_max && range->max < -close_factor);
+}
+
+static prjm_eval_value_range_t fixed_range(PRJM_EVAL_F min, PRJM_EVAL_F max)
+{
+    prjm_eval_value_range_t range = unknown_range;
+    set_min(&range, min, 0);
+    set_max(&range, max, 0);
+    return range;
+}
+
+static prjm_eval_value_range_t boolean_range(void)
+{
+    prjm_eval_value_range_t range = fixed_range(0.0, 1.0);
+    range.integer = true;
+    range.boolean = true;
+    return range;
+}
+
+static prjm_eval_value_range_t constant_range(PRJM_EVAL_F value)
+{
+    prjm_eval_value_range_t range = unknown_range;
+    set_min(&range, value, fabs(value));
+    set_max(&range, value, fabs(value));
+    range.integer = value == floor(value);
+    range.boolean = value == 1.0 || (value == 0.0 && !signbit(value));
+    return range;
+}
+
+static prjm_eval_value_range_t union_range(const prjm_eval_value_range_t* range1,
+                                           const prjm_eval_value_range_t* range2)
+{
+    prjm_eval_value_range_t range = unknown_range;
+    range.has_min = range1->has_min && range2->has_min;
+    range.min = range1->min < range2->min ? range1->min : range2->min;
+    range.has_max = range1->has_max && range2->has_max;
+    range.max = range1->max > range2->max ? range1->max : range2->max;
+    range.integer = range1->integer && range2->integer;
+    range.boolean = range1->boolean && range2->boolean;
+    range.nonzero = range1->nonzero && range2->nonzero;
+    return range;
+}
+
+static prjm_eval_value_range_t negated_range(const prjm_eval_value_range_t* arg)
+{
+    prjm_eval_value_range_t range = unknown_range;
+    range.has_min = arg->has_max;
+    range.min = -arg->max;
+    range.has_max = arg->has_min;
+    range.max = -arg->min;
+    range.integer = arg->integer;
+    range.nonzero = arg->nonzero;
+    return range;
+}
+
+static prjm_eval_value_range_t sum_range(const prjm_eval_value_range_t* arg1,
+                                         const prjm_eval_value_range_t* arg2,
+                                         bool subtract)
+{
+    prjm_eval_value_range_t addend = subtract ? negated_range(arg2) : *arg2;
+
+    prjm_eval_value_range_t range = unknown_range;
+    if (arg1->has_min && addend.has_min)
+    {
+        set_min(&range, arg1->min + addend.min, fabs(arg1->min) + fabs(addend.min));
+    }
+    if (arg1->has_max && addend.has_max)
+    {
+        set_max(&range, arg1->max + addend.max, fabs(arg1->max) + fabs(addend.max));
+    }
+    range.integer = arg1->integer && addend.integer;
+    return range;
+}
+
+static prjm_eval_value_range_t product_range(const prjm_eval_value_range_t* arg1,
+                                             const prjm_eval_value_range_t* arg2)
+{
+    prjm_eval_value_range_t range = unknown_range;
+
+    if (arg1->has_min && arg1->has_max && arg2->has_min && arg2->has_max)
+    {
+        PRJM_EVAL_F products[4] = {
+            arg1->min * arg2->min, arg1->min * arg2->max, arg1->max * arg2->min, arg1->max * arg2->max
+        };
+        PRJM_EVAL_F min = products[0];
+        PRJM_EVAL_F max = products[0];
+        for (int index = 1; index < 4; index++)
+        {
+            min = products[index] < min ? products[index] : min;
+            max = products[index] > max ? products[index] : max;
+        }
+        PRJM_EVAL_F magnitude = fabs(min) > fabs(max) ? fabs(min) : fabs(max);
+        set_min(&range, min, magnitude);
+        set_max(&range, max, magnitude);
+    }
+    else if (arg1->has_min && arg1->min >= 0 && arg2->has_min && arg2->min >= 0)
+    {
+        /* Without upper bounds, only products of non-negative factors have a known lower bound. */
+        set_min(&range, arg1->min * arg2->min, arg1->min * arg2->min);
+        if (arg1->has_max && arg2->has_max)
+        {
+            set_max(&range, arg1->max * arg2->max, arg1->max * arg2->max);
+        }
+    }
+
+    range.integer = arg1->integer && arg2->integer;
+    range.boolean = arg1->boolean && arg2->boolean;
+    return range;
+}
+
+static prjm_eval_value_range_t absolute_range(const prjm_eval_value_range_t* arg)
+{
+    prjm_eval_value_range_t range = unknown_range;
+    if (arg->has_min && arg->min > 0)
+    {
+        set_min(&range, arg->min, 0);
+    }
+    else if (arg->has_max && arg->max < 0)
+    {
+        set_min(&range, -arg->max, 0);
+    }
+    else
+    {
+        set_min(&range, 0, 0);
+    }
+    if (arg->has_min && arg->has_max)
+    {
+        set_max(&range, fabs(arg->min) > fabs(arg->max) ? fabs(arg->min) : fabs(arg->max), 0);
+    }
+    range.integer = arg->integer;
+    range.boolean = arg->boolean;
+    range.nonzero = arg->nonzero;
+    return range;
+}
+
+static prjm_eval_value_range_t square_root_range(const prjm_eval_value_range_t* arg)
+{
+    prjm_eval_value_range_t absolute = absolute_range(arg);
+
+    prjm_eval_value_range_t range = unknown_range;
+    set_min(&range, sqrt(absolute.min), sqrt(absolute.min));
+    if (absolute.has_max)
+    {
+        set_max(&range, sqrt(absolute.max), sqrt(absolute.max));
+    }
+    return range;
+}
+
+static prjm_eval_value_range_t rounded_range(const prjm_eval_value_range_t* arg, bool round_up)
+{
+    prjm_eval_value_range_t range = unknown_range;
+    if (arg->has_min)
+    {
+        set_min(&range, round_up ? ceil(arg->min) : floor(arg->min), 0);
+    }
+    if (arg->has_max)
+    {
+        set_max(&range, round_up ? ceil(arg->max) : floor(arg->max), 0);
+    }
+    range.integer = true;
+    return range;
+}
+
+/**
+ * min() and max() return one of their arguments, so the smaller upper bound also limits min() and the larger lower
+ * bound limits max().
+ */
+static prjm_eval_value_range_t select_range(const prjm_eval_value_range_t* arg1,
+                                            const prjm_eval_value_range_t* arg2,
+                                            bool select_max)
+{
+    prjm_eval_value_range_t range = union_range(arg1, arg2);
+    if (!select_max && (arg1->has_max || arg2->has_max))
+    {
+        range.has_max = true;
+        range.max = !arg2->has_max || (arg1->has_max && arg1->max < arg2->max) ? arg1->max : arg2->max;
+    }
+    if (select_max && (arg1->has_min || arg2->has_min))
+    {
+        range.has_min = true;
+        range.min = !arg2->has_min || (arg1->has_min && arg1->min > arg2->min) ? arg1->min : arg2->min;
+    }
+    return range;
+}
+
+/**
+ * Returns the range of an operator or intrinsic function, given the ranges of its first three arguments and the
+ * range of its last argument.
+ */
+static prjm_eval_value_range_t operation_range(prjm_eval_expr_func_t* func,
+                                               const prjm_eval_value_range_t* args,
+                                               const prjm_eval_value_range_t* last_arg)
+{
+    if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        return *last_arg;
+    }
+
+    if (func == prjm_eval_func_equal || func == prjm_eval_func_notequal ||
+        func == prjm_eval_func_below || func == prjm_eval_func_above ||
+        func == prjm_eval_func_beloweq || func == prjm_eval_func_aboveeq ||
+        func == prjm_eval_func_bnot ||
+        func == prjm_eval_func_boolean_and_func || func == prjm_eval_func_boolean_or_func)
+    {
+        return boolean_range();
+    }
+
+    if (func == prjm_eval_func_set)
+    {
+        return args[1];
+    }
+    if (func == prjm_eval_func_add || func == prjm_eval_func_add_op)
+    {
+        return sum_range(&args[0], &args[1], false);
+    }
+    if (func == prjm_eval_func_sub || func == prjm_eval_func_sub_op)
+    {
+        return sum_range(&args[0], &args[1], true);
+    }
+    if (func == prjm_eval_func_mul || func == prjm_eval_func_mul_op)
+    {
+        return product_range(&args[0], &args[1]);
+    }
+    if (func == prjm_eval_func_neg)
+    {
+        return negated_range(&args[0]);
+    }
+    if (func == prjm_eval_func_min || func == prjm_eval_func_max)
+    {
+        return select_range(&args[0], &args[1], func == prjm_eval_func_max);
+    }
+    if (func == prjm_eval_func_abs)
+    {
+        return absolute_range(&args[0]);
+    }
+    if (func == prjm_eval_func_sqr)
+    {
+        prjm_eval_value_range_t absolute = absolute_range(&args[0]);
+        return product_range(&absolute, &absolute);
+    }
+    if (func == prjm_eval_func_sqrt)
+    {
+        return square_root_range(&args[0]);
+    }
+    if (func == prjm_eval_func_floor || func == prjm_eval_func_ceil)
+    {
+        return rounded_range(&args[0], func == prjm_eval_func_ceil);
+    }
+
+    prjm_eval_value_range_t range = unknown_range;
+    if (func == prjm_eval_func_mod || func == prjm_eval_func_mod_op ||
+        func == prjm_eval_func_bitwise_or || func == prjm_eval_func_bitwise_or_op ||
+        func == prjm_eval_func_bitwise_and || func == prjm_eval_func_bitwise_and_op)
+    {
+        range.integer = true;
+    }
+    else if (func == prjm_eval_func_sign)
+    {
+        range = fixed_range(-1.0, 1.0);
+        range.integer = true;
+    }
+    else if (func == prjm_eval_func_sin || func == prjm_eval_func_cos)
+    {
+        range = fixed_range(-1.0, 1.0);
+    }
+    else if (func == prjm_eval_func_asin || func == prjm_eval_func_atan)
+    {
+        range = fixed_range(-1.6, 1.6);
+    }
+    else if (func == prjm_eval_func_acos)
+    {
+        range = fixed_range(0.0, 3.2);
+    }
+    else if (func == prjm_eval_func_atan2)
+    {
+        range = fixed_range(-3.2, 3.2);
+    }
+    else if (func == prjm_eval_func_sigmoid)
+    {
+        range = fixed_range(0.0, 1.0);
+    }
+    else if (func == prjm_eval_func_exp || func == prjm_eval_func_rand)
+    {
+        set_min(&range, 0.0, 0);
+    }
+
+    return range;
+}
+
+static prjm_eval_variable_range_t* find_variable_range(prjm_eval_range_table_t* table, const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < table->count; index++)
+    {
+        if (table->entries[index].var == var)
+        {
+            return &table->entries[index];
+        }
+    }
+
+    return NULL;
+}
+
+static prjm_eval_value_range_t variable_range(prjm_eval_range_table_t* table, const PRJM_EVAL_F* var)
+{
+    prjm_eval_variable_range_t* entry = find_variable_range(table, var);
+    return entry ? entry->range : unknown_range;
+}
+
+static void forget_variable(prjm_eval_range_table_t* table, const PRJM_EVAL_F* var)
+{
+    prjm_eval_variable_range_t* entry = find_variable_range(table, var);
+    if (entry)
+    {
+        *entry = table->entries[--table->count];
+    }
+}
+
+static void set_variable_range(prjm_eval_range_table_t* table, PRJM_EVAL_F* var, const prjm_eval_value_range_t* range)
+{
+    if (is_unknown(range))
+    {
+        forget_variable(table, var);
+        return;
+    }
+
+    prjm_eval_variable_range_t* entry = find_variable_range(table, var);
+    if (!entry)
+    {
+        if (table->count == RANGE_MAX_VARIABLES)
+        {
+            return;
+        }
+        entry = &table->entries[table->count++];
+        entry->var = var;
+    }
+
+    entry->range = *range;
+}
+
+/**
+ * Combines the ranges after two alternative code paths. Variables unknown after either path become unknown.
+ */
+static void merge_tables(prjm_eval_range_table_t* table, prjm_eval_range_table_t* other)
+{
+    int index = 0;
+    while (index < table->count)
+    {
+        prjm_eval_variable_range_t* entry = &table->entries[index];
+        prjm_eval_variable_range_t* other_entry = find_variable_range(other, entry->var);
+        if (!other_entry)
+        {
+            *entry = table->entries[--table->count];
+            continue;
+        }
+
+        entry->range = union_range(&entry->range, &other_entry->range);
+        index++;
+    }
+}
+
+/**
+ * Forgets the variables written by an assignment target.
+ */
+static void forget_target(prjm_eval_range_table_t* table, const prjm_eval_exptreenode_t* target)
+{
+    if (target->func == prjm_eval_func_var)
+    {
+        forget_variable(table, target->var);
+        return;
+    }
+
+    if (!target->args)
+    {
+        return;
+    }
+
+    for (int index = 0; target->args[index]; index++)
+    {
+        if (may_return_argument(target, index))
+        {
+            forget_target(table, target->args[index]);
+        }
+    }
+}
+
+/**
+ * Forgets all variables assigned anywhere in the given tree.
+ */
+static void forget_assigned_variables(prjm_eval_range_table_t* table, const prjm_eval_exptreenode_t* expr)
+{
+    if (!expr->args)
+    {
+        return;
+    }
+
+    if (prjm_eval_exptreenode_is_assignment(expr) || prjm_eval_exptreenode_is_indirect_store(expr))
+    {
+        forget_target(table, expr->args[0]);
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        forget_assigned_variables(table, *arg);
+    }
+}
+
+/**
+ * Checks if an assignment target may write to the variable.
+ */
+static bool target_writes_variable(const prjm_eval_exptreenode_t* target, const PRJM_EVAL_F* var)
+{
+    if (target->func == prjm_eval_func_var)
+    {
+        return target->var == var;
+    }
+
+    if (!target->args)
+    {
+        return false;
+    }
+
+    for (int index = 0; target->args[index]; index++)
+    {
+        if (may_return_argument(target, index) && target_writes_variable(target->args[index], var))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Checks if the variable is assigned anywhere in the given tree.
+ */
+static bool assigns_variable(const prjm_eval_exptreenode_t* expr, const PRJM_EVAL_F* var)
+{
+    if (!expr->args)
+    {
+        return false;
+    }
+
+    if ((prjm_eval_exptreenode_is_assignment(expr) || prjm_eval_exptreenode_is_indirect_store(expr)) &&
+        target_writes_variable(expr->args[0], var))
+    {
+        return true;
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        if (assigns_variable(*arg, var))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Narrows the range of a variable compared to a constant, assuming the condition has the given truth value.
+ * Variables assigned anywhere in the whole condition are skipped, as the comparison may have read an older value, e.g.
+ * in "x > 1 && exec2(x = 0, 1)".
+ * @param root The whole condition.
+ */
+static void refine_condition(prjm_eval_range_table_t* table,
+                             const prjm_eval_exptreenode_t* root,
+                             const prjm_eval_exptreenode_t* condition,
+                             bool truth)
+{
+    prjm_eval_expr_func_t* func = condition->func;
+
+    if (func == prjm_eval_func_bnot)
+    {
+        refine_condition(table, root, condition->args[0], !truth);
+        return;
+    }
+
+    if ((func == prjm_eval_func_boolean_and_op && truth) || (func == prjm_eval_func_boolean_or_op && !truth))
+    {
+        refine_condition(table, root, condition->args[0], truth);
+        refine_condition(table, root, condition->args[1], truth);
+        return;
+    }
+
+    bool below = func == prjm_eval_func_below || func == prjm_eval_func_beloweq;
+    bool above = func == prjm_eval_func_above || func == prjm_eval_func_aboveeq;
+    bool not_equal = func == prjm_eval_func_notequal;
+    if (!below && !above && !not_equal && func != prjm_eval_func_equal)
+    {
+        return;
+    }
+
+    const prjm_eval_exptreenode_t* variable = condition->args[0];
+    const prjm_eval_exptreenode_t* constant = condition->args[1];
+    if (variable->func == prjm_eval_func_const)
+    {
+        /* 0 < x is the same as x > 0. */
+        variable = condition->args[1];
+        constant = condition->args[0];
+        bool swapped = below;
+        below = above;
+        above = swapped;
+    }
+    if (variable->func != prjm_eval_func_var || constant->func != prjm_eval_func_const ||
+        fabs(constant->value) > RANGE_MAX_BOUND || assigns_variable(root, variable->var))
+    {
+        return;
+    }
+
+    if (!truth)
+    {
+        /* If x < c is false, x >= c. NaN isn't covered by the ranges. */
+        bool swapped = below;
+        below = above;
+        above = swapped;
+        not_equal = !not_equal;
+    }
+
+    PRJM_EVAL_F value = constant->value;
+    prjm_eval_value_range_t range = variable_range(table, variable->var);
+    if (not_equal && value == 0.0)
+    {
+        range.nonzero = true;
+    }
+    else if (below && (!range.has_max || value < range.max))
+    {
+        set_max(&range, value, fabs(value));
+    }
+    else if (above && (!range.has_min || value > range.min))
+    {
+        set_min(&range, value, fabs(value));
+    }
+    set_variable_range(table, variable->var, &range);
+}
+
+static bool is_intrinsic_function(prjm_eval_range_state_t* state, prjm_eval_expr_func_t* func)
+{
+    for (uint32_t index = 0; index < state->intrinsic_count; index++)
+    {
+        if (state->intrinsics[index].func == func)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool has_later_side_effects(const prjm_eval_exptreenode_t* expr, int index)
+{
+    for (prjm_eval_exptreenode_t* const* arg = &expr->args[index + 1]; *arg; arg++)
+    {
+        if (prjm_eval_exptreenode_has_side_effects(*arg))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static prjm_eval_exptreenode_t* create_binary_node(prjm_eval_expr_func_t* func,
+                                                   prjm_eval_exptreenode_t* arg1,
+                                                   prjm_eval_exptreenode_t* arg2)
+{
+    prjm_eval_exptreenode_t* expr = create_unary_node(func, arg1);
+    if (!expr)
+    {
+        return NULL;
+    }
+
+    prjm_eval_exptreenode_t** args = realloc(expr->args, 3 * sizeof(prjm_eval_exptreenode_t*));
+    if (!args)
+    {
+        free(expr->args);
+        free(expr);
+        return NULL;
+    }
+
+    args[1] = arg2;
+    args[2] = NULL;
+    expr->args = args;
+
+    return expr;
+}
+
+/**
+ * Replaces an operation with a cheaper function or its argument if the argument ranges allow it.
+ */
+static void specialize_operation(prjm_eval_range_state_t* state,
+                                 prjm_eval_exptreenode_t** slot,
+                                 const prjm_eval_value_range_t* args,
+                                 bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_expr_func_t* func = expr->func;
+
+    if (func == prjm_eval_func_div && is_nonzero(&args[1]))
+    {
+        expr->func = prjm_eval_func_div_nonzero;
+        state->specialized_count++;
+        return;
+    }
+
+    if (func == prjm_eval_func_div_op && expr->args[0]->func == prjm_eval_func_var && is_nonzero(&args[1]))
+    {
+        /* x /= y -> x = div_nonzero(x, y), which also reads x after evaluating y. */
+        prjm_eval_exptreenode_t* target = create_variable_node(expr->args[0]->var);
+        prjm_eval_exptreenode_t* division = target ? create_binary_node(prjm_eval_func_div_nonzero,
+                                                                        target,
+                                                                        expr->args[1])
+                                                   : NULL;
+        if (!division)
+        {
+            free(target);
+            return;
+        }
+
+        expr->args[1] = division;
+        expr->func = prjm_eval_func_set;
+        state->specialized_count++;
+        return;
+    }
+
+    /* Both arguments are 0 or 1, which the product and maximum return unchanged. */
+    if (func == prjm_eval_func_boolean_and_func && args[0].boolean && args[1].boolean)
+    {
+        expr->func = prjm_eval_func_mul;
+        state->specialized_count++;
+        return;
+    }
+    if (func == prjm_eval_func_boolean_or_func && args[0].boolean && args[1].boolean)
+    {
+        expr->func = prjm_eval_func_max;
+        state->specialized_count++;
+        return;
+    }
+
+    /* Integers are already rounded. */
+    if ((func == prjm_eval_func_floor || func == prjm_eval_func_ceil) && args[0].integer &&
+        (allow_reference || prjm_eval_exptreenode_returns_value(expr->args[0])))
+    {
+        replace_with_argument(slot, 0);
+        state->specialized_count++;
+    }
+}
+
+static prjm_eval_value_range_t infer_range(prjm_eval_range_state_t* state,
+                                           prjm_eval_range_table_t* table,
+                                           prjm_eval_exptreenode_t** slot,
+                                           bool allow_reference);
+
+static prjm_eval_value_range_t infer_if_range(prjm_eval_range_state_t* state,
+                                              prjm_eval_range_table_t* table,
+                                              prjm_eval_exptreenode_t* expr)
+{
+    infer_range(state, table, &expr->args[0], false);
+
+    prjm_eval_range_table_t else_table = *table;
+    refine_condition(table, expr->args[0], expr->args[0], true);
+    refine_condition(&else_table, expr->args[0], expr->args[0], false);
+
+    prjm_eval_value_range_t then_range = infer_range(state, table, &expr->args[1], false);
+    prjm_eval_value_range_t else_range = infer_range(state, &else_table, &expr->args[2], false);
+    merge_tables(table, &else_table);
+
+    return union_range(&then_range, &else_range);
+}
+
+static prjm_eval_value_range_t infer_short_circuit_range(prjm_eval_range_state_t* state,
+                                                         prjm_eval_range_table_t* table,
+                                                         prjm_eval_exptreenode_t* expr)
+{
+    infer_range(state, table, &expr->args[0], false);
+
+    /* The second argument is only evaluated if the first one is true for && and false for ||. */
+    prjm_eval_range_table_t second_table = *table;
+    refine_condition(&second_table, expr->args[0], expr->args[0], expr->func == prjm_eval_func_boolean_and_op);
+    infer_range(state, &second_table, &expr->args[1], false);
+    merge_tables(table, &second_table);
+
+    return boolean_range();
+}
+
+/**
+ * Infers the range of an intrinsic operation evaluating each argument once, in order.
+ */
+static prjm_eval_value_range_t infer_operation_range(prjm_eval_range_state_t* state,
+                                                     prjm_eval_range_table_t* table,
+                                                     prjm_eval_exptreenode_t** slot,
+                                                     bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_value_range_t args[3] = { unknown_range, unknown_range, unknown_range };
+    prjm_eval_value_range_t last_arg = unknown_range;
+
+    if (expr->args)
+    {
+        for (int index = 0; expr->args[index]; index++)
+        {
+            last_arg = infer_range(state, table, &expr->args[index], reads_argument_immediately(expr, index));
+            if (index < 3)
+            {
+                args[index] = last_arg;
+            }
+        }
+
+        /* References are only read after all arguments were evaluated, e.g. in "x + (x = 5)". */
+        for (int index = 0; index < 3 && expr->args[index]; index++)
+        {
+            const prjm_eval_exptreenode_t* arg = expr->args[index];
+            if (!prjm_eval_exptreenode_returns_value(arg) && has_later_side_effects(expr, index))
+            {
+                args[index] = arg->func == prjm_eval_func_var ? variable_range(table, arg->var) : unknown_range;
+            }
+        }
+    }
+
+    prjm_eval_value_range_t range = operation_range(expr->func, args, &last_arg);
+
+    if (prjm_eval_exptreenode_is_assignment(expr))
+    {
+        if (expr->args[0]->func == prjm_eval_func_var)
+        {
+            set_variable_range(table, expr->args[0]->var, &range);
+        }
+        else
+        {
+            forget_target(table, expr->args[0]);
+        }
+    }
+    else if (prjm_eval_exptreenode_is_indirect_store(expr))
+    {
+        forget_target(table, expr->args[0]);
+    }
+
+    specialize_operation(state, slot, args, allow_reference);
+
+    return range;
+}
+
+/**
+ * Infers the range of a subtree in evaluation order, updating the variable ranges and specializing operations.
+ * @param allow_reference If false, the node must not be replaced by a node returning a reference.
+ */
+static prjm_eval_value_range_t infer_range(prjm_eval_range_state_t* state,
+                                           prjm_eval_range_table_t* table,
+                                           prjm_eval_exptreenode_t** slot,
+                                           bool allow_reference)
+{
+    prjm_eval_exptreenode_t* expr = *slot;
+    prjm_eval_expr_func_t* func = expr->func;
+
+    if (func == prjm_eval_func_const)
+    {
+        return constant_range(expr->value);
+    }
+
+    if (func == prjm_eval_func_var)
+    {
+        return variable_range(table, expr->var);
+    }
+
+    if (func == prjm_eval_func_if)
+    {
+        return infer_if_range(state, table, expr);
+    }
+
+    if (func == prjm_eval_func_boolean_and_op || func == prjm_eval_func_boolean_or_op)
+    {
+        return infer_short_circuit_range(state, table, expr);
+    }
+
+    /* Loop bodies start with any value the previous iteration assigned. */
+    if (func == prjm_eval_func_execute_loop)
+    {
+        infer_range(state, table, &expr->args[0], false);
+        forget_assigned_variables(table, expr->args[1]);
+        infer_range(state, table, &expr->args[1], false);
+        forget_assigned_variables(table, expr->args[1]);
+        return unknown_range;
+    }
+
+    if (func == prjm_eval_func_execute_while)
+    {
+        forget_assigned_variables(table, expr->args[0]);
+        infer_range(state, table, &expr->args[0], false);
+        return unknown_range;
+    }
+
+    /* External functions may evaluate their arguments any number of times. */
+    if (!is_intrinsic_function(state, func))
+    {
+        forget_assigned_variables(table, expr);
+        for (prjm_eval_exptreenode_t** arg = expr->args; arg && *arg; arg++)
+        {
+            infer_range(state, table, arg, false);
+        }
+        forget_assigned_variables(table, expr);
+        return unknown_range;
+    }
+
+    return infer_operation_range(state, table, slot, allow_reference);
+}
+
+int prjm_eval_compiler_specialize_value_ranges(prjm_eval_exptreenode_t** expr)
+{
+    prjm_eval_range_state_t state = { 0 };
+    prjm_eval_intrinsic_functions(&state.intrinsics, &state.intrinsic_count);
+
+    /* Programs are executed repeatedly and variables may be changed by the host, so nothing is known initially. */
+    prjm_eval_range_table_t table;
+    table.count = 0;
+
+    infer_range(&state, &table, expr, false);
+
+    return state.specialized_count;
+}
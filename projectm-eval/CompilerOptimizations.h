@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CompilerTypes.h"
+
+/**
+ * @brief Removes code which is never executed or has no effect because a condition or loop count is constant.
+ * "if" with a constant condition is replaced by the executed branch, loops with constant counts below two by the count
+ * or their body, "while" with a constant body by the body, and "&&" and "||" with a constant argument by a constant or a
+ * comparison of the other argument. Arguments of exec2, exec3 and instruction lists without side effects are removed,
+ * except for the last one. Nodes whose arguments became constant are evaluated. The results are always identical. Must
+ * be called on the parsed tree, before it is fused or specialized.
+ * @param cctx The compiler context the tree was parsed with.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @return The number of pruned or evaluated nodes.
+ */
+int prjm_eval_compiler_prune_branches(prjm_eval_compiler_context_t* cctx, prjm_eval_exptreenode_t** expr);
+
+/**
+ * @brief Computes identical pure subexpressions only once.
+ * Pure subexpressions only consist of variables, constants and functions which are const-evaluable and not
+ * state-changing according to their prjm_eval_function_def_t. If such an expression is found again before any of the
+ * variables it reads may have been changed, the first occurrence stores its value in a hidden context variable and the
+ * later occurrences read this variable instead. Must be called on the parsed tree, before it is fused or specialized.
+ * @param cctx The compiler context the tree was parsed with. Hidden variables are registered in this context.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @return The number of replaced subexpression occurrences.
+ */
+int prjm_eval_compiler_eliminate_common_subexpressions(prjm_eval_compiler_context_t* cctx,
+                                                       prjm_eval_exptreenode_t** expr);
+
+/**
+ * @brief Moves pure computations which don't depend on the iteration out of loop() and while() bodies.
+ * An expression is invariant if it is pure, as defined for the common subexpression elimination, and reads none of the
+ * variables assigned anywhere in the loop, including the count of loop(). Each invariant expression is assigned to a
+ * hidden context variable in front of the loop, and the body reads this variable instead. Outer loops are processed
+ * first, so expressions are moved out of as many nested loops as possible. Must be called on the parsed tree, before
+ * it is fused or specialized.
+ * @param cctx The compiler context the tree was parsed with. Hidden variables are registered in this context.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @return The number of moved expression occurrences.
+ */
+int prjm_eval_compiler_hoist_loop_invariants(prjm_eval_compiler_context_t* cctx, prjm_eval_exptreenode_t** expr);
+
+/**
+ * @brief Replaces loop() calls with constant counts by copies of their body.
+ * Loops are unrolled completely if the copies of the body have no more than node_limit nodes in total. Otherwise, the
+ * loop executes a list of 8, 4 or 2 body copies per iteration, followed by the remaining iterations, if these fit into
+ * the limit. Constant counts are truncated and clamped to the maximum loop count. Loops with counts below one are left
+ * unchanged. The results are always identical. Must be called on the parsed tree, before it is fused or specialized.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @param node_limit The maximum number of nodes of the copied loop bodies. 0 disables unrolling.
+ * @return The number of unrolled loops.
+ */
+int prjm_eval_compiler_unroll_loops(prjm_eval_exptreenode_t** expr, int node_limit);
+
+/**
+ * @brief Removes assignments to variables which are neither read by the program afterwards nor declared as output.
+ * Values are kept if they are used or have side effects, e.g. "x = (megabuf(0) = 1)" becomes "megabuf(0) = 1" if x is
+ * dead. Memory and reg00 to reg99 are always live. As the program is executed repeatedly, variables it reads before
+ * assigning them stay live after the last assignment. Must be called on the parsed tree, before it is fused or
+ * specialized.
+ * @param cctx The compiler context the tree was parsed with.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @param output_variables The variables read by the host or other programs after the program was executed.
+ * @param output_variable_count Number of entries in output_variables.
+ * @return The number of removed assignments.
+ */
+int prjm_eval_compiler_eliminate_dead_stores(prjm_eval_compiler_context_t* cctx,
+                                             prjm_eval_exptreenode_t** expr,
+                                             PRJM_EVAL_F* const* output_variables,
+                                             int output_variable_count);
+
+/**
+ * @brief Rewrites costly operations into cheaper equivalents, e.g. pow(x, 2) into sqr(x) or x / 4 into x * 0.25.
+ * Some rules change the result by rounding differences, see the rule list in docs/Compiler-Internals.md. Nodes are only
+ * replaced by variables or other nodes returning a reference if the parent reads the value immediately. Must be called
+ * on the parsed tree, before it is fused or specialized.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @return The number of applied rewrite rules.
+ */
+int prjm_eval_compiler_simplify_expressions(prjm_eval_exptreenode_t** expr);
+
+/**
+ * @brief Replaces operations by cheaper variants if the inferred ranges of their arguments allow it.
+ * Ranges are inferred in evaluation order from constants, operators with known result ranges and conditions of "if",
+ * "&&" and "||" comparing a variable to a constant. Divisions by values which can't be zero skip the zero check, floor()
+ * and ceil() of integers are removed, and "&" and "|" of booleans become a product and a maximum. The results are
+ * always identical. Must be called on the parsed tree, before it is fused or specialized.
+ * @param expr Pointer to the root node of the tree. The root node may be replaced.
+ * @return The number of specialized operations.
+ */
+int prjm_eval_compiler_specialize_value_ranges(prjm_eval_exptreenode_t** expr);
@@ -5,12 +5,21 @@
 #include <stdbool.h>
 
 struct prjm_eval_exptreenode;
+struct prjm_eval_bytecode;
+struct prjm_eval_register_code;
+struct prjm_eval_jit_code;
+struct prjm_eval_batch_code;
 
 /**
  * @brief Node function for a single expression.
  */
 typedef void (prjm_eval_expr_func_t)(struct prjm_eval_exptreenode* ctx, PRJM_EVAL_F** ret_val);
 
+/**
+ * @brief Node function returning the value of an expression directly, used where no reference is required.
+ */
+typedef PRJM_EVAL_F (prjm_eval_value_func_t)(struct prjm_eval_exptreenode* ctx);
+
 /**
  * @brief Structure containing information about an available function implementation.
  * This struct is used to fill the intrinsic function table and is used to add additional,
@@ -44,8 +53,18 @@ typedef struct prjm_eval_variable_def
 {
     char* name; /*!< The lower-case name of the variable in the expression syntax. */
     PRJM_EVAL_F value; /*!< The internal value of the variable. */
+    bool frozen; /*!< If true, programs are specialized for the current value of the variable. */
 } prjm_eval_variable_def_t;
 
+/**
+ * @brief A frozen variable and the value a program was specialized with.
+ */
+typedef struct prjm_eval_frozen_value
+{
+    PRJM_EVAL_F* var; /*!< The frozen variable. */
+    PRJM_EVAL_F value; /*!< The value the variable is replaced with. */
+} prjm_eval_frozen_value_t;
+
 typedef struct prjm_eval_variable_entry
 {
     prjm_eval_variable_def_t* variable;
@@ -57,14 +76,6 @@ typedef struct
     prjm_eval_variable_entry_t* first;
 } prjm_eval_variable_list_t;
 
-struct prjm_eval_exptreenode;
-
-typedef struct prjm_eval_exptreenode_list_item
-{
-    struct prjm_eval_exptreenode* expr;
-    struct prjm_eval_exptreenode_list_item* next;
-} prjm_eval_exptreenode_list_item_t;
-
 /**
  * @brief A single function, variable or constant in the expression tree.
  * The assigned function will determine how to access the other members.
@@ -72,14 +83,14 @@ typedef struct prjm_eval_exptreenode_list_item
 typedef struct prjm_eval_exptreenode
 {
     prjm_eval_expr_func_t* func;
+    prjm_eval_value_func_t* value_func; /*!< Value-returning variant of func, assigned after compilation. */
     PRJM_EVAL_F value; /*!< A constant, numerical value. Also used as temp value. */
     union
     {
         PRJM_EVAL_F* var; /*!< Variable reference. */
         projectm_eval_mem_buffer memory_buffer; /*!< megabuf/gmegabuf memory block. */
     };
-    struct prjm_eval_exptreenode** args; /*!< Function arguments. Last element must be a NULL pointer*/
-    prjm_eval_exptreenode_list_item_t* list;  /*!< Next argument in the instruction list. */
+    struct prjm_eval_exptreenode** args; /*!< Function arguments or instruction list. Last element must be a NULL pointer*/
 } prjm_eval_exptreenode_t;
 
 
@@ -121,6 +132,20 @@ typedef struct
     int column_end;
 } prjm_eval_compiler_error_t;
 
+/**
+ * @brief The tree passes applied to a program, copied from the context when the program is compiled.
+ */
+typedef struct
+{
+    bool fuse_superinstructions; /*!< If true, common statement patterns are fused into single nodes. */
+    bool prune_branches; /*!< If true, code skipped due to constant conditions or loop counts is removed. */
+    bool eliminate_common_subexpressions; /*!< If true, repeated pure subexpressions are only computed once. */
+    bool simplify_expressions; /*!< If true, costly operations are rewritten into cheaper equivalents. */
+    bool hoist_loop_invariants; /*!< If true, computations not depending on the iteration are moved out of loops. */
+    bool specialize_value_ranges; /*!< If true, operations are specialized for the inferred ranges of their arguments. */
+    int unroll_limit; /*!< Maximum number of nodes of loop bodies copied by unrolling constant loops. */
+} prjm_eval_pass_options_t;
+
 typedef struct projectm_eval_context
 {
     prjm_eval_function_list_t functions; /*!< Functions available to this context. Initialized with the intrinsics table. */
@@ -130,10 +155,54 @@ typedef struct projectm_eval_context
     projectm_eval_mem_buffer global_memory; /*!< The global memory buffer, referred to as gmegabuf. */
     prjm_eval_compiler_error_t error; /*!< Holds information about the last compile error. */
     prjm_eval_exptreenode_t* compile_result; /*!< The result of the last compilation. Used temporarily during compilation. */
+    bool fuse_superinstructions; /*!< If true, common statement patterns are fused into single nodes after parsing. */
+    bool prune_branches; /*!< If true, code skipped due to constant conditions or loop counts is removed. */
+    bool eliminate_common_subexpressions; /*!< If true, repeated pure subexpressions are only computed once. */
+    bool simplify_expressions; /*!< If true, costly operations are rewritten into cheaper equivalents. */
+    bool hoist_loop_invariants; /*!< If true, computations not depending on the iteration are moved out of loops. */
+    bool vectorize_loops; /*!< If true, independent loop iterations of new programs are executed in batches. */
+    bool specialize_value_ranges; /*!< If true, operations are specialized for the inferred ranges of their arguments. */
+    int unroll_limit; /*!< Maximum number of nodes of loop bodies copied by unrolling constant loops. 0 disables it. */
+    int tiering_threshold; /*!< Executions after which new programs are moved to a faster engine. 0 disables tiering. */
+    int frozen_generation; /*!< Incremented each time a variable is frozen or unfrozen. */
+    const prjm_eval_frozen_value_t* frozen_values; /*!< Variables replaced by constants during compilation. */
+    int frozen_value_count; /*!< Number of entries in frozen_values. */
+    PRJM_EVAL_F** output_variables; /*!< Variables read after new programs are executed, NULL if all variables are. */
+    int output_variable_count; /*!< Number of entries in output_variables. */
 } prjm_eval_compiler_context_t;
 
 typedef struct
 {
     prjm_eval_exptreenode_t* program;
     prjm_eval_compiler_context_t* cctx;
+    projectm_eval_engine engine; /*!< The engine used to execute the program. */
+    struct prjm_eval_bytecode* bytecode; /*!< Bytecode translation of the program, created on demand. */
+    struct prjm_eval_register_code* register_code; /*!< Register code translation of the program, created on demand. */
+    struct prjm_eval_jit_code* jit_code; /*!< Native machine code of the program, created on demand. */
+    struct prjm_eval_batch_code* batch_code; /*!< Lane-parallel register code, created on first batch execution. */
+    projectm_eval_precision batch_precision; /*!< The arithmetic precision used for batch execution. */
+    bool vectorize_loops; /*!< If true, the register code executes independent loop iterations in batches. */
+    const projectm_eval_native_program* native; /*!< Precompiled program, if created from generated C code. */
+    PRJM_EVAL_F** native_variables; /*!< Variable pointers passed to the precompiled program. */
+    PRJM_EVAL_F* native_batch_values; /*!< Values of the native variables when a batch started. */
+    int execution_count; /*!< Number of executions while the program waits for promotion. */
+    int tiering_threshold; /*!< Executions after which the program is promoted, 0 if it won't be promoted anymore. */
+    PRJM_EVAL_F** uniform_variables; /*!< Variables marked as uniform for batch execution. */
+    int uniform_variable_count; /*!< Number of entries in uniform_variables. */
+    char* source; /*!< The program code, kept to specialize the program for frozen variables. */
+    PRJM_EVAL_F** freeze_candidates; /*!< Variables the program reads but never assigns. */
+    int freeze_candidate_count; /*!< Number of entries in freeze_candidates. */
+    prjm_eval_frozen_value_t* frozen_values; /*!< The frozen variables the current tree was specialized for. */
+    int frozen_value_count; /*!< Number of entries in frozen_values. */
+    int frozen_generation; /*!< The context's frozen_generation when the program was last specialized. */
+    int eliminated_subexpression_count; /*!< Number of subexpressions replaced by a previously computed value. */
+    PRJM_EVAL_F** output_variables; /*!< The context's output variables when the program was compiled. */
+    int output_variable_count; /*!< Number of entries in output_variables. */
+    prjm_eval_pass_options_t pass_options; /*!< The context's pass options when the program was compiled. */
+    int removed_store_count; /*!< Number of assignments removed because the variable isn't read afterwards. */
+    int simplified_expression_count; /*!< Number of applied algebraic simplification rules. */
+    int pruned_branch_count; /*!< Number of nodes removed or evaluated because of constant conditions. */
+    int hoisted_expression_count; /*!< Number of expressions moved out of loops. */
+    int unrolled_loop_count; /*!< Number of loops with constant counts which were unrolled. */
+    int specialized_operation_count; /*!< Number of operations specialized for the ranges of their arguments. */
 } prjm_eval_program_t;
@@ -0,0 +1,234 @@
+#include "CpuDispatch.h"
+
+#include "VectorMath.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PRJM_EVAL_CPU_X86_64
+#define PRJM_EVAL_CPU_BASELINE PROJECTM_EVAL_CPU_SSE2
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define PRJM_EVAL_CPU_BASELINE PROJECTM_EVAL_CPU_GENERIC
+#endif
+
+#define PRJM_EVAL_CPU_KERNEL_TABLE(table_level, variant)              \
+    {                                                                 \
+        table_level,                                                  \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_sin, variant),               \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_cos, variant),               \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_exp, variant),               \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_log, variant),               \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_sqrt, variant),              \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_invsqrt, variant),           \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_pow, variant),               \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_atan2, variant),             \
+        PRJM_EVAL_CPU_KERNEL_NAME(vector_fill, variant),              \
+        PRJM_EVAL_CPU_KERNEL_NAME(batch_execute_lanes, variant),      \
+        PRJM_EVAL_CPU_KERNEL_NAME(batch_execute_float_lanes, variant) \
+    }
+
+/**
+ * All built variants, ordered by level. On x86-64, the generic build uses the baseline instruction set, SSE2.
+ */
+static const prjm_eval_cpu_kernels_t kernel_variants[] = {
+    PRJM_EVAL_CPU_KERNEL_TABLE(PRJM_EVAL_CPU_BASELINE, generic),
+#ifdef PRJM_EVAL_CPU_DISPATCH_AVX2
+    PRJM_EVAL_CPU_KERNEL_TABLE(PROJECTM_EVAL_CPU_AVX2, avx2),
+#endif
+#ifdef PRJM_EVAL_CPU_DISPATCH_AVX512
+    PRJM_EVAL_CPU_KERNEL_TABLE(PROJECTM_EVAL_CPU_AVX512, avx512),
+#endif
+};
+
+#undef PRJM_EVAL_CPU_KERNEL_TABLE
+
+static const prjm_eval_cpu_kernels_t* active_kernels = NULL;
+static projectm_eval_cpu_level active_level = PROJECTM_EVAL_CPU_GENERIC;
+
+#ifdef PRJM_EVAL_CPU_X86_64
+
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER)
+    int values[4];
+    __cpuidex(values, (int) leaf, (int) subleaf);
+    memcpy(registers, values, sizeof(values));
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+/**
+ * Returns the register states saved by the operating system on context switches (XCR0).
+ */
+static uint64_t enabled_register_states()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax;
+    uint32_t edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t) edx << 32) | eax;
+#endif
+}
+
+#endif
+
+projectm_eval_cpu_level prjm_eval_cpu_detect()
+{
+#ifdef PRJM_EVAL_CPU_X86_64
+    uint32_t registers[4];
+
+    cpuid(0, 0, registers);
+    uint32_t max_leaf = registers[0];
+    if (max_leaf < 7)
+    {
+        return PROJECTM_EVAL_CPU_SSE2;
+    }
+
+    /* AVX registers can only be used if the OS saves their state, which is announced via OSXSAVE and XCR0. */
+    cpuid(1, 0, registers);
+    const uint32_t osxsave = 1u << 27;
+    const uint32_t avx = 1u << 28;
+    if ((registers[2] & (osxsave | avx)) != (osxsave | avx))
+    {
+        return PROJECTM_EVAL_CPU_SSE2;
+    }
+
+    uint64_t register_states = enabled_register_states();
+    const uint64_t ymm_states = 0x06; /* SSE and AVX */
+    const uint64_t zmm_states = 0xe6; /* SSE, AVX, opmask and both ZMM halves */
+
+    cpuid(7, 0, registers);
+    const uint32_t avx2 = 1u << 5;
+    const uint32_t avx512f = 1u << 16;
+
+    if ((registers[1] & avx2) == 0 || (register_states & ymm_states) != ymm_states)
+    {
+        return PROJECTM_EVAL_CPU_SSE2;
+    }
+    if ((registers[1] & avx512f) == 0 || (register_states & zmm_states) != zmm_states)
+    {
+        return PROJECTM_EVAL_CPU_AVX2;
+    }
+    return PROJECTM_EVAL_CPU_AVX512;
+#else
+    return PROJECTM_EVAL_CPU_GENERIC;
+#endif
+}
+
+int prjm_eval_cpu_select(projectm_eval_cpu_level level)
+{
+    if (level > prjm_eval_cpu_detect())
+    {
+        return 0;
+    }
+
+    /* Use the best variant not above the requested level. There is always at least the generic build. */
+    const prjm_eval_cpu_kernels_t* selected = &kernel_variants[0];
+    for (size_t index = 1; index < sizeof(kernel_variants) / sizeof(kernel_variants[0]); index++)
+    {
+        if (kernel_variants[index].level <= level)
+        {
+            selected = &kernel_variants[index];
+        }
+    }
+
+    /* The baseline variant is also used for lower levels, e.g. PROJECTM_EVAL_CPU_GENERIC on x86-64. */
+    active_kernels = selected;
+    active_level = selected->level < level ? selected->level : level;
+    return 1;
+}
+
+void prjm_eval_cpu_select_default()
+{
+    projectm_eval_cpu_level level = prjm_eval_cpu_detect();
+
+    const char* requested = getenv("PROJECTM_EVAL_CPU");
+    if (requested)
+    {
+        static const char* const level_names[] = {"generic", "sse2", "avx2", "avx512"};
+        for (int index = 0; index < (int) (sizeof(level_names) / sizeof(level_names[0])); index++)
+        {
+            if (strcmp(requested, level_names[index]) == 0 && (projectm_eval_cpu_level) index < level)
+            {
+                level = (projectm_eval_cpu_level) index;
+            }
+        }
+    }
+
+    prjm_eval_cpu_select(level);
+}
+
+const prjm_eval_cpu_kernels_t* prjm_eval_cpu_kernels()
+{
+    if (!active_kernels)
+    {
+        prjm_eval_cpu_select_default();
+    }
+
+    return active_kernels;
+}
+
+projectm_eval_cpu_level prjm_eval_cpu_level()
+{
+    if (!active_kernels)
+    {
+        prjm_eval_cpu_select_default();
+    }
+
+    return active_level;
+}
+
+void prjm_eval_vector_sin(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    prjm_eval_cpu_kernels()->vector_sin(dst, src, count);
+}
+
+void prjm_eval_vector_cos(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    prjm_eval_cpu_kernels()->vector_cos(dst, src, count);
+}
+
+void prjm_eval_vector_exp(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    prjm_eval_cpu_kernels()->vector_exp(dst, src, count);
+}
+
+void prjm_eval_vector_log(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    prjm_eval_cpu_kernels()->vector_log(dst, src, count);
+}
+
+void prjm_eval_vector_sqrt(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    prjm_eval_cpu_kernels()->vector_sqrt(dst, src, count);
+}
+
+void prjm_eval_vector_invsqrt(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    prjm_eval_cpu_kernels()->vector_invsqrt(dst, src, count);
+}
+
+void prjm_eval_vector_pow(PRJM_EVAL_F* dst, const PRJM_EVAL_F* base, const PRJM_EVAL_F* exponent, int count)
+{
+    prjm_eval_cpu_kernels()->vector_pow(dst, base, exponent, count);
+}
+
+void prjm_eval_vector_atan2(PRJM_EVAL_F* dst, const PRJM_EVAL_F* y, const PRJM_EVAL_F* x, int count)
+{
+    prjm_eval_cpu_kernels()->vector_atan2(dst, y, x, count);
+}
+
+void prjm_eval_vector_fill(PRJM_EVAL_F* dst, PRJM_EVAL_F value, int count)
+{
+    prjm_eval_cpu_kernels()->vector_fill(dst, value, count);
+}
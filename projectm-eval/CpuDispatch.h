@@ -0,0 +1,102 @@
+/**
+ * @file CpuDispatch.h
+ * @brief Selects the variant of the hot kernels matching the CPU's instruction set extensions.
+ *
+ * The array kernels (VectorMath.c) and the batch interpreters (BatchExecute.c, BatchExecuteFloat.c) are compiled once
+ * with the build's regular flags. If ENABLE_CPU_DISPATCH is set on x86-64, all sources are compiled again for AVX2 and
+ * AVX-512.
+ * Each build gets its own function name suffix via PRJM_EVAL_CPU_VARIANT, and the functions of each build are
+ * collected in a prjm_eval_cpu_kernels_t table. The best table supported by the CPU is selected once, using cpuid
+ * and the PROJECTM_EVAL_CPU environment variable, and can be changed with projectm_eval_set_cpu_level().
+ */
+#pragma once
+
+#include "BatchCode.h"
+
+#ifndef PRJM_EVAL_CPU_VARIANT
+/**
+ * @brief Name suffix of the kernel variant being compiled. Set by the generated source of each variant.
+ */
+#define PRJM_EVAL_CPU_VARIANT generic
+#endif
+
+#define PRJM_EVAL_CPU_KERNEL_NAME_(name, variant) prjm_eval_ ## name ## _ ## variant
+#define PRJM_EVAL_CPU_KERNEL_NAME(name, variant) PRJM_EVAL_CPU_KERNEL_NAME_(name, variant)
+
+/**
+ * @brief Returns the name of a kernel function in the variant being compiled, e.g. prjm_eval_vector_sin_avx2.
+ */
+#define PRJM_EVAL_CPU_KERNEL(name) PRJM_EVAL_CPU_KERNEL_NAME(name, PRJM_EVAL_CPU_VARIANT)
+
+/**
+ * @brief The kernel functions of one variant.
+ * See VectorMath.h and BatchCode.h for the functions' descriptions.
+ */
+typedef struct prjm_eval_cpu_kernels
+{
+    projectm_eval_cpu_level level; /*!< The instruction set level the variant was compiled for. */
+    void (* vector_sin)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+    void (* vector_cos)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+    void (* vector_exp)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+    void (* vector_log)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+    void (* vector_sqrt)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+    void (* vector_invsqrt)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+    void (* vector_pow)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* base, const PRJM_EVAL_F* exponent, int count);
+    void (* vector_atan2)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* y, const PRJM_EVAL_F* x, int count);
+    void (* vector_fill)(PRJM_EVAL_F* dst, PRJM_EVAL_F value, int count);
+    void (* batch_execute_lanes)(prjm_eval_batch_code_t* code, int lane_count);
+    void (* batch_execute_float_lanes)(prjm_eval_batch_code_t* code, int lane_count);
+} prjm_eval_cpu_kernels_t;
+
+/**
+ * @brief Declares the kernel functions of a variant.
+ */
+#define PRJM_EVAL_CPU_DECLARE_KERNELS(variant) \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_sin, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_cos, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_exp, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_log, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_sqrt, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_invsqrt, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_pow, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* base, \
+                                                        const PRJM_EVAL_F* exponent, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_atan2, variant)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* y, \
+                                                          const PRJM_EVAL_F* x, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(vector_fill, variant)(PRJM_EVAL_F* dst, PRJM_EVAL_F value, int count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(batch_execute_lanes, variant)(prjm_eval_batch_code_t* code, int lane_count); \
+    void PRJM_EVAL_CPU_KERNEL_NAME(batch_execute_float_lanes, variant)(prjm_eval_batch_code_t* code, int lane_count);
+
+PRJM_EVAL_CPU_DECLARE_KERNELS(generic)
+PRJM_EVAL_CPU_DECLARE_KERNELS(avx2)
+PRJM_EVAL_CPU_DECLARE_KERNELS(avx512)
+
+/**
+ * @brief Returns the highest instruction set level supported by the CPU and operating system.
+ * @return The supported level, PROJECTM_EVAL_CPU_GENERIC on CPUs other than x86-64.
+ */
+projectm_eval_cpu_level prjm_eval_cpu_detect();
+
+/**
+ * @brief Selects the best variant for the CPU, limited by the PROJECTM_EVAL_CPU environment variable if set.
+ */
+void prjm_eval_cpu_select_default();
+
+/**
+ * @brief Selects the best built variant up to the given level.
+ * @param level The highest level to use.
+ * @return 1 if the CPU supports the level, 0 if not. The active variant is unchanged in the latter case.
+ */
+int prjm_eval_cpu_select(projectm_eval_cpu_level level);
+
+/**
+ * @brief Returns the active kernel table, selecting the default variant on first use.
+ * @return The kernels of the active variant.
+ */
+const prjm_eval_cpu_kernels_t* prjm_eval_cpu_kernels();
+
+/**
+ * @brief Returns the level selected with the active variant.
+ * This may be below the variant's level, as the baseline variant also serves lower levels.
+ * @return The active instruction set level.
+ */
+projectm_eval_cpu_level prjm_eval_cpu_level();
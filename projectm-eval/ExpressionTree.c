@@ -1,5 +1,9 @@
 #include "ExpressionTree.h"
 
+#include "TreeFunctions.h"
+
+#include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 
 void prjm_eval_destroy_exptreenode(prjm_eval_exptreenode_t* expr)
@@ -22,18 +26,438 @@ void prjm_eval_destroy_exptreenode(prjm_eval_exptreenode_t* expr)
         free(expr->args);
     }
 
-    /* Free execution list */
-    if (expr->list)
+    free(expr);
+}
+
+prjm_eval_exptreenode_t* prjm_eval_exptreenode_copy(const prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_exptreenode_t* copy = malloc(sizeof(prjm_eval_exptreenode_t));
+    if (!copy)
     {
-        prjm_eval_exptreenode_list_item_t* item = expr->list;
-        while(item)
+        return NULL;
+    }
+
+    *copy = *expr;
+    if (!expr->args)
+    {
+        return copy;
+    }
+
+    int arg_count = 0;
+    while (expr->args[arg_count])
+    {
+        arg_count++;
+    }
+
+    copy->args = calloc(arg_count + 1, sizeof(prjm_eval_exptreenode_t*));
+    if (!copy->args)
+    {
+        free(copy);
+        return NULL;
+    }
+
+    for (int arg = 0; arg < arg_count; arg++)
+    {
+        copy->args[arg] = prjm_eval_exptreenode_copy(expr->args[arg]);
+        if (!copy->args[arg])
         {
-            prjm_eval_exptreenode_list_item_t* free_item = item;
-            item = item->next;
-            prjm_eval_destroy_exptreenode(free_item->expr);
-            free(free_item);
+            prjm_eval_destroy_exptreenode(copy);
+            return NULL;
         }
     }
 
-    free(expr);
+    return copy;
+}
+
+static size_t packed_size(const prjm_eval_exptreenode_t* expr)
+{
+    size_t size = sizeof(prjm_eval_exptreenode_t);
+
+    if (expr->args)
+    {
+        prjm_eval_exptreenode_t** arg = expr->args;
+        for (; *arg; arg++)
+        {
+            size += packed_size(*arg);
+        }
+
+        size += (arg - expr->args + 1) * sizeof(prjm_eval_exptreenode_t*);
+    }
+
+    return size;
+}
+
+static prjm_eval_exptreenode_t* pack_node(const prjm_eval_exptreenode_t* expr, char** cursor)
+{
+    prjm_eval_exptreenode_t* packed = (prjm_eval_exptreenode_t*) *cursor;
+    *cursor += sizeof(prjm_eval_exptreenode_t);
+    *packed = *expr;
+
+    if (expr->args)
+    {
+        int arg_count = 0;
+        while (expr->args[arg_count])
+        {
+            arg_count++;
+        }
+
+        packed->args = (prjm_eval_exptreenode_t**) *cursor;
+        *cursor += (arg_count + 1) * sizeof(prjm_eval_exptreenode_t*);
+
+        for (int arg = 0; arg < arg_count; arg++)
+        {
+            packed->args[arg] = pack_node(expr->args[arg], cursor);
+        }
+        packed->args[arg_count] = NULL;
+    }
+
+    return packed;
+}
+
+prjm_eval_exptreenode_t* prjm_eval_exptreenode_pack(prjm_eval_exptreenode_t* expr)
+{
+    size_t size = packed_size(expr);
+
+    char* block = malloc(size);
+    if (!block)
+    {
+        return NULL;
+    }
+
+    char* cursor = block;
+    prjm_eval_exptreenode_t* packed = pack_node(expr, &cursor);
+    assert(cursor == block + size);
+
+    prjm_eval_destroy_exptreenode(expr);
+
+    return packed;
+}
+
+static bool is_assignment_function(prjm_eval_expr_func_t* func)
+{
+    func = prjm_eval_generic_function(func);
+
+    return func == prjm_eval_func_set ||
+           func == prjm_eval_func_add_op ||
+           func == prjm_eval_func_sub_op ||
+           func == prjm_eval_func_mul_op ||
+           func == prjm_eval_func_div_op ||
+           func == prjm_eval_func_mod_op ||
+           func == prjm_eval_func_bitwise_or_op ||
+           func == prjm_eval_func_bitwise_and_op ||
+           func == prjm_eval_func_pow_op;
+}
+
+bool prjm_eval_exptreenode_is_assignment(const prjm_eval_exptreenode_t* expr)
+{
+    return is_assignment_function(expr->func);
+}
+
+static bool is_compare_select_function(prjm_eval_expr_func_t* func)
+{
+#define COMPARE_SELECT_MATCH(name, condition) func == prjm_eval_func_if_ ## name ||
+    return PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(COMPARE_SELECT_MATCH) false;
+#undef COMPARE_SELECT_MATCH
+}
+
+static prjm_eval_operand_kind_t operand_kind(const prjm_eval_exptreenode_t* expr)
+{
+    if (expr->func == prjm_eval_func_var)
+    {
+        return PRJM_EVAL_OPERAND_VAR;
+    }
+
+    if (expr->func == prjm_eval_func_const)
+    {
+        return PRJM_EVAL_OPERAND_CONST;
+    }
+
+    return PRJM_EVAL_OPERAND_EXPR;
+}
+
+void prjm_eval_exptreenode_specialize(prjm_eval_exptreenode_t* expr)
+{
+    if (!expr->args || !expr->args[0])
+    {
+        return;
+    }
+
+    for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+    {
+        prjm_eval_exptreenode_specialize(*arg);
+    }
+
+    prjm_eval_operand_kind_t arg2_kind = expr->args[1] ? operand_kind(expr->args[1]) : PRJM_EVAL_OPERAND_EXPR;
+    prjm_eval_expr_func_t* variant = prjm_eval_specialized_function(expr->func, operand_kind(expr->args[0]), arg2_kind);
+    if (variant)
+    {
+        expr->func = variant;
+    }
+}
+
+/**
+ * Checks if the value-returning variant would read the first argument too early. The reference-returning functions
+ * only dereference their arguments after evaluating all of them, so a later argument may change the referenced value.
+ */
+static bool reads_reference_late(const prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    if (!expr->args || !expr->args[0] || !expr->args[1] ||
+        func == prjm_eval_func_execute_list ||
+        func == prjm_eval_func_execute_loop ||
+        func == prjm_eval_func_if ||
+        func == prjm_eval_func_exec2 ||
+        func == prjm_eval_func_exec3 ||
+        func == prjm_eval_func_boolean_and_op ||
+        func == prjm_eval_func_boolean_or_op ||
+        func == prjm_eval_func_mem_set ||
+        is_assignment_function(func))
+    {
+        return false;
+    }
+
+    return !prjm_eval_exptreenode_returns_value(expr->args[0]) &&
+           prjm_eval_exptreenode_has_side_effects(expr->args[1]);
+}
+
+void prjm_eval_exptreenode_assign_value_functions(prjm_eval_exptreenode_t* expr)
+{
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            prjm_eval_exptreenode_assign_value_functions(*arg);
+        }
+    }
+
+    prjm_eval_value_func_t* value_func = prjm_eval_value_function(expr->func);
+    if (!value_func || reads_reference_late(expr) || prjm_eval_exptreenode_stores_through_reference(expr))
+    {
+        value_func = prjm_eval_value_via_ref;
+    }
+
+    expr->value_func = value_func;
+}
+
+bool prjm_eval_exptreenode_is_indirect_store(const prjm_eval_exptreenode_t* expr)
+{
+    return expr->func == prjm_eval_func_exec3 && !prjm_eval_exptreenode_returns_value(expr->args[0]);
+}
+
+/**
+ * Checks if the node may return a reference to a location it didn't create itself, e.g. a variable or memory.
+ */
+static bool may_return_reference(const prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    if (func == prjm_eval_func_if)
+    {
+        return may_return_reference(expr->args[1]) || may_return_reference(expr->args[2]);
+    }
+    if (is_compare_select_function(func))
+    {
+        return may_return_reference(expr->args[2]) || may_return_reference(expr->args[3]);
+    }
+    if (func == prjm_eval_func_execute_list)
+    {
+        prjm_eval_exptreenode_t* const* arg = expr->args;
+        while (*(arg + 1))
+        {
+            arg++;
+        }
+        return may_return_reference(*arg);
+    }
+    if (func == prjm_eval_func_exec2 || func == prjm_eval_func_execute_loop)
+    {
+        return may_return_reference(expr->args[1]);
+    }
+    if (func == prjm_eval_func_exec3)
+    {
+        return may_return_reference(expr->args[2]);
+    }
+    if (func == prjm_eval_func_execute_while ||
+        func == prjm_eval_func_freembuf ||
+        func == prjm_eval_func_memcpy ||
+        func == prjm_eval_func_memset)
+    {
+        return may_return_reference(expr->args[0]);
+    }
+
+    return !prjm_eval_exptreenode_returns_value(expr);
+}
+
+/**
+ * Checks if the node may write a value into the location its caller passed for the result, instead of only
+ * returning a reference to a different location.
+ */
+static bool may_write_result(const prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    if (func == prjm_eval_func_var ||
+        func == prjm_eval_func_execute_list ||
+        func == prjm_eval_func_execute_loop ||
+        func == prjm_eval_func_execute_while ||
+        func == prjm_eval_func_memcpy ||
+        func == prjm_eval_func_memset)
+    {
+        return false;
+    }
+    if (func == prjm_eval_func_if)
+    {
+        return may_write_result(expr->args[1]) || may_write_result(expr->args[2]);
+    }
+    if (is_compare_select_function(func))
+    {
+        return may_write_result(expr->args[2]) || may_write_result(expr->args[3]);
+    }
+    if (func == prjm_eval_func_exec2)
+    {
+        return may_write_result(expr->args[1]);
+    }
+    if (func == prjm_eval_func_exec3)
+    {
+        return may_write_result(expr->args[2]);
+    }
+    if (func == prjm_eval_func_freembuf || is_assignment_function(func))
+    {
+        /* Assignments receive the result location for their target and only write to it if it isn't replaced. */
+        return may_write_result(expr->args[0]);
+    }
+
+    /* Values, but also memory accesses which store a zero if the index is out of range. */
+    return true;
+}
+
+bool prjm_eval_exptreenode_receives_reference(const prjm_eval_exptreenode_t* expr, int index)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    /* exec3 evaluates its first two arguments into the same location, while loops don't reset it between iterations. */
+    if ((func == prjm_eval_func_exec3 && index == 1) ||
+        (func == prjm_eval_func_execute_while && index == 0))
+    {
+        return may_return_reference(expr->args[0]);
+    }
+
+    return false;
+}
+
+bool prjm_eval_exptreenode_stores_through_reference(const prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    if (func == prjm_eval_func_exec3)
+    {
+        return prjm_eval_exptreenode_receives_reference(expr, 1) && may_write_result(expr->args[1]);
+    }
+
+    if (func == prjm_eval_func_execute_while)
+    {
+        return prjm_eval_exptreenode_receives_reference(expr, 0) && may_write_result(expr->args[0]);
+    }
+
+    return false;
+}
+
+bool prjm_eval_exptreenode_has_side_effects(const prjm_eval_exptreenode_t* expr)
+{
+    if (is_assignment_function(expr->func) ||
+        prjm_eval_exptreenode_is_indirect_store(expr) ||
+        expr->func == prjm_eval_func_mem_set ||
+        expr->func == prjm_eval_func_freembuf ||
+        expr->func == prjm_eval_func_memcpy ||
+        expr->func == prjm_eval_func_memset)
+    {
+        return true;
+    }
+
+    if (expr->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            if (prjm_eval_exptreenode_has_side_effects(*arg))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool prjm_eval_exptreenode_returns_value(const prjm_eval_exptreenode_t* expr)
+{
+    return !(is_assignment_function(expr->func) ||
+             expr->func == prjm_eval_func_var ||
+             expr->func == prjm_eval_func_execute_list ||
+             expr->func == prjm_eval_func_execute_loop ||
+             expr->func == prjm_eval_func_execute_while ||
+             expr->func == prjm_eval_func_if ||
+             is_compare_select_function(expr->func) ||
+             expr->func == prjm_eval_func_exec2 ||
+             expr->func == prjm_eval_func_exec3 ||
+             expr->func == prjm_eval_func_mem ||
+             expr->func == prjm_eval_func_mem_set ||
+             expr->func == prjm_eval_func_freembuf ||
+             expr->func == prjm_eval_func_memcpy ||
+             expr->func == prjm_eval_func_memset);
+}
+
+bool prjm_eval_exptreenode_returns_boolean(const prjm_eval_exptreenode_t* expr)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(expr->func);
+
+    if (func == prjm_eval_func_const)
+    {
+        return expr->value == 1.0 || (expr->value == 0.0 && !signbit(expr->value));
+    }
+
+    if (func == prjm_eval_func_equal ||
+        func == prjm_eval_func_notequal ||
+        func == prjm_eval_func_below ||
+        func == prjm_eval_func_above ||
+        func == prjm_eval_func_beloweq ||
+        func == prjm_eval_func_aboveeq ||
+        func == prjm_eval_func_bnot ||
+        func == prjm_eval_func_boolean_and_op ||
+        func == prjm_eval_func_boolean_or_op ||
+        func == prjm_eval_func_boolean_and_func ||
+        func == prjm_eval_func_boolean_or_func)
+    {
+        return true;
+    }
+
+    if (func == prjm_eval_func_if)
+    {
+        return prjm_eval_exptreenode_returns_boolean(expr->args[1]) &&
+               prjm_eval_exptreenode_returns_boolean(expr->args[2]);
+    }
+
+    if (is_compare_select_function(func))
+    {
+        return prjm_eval_exptreenode_returns_boolean(expr->args[2]) &&
+               prjm_eval_exptreenode_returns_boolean(expr->args[3]);
+    }
+
+    /* Products, minimums and maximums of 0 and 1 are 0 or 1 again. */
+    if (func == prjm_eval_func_mul || func == prjm_eval_func_min || func == prjm_eval_func_max)
+    {
+        return prjm_eval_exptreenode_returns_boolean(expr->args[0]) &&
+               prjm_eval_exptreenode_returns_boolean(expr->args[1]);
+    }
+
+    if (func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3 || func == prjm_eval_func_execute_list)
+    {
+        const prjm_eval_exptreenode_t* last = NULL;
+        for (prjm_eval_exptreenode_t** arg = expr->args; *arg; arg++)
+        {
+            last = *arg;
+        }
+        return last && prjm_eval_exptreenode_returns_boolean(last);
+    }
+
+    return false;
 }
@@ -7,3 +7,98 @@
  * @param expr The node to free.
  */
 void prjm_eval_destroy_exptreenode(prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Recursively copies the given node into individually allocated nodes.
+ * @param expr The root node of the tree to copy. Must not be packed.
+ * @return The root node of the copy or NULL if the memory could not be allocated.
+ */
+prjm_eval_exptreenode_t* prjm_eval_exptreenode_copy(const prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Copies the tree into a single memory block, placing each node in evaluation order followed by its argument
+ * array.
+ * The packed tree must not be changed structurally, as nodes and argument arrays can't be freed individually. It is
+ * freed with a single call to free() on the returned root node.
+ * @param expr The root node of the tree to pack. Destroyed if the tree was packed successfully.
+ * @return The root node of the packed tree or NULL if the memory could not be allocated.
+ */
+prjm_eval_exptreenode_t* prjm_eval_exptreenode_pack(prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Replaces the node functions in the given tree with variants specialized for their argument kinds.
+ * Specialized variants read variable and constant arguments directly instead of calling their node functions.
+ * @param expr The root node of the tree to specialize.
+ */
+void prjm_eval_exptreenode_specialize(prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Assigns the value-returning node function of each node in the given tree.
+ * Nodes without a value-returning variant, or which rely on reading a returned reference after evaluating a later
+ * argument, are evaluated through their reference-returning function.
+ * @param expr The root node of the tree.
+ */
+void prjm_eval_exptreenode_assign_value_functions(prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Checks if the node assigns a value to its first argument, e.g. "x = y" or "x += y".
+ * @param expr The node to check.
+ * @return true if the node is a plain or compound assignment.
+ */
+bool prjm_eval_exptreenode_is_assignment(const prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Checks if the node is an exec3 call which may store its second argument where the first one points to.
+ * exec3 evaluates its first two arguments into the same location. If the first one returns a reference, e.g. to a
+ * variable, a value computed by the second one is written to the referenced variable or memory location.
+ * @param expr The node to check.
+ * @return true if the first argument acts as an assignment target and the second one as the assigned value.
+ */
+bool prjm_eval_exptreenode_is_indirect_store(const prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Checks if the tree function passes a result location to the argument which may point to a variable or memory.
+ * This happens for the second exec3 argument if the first one returns a reference, and for the body of while loops
+ * returning a reference, which receives the reference returned by the previous iteration. Replacing such an argument
+ * with an equivalent value can change which locations are written.
+ * @param expr The node to check.
+ * @param index The argument index.
+ * @return true if the argument may receive a reference to a variable or memory location as result location.
+ */
+bool prjm_eval_exptreenode_receives_reference(const prjm_eval_exptreenode_t* expr, int index);
+
+/**
+ * @brief Checks if the tree function of the node writes a value through a reference returned by one of its arguments.
+ * This happens in exec3 if the first argument returns a reference and the second one a value, or in while loops if
+ * the body returns a reference in one iteration and a value in a later one. Value functions and other engines don't
+ * pass result locations around, so they have to execute such nodes via the tree function.
+ * @param expr The node to check.
+ * @return true if the node needs the reference-passing tree function to produce the correct side effects.
+ */
+bool prjm_eval_exptreenode_stores_through_reference(const prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Checks if the node or any of its sub nodes may change a variable or memory location.
+ * @param expr The node to check.
+ * @return true if executing the node can have side effects, false if not.
+ */
+bool prjm_eval_exptreenode_has_side_effects(const prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Checks if the node function always returns a plain value instead of a reference.
+ * Tree functions dereference their arguments only after all arguments were evaluated. A reference returned by the
+ * first argument may thus point to a value that is changed by a later argument, e.g. in "x + (x = 5)". Other engines
+ * use this function to decide if they need to replicate this behavior.
+ * @param expr The node to check.
+ * @return true if the node never returns a reference to a variable or memory location.
+ */
+bool prjm_eval_exptreenode_returns_value(const prjm_eval_exptreenode_t* expr);
+
+/**
+ * @brief Checks if the node always returns exactly 0 or 1, e.g. a comparison or a boolean operator.
+ * Code generators can skip converting such values into a truth value. Specialized variants and fused nodes are
+ * recognized as well, variables never count as boolean.
+ * @param expr The node to check.
+ * @return true if the node is known to return 0 or 1 only.
+ */
+bool prjm_eval_exptreenode_returns_boolean(const prjm_eval_exptreenode_t* expr);
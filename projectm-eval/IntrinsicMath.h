@@ -0,0 +1,201 @@
+/**
+ * @file IntrinsicMath.h
+ * @brief Scalar implementations of the non-trivial intrinsic operations.
+ *
+ * The expression tree functions and all other execution engines use these helpers, so the results of a program
+ * don't depend on which engine runs it. Only operations with special handling (zero checks, NaN replacement etc.)
+ * are defined here, simple operators like addition are implemented inline by each engine.
+ */
+#pragma once
+
+#include "CompilerTypes.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#if PRJM_F_SIZE == 4
+typedef int32_t PRJM_EVAL_I;
+#else
+typedef int64_t PRJM_EVAL_I;
+#endif
+
+/* Allowed error for float/double comparisons to exact values */
+#define COMPARE_CLOSEFACTOR 0.00001
+static const PRJM_EVAL_F close_factor = COMPARE_CLOSEFACTOR;
+
+/* These factors are not exactly as close to zero as their ns-eel2 equivalents, but that shouldn't
+ * matter too much. In ns-eel2, the value is represented as binary 0x00000000FFFFFFFF for doubles.
+ */
+#if PRJM_F_SIZE == 4
+static const PRJM_EVAL_F close_factor_low = 1e-41;
+#else
+static const PRJM_EVAL_F close_factor_low = 1e-300;
+#endif
+
+/* Maximum number of loop iterations */
+#define MAX_LOOP_COUNT 1048576
+
+/**
+ * @brief Returns the next number from Milkdrop's Mersenne Twister random number generator.
+ * The generator state is shared by all engines, so rand() returns the same sequence regardless of the engine.
+ * @return A pseudo-random 32-bit integer.
+ */
+uint32_t prjm_eval_genrand_int32(void);
+
+/**
+ * @brief Converts a value to a megabuf/gmegabuf index.
+ * Adds 0.0001 to avoid using the wrong index due to tiny float rounding errors.
+ */
+static inline int32_t prjm_eval_math_mem_index(PRJM_EVAL_F value)
+{
+    return (int32_t) (value + 0.0001);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_div(PRJM_EVAL_F dividend, PRJM_EVAL_F divisor)
+{
+    if (fabs(divisor) < close_factor_low)
+    {
+        return 0.0;
+    }
+
+    return dividend / divisor;
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_div_nonzero(PRJM_EVAL_F dividend, PRJM_EVAL_F divisor)
+{
+    return dividend / divisor;
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_mod(PRJM_EVAL_F dividend, PRJM_EVAL_F divisor)
+{
+    PRJM_EVAL_I int_divisor = (PRJM_EVAL_I) divisor;
+    if (int_divisor == 0)
+    {
+        return 0.0;
+    }
+
+    return (PRJM_EVAL_F) ((PRJM_EVAL_I) dividend % int_divisor);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_bitwise_or(PRJM_EVAL_F val1, PRJM_EVAL_F val2)
+{
+    return (PRJM_EVAL_F) ((PRJM_EVAL_I) val1 | (PRJM_EVAL_I) val2);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_bitwise_and(PRJM_EVAL_F val1, PRJM_EVAL_F val2)
+{
+    return (PRJM_EVAL_F) ((PRJM_EVAL_I) val1 & (PRJM_EVAL_I) val2);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_pow(PRJM_EVAL_F base, PRJM_EVAL_F exponent)
+{
+    if (fabs(base) < close_factor_low && exponent < 0)
+    {
+        return .0;
+    }
+
+    PRJM_EVAL_F result = pow(base, exponent);
+
+    return isnan(result) ? .0 : result;
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_asin(PRJM_EVAL_F value)
+{
+    if (value < -1.0 || value > 1.0)
+    {
+        return .0;
+    }
+
+    return asin(value);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_acos(PRJM_EVAL_F value)
+{
+    if (value < -1.0 || value > 1.0)
+    {
+        return .0;
+    }
+
+    return acos(value);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_log(PRJM_EVAL_F value)
+{
+    if (value <= 0.0)
+    {
+        return .0;
+    }
+
+    return log(value);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_log10(PRJM_EVAL_F value)
+{
+    if (value <= 0.0)
+    {
+        return .0;
+    }
+
+    return log10(value);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_sigmoid(PRJM_EVAL_F value, PRJM_EVAL_F constraint)
+{
+    double t = (1 + exp((double) -(value) * (constraint)));
+    return (PRJM_EVAL_F) (fabs(t) > close_factor ? 1.0 / t : .0);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_sign(PRJM_EVAL_F value)
+{
+    if (value == 0)
+    {
+        return .0;
+    }
+
+    return value < .0 ? -1. : 1.;
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_rand(PRJM_EVAL_F max_value)
+{
+    PRJM_EVAL_F rand_max = floor(max_value);
+    if (rand_max < 1.)
+    {
+        rand_max = 1.;
+    }
+
+    return (PRJM_EVAL_F) (prjm_eval_genrand_int32() * (1.0 / (double) 0xFFFFFFFF) * rand_max);
+}
+
+static inline PRJM_EVAL_F prjm_eval_math_invsqrt(PRJM_EVAL_F value)
+{
+    /*
+     * Using fast inverse square root implementation here, same as Milkdrop, except supporting doubles.
+     * See https://en.wikipedia.org/wiki/Fast_inverse_square_root
+     */
+#if PRJM_F_SIZE == 4
+#define INVSQRT_MAGIC_NUMBER 0x5f3759df
+#define INVSQRT_INT uint32_t
+#else
+#define INVSQRT_MAGIC_NUMBER 0x5fe6eb50c7b537a9
+#define INVSQRT_INT uint64_t
+#endif
+
+    union
+    {
+        PRJM_EVAL_F PRJM_F_val;
+        INVSQRT_INT int_val;
+    } type_conv;
+
+    static const PRJM_EVAL_F three_halfs = 1.5;
+    static const PRJM_EVAL_F one_half = .5;
+
+    PRJM_EVAL_F num2 = value * one_half;
+    type_conv.PRJM_F_val = value;
+    type_conv.int_val = INVSQRT_MAGIC_NUMBER - (type_conv.int_val >> 1);
+    type_conv.PRJM_F_val = type_conv.PRJM_F_val * (three_halfs - (num2 * type_conv.PRJM_F_val * type_conv.PRJM_F_val));
+
+#undef INVSQRT_MAGIC_NUMBER
+#undef INVSQRT_INT
+
+    return isnan(type_conv.PRJM_F_val) ? 0 : (type_conv.PRJM_F_val);
+}
@@ -0,0 +1,855 @@
+/**
+ * @file Jit.c
+ * @brief Implements the x86-64 machine code generator.
+ *
+ * The generator translates each register code instruction into a short sequence of SSE2 instructions operating
+ * directly on the register code's slot frame, which is addressed relative to RBX. Instructions without a native
+ * translation, like transcendental functions or memory lookups, call
+ * prjm_eval_register_code_execute_instruction(), so both engines always share the same implementation.
+ *
+ * The generated function has the signature "void func(PRJM_EVAL_F* frame)" and follows the System V ABI.
+ */
+#include "Jit.h"
+
+#include "IntrinsicMath.h"
+#include "RegisterCode.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef void (* prjm_eval_jit_function_t)(PRJM_EVAL_F* frame);
+
+struct prjm_eval_jit_code
+{
+    prjm_eval_register_code_t* register_code; /*!< The translated register code, owns the slot frame. */
+    void* memory; /*!< Executable memory containing the machine code. */
+    size_t memory_size; /*!< Size of the executable memory in bytes. */
+    prjm_eval_jit_function_t entry; /*!< Entry point of the machine code. */
+};
+
+/**
+ * @brief A rel32 jump operand which needs to be patched after all instructions are emitted.
+ */
+typedef struct prjm_eval_jit_fixup
+{
+    size_t position; /*!< Offset of the rel32 operand. */
+    int32_t target; /*!< Register code instruction index of the jump target. */
+} prjm_eval_jit_fixup_t;
+
+typedef struct prjm_eval_jit_builder
+{
+    uint8_t* code;
+    size_t length;
+    size_t capacity;
+    prjm_eval_jit_fixup_t* fixups;
+    int32_t fixup_count;
+    int32_t fixup_capacity;
+    prjm_eval_register_code_t* register_code;
+    bool failed;
+} prjm_eval_jit_builder_t;
+
+/* General purpose registers */
+#define JIT_RAX 0
+#define JIT_RCX 1
+#define JIT_RBX 3
+#define JIT_RSI 6
+#define JIT_RDI 7
+
+/* Condition codes for Jcc */
+#define JIT_CC_E 0x4
+#define JIT_CC_NE 0x5
+#define JIT_CC_BE 0x6
+#define JIT_CC_A 0x7
+#define JIT_CC_P 0xA
+#define JIT_CC_LE 0xE
+#define JIT_CC_ALWAYS -1
+
+/* Predicates for CMPSS/CMPSD */
+#define JIT_CMP_LT 1
+#define JIT_CMP_LE 2
+
+/* Opcodes of the scalar SSE instructions, following the 0x0F escape byte */
+#define JIT_SSE_LOAD 0x10
+#define JIT_SSE_STORE 0x11
+#define JIT_SSE_SQRT 0x51
+#define JIT_SSE_AND 0x54
+#define JIT_SSE_XOR 0x57
+#define JIT_SSE_ADD 0x58
+#define JIT_SSE_MUL 0x59
+#define JIT_SSE_SUB 0x5C
+#define JIT_SSE_MIN 0x5D
+#define JIT_SSE_DIV 0x5E
+#define JIT_SSE_MAX 0x5F
+#define JIT_SSE_CMP 0xC2
+
+#if PRJM_F_SIZE == 4
+#define JIT_SCALAR_PREFIX 0xF3 /* ss instructions */
+#define JIT_SIGN_MASK 0x80000000ull
+#else
+#define JIT_SCALAR_PREFIX 0xF2 /* sd instructions */
+#define JIT_SIGN_MASK 0x8000000000000000ull
+#endif
+
+#define JIT_ABS_MASK (JIT_SIGN_MASK - 1)
+
+/* Byte emission */
+
+static void emit_byte(prjm_eval_jit_builder_t* builder, uint8_t byte)
+{
+    if (builder->length == builder->capacity)
+    {
+        size_t new_capacity = builder->capacity ? builder->capacity * 2 : 1024;
+        uint8_t* new_code = realloc(builder->code, new_capacity);
+        if (!new_code)
+        {
+            builder->failed = true;
+            return;
+        }
+        builder->code = new_code;
+        builder->capacity = new_capacity;
+    }
+
+    builder->code[builder->length++] = byte;
+}
+
+static void emit_int32(prjm_eval_jit_builder_t* builder, int32_t value)
+{
+    uint32_t bits = (uint32_t) value;
+    for (int byte = 0; byte < 4; byte++)
+    {
+        emit_byte(builder, (uint8_t) (bits >> (byte * 8)));
+    }
+}
+
+static void emit_uint64(prjm_eval_jit_builder_t* builder, uint64_t value)
+{
+    for (int byte = 0; byte < 8; byte++)
+    {
+        emit_byte(builder, (uint8_t) (value >> (byte * 8)));
+    }
+}
+
+static uint8_t modrm(int mod, int reg, int rm)
+{
+    return (uint8_t) ((mod << 6) | ((reg & 7) << 3) | (rm & 7));
+}
+
+/**
+ * @brief Emits the ModRM byte and displacement addressing the given frame slot relative to RBX.
+ */
+static void emit_slot_operand(prjm_eval_jit_builder_t* builder, int reg, int32_t slot)
+{
+    emit_byte(builder, modrm(2, reg, JIT_RBX));
+    emit_int32(builder, slot * (int32_t) sizeof(PRJM_EVAL_F));
+}
+
+/* Instruction emission */
+
+/**
+ * @brief Emits "mov reg, imm64".
+ */
+static void emit_mov_imm64(prjm_eval_jit_builder_t* builder, int reg, uint64_t value)
+{
+    emit_byte(builder, 0x48);
+    emit_byte(builder, (uint8_t) (0xB8 + reg));
+    emit_uint64(builder, value);
+}
+
+/**
+ * @brief Emits a scalar SSE instruction with a frame slot operand, e.g. "addsd xmm, [rbx + slot]".
+ */
+static void emit_scalar_slot(prjm_eval_jit_builder_t* builder, uint8_t opcode, int xmm, int32_t slot)
+{
+    emit_byte(builder, JIT_SCALAR_PREFIX);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, opcode);
+    emit_slot_operand(builder, xmm, slot);
+}
+
+/**
+ * @brief Emits a scalar SSE instruction with two registers, e.g. "addsd xmm_dst, xmm_src".
+ */
+static void emit_scalar_reg(prjm_eval_jit_builder_t* builder, uint8_t opcode, int xmm_dst, int xmm_src)
+{
+    emit_byte(builder, JIT_SCALAR_PREFIX);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, opcode);
+    emit_byte(builder, modrm(3, xmm_dst, xmm_src));
+}
+
+/**
+ * @brief Emits a packed bitwise SSE instruction with two registers, e.g. "andps xmm_dst, xmm_src".
+ */
+static void emit_packed_reg(prjm_eval_jit_builder_t* builder, uint8_t opcode, int xmm_dst, int xmm_src)
+{
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, opcode);
+    emit_byte(builder, modrm(3, xmm_dst, xmm_src));
+}
+
+static void emit_load(prjm_eval_jit_builder_t* builder, int xmm, int32_t slot)
+{
+    emit_scalar_slot(builder, JIT_SSE_LOAD, xmm, slot);
+}
+
+static void emit_store(prjm_eval_jit_builder_t* builder, int32_t slot, int xmm)
+{
+    emit_scalar_slot(builder, JIT_SSE_STORE, xmm, slot);
+}
+
+/**
+ * @brief Emits "cmpss/cmpsd xmm_dst, xmm_src, predicate", which sets xmm_dst to an all-ones mask if true.
+ */
+static void emit_compare_reg(prjm_eval_jit_builder_t* builder, int xmm_dst, int xmm_src, uint8_t predicate)
+{
+    emit_scalar_reg(builder, JIT_SSE_CMP, xmm_dst, xmm_src);
+    emit_byte(builder, predicate);
+}
+
+static void emit_compare_slot(prjm_eval_jit_builder_t* builder, int xmm, int32_t slot, uint8_t predicate)
+{
+    emit_scalar_slot(builder, JIT_SSE_CMP, xmm, slot);
+    emit_byte(builder, predicate);
+}
+
+/**
+ * @brief Emits "ucomiss/ucomisd xmm_a, xmm_b". Afterwards, "ja" jumps if a > b.
+ */
+static void emit_unordered_compare(prjm_eval_jit_builder_t* builder, int xmm_a, int xmm_b)
+{
+#if PRJM_F_SIZE != 4
+    emit_byte(builder, 0x66);
+#endif
+    emit_packed_reg(builder, 0x2E, xmm_a, xmm_b);
+}
+
+/**
+ * @brief Loads raw bits into the lower lane of an SSE register. Uses RAX.
+ */
+static void emit_load_bits(prjm_eval_jit_builder_t* builder, int xmm, uint64_t bits)
+{
+    emit_mov_imm64(builder, JIT_RAX, bits);
+    /* movq xmm, rax */
+    emit_byte(builder, 0x66);
+    emit_byte(builder, 0x48);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, 0x6E);
+    emit_byte(builder, modrm(3, xmm, JIT_RAX));
+}
+
+static void emit_load_constant(prjm_eval_jit_builder_t* builder, int xmm, PRJM_EVAL_F value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(PRJM_EVAL_F));
+    emit_load_bits(builder, xmm, bits);
+}
+
+static void emit_zero(prjm_eval_jit_builder_t* builder, int xmm)
+{
+    emit_packed_reg(builder, JIT_SSE_XOR, xmm, xmm);
+}
+
+/**
+ * @brief Clears the sign bit of xmm, using xmm_scratch.
+ */
+static void emit_abs(prjm_eval_jit_builder_t* builder, int xmm, int xmm_scratch)
+{
+    emit_load_bits(builder, xmm_scratch, JIT_ABS_MASK);
+    emit_packed_reg(builder, JIT_SSE_AND, xmm, xmm_scratch);
+}
+
+/**
+ * @brief Turns a comparison mask in xmm_mask into 1.0 or 0.0, using xmm_scratch.
+ */
+static void emit_mask_to_bool(prjm_eval_jit_builder_t* builder, int xmm_mask, int xmm_scratch)
+{
+    emit_load_constant(builder, xmm_scratch, 1.0);
+    emit_packed_reg(builder, JIT_SSE_AND, xmm_mask, xmm_scratch);
+}
+
+/**
+ * @brief Compares the absolute value of a slot against close_factor_low.
+ * Afterwards, "ja" jumps if the value is considered true (greater than close_factor_low) or,
+ * if check_below is true, if the value is considered false (below close_factor_low).
+ */
+static void emit_truth_test(prjm_eval_jit_builder_t* builder, int32_t slot, bool check_below)
+{
+    emit_load(builder, 0, slot);
+    emit_abs(builder, 0, 1);
+    emit_load_constant(builder, 1, close_factor_low);
+    if (check_below)
+    {
+        emit_unordered_compare(builder, 1, 0);
+    }
+    else
+    {
+        emit_unordered_compare(builder, 0, 1);
+    }
+}
+
+/**
+ * @brief Emits a jump to a register code instruction, which is resolved after all instructions were emitted.
+ * @param condition_code The Jcc condition code or JIT_CC_ALWAYS.
+ */
+static void emit_jump(prjm_eval_jit_builder_t* builder, int condition_code, int32_t target)
+{
+    if (condition_code == JIT_CC_ALWAYS)
+    {
+        emit_byte(builder, 0xE9);
+    }
+    else
+    {
+        emit_byte(builder, 0x0F);
+        emit_byte(builder, (uint8_t) (0x80 | condition_code));
+    }
+
+    if (builder->fixup_count == builder->fixup_capacity)
+    {
+        int32_t new_capacity = builder->fixup_capacity ? builder->fixup_capacity * 2 : 64;
+        prjm_eval_jit_fixup_t* new_fixups = realloc(builder->fixups, new_capacity * sizeof(prjm_eval_jit_fixup_t));
+        if (!new_fixups)
+        {
+            builder->failed = true;
+            return;
+        }
+        builder->fixups = new_fixups;
+        builder->fixup_capacity = new_capacity;
+    }
+
+    builder->fixups[builder->fixup_count].position = builder->length;
+    builder->fixups[builder->fixup_count].target = target;
+    builder->fixup_count++;
+
+    emit_int32(builder, 0);
+}
+
+/**
+ * @brief Emits a short forward jump within the code of a single instruction.
+ * @param condition_code The Jcc condition code or JIT_CC_ALWAYS.
+ * @return The position of the rel8 operand, to be passed to patch_short_jump().
+ */
+static size_t emit_short_jump(prjm_eval_jit_builder_t* builder, int condition_code)
+{
+    emit_byte(builder, condition_code == JIT_CC_ALWAYS ? 0xEB : (uint8_t) (0x70 | condition_code));
+    emit_byte(builder, 0);
+    return builder->length - 1;
+}
+
+/**
+ * @brief Lets a short jump continue at the current position.
+ */
+static void patch_short_jump(prjm_eval_jit_builder_t* builder, size_t position)
+{
+    if (builder->failed)
+    {
+        return;
+    }
+
+    size_t distance = builder->length - (position + 1);
+    assert(distance < 128);
+    builder->code[position] = (uint8_t) distance;
+}
+
+/**
+ * @brief Emits a call of the C implementation of the given instruction.
+ */
+static void emit_fallback(prjm_eval_jit_builder_t* builder, const prjm_eval_register_instruction_t* ip)
+{
+    emit_mov_imm64(builder, JIT_RDI, (uint64_t) (uintptr_t) builder->register_code);
+    emit_mov_imm64(builder, JIT_RSI, (uint64_t) (uintptr_t) ip);
+    emit_mov_imm64(builder, JIT_RAX, (uint64_t) (uintptr_t) prjm_eval_register_code_execute_instruction);
+    /* call rax */
+    emit_byte(builder, 0xFF);
+    emit_byte(builder, modrm(3, 2, JIT_RAX));
+}
+
+/**
+ * @brief Loads the address stored in the given reference register into RAX.
+ */
+static void emit_load_reference(prjm_eval_jit_builder_t* builder, int32_t ref)
+{
+    emit_mov_imm64(builder, JIT_RAX, (uint64_t) (uintptr_t) &builder->register_code->refs[ref]);
+    /* mov rax, [rax] */
+    emit_byte(builder, 0x48);
+    emit_byte(builder, 0x8B);
+    emit_byte(builder, modrm(0, JIT_RAX, JIT_RAX));
+}
+
+/**
+ * @brief Emits the ModRM byte and displacement addressing a field of the memory cursor in RAX.
+ */
+static void emit_cursor_operand(prjm_eval_jit_builder_t* builder, int reg, size_t field_offset)
+{
+    emit_byte(builder, modrm(1, reg, JIT_RAX));
+    emit_byte(builder, (uint8_t) field_offset);
+}
+
+/**
+ * @brief Emits a memory access using a cursor.
+ * If the cursor expects the index value, its address is used inline and advanced. Otherwise, the C implementation
+ * looks up the address and sets up the cursor again.
+ */
+static void emit_cursor_access(prjm_eval_jit_builder_t* builder, const prjm_eval_register_instruction_t* ip)
+{
+    prjm_eval_register_cursor_t* cursor = &builder->register_code->cursors[ip->cursor];
+
+    emit_mov_imm64(builder, JIT_RAX, (uint64_t) (uintptr_t) cursor);
+    emit_load(builder, 0, ip->src1);
+
+    /* ucomisd xmm0, [rax + index] */
+#if PRJM_F_SIZE != 4
+    emit_byte(builder, 0x66);
+#endif
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, 0x2E);
+    emit_cursor_operand(builder, 0, offsetof(prjm_eval_register_cursor_t, index));
+    size_t other_index = emit_short_jump(builder, JIT_CC_NE);
+    size_t unordered = emit_short_jump(builder, JIT_CC_P);
+
+    /* cmp dword [rax + remaining], 0 */
+    emit_byte(builder, 0x83);
+    emit_cursor_operand(builder, 7, offsetof(prjm_eval_register_cursor_t, remaining));
+    emit_byte(builder, 0);
+    size_t depleted = emit_short_jump(builder, JIT_CC_LE);
+
+    /* dec dword [rax + remaining] */
+    emit_byte(builder, 0xFF);
+    emit_cursor_operand(builder, 1, offsetof(prjm_eval_register_cursor_t, remaining));
+
+    /* mov rcx, [rax + address] */
+    emit_byte(builder, 0x48);
+    emit_byte(builder, 0x8B);
+    emit_cursor_operand(builder, JIT_RCX, offsetof(prjm_eval_register_cursor_t, address));
+
+    if (ip->opcode == PRJM_EVAL_REG_MEM_LOAD_CURSOR)
+    {
+        /* movsd xmm1, [rcx] */
+        emit_byte(builder, JIT_SCALAR_PREFIX);
+        emit_byte(builder, 0x0F);
+        emit_byte(builder, JIT_SSE_LOAD);
+        emit_byte(builder, modrm(0, 1, JIT_RCX));
+        emit_store(builder, ip->dst, 1);
+    }
+    else if (ip->opcode == PRJM_EVAL_REG_MEM_STORE_CURSOR)
+    {
+        emit_load(builder, 1, ip->src2);
+        /* movsd [rcx], xmm1 */
+        emit_byte(builder, JIT_SCALAR_PREFIX);
+        emit_byte(builder, 0x0F);
+        emit_byte(builder, JIT_SSE_STORE);
+        emit_byte(builder, modrm(0, 1, JIT_RCX));
+    }
+    else
+    {
+        emit_mov_imm64(builder, JIT_RSI, (uint64_t) (uintptr_t) &builder->register_code->refs[ip->dst]);
+        /* mov [rsi], rcx */
+        emit_byte(builder, 0x48);
+        emit_byte(builder, 0x89);
+        emit_byte(builder, modrm(0, JIT_RCX, JIT_RSI));
+    }
+
+    /* add qword [rax + address], stride * sizeof(PRJM_EVAL_F) */
+    emit_byte(builder, 0x48);
+    emit_byte(builder, 0x81);
+    emit_cursor_operand(builder, 0, offsetof(prjm_eval_register_cursor_t, address));
+    emit_int32(builder, cursor->stride * (int32_t) sizeof(PRJM_EVAL_F));
+
+    /* addsd xmm0, [rax + index_stride]; movsd [rax + index], xmm0 */
+    emit_byte(builder, JIT_SCALAR_PREFIX);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, JIT_SSE_ADD);
+    emit_cursor_operand(builder, 0, offsetof(prjm_eval_register_cursor_t, index_stride));
+    emit_byte(builder, JIT_SCALAR_PREFIX);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, JIT_SSE_STORE);
+    emit_cursor_operand(builder, 0, offsetof(prjm_eval_register_cursor_t, index));
+    size_t done = emit_short_jump(builder, JIT_CC_ALWAYS);
+
+    patch_short_jump(builder, other_index);
+    patch_short_jump(builder, unordered);
+    patch_short_jump(builder, depleted);
+    emit_fallback(builder, ip);
+    patch_short_jump(builder, done);
+}
+
+static void emit_loop_init(prjm_eval_jit_builder_t* builder, const prjm_eval_register_instruction_t* ip)
+{
+    uint8_t rex = sizeof(PRJM_EVAL_I) == 8 ? 0x48 : 0x40;
+
+    /* cvttsd2si rax, [slot] */
+    emit_byte(builder, JIT_SCALAR_PREFIX);
+    emit_byte(builder, rex);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, 0x2C);
+    emit_slot_operand(builder, JIT_RAX, ip->src1);
+
+    /* mov ecx, MAX_LOOP_COUNT */
+    emit_byte(builder, 0xB8 + JIT_RCX);
+    emit_int32(builder, MAX_LOOP_COUNT);
+
+    /* cmp rax, rcx */
+    emit_byte(builder, rex);
+    emit_byte(builder, 0x39);
+    emit_byte(builder, modrm(3, JIT_RCX, JIT_RAX));
+
+    /* cmovg rax, rcx */
+    emit_byte(builder, rex);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, 0x4F);
+    emit_byte(builder, modrm(3, JIT_RAX, JIT_RCX));
+
+    /* cvtsi2sd xmm0, rax */
+    emit_byte(builder, JIT_SCALAR_PREFIX);
+    emit_byte(builder, rex);
+    emit_byte(builder, 0x0F);
+    emit_byte(builder, 0x2A);
+    emit_byte(builder, modrm(3, 0, JIT_RAX));
+
+    emit_store(builder, ip->dst, 0);
+}
+
+/**
+ * @brief Emits the machine code for a single register code instruction.
+ */
+static void emit_instruction(prjm_eval_jit_builder_t* builder, const prjm_eval_register_instruction_t* ip)
+{
+    size_t skip;
+
+    switch (ip->opcode)
+    {
+        case PRJM_EVAL_REG_HALT:
+            /* pop rbx; ret */
+            emit_byte(builder, 0x5B);
+            emit_byte(builder, 0xC3);
+            break;
+
+        case PRJM_EVAL_REG_MOV:
+            emit_load(builder, 0, ip->src1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_JUMP:
+            emit_jump(builder, JIT_CC_ALWAYS, ip->target);
+            break;
+
+        case PRJM_EVAL_REG_JUMP_IF_ZERO:
+            emit_load(builder, 0, ip->src1);
+            emit_zero(builder, 1);
+            emit_unordered_compare(builder, 0, 1);
+            /* NaN compares unordered, which also sets ZF. */
+            skip = emit_short_jump(builder, JIT_CC_P);
+            emit_jump(builder, JIT_CC_E, ip->target);
+            patch_short_jump(builder, skip);
+            break;
+
+        case PRJM_EVAL_REG_AND_TEST:
+            emit_truth_test(builder, ip->src1, false);
+            skip = emit_short_jump(builder, JIT_CC_A);
+            emit_zero(builder, 0);
+            emit_store(builder, ip->dst, 0);
+            emit_jump(builder, JIT_CC_ALWAYS, ip->target);
+            patch_short_jump(builder, skip);
+            break;
+
+        case PRJM_EVAL_REG_OR_TEST:
+            emit_truth_test(builder, ip->src1, true);
+            skip = emit_short_jump(builder, JIT_CC_A);
+            emit_load_constant(builder, 0, 1.0);
+            emit_store(builder, ip->dst, 0);
+            emit_jump(builder, JIT_CC_ALWAYS, ip->target);
+            patch_short_jump(builder, skip);
+            break;
+
+        case PRJM_EVAL_REG_LOOP_INIT:
+            emit_loop_init(builder, ip);
+            break;
+
+        case PRJM_EVAL_REG_LOOP_NEXT:
+            emit_load(builder, 0, ip->src1);
+            emit_zero(builder, 1);
+            emit_unordered_compare(builder, 0, 1);
+            emit_jump(builder, JIT_CC_BE, ip->target);
+            emit_load_constant(builder, 1, 1.0);
+            emit_scalar_reg(builder, JIT_SSE_SUB, 0, 1);
+            emit_store(builder, ip->src1, 0);
+            break;
+
+        case PRJM_EVAL_REG_WHILE_NEXT:
+            emit_truth_test(builder, ip->src1, false);
+            skip = emit_short_jump(builder, JIT_CC_BE);
+            emit_load(builder, 0, ip->src2);
+            emit_load_constant(builder, 1, 1.0);
+            emit_scalar_reg(builder, JIT_SSE_SUB, 0, 1);
+            emit_store(builder, ip->src2, 0);
+            emit_zero(builder, 1);
+            emit_unordered_compare(builder, 0, 1);
+            emit_jump(builder, JIT_CC_NE, ip->target);
+            emit_jump(builder, JIT_CC_P, ip->target);
+            patch_short_jump(builder, skip);
+            break;
+
+        case PRJM_EVAL_REG_MEM_LOAD_CURSOR:
+        case PRJM_EVAL_REG_MEM_STORE_CURSOR:
+        case PRJM_EVAL_REG_MEM_REF_CURSOR:
+            emit_cursor_access(builder, ip);
+            break;
+
+        case PRJM_EVAL_REG_SLOT_REF:
+            /* lea rax, [slot] */
+            emit_byte(builder, 0x48);
+            emit_byte(builder, 0x8D);
+            emit_slot_operand(builder, JIT_RAX, ip->src1);
+            emit_mov_imm64(builder, JIT_RCX, (uint64_t) (uintptr_t) &builder->register_code->refs[ip->dst]);
+            /* mov [rcx], rax */
+            emit_byte(builder, 0x48);
+            emit_byte(builder, 0x89);
+            emit_byte(builder, modrm(0, JIT_RAX, JIT_RCX));
+            break;
+
+        case PRJM_EVAL_REG_LOAD_REF:
+            emit_load_reference(builder, ip->src1);
+            /* movsd xmm0, [rax] */
+            emit_byte(builder, JIT_SCALAR_PREFIX);
+            emit_byte(builder, 0x0F);
+            emit_byte(builder, JIT_SSE_LOAD);
+            emit_byte(builder, modrm(0, 0, JIT_RAX));
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_STORE_REF:
+            emit_load(builder, 0, ip->src1);
+            emit_load_reference(builder, ip->dst);
+            /* movsd [rax], xmm0 */
+            emit_byte(builder, JIT_SCALAR_PREFIX);
+            emit_byte(builder, 0x0F);
+            emit_byte(builder, JIT_SSE_STORE);
+            emit_byte(builder, modrm(0, 0, JIT_RAX));
+            break;
+
+        case PRJM_EVAL_REG_BOOL:
+            emit_load(builder, 0, ip->src1);
+            emit_abs(builder, 0, 1);
+            emit_load_constant(builder, 1, close_factor_low);
+            emit_compare_reg(builder, 1, 0, JIT_CMP_LT);
+            emit_mask_to_bool(builder, 1, 0);
+            emit_store(builder, ip->dst, 1);
+            break;
+
+        case PRJM_EVAL_REG_BNOT:
+            emit_load(builder, 0, ip->src1);
+            emit_abs(builder, 0, 1);
+            emit_load_constant(builder, 1, close_factor_low);
+            emit_compare_reg(builder, 0, 1, JIT_CMP_LT);
+            emit_mask_to_bool(builder, 0, 1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_NEG:
+            emit_load(builder, 0, ip->src1);
+            emit_load_bits(builder, 1, JIT_SIGN_MASK);
+            emit_packed_reg(builder, JIT_SSE_XOR, 0, 1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_ABS:
+            emit_load(builder, 0, ip->src1);
+            emit_abs(builder, 0, 1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_SQR:
+            emit_load(builder, 0, ip->src1);
+            emit_scalar_reg(builder, JIT_SSE_MUL, 0, 0);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_SQRT:
+            emit_load(builder, 0, ip->src1);
+            emit_abs(builder, 0, 1);
+            emit_scalar_reg(builder, JIT_SSE_SQRT, 0, 0);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_ADD:
+        case PRJM_EVAL_REG_SUB:
+        case PRJM_EVAL_REG_MUL:
+        case PRJM_EVAL_REG_DIV_NONZERO:
+        case PRJM_EVAL_REG_MIN:
+        case PRJM_EVAL_REG_MAX:
+        {
+            /* minsd/maxsd return the second operand if the comparison is false, same as "a < b ? a : b". */
+            uint8_t opcode = ip->opcode == PRJM_EVAL_REG_ADD ? JIT_SSE_ADD
+                           : ip->opcode == PRJM_EVAL_REG_SUB ? JIT_SSE_SUB
+                           : ip->opcode == PRJM_EVAL_REG_MUL ? JIT_SSE_MUL
+                           : ip->opcode == PRJM_EVAL_REG_DIV_NONZERO ? JIT_SSE_DIV
+                           : ip->opcode == PRJM_EVAL_REG_MIN ? JIT_SSE_MIN
+                           : JIT_SSE_MAX;
+            emit_load(builder, 0, ip->src1);
+            emit_scalar_slot(builder, opcode, 0, ip->src2);
+            emit_store(builder, ip->dst, 0);
+            break;
+        }
+
+        case PRJM_EVAL_REG_BELOW:
+        case PRJM_EVAL_REG_BELOWEQ:
+            emit_load(builder, 0, ip->src1);
+            emit_compare_slot(builder, 0, ip->src2, ip->opcode == PRJM_EVAL_REG_BELOW ? JIT_CMP_LT : JIT_CMP_LE);
+            emit_mask_to_bool(builder, 0, 1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_ABOVE:
+        case PRJM_EVAL_REG_ABOVEEQ:
+            /* a > b is evaluated as b < a */
+            emit_load(builder, 0, ip->src2);
+            emit_compare_slot(builder, 0, ip->src1, ip->opcode == PRJM_EVAL_REG_ABOVE ? JIT_CMP_LT : JIT_CMP_LE);
+            emit_mask_to_bool(builder, 0, 1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_EQUAL:
+            emit_load(builder, 0, ip->src1);
+            emit_scalar_slot(builder, JIT_SSE_SUB, 0, ip->src2);
+            emit_abs(builder, 0, 1);
+            emit_load_constant(builder, 1, close_factor_low);
+            emit_compare_reg(builder, 0, 1, JIT_CMP_LT);
+            emit_mask_to_bool(builder, 0, 1);
+            emit_store(builder, ip->dst, 0);
+            break;
+
+        case PRJM_EVAL_REG_NOTEQUAL:
+            emit_load(builder, 0, ip->src1);
+            emit_scalar_slot(builder, JIT_SSE_SUB, 0, ip->src2);
+            emit_abs(builder, 0, 1);
+            emit_load_constant(builder, 1, close_factor_low);
+            emit_compare_reg(builder, 1, 0, JIT_CMP_LT);
+            emit_mask_to_bool(builder, 1, 0);
+            emit_store(builder, ip->dst, 1);
+            break;
+
+        default:
+            emit_fallback(builder, ip);
+            break;
+    }
+}
+
+prjm_eval_jit_code_t* prjm_eval_jit_code_create(prjm_eval_exptreenode_t* tree, int register_options)
+{
+    prjm_eval_register_code_t* register_code = prjm_eval_register_code_create(tree, register_options);
+    if (!register_code)
+    {
+        return NULL;
+    }
+
+    prjm_eval_jit_builder_t builder = { 0 };
+    builder.register_code = register_code;
+
+    size_t* offsets = calloc(register_code->instruction_count, sizeof(size_t));
+    if (!offsets)
+    {
+        prjm_eval_register_code_destroy(register_code);
+        return NULL;
+    }
+
+    /* push rbx; mov rbx, rdi */
+    emit_byte(&builder, 0x53);
+    emit_byte(&builder, 0x48);
+    emit_byte(&builder, 0x89);
+    emit_byte(&builder, modrm(3, JIT_RDI, JIT_RBX));
+
+    for (int32_t index = 0; index < register_code->instruction_count; index++)
+    {
+        offsets[index] = builder.length;
+        emit_instruction(&builder, &register_code->instructions[index]);
+    }
+
+    prjm_eval_jit_code_t* code = NULL;
+
+    if (!builder.failed)
+    {
+        for (int32_t index = 0; index < builder.fixup_count; index++)
+        {
+            size_t position = builder.fixups[index].position;
+            int32_t rel32 = (int32_t) ((int64_t) offsets[builder.fixups[index].target] - (int64_t) (position + 4));
+            memcpy(&builder.code[position], &rel32, sizeof(int32_t));
+        }
+
+        code = calloc(1, sizeof(prjm_eval_jit_code_t));
+    }
+
+    if (code)
+    {
+        size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+        code->register_code = register_code;
+        code->memory_size = (builder.length + page_size - 1) / page_size * page_size;
+        code->memory = mmap(NULL, code->memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (code->memory == MAP_FAILED)
+        {
+            code->memory = NULL;
+        }
+        else
+        {
+            memcpy(code->memory, builder.code, builder.length);
+        }
+
+        if (!code->memory || mprotect(code->memory, code->memory_size, PROT_READ | PROT_EXEC) != 0)
+        {
+            prjm_eval_jit_code_destroy(code);
+            code = NULL;
+        }
+        else
+        {
+            /* ISO C doesn't allow casting object pointers to function pointers. */
+            memcpy(&code->entry, &code->memory, sizeof(void*));
+        }
+    }
+    else
+    {
+        prjm_eval_register_code_destroy(register_code);
+    }
+
+    free(offsets);
+    free(builder.code);
+    free(builder.fixups);
+
+    return code;
+}
+
+void prjm_eval_jit_code_destroy(prjm_eval_jit_code_t* code)
+{
+    if (!code)
+    {
+        return;
+    }
+
+    if (code->memory)
+    {
+        munmap(code->memory, code->memory_size);
+    }
+
+    prjm_eval_register_code_destroy(code->register_code);
+    free(code);
+}
+
+PRJM_EVAL_F prjm_eval_jit_code_execute(prjm_eval_jit_code_t* code)
+{
+    assert(code);
+
+    prjm_eval_register_code_t* register_code = code->register_code;
+
+    prjm_eval_register_code_load_variables(register_code);
+    code->entry(register_code->frame);
+
+    PRJM_EVAL_F result = register_code->frame[register_code->result];
+    prjm_eval_register_code_store_variables(register_code);
+
+    return result;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file Jit.h
+ * @brief Translates register code into native x86-64 machine code.
+ *
+ * Only available if the library was built with the ENABLE_JIT CMake option, which defines PRJM_EVAL_ENABLE_JIT.
+ * The generated code requires an x86-64 CPU and the System V calling convention.
+ */
+#pragma once
+
+#include "CompilerTypes.h"
+
+struct prjm_eval_jit_code;
+typedef struct prjm_eval_jit_code prjm_eval_jit_code_t;
+
+/**
+ * @brief Compiles an expression tree into native machine code.
+ * The tree must stay valid as long as the machine code is used, as functions without a native
+ * implementation are executed by calling their tree node function.
+ * @param tree The root node of the program tree.
+ * @param register_options The prjm_eval_register_option_t flags used to create the translated register code.
+ * @return The compiled program or NULL if the tree is empty, an allocation failed or the operating system
+ *         doesn't allow executable memory.
+ */
+prjm_eval_jit_code_t* prjm_eval_jit_code_create(prjm_eval_exptreenode_t* tree, int register_options);
+
+/**
+ * @brief Frees the given machine code.
+ * @param code The machine code to free.
+ */
+void prjm_eval_jit_code_destroy(prjm_eval_jit_code_t* code);
+
+/**
+ * @brief Executes the machine code.
+ * @param code The machine code to execute.
+ * @return The value of the last executed top-level expression.
+ */
+PRJM_EVAL_F prjm_eval_jit_code_execute(prjm_eval_jit_code_t* code);
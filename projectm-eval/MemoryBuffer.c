@@ -1,5 +1,7 @@
 #include "MemoryBuffer.h"
 
+#include "VectorMath.h"
+
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -110,6 +112,21 @@ PRJM_EVAL_F* prjm_eval_memory_allocate(projectm_eval_mem_buffer buffer, int32_t
     return NULL;
 }
 
+int32_t prjm_eval_memory_block_run(int32_t index, int32_t stride)
+{
+    int32_t offset = index & (PRJM_EVAL_MEM_ITEMSPERBLOCK - 1);
+
+    if (stride > 0)
+    {
+        return (PRJM_EVAL_MEM_ITEMSPERBLOCK - 1 - offset) / stride;
+    }
+    if (stride < 0)
+    {
+        return offset / -stride;
+    }
+    return INT32_MAX;
+}
+
 PRJM_EVAL_F* prjm_eval_memory_copy(projectm_eval_mem_buffer buffer,
                                    PRJM_EVAL_F* dest,
                                    PRJM_EVAL_F* src,
@@ -229,10 +246,7 @@ PRJM_EVAL_F* prjm_eval_memory_set(projectm_eval_mem_buffer buffer,
         count -= block_count;
         offset_dest += block_count;
 
-        while (block_count--)
-        {
-            *block_pointer++ = val;
-        }
+        prjm_eval_vector_fill(block_pointer, val, block_count);
     }
 
     return dest;
@@ -7,6 +7,8 @@
 
 #include "CompilerTypes.h"
 
+#include <stdint.h>
+
 /**
  * @brief Destroys the global memory buffer and its contents.
  * Only to be used after all context objects are destroyed. Will cause segfaults otherwise.
@@ -55,6 +57,15 @@ void prjm_eval_memory_free_block(projectm_eval_mem_buffer buffer, int block);
  */
 PRJM_EVAL_F* prjm_eval_memory_allocate(projectm_eval_mem_buffer buffer, int index);
 
+/**
+ * @brief Returns how many of the indices index + stride, index + 2 * stride and so on are in the same block as index.
+ * Pointers returned by @a prjm_eval_memory_allocate() for an index can be advanced by the stride this many times.
+ * @param index A valid memory index.
+ * @param stride The distance between two indices.
+ * @return The number of following indices in the same block, INT32_MAX if stride is zero.
+ */
+int32_t prjm_eval_memory_block_run(int32_t index, int32_t stride);
+
 /**
  * @brief Copies a continuous block of values from one location to another.
  * @param buffer A pointer to the buffer to use.
@@ -0,0 +1,2432 @@
+/**
+ * @file RegisterCode.c
+ * @brief Implements the register code generator and interpreter.
+ *
+ * The generator allocates temporary slots like a stack: each expression leaves its result in a slot below the current
+ * temporary top, and the consuming function resets the top to where it was before evaluating its arguments.
+ */
+#include "RegisterCode.h"
+
+#include "BatchCode.h"
+#include "ExpressionTree.h"
+#include "IntrinsicMath.h"
+#include "MemoryBuffer.h"
+#include "TreeFunctions.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct prjm_eval_register_builder
+{
+    prjm_eval_register_instruction_t* code;
+    int32_t length;
+    int32_t capacity;
+    PRJM_EVAL_F* constants;
+    int32_t constant_count;
+    int32_t constant_capacity;
+    prjm_eval_register_variable_t* variables;
+    int32_t variable_count;
+    int32_t variable_capacity;
+    int32_t temp_base; /*!< First temporary slot. */
+    int32_t temp_top; /*!< Next free temporary slot. */
+    int32_t frame_size; /*!< Number of slots used so far. */
+    int32_t ref_count; /*!< Number of allocated reference registers. */
+    int32_t label; /*!< Instruction index of the last jump target. */
+    prjm_eval_register_cursor_t* cursors;
+    prjm_eval_exptreenode_t** cursor_nodes; /*!< The memory access of each cursor, NULL after it was compiled. */
+    int32_t cursor_count;
+    int32_t cursor_capacity;
+    prjm_eval_register_vector_loop_t** vector_loops;
+    int32_t vector_loop_count;
+    bool use_cursors;
+    bool vectorize_loops;
+    bool failed;
+} prjm_eval_register_builder_t;
+
+typedef struct prjm_eval_register_func_map
+{
+    prjm_eval_expr_func_t* func;
+    prjm_eval_register_opcode_t opcode;
+} prjm_eval_register_func_map_t;
+
+static const prjm_eval_register_func_map_t unary_functions[] = {
+    { prjm_eval_func_bnot,    PRJM_EVAL_REG_BNOT },
+    { prjm_eval_func_neg,     PRJM_EVAL_REG_NEG },
+    { prjm_eval_func_sin,     PRJM_EVAL_REG_SIN },
+    { prjm_eval_func_cos,     PRJM_EVAL_REG_COS },
+    { prjm_eval_func_tan,     PRJM_EVAL_REG_TAN },
+    { prjm_eval_func_asin,    PRJM_EVAL_REG_ASIN },
+    { prjm_eval_func_acos,    PRJM_EVAL_REG_ACOS },
+    { prjm_eval_func_atan,    PRJM_EVAL_REG_ATAN },
+    { prjm_eval_func_sqrt,    PRJM_EVAL_REG_SQRT },
+    { prjm_eval_func_exp,     PRJM_EVAL_REG_EXP },
+    { prjm_eval_func_log,     PRJM_EVAL_REG_LOG },
+    { prjm_eval_func_log10,   PRJM_EVAL_REG_LOG10 },
+    { prjm_eval_func_floor,   PRJM_EVAL_REG_FLOOR },
+    { prjm_eval_func_ceil,    PRJM_EVAL_REG_CEIL },
+    { prjm_eval_func_sqr,     PRJM_EVAL_REG_SQR },
+    { prjm_eval_func_abs,     PRJM_EVAL_REG_ABS },
+    { prjm_eval_func_sign,    PRJM_EVAL_REG_SIGN },
+    { prjm_eval_func_rand,    PRJM_EVAL_REG_RAND },
+    { prjm_eval_func_invsqrt, PRJM_EVAL_REG_INVSQRT }
+};
+
+static const prjm_eval_register_func_map_t binary_functions[] = {
+    { prjm_eval_func_equal,            PRJM_EVAL_REG_EQUAL },
+    { prjm_eval_func_notequal,         PRJM_EVAL_REG_NOTEQUAL },
+    { prjm_eval_func_below,            PRJM_EVAL_REG_BELOW },
+    { prjm_eval_func_above,            PRJM_EVAL_REG_ABOVE },
+    { prjm_eval_func_beloweq,          PRJM_EVAL_REG_BELOWEQ },
+    { prjm_eval_func_aboveeq,          PRJM_EVAL_REG_ABOVEEQ },
+    { prjm_eval_func_add,              PRJM_EVAL_REG_ADD },
+    { prjm_eval_func_sub,              PRJM_EVAL_REG_SUB },
+    { prjm_eval_func_mul,              PRJM_EVAL_REG_MUL },
+    { prjm_eval_func_div,              PRJM_EVAL_REG_DIV },
+    { prjm_eval_func_div_nonzero,      PRJM_EVAL_REG_DIV_NONZERO },
+    { prjm_eval_func_mod,              PRJM_EVAL_REG_MOD },
+    { prjm_eval_func_bitwise_or,       PRJM_EVAL_REG_BITWISE_OR },
+    { prjm_eval_func_bitwise_and,      PRJM_EVAL_REG_BITWISE_AND },
+    { prjm_eval_func_boolean_and_func, PRJM_EVAL_REG_BOOLEAN_AND },
+    { prjm_eval_func_boolean_or_func,  PRJM_EVAL_REG_BOOLEAN_OR },
+    { prjm_eval_func_pow,              PRJM_EVAL_REG_POW },
+    { prjm_eval_func_atan2,            PRJM_EVAL_REG_ATAN2 },
+    { prjm_eval_func_min,              PRJM_EVAL_REG_MIN },
+    { prjm_eval_func_max,              PRJM_EVAL_REG_MAX },
+    { prjm_eval_func_sigmoid,          PRJM_EVAL_REG_SIGMOID }
+};
+
+/* Fused compare-and-select functions map to their comparison operator. */
+static const prjm_eval_register_func_map_t select_functions[] = {
+    { prjm_eval_func_if_equal,    PRJM_EVAL_REG_EQUAL },
+    { prjm_eval_func_if_notequal, PRJM_EVAL_REG_NOTEQUAL },
+    { prjm_eval_func_if_below,    PRJM_EVAL_REG_BELOW },
+    { prjm_eval_func_if_above,    PRJM_EVAL_REG_ABOVE },
+    { prjm_eval_func_if_beloweq,  PRJM_EVAL_REG_BELOWEQ },
+    { prjm_eval_func_if_aboveeq,  PRJM_EVAL_REG_ABOVEEQ }
+};
+
+/* Compound assignments map to the binary operator applied to the target. */
+static const prjm_eval_register_func_map_t assign_functions[] = {
+    { prjm_eval_func_add_op,         PRJM_EVAL_REG_ADD },
+    { prjm_eval_func_sub_op,         PRJM_EVAL_REG_SUB },
+    { prjm_eval_func_mul_op,         PRJM_EVAL_REG_MUL },
+    { prjm_eval_func_div_op,         PRJM_EVAL_REG_DIV },
+    { prjm_eval_func_mod_op,         PRJM_EVAL_REG_MOD },
+    { prjm_eval_func_bitwise_or_op,  PRJM_EVAL_REG_BITWISE_OR },
+    { prjm_eval_func_bitwise_and_op, PRJM_EVAL_REG_BITWISE_AND },
+    { prjm_eval_func_pow_op,         PRJM_EVAL_REG_POW }
+};
+
+#define PRJM_EVAL_REGISTER_MAP_SIZE(map) ((int) (sizeof(map) / sizeof(prjm_eval_register_func_map_t)))
+
+static const prjm_eval_register_func_map_t* find_function(const prjm_eval_register_func_map_t* map,
+                                                          int count,
+                                                          prjm_eval_expr_func_t* func)
+{
+    for (int index = 0; index < count; index++)
+    {
+        if (map[index].func == func)
+        {
+            return &map[index];
+        }
+    }
+
+    return NULL;
+}
+
+/* Slot management */
+
+static void add_constant(prjm_eval_register_builder_t* builder, PRJM_EVAL_F value)
+{
+    for (int32_t index = 0; index < builder->constant_count; index++)
+    {
+        if (memcmp(&builder->constants[index], &value, sizeof(PRJM_EVAL_F)) == 0)
+        {
+            return;
+        }
+    }
+
+    if (builder->constant_count == builder->constant_capacity)
+    {
+        int32_t new_capacity = builder->constant_capacity ? builder->constant_capacity * 2 : 16;
+        PRJM_EVAL_F* new_constants = realloc(builder->constants, new_capacity * sizeof(PRJM_EVAL_F));
+        if (!new_constants)
+        {
+            builder->failed = true;
+            return;
+        }
+        builder->constants = new_constants;
+        builder->constant_capacity = new_capacity;
+    }
+
+    builder->constants[builder->constant_count++] = value;
+}
+
+static void add_variable(prjm_eval_register_builder_t* builder, PRJM_EVAL_F* var)
+{
+    for (int32_t index = 0; index < builder->variable_count; index++)
+    {
+        if (builder->variables[index].var == var)
+        {
+            return;
+        }
+    }
+
+    if (builder->variable_count == builder->variable_capacity)
+    {
+        int32_t new_capacity = builder->variable_capacity ? builder->variable_capacity * 2 : 16;
+        prjm_eval_register_variable_t* new_variables = realloc(builder->variables,
+                                                               new_capacity * sizeof(prjm_eval_register_variable_t));
+        if (!new_variables)
+        {
+            builder->failed = true;
+            return;
+        }
+        builder->variables = new_variables;
+        builder->variable_capacity = new_capacity;
+    }
+
+    builder->variables[builder->variable_count].var = var;
+    builder->variables[builder->variable_count].slot = 0;
+    builder->variable_count++;
+}
+
+/**
+ * @brief Collects all constants and variables of the tree, so the frame layout is known before generating code.
+ */
+static void collect_slots(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    if (node->func == prjm_eval_func_const)
+    {
+        add_constant(builder, node->value);
+    }
+    else if (node->func == prjm_eval_func_var)
+    {
+        add_variable(builder, node->var);
+    }
+    else if (node->func == prjm_eval_func_execute_while)
+    {
+        add_constant(builder, MAX_LOOP_COUNT);
+    }
+
+    if (node->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            collect_slots(builder, *arg);
+        }
+    }
+}
+
+static int32_t constant_slot(prjm_eval_register_builder_t* builder, PRJM_EVAL_F value)
+{
+    for (int32_t index = 0; index < builder->constant_count; index++)
+    {
+        if (memcmp(&builder->constants[index], &value, sizeof(PRJM_EVAL_F)) == 0)
+        {
+            return index;
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+
+static int32_t variable_slot(prjm_eval_register_builder_t* builder, PRJM_EVAL_F* var)
+{
+    for (int32_t index = 0; index < builder->variable_count; index++)
+    {
+        if (builder->variables[index].var == var)
+        {
+            return builder->variables[index].slot;
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+
+static int32_t alloc_temp(prjm_eval_register_builder_t* builder)
+{
+    int32_t slot = builder->temp_top++;
+    if (builder->temp_top > builder->frame_size)
+    {
+        builder->frame_size = builder->temp_top;
+    }
+    return slot;
+}
+
+static bool is_temp(prjm_eval_register_builder_t* builder, int32_t slot)
+{
+    return slot >= builder->temp_base;
+}
+
+/* Instruction emission */
+
+static int32_t emit(prjm_eval_register_builder_t* builder,
+                    prjm_eval_register_opcode_t opcode,
+                    int32_t dst,
+                    int32_t src1,
+                    int32_t src2)
+{
+    if (builder->length == builder->capacity)
+    {
+        int32_t new_capacity = builder->capacity ? builder->capacity * 2 : 64;
+        prjm_eval_register_instruction_t* new_code = realloc(builder->code,
+                                                             new_capacity * sizeof(prjm_eval_register_instruction_t));
+        if (!new_code)
+        {
+            builder->failed = true;
+            return -1;
+        }
+        builder->code = new_code;
+        builder->capacity = new_capacity;
+    }
+
+    prjm_eval_register_instruction_t* instr = &builder->code[builder->length];
+    memset(instr, 0, sizeof(prjm_eval_register_instruction_t));
+    instr->opcode = opcode;
+    instr->dst = dst;
+    instr->src1 = src1;
+    instr->src2 = src2;
+
+    return builder->length++;
+}
+
+static void emit_memory(prjm_eval_register_builder_t* builder,
+                        prjm_eval_register_opcode_t opcode,
+                        projectm_eval_mem_buffer memory_buffer,
+                        int32_t dst,
+                        int32_t src1,
+                        int32_t src2)
+{
+    int32_t index = emit(builder, opcode, dst, src1, src2);
+    if (index >= 0)
+    {
+        builder->code[index].memory_buffer = memory_buffer;
+    }
+}
+
+static void emit_move(prjm_eval_register_builder_t* builder, int32_t dst, int32_t src)
+{
+    if (dst != src)
+    {
+        emit(builder, PRJM_EVAL_REG_MOV, dst, src, 0);
+    }
+}
+
+/**
+ * @brief Marks the current position as a jump target and returns its instruction index.
+ */
+static int32_t mark_label(prjm_eval_register_builder_t* builder)
+{
+    builder->label = builder->length;
+    return builder->length;
+}
+
+static void set_target(prjm_eval_register_builder_t* builder, int32_t index, int32_t target)
+{
+    if (index >= 0)
+    {
+        builder->code[index].target = target;
+    }
+}
+
+/**
+ * @brief Checks if the instruction only writes its dst slot, after reading all sources.
+ */
+static bool writes_dst_slot(prjm_eval_register_opcode_t opcode)
+{
+    return opcode == PRJM_EVAL_REG_MOV ||
+           opcode == PRJM_EVAL_REG_LOAD_REF ||
+           opcode == PRJM_EVAL_REG_MEM_LOAD ||
+           opcode == PRJM_EVAL_REG_MEM_LOAD_CURSOR ||
+           opcode == PRJM_EVAL_REG_CALL_NODE ||
+           opcode >= PRJM_EVAL_REG_BOOL;
+}
+
+/**
+ * @brief Lets the last instruction write directly into the given slot instead of its temporary result slot.
+ * Turns sequences like "t = add(a, b); x = t" into "x = add(a, b)".
+ * @return true if the instruction was changed, false if a move is still required.
+ */
+static bool retarget_result(prjm_eval_register_builder_t* builder, int32_t result, int32_t slot)
+{
+    if (builder->failed || !is_temp(builder, result) || builder->length == 0 || builder->label == builder->length)
+    {
+        return false;
+    }
+
+    prjm_eval_register_instruction_t* last = &builder->code[builder->length - 1];
+    if (last->dst != result || !writes_dst_slot(last->opcode))
+    {
+        return false;
+    }
+
+    last->dst = slot;
+    return true;
+}
+
+/* Code generation */
+
+static int32_t compile_value(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node);
+
+static void compile_effect(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node);
+
+static void compile_ref(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node, int32_t ref);
+
+static bool has_later_side_effects(prjm_eval_exptreenode_t** args, int index, int count)
+{
+    for (int later = index + 1; later < count; later++)
+    {
+        if (prjm_eval_exptreenode_has_side_effects(args[later]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Compiles function arguments and returns their slots.
+ * Tree functions read argument values only after all arguments were evaluated. Variable slots are read late by
+ * design, other references are kept in a reference register and loaded after the last argument, if a later
+ * argument might change the referenced value.
+ */
+static void compile_args(prjm_eval_register_builder_t* builder,
+                         prjm_eval_exptreenode_t* node,
+                         int count,
+                         int32_t* slots)
+{
+    int32_t refs[3];
+    assert(count <= 3);
+
+    for (int index = 0; index < count; index++)
+    {
+        prjm_eval_exptreenode_t* arg = node->args[index];
+        refs[index] = -1;
+
+        if (arg->func != prjm_eval_func_var &&
+            !prjm_eval_exptreenode_returns_value(arg) &&
+            has_later_side_effects(node->args, index, count))
+        {
+            refs[index] = builder->ref_count++;
+            compile_ref(builder, arg, refs[index]);
+        }
+        else
+        {
+            slots[index] = compile_value(builder, arg);
+        }
+    }
+
+    for (int index = 0; index < count; index++)
+    {
+        if (refs[index] >= 0)
+        {
+            slots[index] = alloc_temp(builder);
+            emit(builder, PRJM_EVAL_REG_LOAD_REF, slots[index], refs[index], 0);
+        }
+    }
+}
+
+static int32_t compile_call_node(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    int32_t dst = alloc_temp(builder);
+    int32_t index = emit(builder, PRJM_EVAL_REG_CALL_NODE, dst, 0, 0);
+    if (index >= 0)
+    {
+        builder->code[index].node = node;
+    }
+    return dst;
+}
+
+static void compile_call_node_ref(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node, int32_t ref)
+{
+    int32_t index = emit(builder, PRJM_EVAL_REG_CALL_NODE_REF, ref, alloc_temp(builder), 0);
+    if (index >= 0)
+    {
+        builder->code[index].node = node;
+    }
+}
+
+static bool is_if_function(prjm_eval_expr_func_t* func)
+{
+    return func == prjm_eval_func_if ||
+           find_function(select_functions, PRJM_EVAL_REGISTER_MAP_SIZE(select_functions), func);
+}
+
+/**
+ * @brief Compiles the condition of an "if" node and returns its slot.
+ * Fused compare-and-select nodes take the two compared values instead of the condition.
+ * @param branches Receives the "then" and "else" branch arguments of the node.
+ */
+static int32_t compile_condition(prjm_eval_register_builder_t* builder,
+                                 prjm_eval_exptreenode_t* node,
+                                 prjm_eval_exptreenode_t*** branches)
+{
+    const prjm_eval_register_func_map_t* mapping = find_function(select_functions,
+                                                                 PRJM_EVAL_REGISTER_MAP_SIZE(select_functions),
+                                                                 node->func);
+    if (!mapping)
+    {
+        *branches = node->args + 1;
+        return compile_value(builder, node->args[0]);
+    }
+
+    *branches = node->args + 2;
+
+    int32_t mark = builder->temp_top;
+    int32_t args[2];
+    compile_args(builder, node, 2, args);
+    builder->temp_top = mark;
+    int32_t dst = alloc_temp(builder);
+    emit(builder, mapping->opcode, dst, args[0], args[1]);
+    return dst;
+}
+
+static int32_t compile_if(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    prjm_eval_exptreenode_t** branches;
+    int32_t mark = builder->temp_top;
+    int32_t condition = compile_condition(builder, node, &branches);
+    builder->temp_top = mark;
+    int32_t jump_to_else = emit(builder, PRJM_EVAL_REG_JUMP_IF_ZERO, 0, condition, 0);
+
+    int32_t dst = alloc_temp(builder);
+
+    emit_move(builder, dst, compile_value(builder, branches[0]));
+    builder->temp_top = mark + 1;
+    int32_t jump_to_end = emit(builder, PRJM_EVAL_REG_JUMP, 0, 0, 0);
+
+    set_target(builder, jump_to_else, mark_label(builder));
+    emit_move(builder, dst, compile_value(builder, branches[1]));
+    builder->temp_top = mark + 1;
+
+    set_target(builder, jump_to_end, mark_label(builder));
+
+    return dst;
+}
+
+/* Memory cursors */
+
+#define PRJM_EVAL_REGISTER_MAX_INDUCTION_VARIABLES 8
+#define PRJM_EVAL_REGISTER_MAX_WRITTEN_VARIABLES 32
+
+/* Larger strides and index offsets never stay within a memory block. */
+#define PRJM_EVAL_REGISTER_MAX_CURSOR_OFFSET 8388608
+
+/**
+ * @brief A variable which is only changed by adding constants at the top level of a loop body.
+ */
+typedef struct prjm_eval_register_induction
+{
+    PRJM_EVAL_F* var;
+    PRJM_EVAL_F stride; /*!< Sum of all constants added to the variable in one iteration. */
+    bool valid; /*!< False if the variable is also changed in other ways. */
+} prjm_eval_register_induction_t;
+
+typedef struct prjm_eval_register_loop_analysis
+{
+    prjm_eval_register_induction_t variables[PRJM_EVAL_REGISTER_MAX_INDUCTION_VARIABLES];
+    int variable_count;
+    PRJM_EVAL_F* written[PRJM_EVAL_REGISTER_MAX_WRITTEN_VARIABLES]; /*!< Variables assigned other than by increments. */
+    int written_count; /*!< Number of entries in written, or -1 if there are too many to track. */
+} prjm_eval_register_loop_analysis_t;
+
+static bool is_function(const prjm_eval_exptreenode_t* node, prjm_eval_expr_func_t* func)
+{
+    return prjm_eval_generic_function(node->func) == func;
+}
+
+static bool is_cursor_offset(const prjm_eval_exptreenode_t* node)
+{
+    return is_function(node, prjm_eval_func_const) &&
+           fabs(node->value) <= PRJM_EVAL_REGISTER_MAX_CURSOR_OFFSET;
+}
+
+/**
+ * @brief Checks if the node is "var += c", "var -= c", "var = var + c", "var = c + var" or "var = var - c".
+ * Only integer constants are accepted, so the variable values stay exact.
+ */
+static bool get_increment(const prjm_eval_exptreenode_t* node, PRJM_EVAL_F** var, PRJM_EVAL_F* step)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+    if ((func != prjm_eval_func_add_op && func != prjm_eval_func_sub_op && func != prjm_eval_func_set) ||
+        !is_function(node->args[0], prjm_eval_func_var))
+    {
+        return false;
+    }
+
+    *var = node->args[0]->var;
+
+    const prjm_eval_exptreenode_t* value = node->args[1];
+    const prjm_eval_exptreenode_t* constant = value;
+    bool negate = func == prjm_eval_func_sub_op;
+    if (func == prjm_eval_func_set)
+    {
+        bool is_add = is_function(value, prjm_eval_func_add);
+        if (!is_add && !is_function(value, prjm_eval_func_sub))
+        {
+            return false;
+        }
+
+        if (is_function(value->args[0], prjm_eval_func_var) && value->args[0]->var == *var)
+        {
+            constant = value->args[1];
+        }
+        else if (is_add && is_function(value->args[1], prjm_eval_func_var) && value->args[1]->var == *var)
+        {
+            constant = value->args[0];
+        }
+        else
+        {
+            return false;
+        }
+        negate = !is_add;
+    }
+
+    if (!is_cursor_offset(constant) || constant->value != floor(constant->value))
+    {
+        return false;
+    }
+
+    *step = negate ? -constant->value : constant->value;
+    return true;
+}
+
+static prjm_eval_register_induction_t* find_induction_variable(prjm_eval_register_loop_analysis_t* analysis,
+                                                               const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < analysis->variable_count; index++)
+    {
+        if (analysis->variables[index].var == var)
+        {
+            return &analysis->variables[index];
+        }
+    }
+    return NULL;
+}
+
+static void mark_written(prjm_eval_register_loop_analysis_t* analysis, PRJM_EVAL_F* var)
+{
+    prjm_eval_register_induction_t* variable = find_induction_variable(analysis, var);
+    if (variable)
+    {
+        variable->valid = false;
+    }
+
+    if (analysis->written_count < 0)
+    {
+        return;
+    }
+    for (int index = 0; index < analysis->written_count; index++)
+    {
+        if (analysis->written[index] == var)
+        {
+            return;
+        }
+    }
+    if (analysis->written_count == PRJM_EVAL_REGISTER_MAX_WRITTEN_VARIABLES)
+    {
+        analysis->written_count = -1;
+        return;
+    }
+    analysis->written[analysis->written_count++] = var;
+}
+
+/**
+ * @brief Adds the increments of all top-level statements of a loop body to the candidate variables.
+ */
+static void collect_increments(prjm_eval_register_loop_analysis_t* analysis, const prjm_eval_exptreenode_t* node)
+{
+    PRJM_EVAL_F* var;
+    PRJM_EVAL_F step;
+
+    if (is_function(node, prjm_eval_func_execute_list))
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            collect_increments(analysis, *arg);
+        }
+    }
+    else if (get_increment(node, &var, &step))
+    {
+        prjm_eval_register_induction_t* variable = find_induction_variable(analysis, var);
+        if (!variable && analysis->variable_count < PRJM_EVAL_REGISTER_MAX_INDUCTION_VARIABLES)
+        {
+            variable = &analysis->variables[analysis->variable_count++];
+            variable->var = var;
+            variable->stride = 0;
+            variable->valid = true;
+        }
+        if (variable)
+        {
+            variable->stride += step;
+        }
+    }
+}
+
+/**
+ * @brief Invalidates all candidate variables written by the node in other ways than a top-level increment.
+ * @return false if the node writes to locations other than variables and memory, which might include variables.
+ */
+static bool check_writes(prjm_eval_register_loop_analysis_t* analysis, const prjm_eval_exptreenode_t* node)
+{
+    /* Freeing memory blocks would leave cursors pointing into released memory. */
+    if (is_function(node, prjm_eval_func_freembuf))
+    {
+        return false;
+    }
+
+    /* While loops storing through references returned by their body may write to any variable in it. */
+    if (is_function(node, prjm_eval_func_execute_while) && prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        return false;
+    }
+
+    if (prjm_eval_exptreenode_is_assignment(node) || prjm_eval_exptreenode_is_indirect_store(node))
+    {
+        const prjm_eval_exptreenode_t* target = node->args[0];
+        if (is_function(target, prjm_eval_func_var))
+        {
+            mark_written(analysis, target->var);
+        }
+        else if (!is_function(target, prjm_eval_func_mem))
+        {
+            return false;
+        }
+    }
+
+    if (node->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            if (!check_writes(analysis, *arg))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool check_statement_writes(prjm_eval_register_loop_analysis_t* analysis,
+                                   const prjm_eval_exptreenode_t* node)
+{
+    PRJM_EVAL_F* var;
+    PRJM_EVAL_F step;
+
+    if (is_function(node, prjm_eval_func_execute_list))
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            if (!check_statement_writes(analysis, *arg))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return get_increment(node, &var, &step) || check_writes(analysis, node);
+}
+
+/**
+ * @brief Checks if the value is the same in each iteration of the analyzed loop.
+ */
+static bool is_invariant_offset(prjm_eval_register_loop_analysis_t* analysis, const prjm_eval_exptreenode_t* node)
+{
+    if (is_cursor_offset(node))
+    {
+        return true;
+    }
+
+    if (!is_function(node, prjm_eval_func_var) || analysis->written_count < 0)
+    {
+        return false;
+    }
+
+    for (int index = 0; index < analysis->written_count; index++)
+    {
+        if (analysis->written[index] == node->var)
+        {
+            return false;
+        }
+    }
+    return !find_induction_variable(analysis, node->var);
+}
+
+static bool get_induction_stride(prjm_eval_register_loop_analysis_t* analysis,
+                                 const prjm_eval_exptreenode_t* node,
+                                 int32_t* stride)
+{
+    if (!is_function(node, prjm_eval_func_var))
+    {
+        return false;
+    }
+
+    prjm_eval_register_induction_t* variable = find_induction_variable(analysis, node->var);
+    if (!variable || !variable->valid)
+    {
+        return false;
+    }
+
+    *stride = (int32_t) variable->stride;
+    return true;
+}
+
+/**
+ * @brief Returns the stride of a memory index "var", "var + offset", "offset + var" or "var - offset" in the analyzed
+ * loop, where offset is a constant or a variable which isn't changed in the loop.
+ */
+static bool get_index_stride(prjm_eval_register_loop_analysis_t* analysis,
+                             const prjm_eval_exptreenode_t* index,
+                             int32_t* stride)
+{
+    if (is_function(index, prjm_eval_func_add))
+    {
+        const prjm_eval_exptreenode_t* first = index->args[0];
+        const prjm_eval_exptreenode_t* second = index->args[1];
+        return (is_invariant_offset(analysis, second) && get_induction_stride(analysis, first, stride)) ||
+               (is_invariant_offset(analysis, first) && get_induction_stride(analysis, second, stride));
+    }
+
+    if (is_function(index, prjm_eval_func_sub))
+    {
+        return is_invariant_offset(analysis, index->args[1]) && get_induction_stride(analysis, index->args[0], stride);
+    }
+
+    return get_induction_stride(analysis, index, stride);
+}
+
+static void add_cursor(prjm_eval_register_builder_t* builder,
+                       prjm_eval_exptreenode_t* node,
+                       int32_t stride)
+{
+    if (builder->cursor_count == builder->cursor_capacity)
+    {
+        int32_t new_capacity = builder->cursor_capacity ? builder->cursor_capacity * 2 : 8;
+        prjm_eval_register_cursor_t* new_cursors = realloc(builder->cursors,
+                                                           new_capacity * sizeof(prjm_eval_register_cursor_t));
+        if (new_cursors)
+        {
+            builder->cursors = new_cursors;
+        }
+        prjm_eval_exptreenode_t** new_nodes = realloc(builder->cursor_nodes,
+                                                      new_capacity * sizeof(prjm_eval_exptreenode_t*));
+        if (new_nodes)
+        {
+            builder->cursor_nodes = new_nodes;
+        }
+        if (!new_cursors || !new_nodes)
+        {
+            builder->failed = true;
+            return;
+        }
+        builder->cursor_capacity = new_capacity;
+    }
+
+    prjm_eval_register_cursor_t* cursor = &builder->cursors[builder->cursor_count];
+    memset(cursor, 0, sizeof(prjm_eval_register_cursor_t));
+    cursor->stride = stride;
+    cursor->index_stride = (PRJM_EVAL_F) stride;
+    cursor->memory_buffer = node->memory_buffer;
+    builder->cursor_nodes[builder->cursor_count] = node;
+    builder->cursor_count++;
+}
+
+/**
+ * @brief Adds a cursor for each memory access in the statement whose index is based on an induction variable.
+ * Accesses in conditional code or nested loops are skipped, as they aren't executed exactly once per iteration.
+ */
+static void find_strided_accesses(prjm_eval_register_builder_t* builder,
+                                  prjm_eval_register_loop_analysis_t* analysis,
+                                  prjm_eval_exptreenode_t* node)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+    int32_t stride;
+
+    if (is_if_function(func) ||
+        func == prjm_eval_func_execute_loop ||
+        func == prjm_eval_func_execute_while ||
+        func == prjm_eval_func_boolean_and_op ||
+        func == prjm_eval_func_boolean_or_op)
+    {
+        return;
+    }
+
+    if ((func == prjm_eval_func_mem || func == prjm_eval_func_mem_set) &&
+        get_index_stride(analysis, node->args[0], &stride))
+    {
+        add_cursor(builder, node, stride);
+    }
+
+    if (node->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            find_strided_accesses(builder, analysis, *arg);
+        }
+    }
+}
+
+/**
+ * @brief Finds the induction variables of a loop body and assigns cursors to the memory accesses using them.
+ * @return The number of added cursors, which directly follow the previously added ones.
+ */
+static int32_t add_loop_cursors(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* body)
+{
+    prjm_eval_register_loop_analysis_t analysis = { 0 };
+    int32_t first_cursor = builder->cursor_count;
+
+    collect_increments(&analysis, body);
+    if (analysis.variable_count == 0 || !check_statement_writes(&analysis, body))
+    {
+        return 0;
+    }
+
+    find_strided_accesses(builder, &analysis, body);
+
+    return builder->failed ? 0 : builder->cursor_count - first_cursor;
+}
+
+/**
+ * @brief Returns the cursor assigned to the memory access node, or -1 if it has none.
+ * Each cursor is only returned once, as it must only be advanced by a single instruction.
+ */
+static int32_t take_cursor(prjm_eval_register_builder_t* builder, const prjm_eval_exptreenode_t* node)
+{
+    for (int32_t index = 0; index < builder->cursor_count; index++)
+    {
+        if (builder->cursor_nodes[index] == node)
+        {
+            builder->cursor_nodes[index] = NULL;
+            return index;
+        }
+    }
+    return -1;
+}
+
+static void emit_cursor(prjm_eval_register_builder_t* builder,
+                        prjm_eval_register_opcode_t opcode,
+                        int32_t cursor,
+                        int32_t dst,
+                        int32_t src1,
+                        int32_t src2)
+{
+    int32_t index = emit(builder, opcode, dst, src1, src2);
+    if (index >= 0)
+    {
+        builder->code[index].cursor = cursor;
+    }
+}
+
+/* Vectorized loops */
+
+#define PRJM_EVAL_REGISTER_MAX_VECTOR_ACCESSES 32
+
+/* Fewer iterations per batch don't pay off the batch setup. */
+#define PRJM_EVAL_REGISTER_MIN_VECTOR_LANES 4
+
+/* Shorter loops are executed faster by the loop instructions. */
+#define PRJM_EVAL_REGISTER_MIN_VECTOR_ITERATIONS 32
+
+/**
+ * @brief A memory access in a loop body considered for vectorization.
+ */
+typedef struct prjm_eval_register_vector_access
+{
+    projectm_eval_mem_buffer memory_buffer; /*!< megabuf/gmegabuf memory block. */
+    int32_t offset; /*!< The index relative to the induction variable value at the start of the iteration. */
+    bool indexed; /*!< False if the index isn't the induction variable plus a constant. */
+    bool write; /*!< True if the access stores a value. */
+} prjm_eval_register_vector_access_t;
+
+typedef struct prjm_eval_register_vector_analysis
+{
+    prjm_eval_register_loop_analysis_t loop;
+    PRJM_EVAL_F* induction_variable;
+    int32_t offset; /*!< The increments of the induction variable before the current statement. */
+    PRJM_EVAL_F* assigned[PRJM_EVAL_REGISTER_MAX_WRITTEN_VARIABLES]; /*!< Variables assigned in every iteration. */
+    int assigned_count;
+    prjm_eval_register_vector_access_t accesses[PRJM_EVAL_REGISTER_MAX_VECTOR_ACCESSES];
+    int access_count;
+} prjm_eval_register_vector_analysis_t;
+
+static bool is_assigned(const prjm_eval_register_vector_analysis_t* analysis, const PRJM_EVAL_F* var)
+{
+    for (int index = 0; index < analysis->assigned_count; index++)
+    {
+        if (analysis->assigned[index] == var)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks if reading the variable gives the same value as in a sequential execution of the iterations.
+ * This is the case for the induction variable, variables the loop doesn't change and variables which were already
+ * assigned in the current iteration.
+ */
+static bool is_private_read(const prjm_eval_register_vector_analysis_t* analysis, const PRJM_EVAL_F* var)
+{
+    if (var == analysis->induction_variable || is_assigned(analysis, var))
+    {
+        return true;
+    }
+
+    for (int index = 0; index < analysis->loop.written_count; index++)
+    {
+        if (analysis->loop.written[index] == var)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void mark_assigned(prjm_eval_register_vector_analysis_t* analysis, PRJM_EVAL_F* var, bool conditional)
+{
+    /* The written variables are limited to the same number, so the array can't overflow. */
+    if (!conditional && !is_assigned(analysis, var))
+    {
+        analysis->assigned[analysis->assigned_count++] = var;
+    }
+}
+
+static bool add_vector_access(prjm_eval_register_vector_analysis_t* analysis,
+                              const prjm_eval_exptreenode_t* access,
+                              const prjm_eval_exptreenode_t* index,
+                              bool write)
+{
+    if (analysis->access_count == PRJM_EVAL_REGISTER_MAX_VECTOR_ACCESSES)
+    {
+        return false;
+    }
+
+    prjm_eval_register_vector_access_t* entry = &analysis->accesses[analysis->access_count++];
+    entry->memory_buffer = access->memory_buffer;
+    entry->offset = analysis->offset;
+    entry->indexed = false;
+    entry->write = write;
+
+    const prjm_eval_exptreenode_t* variable = index;
+    const prjm_eval_exptreenode_t* constant = NULL;
+    bool negate = false;
+    if (is_function(index, prjm_eval_func_add) || is_function(index, prjm_eval_func_sub))
+    {
+        variable = index->args[0];
+        constant = index->args[1];
+        negate = is_function(index, prjm_eval_func_sub);
+        if (!negate && is_function(variable, prjm_eval_func_const))
+        {
+            variable = index->args[1];
+            constant = index->args[0];
+        }
+    }
+
+    if (!is_function(variable, prjm_eval_func_var) || variable->var != analysis->induction_variable)
+    {
+        return true;
+    }
+
+    if (constant)
+    {
+        if (!is_cursor_offset(constant) || constant->value != floor(constant->value))
+        {
+            return true;
+        }
+        entry->offset += (int32_t) (negate ? -constant->value : constant->value);
+    }
+    entry->indexed = true;
+    return true;
+}
+
+/**
+ * @brief Checks the evaluation of a node in a loop body considered for vectorization and collects its memory accesses.
+ * @param conditional True if the node isn't executed in every iteration.
+ * @return false if the node prevents the vectorization, e.g. because it reads a variable assigned in a previous
+ *         iteration or calls a function without a batch code representation.
+ */
+static bool check_vector_node(prjm_eval_register_vector_analysis_t* analysis,
+                              const prjm_eval_exptreenode_t* node,
+                              bool conditional)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+
+    if (func == prjm_eval_func_const)
+    {
+        return true;
+    }
+
+    if (func == prjm_eval_func_var)
+    {
+        return is_private_read(analysis, node->var);
+    }
+
+    if (prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        return false;
+    }
+
+    if (func == prjm_eval_func_set ||
+        find_function(assign_functions, PRJM_EVAL_REGISTER_MAP_SIZE(assign_functions), func))
+    {
+        const prjm_eval_exptreenode_t* target = node->args[0];
+        if (is_function(target, prjm_eval_func_mem))
+        {
+            return add_vector_access(analysis, target, target->args[0], true) &&
+                   check_vector_node(analysis, target->args[0], conditional) &&
+                   check_vector_node(analysis, node->args[1], conditional);
+        }
+
+        if (!is_function(target, prjm_eval_func_var) ||
+            (func != prjm_eval_func_set && !is_private_read(analysis, target->var)) ||
+            !check_vector_node(analysis, node->args[1], conditional))
+        {
+            return false;
+        }
+        mark_assigned(analysis, target->var, conditional);
+        return true;
+    }
+
+    if (func == prjm_eval_func_mem_set || func == prjm_eval_func_mem)
+    {
+        if (!add_vector_access(analysis, node, node->args[0], func == prjm_eval_func_mem_set))
+        {
+            return false;
+        }
+    }
+    else if (is_if_function(func))
+    {
+        /* Fused compare-and-select nodes have two compared values in front of the branches. */
+        int condition_count = func == prjm_eval_func_if ? 1 : 2;
+        for (int index = 0; index < condition_count + 2; index++)
+        {
+            if (!check_vector_node(analysis, node->args[index], conditional || index >= condition_count))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    else if (func == prjm_eval_func_boolean_and_op || func == prjm_eval_func_boolean_or_op)
+    {
+        return check_vector_node(analysis, node->args[0], conditional) &&
+               check_vector_node(analysis, node->args[1], true);
+    }
+    else if (func == prjm_eval_func_rand ||
+             (func != prjm_eval_func_execute_list &&
+              func != prjm_eval_func_exec2 &&
+              func != prjm_eval_func_exec3 &&
+              func != prjm_eval_func_mul_add &&
+              !find_function(unary_functions, PRJM_EVAL_REGISTER_MAP_SIZE(unary_functions), func) &&
+              !find_function(binary_functions, PRJM_EVAL_REGISTER_MAP_SIZE(binary_functions), func)))
+    {
+        /* Loops, memory functions, random numbers and tree node calls aren't vectorized. */
+        return false;
+    }
+
+    if (node->args)
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            if (!check_vector_node(analysis, *arg, conditional))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks the top-level statements of a loop body in order, adding the induction variable increments to the
+ * offset of the following memory accesses.
+ */
+static bool check_vector_statements(prjm_eval_register_vector_analysis_t* analysis, const prjm_eval_exptreenode_t* node)
+{
+    PRJM_EVAL_F* var;
+    PRJM_EVAL_F step;
+
+    if (is_function(node, prjm_eval_func_execute_list))
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            if (!check_vector_statements(analysis, *arg))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (get_increment(node, &var, &step) && var == analysis->induction_variable)
+    {
+        analysis->offset += (int32_t) step;
+        return true;
+    }
+
+    return check_vector_node(analysis, node, false);
+}
+
+/**
+ * @brief Computes how many iterations can be executed together without changing the result, based on the distance
+ * of the iterations accessing the same memory location.
+ * @return The number of iterations or 0 if any written buffer is accessed at an index which isn't the induction
+ *         variable plus a constant.
+ */
+static int32_t get_max_vector_lanes(const prjm_eval_register_vector_analysis_t* analysis,
+                                    int32_t stride,
+                                    int32_t* min_offset)
+{
+    int32_t max_lanes = INT32_MAX;
+    bool has_write = false;
+
+    for (int first = 0; first < analysis->access_count; first++)
+    {
+        const prjm_eval_register_vector_access_t* write = &analysis->accesses[first];
+        if (!write->write)
+        {
+            continue;
+        }
+        has_write = true;
+
+        for (int second = 0; second < analysis->access_count; second++)
+        {
+            const prjm_eval_register_vector_access_t* access = &analysis->accesses[second];
+            if (access->memory_buffer != write->memory_buffer)
+            {
+                continue;
+            }
+            if (!access->indexed || !write->indexed)
+            {
+                return 0;
+            }
+
+            /* Index -1 is rounded to 0, so the lowest index is checked before each execution. */
+            if (access->offset < *min_offset)
+            {
+                *min_offset = access->offset;
+            }
+
+            /* Both accesses use the same location in iterations which are distance iterations apart. */
+            int32_t difference = write->offset - access->offset;
+            if (difference != 0 && difference % stride == 0)
+            {
+                int32_t distance = abs(difference / stride);
+                if (distance < max_lanes)
+                {
+                    max_lanes = distance;
+                }
+            }
+        }
+    }
+
+    return has_write ? max_lanes : 0;
+}
+
+static void add_vector_loop(prjm_eval_register_builder_t* builder, prjm_eval_register_vector_loop_t* loop)
+{
+    prjm_eval_register_vector_loop_t** new_loops = realloc(builder->vector_loops,
+                                                           (builder->vector_loop_count + 1) *
+                                                           sizeof(prjm_eval_register_vector_loop_t*));
+    if (!new_loops)
+    {
+        builder->failed = true;
+        prjm_eval_batch_code_destroy(loop->body);
+        free(loop);
+        return;
+    }
+
+    builder->vector_loops = new_loops;
+    builder->vector_loops[builder->vector_loop_count++] = loop;
+}
+
+/**
+ * @brief Creates the vectorized version of a loop body whose iterations are independent, except for an induction
+ * variable and memory accesses at a known distance.
+ * @return The vectorized loop or NULL if the body can't be vectorized.
+ */
+static prjm_eval_register_vector_loop_t* create_vector_loop(prjm_eval_register_builder_t* builder,
+                                                            prjm_eval_exptreenode_t* body)
+{
+    prjm_eval_register_vector_analysis_t analysis = { 0 };
+
+    collect_increments(&analysis.loop, body);
+    if (analysis.loop.variable_count != 1 ||
+        !check_statement_writes(&analysis.loop, body) ||
+        analysis.loop.written_count < 0 ||
+        !analysis.loop.variables[0].valid ||
+        analysis.loop.variables[0].stride == 0)
+    {
+        return NULL;
+    }
+
+    analysis.induction_variable = analysis.loop.variables[0].var;
+    if (!check_vector_statements(&analysis, body))
+    {
+        return NULL;
+    }
+
+    /* Variables which are only assigned in some iterations would keep the value of the last of these iterations. */
+    for (int index = 0; index < analysis.loop.written_count; index++)
+    {
+        if (!is_assigned(&analysis, analysis.loop.written[index]))
+        {
+            return NULL;
+        }
+    }
+
+    int32_t stride = (int32_t) analysis.loop.variables[0].stride;
+    int32_t min_offset = INT32_MAX;
+    int32_t max_lanes = get_max_vector_lanes(&analysis, stride, &min_offset);
+    if (max_lanes < PRJM_EVAL_REGISTER_MIN_VECTOR_LANES)
+    {
+        return NULL;
+    }
+
+    prjm_eval_register_vector_loop_t* loop = calloc(1, sizeof(prjm_eval_register_vector_loop_t));
+    if (!loop)
+    {
+        builder->failed = true;
+        return NULL;
+    }
+
+    loop->body = prjm_eval_batch_code_create(body);
+    if (!loop->body)
+    {
+        builder->failed = true;
+        free(loop);
+        return NULL;
+    }
+
+    loop->induction_variable = analysis.induction_variable;
+    loop->stride = analysis.loop.variables[0].stride;
+    loop->max_lanes = max_lanes;
+    loop->min_offset = min_offset;
+
+    add_vector_loop(builder, loop);
+    return builder->failed ? NULL : loop;
+}
+
+static int32_t compile_loop(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node, bool keep_result)
+{
+    int32_t mark = builder->temp_top;
+    int32_t count = compile_value(builder, node->args[0]);
+    builder->temp_top = mark;
+
+    /* If the body is never executed, the loop returns the count value. */
+    int32_t result = alloc_temp(builder);
+    int32_t counter = alloc_temp(builder);
+    emit(builder, PRJM_EVAL_REG_LOOP_INIT, counter, count, 0);
+    if (keep_result)
+    {
+        emit_move(builder, result, count);
+    }
+
+    prjm_eval_register_vector_loop_t* vector_loop = NULL;
+    if (builder->vectorize_loops)
+    {
+        vector_loop = create_vector_loop(builder, node->args[1]);
+    }
+    if (vector_loop)
+    {
+        int32_t index = emit(builder, PRJM_EVAL_REG_VECTOR_LOOP, 0, counter, 0);
+        if (index >= 0)
+        {
+            builder->code[index].vector_loop = vector_loop;
+        }
+    }
+
+    int32_t first_cursor = builder->cursor_count;
+    int32_t cursor_count = builder->use_cursors ? add_loop_cursors(builder, node->args[1]) : 0;
+    if (cursor_count > 0)
+    {
+        emit_cursor(builder, PRJM_EVAL_REG_CURSOR_RESET, first_cursor, 0, 0, cursor_count);
+    }
+
+    int32_t loop_start = mark_label(builder);
+    int32_t jump_to_end = emit(builder, PRJM_EVAL_REG_LOOP_NEXT, 0, counter, 0);
+
+    if (keep_result)
+    {
+        emit_move(builder, result, compile_value(builder, node->args[1]));
+    }
+    else
+    {
+        compile_effect(builder, node->args[1]);
+    }
+    builder->temp_top = mark + 2;
+
+    set_target(builder, emit(builder, PRJM_EVAL_REG_JUMP, 0, 0, 0), loop_start);
+    set_target(builder, jump_to_end, mark_label(builder));
+
+    builder->temp_top = mark + 1;
+    return result;
+}
+
+static int32_t compile_while(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    int32_t mark = builder->temp_top;
+    int32_t counter = alloc_temp(builder);
+    emit_move(builder, counter, constant_slot(builder, MAX_LOOP_COUNT));
+
+    int32_t loop_start = mark_label(builder);
+    int32_t condition = compile_value(builder, node->args[0]);
+    set_target(builder, emit(builder, PRJM_EVAL_REG_WHILE_NEXT, 0, condition, counter), loop_start);
+
+    builder->temp_top = mark;
+
+    /* The loop returns the last condition value. */
+    if (!is_temp(builder, condition))
+    {
+        return condition;
+    }
+
+    int32_t result = alloc_temp(builder);
+    emit_move(builder, result, condition);
+    return result;
+}
+
+static int32_t compile_short_circuit(prjm_eval_register_builder_t* builder,
+                                     prjm_eval_exptreenode_t* node,
+                                     prjm_eval_register_opcode_t test_opcode)
+{
+    int32_t mark = builder->temp_top;
+    int32_t first = compile_value(builder, node->args[0]);
+    builder->temp_top = mark;
+
+    int32_t dst = alloc_temp(builder);
+    int32_t jump_to_end = emit(builder, test_opcode, dst, first, 0);
+
+    /* Comparisons and other boolean operators already return the truth value. */
+    int32_t second = compile_value(builder, node->args[1]);
+    if (prjm_eval_exptreenode_returns_boolean(node->args[1]))
+    {
+        emit_move(builder, dst, second);
+    }
+    else
+    {
+        emit(builder, PRJM_EVAL_REG_BOOL, dst, second, 0);
+    }
+    set_target(builder, jump_to_end, mark_label(builder));
+
+    builder->temp_top = mark + 1;
+    return dst;
+}
+
+/**
+ * @brief Compiles an assignment to a memory location, used for "megabuf(index) = value" and fused mem_set nodes.
+ * @param access The assigned mem node or the mem_set node, which selects the memory buffer and cursor.
+ */
+static int32_t compile_memory_store(prjm_eval_register_builder_t* builder,
+                                    prjm_eval_exptreenode_t* access,
+                                    prjm_eval_exptreenode_t* index_node,
+                                    prjm_eval_exptreenode_t* value)
+{
+    int32_t cursor = take_cursor(builder, access);
+
+    /* The index is evaluated first, so it must not be changed by the value expression. */
+    if (!prjm_eval_exptreenode_has_side_effects(value))
+    {
+        int32_t index = compile_value(builder, index_node);
+        int32_t result = compile_value(builder, value);
+        if (cursor >= 0)
+        {
+            emit_cursor(builder, PRJM_EVAL_REG_MEM_STORE_CURSOR, cursor, 0, index, result);
+        }
+        else
+        {
+            emit_memory(builder, PRJM_EVAL_REG_MEM_STORE, access->memory_buffer, 0, index, result);
+        }
+        return result;
+    }
+
+    int32_t ref = builder->ref_count++;
+    int32_t index = compile_value(builder, index_node);
+    if (cursor >= 0)
+    {
+        emit_cursor(builder, PRJM_EVAL_REG_MEM_REF_CURSOR, cursor, ref, index, alloc_temp(builder));
+    }
+    else
+    {
+        emit_memory(builder, PRJM_EVAL_REG_MEM_REF, access->memory_buffer, ref, index, alloc_temp(builder));
+    }
+    int32_t result = compile_value(builder, value);
+    emit(builder, PRJM_EVAL_REG_STORE_REF, ref, result, 0);
+    return result;
+}
+
+static int32_t compile_set(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    prjm_eval_exptreenode_t* target = node->args[0];
+    prjm_eval_exptreenode_t* value = node->args[1];
+
+    if (target->func == prjm_eval_func_var)
+    {
+        int32_t slot = variable_slot(builder, target->var);
+        int32_t mark = builder->temp_top;
+        int32_t result = compile_value(builder, value);
+        if (!retarget_result(builder, result, slot))
+        {
+            emit_move(builder, slot, result);
+        }
+        builder->temp_top = mark;
+        return slot;
+    }
+
+    if (target->func == prjm_eval_func_mem)
+    {
+        return compile_memory_store(builder, target, target->args[0], value);
+    }
+
+    int32_t ref = builder->ref_count++;
+    compile_ref(builder, target, ref);
+    int32_t result = compile_value(builder, value);
+    emit(builder, PRJM_EVAL_REG_STORE_REF, ref, result, 0);
+    return result;
+}
+
+static int32_t compile_compound_assignment(prjm_eval_register_builder_t* builder,
+                                           prjm_eval_exptreenode_t* node,
+                                           prjm_eval_register_opcode_t opcode)
+{
+    prjm_eval_exptreenode_t* target = node->args[0];
+
+    if (target->func == prjm_eval_func_var)
+    {
+        int32_t slot = variable_slot(builder, target->var);
+        int32_t mark = builder->temp_top;
+        emit(builder, opcode, slot, slot, compile_value(builder, node->args[1]));
+        builder->temp_top = mark;
+        return slot;
+    }
+
+    int32_t ref = builder->ref_count++;
+    compile_ref(builder, target, ref);
+    int32_t value = compile_value(builder, node->args[1]);
+    int32_t result = alloc_temp(builder);
+    emit(builder, PRJM_EVAL_REG_LOAD_REF, result, ref, 0);
+    emit(builder, opcode, result, result, value);
+    emit(builder, PRJM_EVAL_REG_STORE_REF, ref, result, 0);
+    return result;
+}
+
+/**
+ * @brief Compiles a node and returns the slot containing its value.
+ * Temporary slots used for the result stay allocated until the caller resets the temporary top.
+ */
+static int32_t compile_value(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    assert(node);
+    assert(node->func);
+
+    if (builder->failed)
+    {
+        return 0;
+    }
+
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+    const prjm_eval_register_func_map_t* mapping;
+
+    if (func == prjm_eval_func_const)
+    {
+        return constant_slot(builder, node->value);
+    }
+
+    if (func == prjm_eval_func_var)
+    {
+        return variable_slot(builder, node->var);
+    }
+
+    /* The tree function passes result locations between its arguments, which can't be expressed with slots. */
+    if (prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        return compile_call_node(builder, node);
+    }
+
+    if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        prjm_eval_exptreenode_t** arg = node->args;
+        for (; *(arg + 1); arg++)
+        {
+            compile_effect(builder, *arg);
+        }
+        return compile_value(builder, *arg);
+    }
+
+    if (is_if_function(func))
+    {
+        return compile_if(builder, node);
+    }
+
+    if (func == prjm_eval_func_execute_loop)
+    {
+        return compile_loop(builder, node, true);
+    }
+
+    if (func == prjm_eval_func_execute_while)
+    {
+        return compile_while(builder, node);
+    }
+
+    if (func == prjm_eval_func_boolean_and_op)
+    {
+        return compile_short_circuit(builder, node, PRJM_EVAL_REG_AND_TEST);
+    }
+
+    if (func == prjm_eval_func_boolean_or_op)
+    {
+        return compile_short_circuit(builder, node, PRJM_EVAL_REG_OR_TEST);
+    }
+
+    if (func == prjm_eval_func_set)
+    {
+        return compile_set(builder, node);
+    }
+
+    if ((mapping = find_function(assign_functions, PRJM_EVAL_REGISTER_MAP_SIZE(assign_functions), func)))
+    {
+        return compile_compound_assignment(builder, node, mapping->opcode);
+    }
+
+    if (func == prjm_eval_func_mem_set)
+    {
+        return compile_memory_store(builder, node, node->args[0], node->args[1]);
+    }
+
+    if (func == prjm_eval_func_mul_add)
+    {
+        /* The product is calculated before the addend is evaluated. */
+        int32_t mark = builder->temp_top;
+        int32_t args[2];
+        compile_args(builder, node, 2, args);
+        builder->temp_top = mark;
+        int32_t dst = alloc_temp(builder);
+        emit(builder, PRJM_EVAL_REG_MUL, dst, args[0], args[1]);
+        emit(builder, PRJM_EVAL_REG_ADD, dst, dst, compile_value(builder, node->args[2]));
+        builder->temp_top = mark + 1;
+        return dst;
+    }
+
+    if (func == prjm_eval_func_mem)
+    {
+        int32_t cursor = take_cursor(builder, node);
+        int32_t mark = builder->temp_top;
+        int32_t index = compile_value(builder, node->args[0]);
+        builder->temp_top = mark;
+        int32_t dst = alloc_temp(builder);
+        if (cursor >= 0)
+        {
+            emit_cursor(builder, PRJM_EVAL_REG_MEM_LOAD_CURSOR, cursor, dst, index, 0);
+        }
+        else
+        {
+            emit_memory(builder, PRJM_EVAL_REG_MEM_LOAD, node->memory_buffer, dst, index, 0);
+        }
+        return dst;
+    }
+
+    if (func == prjm_eval_func_freembuf)
+    {
+        int32_t index = compile_value(builder, node->args[0]);
+        emit_memory(builder, PRJM_EVAL_REG_FREEMBUF, node->memory_buffer, 0, index, 0);
+        return index;
+    }
+
+    /* The result references the destination argument, which may be overwritten by the function itself. */
+    if ((func == prjm_eval_func_memcpy || func == prjm_eval_func_memset) &&
+        node->args[0]->func != prjm_eval_func_var &&
+        !prjm_eval_exptreenode_returns_value(node->args[0]))
+    {
+        return compile_call_node(builder, node);
+    }
+
+    if (func == prjm_eval_func_memcpy || func == prjm_eval_func_memset)
+    {
+        int32_t args[3];
+        compile_args(builder, node, 3, args);
+        emit_memory(builder,
+                    func == prjm_eval_func_memcpy ? PRJM_EVAL_REG_MEMCPY : PRJM_EVAL_REG_MEMSET,
+                    node->memory_buffer, args[0], args[1], args[2]);
+        return args[0];
+    }
+
+    if ((mapping = find_function(unary_functions, PRJM_EVAL_REGISTER_MAP_SIZE(unary_functions), func)))
+    {
+        int32_t mark = builder->temp_top;
+        int32_t arg;
+        compile_args(builder, node, 1, &arg);
+        builder->temp_top = mark;
+        int32_t dst = alloc_temp(builder);
+        emit(builder, mapping->opcode, dst, arg, 0);
+        return dst;
+    }
+
+    if ((mapping = find_function(binary_functions, PRJM_EVAL_REGISTER_MAP_SIZE(binary_functions), func)))
+    {
+        int32_t mark = builder->temp_top;
+        int32_t args[2];
+        compile_args(builder, node, 2, args);
+        builder->temp_top = mark;
+        int32_t dst = alloc_temp(builder);
+        emit(builder, mapping->opcode, dst, args[0], args[1]);
+        return dst;
+    }
+
+    /* No register code equivalent, let the tree node do the work. */
+    return compile_call_node(builder, node);
+}
+
+/**
+ * @brief Compiles a node whose result isn't used.
+ */
+static void compile_effect(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node)
+{
+    int32_t mark = builder->temp_top;
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+
+    if (prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        compile_call_node(builder, node);
+    }
+    else if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        for (prjm_eval_exptreenode_t** arg = node->args; *arg; arg++)
+        {
+            compile_effect(builder, *arg);
+        }
+    }
+    else if (is_if_function(func))
+    {
+        prjm_eval_exptreenode_t** branches;
+        int32_t condition = compile_condition(builder, node, &branches);
+        builder->temp_top = mark;
+        int32_t jump_to_else = emit(builder, PRJM_EVAL_REG_JUMP_IF_ZERO, 0, condition, 0);
+        compile_effect(builder, branches[0]);
+        int32_t jump_to_end = emit(builder, PRJM_EVAL_REG_JUMP, 0, 0, 0);
+        set_target(builder, jump_to_else, mark_label(builder));
+        compile_effect(builder, branches[1]);
+        set_target(builder, jump_to_end, mark_label(builder));
+    }
+    else if (func == prjm_eval_func_execute_loop)
+    {
+        compile_loop(builder, node, false);
+    }
+    else
+    {
+        compile_value(builder, node);
+    }
+
+    builder->temp_top = mark;
+}
+
+/**
+ * @brief Compiles a node as an lvalue and stores the returned reference in the given reference register.
+ * Temporary slots the reference may point to stay allocated until the caller resets the temporary top.
+ */
+static void compile_ref(prjm_eval_register_builder_t* builder, prjm_eval_exptreenode_t* node, int32_t ref)
+{
+    if (builder->failed)
+    {
+        return;
+    }
+
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+    const prjm_eval_register_func_map_t* mapping;
+
+    if (func == prjm_eval_func_var)
+    {
+        emit(builder, PRJM_EVAL_REG_SLOT_REF, ref, variable_slot(builder, node->var), 0);
+    }
+    else if (prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        compile_call_node_ref(builder, node, ref);
+    }
+    else if (func == prjm_eval_func_mem)
+    {
+        int32_t cursor = take_cursor(builder, node);
+        int32_t index = compile_value(builder, node->args[0]);
+        if (cursor >= 0)
+        {
+            emit_cursor(builder, PRJM_EVAL_REG_MEM_REF_CURSOR, cursor, ref, index, alloc_temp(builder));
+        }
+        else
+        {
+            emit_memory(builder, PRJM_EVAL_REG_MEM_REF, node->memory_buffer, ref, index, alloc_temp(builder));
+        }
+    }
+    else if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2 || func == prjm_eval_func_exec3)
+    {
+        prjm_eval_exptreenode_t** arg = node->args;
+        for (; *(arg + 1); arg++)
+        {
+            compile_effect(builder, *arg);
+        }
+        compile_ref(builder, *arg, ref);
+    }
+    else if (is_if_function(func))
+    {
+        prjm_eval_exptreenode_t** branches;
+        int32_t mark = builder->temp_top;
+        int32_t condition = compile_condition(builder, node, &branches);
+        builder->temp_top = mark;
+        int32_t jump_to_else = emit(builder, PRJM_EVAL_REG_JUMP_IF_ZERO, 0, condition, 0);
+
+        /* Only one branch is executed, so both can use the same temporary slots. */
+        compile_ref(builder, branches[0], ref);
+        int32_t then_top = builder->temp_top;
+        builder->temp_top = mark;
+        int32_t jump_to_end = emit(builder, PRJM_EVAL_REG_JUMP, 0, 0, 0);
+
+        set_target(builder, jump_to_else, mark_label(builder));
+        compile_ref(builder, branches[1], ref);
+        set_target(builder, jump_to_end, mark_label(builder));
+
+        if (then_top > builder->temp_top)
+        {
+            builder->temp_top = then_top;
+        }
+    }
+    else if (func == prjm_eval_func_execute_loop)
+    {
+        compile_ref(builder, node->args[0], ref);
+        int32_t count = alloc_temp(builder);
+        emit(builder, PRJM_EVAL_REG_LOAD_REF, count, ref, 0);
+        int32_t counter = alloc_temp(builder);
+        emit(builder, PRJM_EVAL_REG_LOOP_INIT, counter, count, 0);
+
+        int32_t loop_start = mark_label(builder);
+        int32_t jump_to_end = emit(builder, PRJM_EVAL_REG_LOOP_NEXT, 0, counter, 0);
+        compile_ref(builder, node->args[1], ref);
+        set_target(builder, emit(builder, PRJM_EVAL_REG_JUMP, 0, 0, 0), loop_start);
+        set_target(builder, jump_to_end, mark_label(builder));
+    }
+    else if (func == prjm_eval_func_execute_while)
+    {
+        int32_t counter = alloc_temp(builder);
+        emit_move(builder, counter, constant_slot(builder, MAX_LOOP_COUNT));
+
+        int32_t loop_start = mark_label(builder);
+        compile_ref(builder, node->args[0], ref);
+        int32_t condition = alloc_temp(builder);
+        emit(builder, PRJM_EVAL_REG_LOAD_REF, condition, ref, 0);
+        set_target(builder, emit(builder, PRJM_EVAL_REG_WHILE_NEXT, 0, condition, counter), loop_start);
+    }
+    else if (func == prjm_eval_func_set && node->args[0]->func == prjm_eval_func_var)
+    {
+        emit(builder, PRJM_EVAL_REG_SLOT_REF, ref, compile_set(builder, node), 0);
+    }
+    else if (func == prjm_eval_func_set)
+    {
+        compile_ref(builder, node->args[0], ref);
+        emit(builder, PRJM_EVAL_REG_STORE_REF, ref, compile_value(builder, node->args[1]), 0);
+    }
+    else if ((mapping = find_function(assign_functions, PRJM_EVAL_REGISTER_MAP_SIZE(assign_functions), func)))
+    {
+        if (node->args[0]->func == prjm_eval_func_var)
+        {
+            emit(builder, PRJM_EVAL_REG_SLOT_REF, ref, compile_compound_assignment(builder, node, mapping->opcode), 0);
+        }
+        else
+        {
+            compile_ref(builder, node->args[0], ref);
+            int32_t value = compile_value(builder, node->args[1]);
+            int32_t result = alloc_temp(builder);
+            emit(builder, PRJM_EVAL_REG_LOAD_REF, result, ref, 0);
+            emit(builder, mapping->opcode, result, result, value);
+            emit(builder, PRJM_EVAL_REG_STORE_REF, ref, result, 0);
+        }
+    }
+    else if (func == prjm_eval_func_freembuf)
+    {
+        compile_ref(builder, node->args[0], ref);
+        int32_t index = alloc_temp(builder);
+        emit(builder, PRJM_EVAL_REG_LOAD_REF, index, ref, 0);
+        emit_memory(builder, PRJM_EVAL_REG_FREEMBUF, node->memory_buffer, 0, index, 0);
+    }
+    else if (func == prjm_eval_func_memcpy || func == prjm_eval_func_memset ||
+             !prjm_eval_exptreenode_returns_value(node))
+    {
+        compile_call_node_ref(builder, node, ref);
+    }
+    else
+    {
+        /* Plain values are written into a temporary slot, assignments to it have no effect. */
+        int32_t value = compile_value(builder, node);
+        if (!is_temp(builder, value))
+        {
+            int32_t temp = alloc_temp(builder);
+            emit_move(builder, temp, value);
+            value = temp;
+        }
+        emit(builder, PRJM_EVAL_REG_SLOT_REF, ref, value, 0);
+    }
+}
+
+static void destroy_vector_loops(prjm_eval_register_vector_loop_t** loops, int32_t count)
+{
+    for (int32_t index = 0; index < count; index++)
+    {
+        prjm_eval_batch_code_destroy(loops[index]->body);
+        free(loops[index]);
+    }
+    free(loops);
+}
+
+prjm_eval_register_code_t* prjm_eval_register_code_create(prjm_eval_exptreenode_t* tree, int options)
+{
+    if (!tree)
+    {
+        return NULL;
+    }
+
+    prjm_eval_register_builder_t builder = { 0 };
+    builder.label = -1;
+    builder.use_cursors = (options & PRJM_EVAL_REGISTER_USE_CURSORS) != 0;
+    builder.vectorize_loops = (options & PRJM_EVAL_REGISTER_VECTORIZE_LOOPS) != 0;
+
+    collect_slots(&builder, tree);
+
+    for (int32_t index = 0; index < builder.variable_count; index++)
+    {
+        builder.variables[index].slot = builder.constant_count + index;
+    }
+    builder.temp_base = builder.constant_count + builder.variable_count;
+    builder.temp_top = builder.temp_base;
+    builder.frame_size = builder.temp_base;
+
+    int32_t result = compile_value(&builder, tree);
+    emit(&builder, PRJM_EVAL_REG_HALT, 0, 0, 0);
+
+    prjm_eval_register_code_t* code = NULL;
+    if (!builder.failed)
+    {
+        code = calloc(1, sizeof(prjm_eval_register_code_t));
+    }
+
+    if (code)
+    {
+        code->instructions = builder.code;
+        code->instruction_count = builder.length;
+        code->variables = builder.variables;
+        code->variable_count = builder.variable_count;
+        code->constant_count = builder.constant_count;
+        code->frame_size = builder.frame_size;
+        code->ref_count = builder.ref_count;
+        code->cursors = builder.cursors;
+        code->cursor_count = builder.cursor_count;
+        code->vector_loops = builder.vector_loops;
+        code->vector_loop_count = builder.vector_loop_count;
+        code->result = result;
+        code->frame = calloc(builder.frame_size + 1, sizeof(PRJM_EVAL_F));
+        code->refs = calloc(builder.ref_count + 1, sizeof(PRJM_EVAL_F*));
+
+        if (!code->frame || !code->refs)
+        {
+            prjm_eval_register_code_destroy(code);
+            code = NULL;
+        }
+        else
+        {
+            memcpy(code->frame, builder.constants, builder.constant_count * sizeof(PRJM_EVAL_F));
+        }
+    }
+    else
+    {
+        free(builder.code);
+        free(builder.variables);
+        free(builder.cursors);
+        destroy_vector_loops(builder.vector_loops, builder.vector_loop_count);
+    }
+
+    free(builder.constants);
+    free(builder.cursor_nodes);
+
+    return code;
+}
+
+void prjm_eval_register_code_destroy(prjm_eval_register_code_t* code)
+{
+    if (!code)
+    {
+        return;
+    }
+
+    free(code->instructions);
+    free(code->variables);
+    free(code->frame);
+    free(code->refs);
+    free(code->cursors);
+    destroy_vector_loops(code->vector_loops, code->vector_loop_count);
+    free(code);
+}
+
+void prjm_eval_register_code_load_variables(prjm_eval_register_code_t* code)
+{
+    for (int32_t index = 0; index < code->variable_count; index++)
+    {
+        code->frame[code->variables[index].slot] = *code->variables[index].var;
+    }
+}
+
+void prjm_eval_register_code_store_variables(prjm_eval_register_code_t* code)
+{
+    for (int32_t index = 0; index < code->variable_count; index++)
+    {
+        *code->variables[index].var = code->frame[code->variables[index].slot];
+    }
+}
+
+/**
+ * @brief Replaces a reference to a context variable with a reference to its frame slot.
+ */
+static PRJM_EVAL_F* frame_reference(prjm_eval_register_code_t* code, PRJM_EVAL_F* ref)
+{
+    for (int32_t index = 0; index < code->variable_count; index++)
+    {
+        if (code->variables[index].var == ref)
+        {
+            return &code->frame[code->variables[index].slot];
+        }
+    }
+
+    return ref;
+}
+
+/**
+ * @brief Returns the memory address for the index value, advancing the cursor to the next access.
+ */
+static inline PRJM_EVAL_F* cursor_address(prjm_eval_register_cursor_t* cursor, PRJM_EVAL_F index_value)
+{
+    PRJM_EVAL_F* address;
+
+    if (cursor->remaining > 0 && index_value == cursor->index)
+    {
+        address = cursor->address;
+        cursor->remaining--;
+    }
+    else
+    {
+        /* Only integer indices are followed, so the expected index values are exact. */
+        int32_t index = prjm_eval_math_mem_index(index_value);
+        address = prjm_eval_memory_allocate(cursor->memory_buffer, index);
+        cursor->remaining = address && index_value == (PRJM_EVAL_F) index
+                            ? prjm_eval_memory_block_run(index, cursor->stride)
+                            : 0;
+    }
+
+    if (cursor->remaining > 0)
+    {
+        cursor->address = address + cursor->stride;
+        cursor->index = index_value + cursor->index_stride;
+    }
+
+    return address;
+}
+
+/**
+ * @brief Executes all but the last iteration of a vectorized loop in batches, if the current values allow it.
+ * The last iteration is left to the loop instructions, which also compute the loop's return value. Expects the
+ * variables to be stored in the context.
+ * @param count The number of remaining iterations.
+ * @return The number of executed iterations.
+ */
+static PRJM_EVAL_F execute_vector_loop(prjm_eval_register_vector_loop_t* loop, PRJM_EVAL_F count)
+{
+    int32_t iterations = (int32_t) count - 1;
+    PRJM_EVAL_F start = *loop->induction_variable;
+    if (iterations < PRJM_EVAL_REGISTER_MIN_VECTOR_ITERATIONS || start != floor(start))
+    {
+        return 0;
+    }
+
+    /* The memory locations of different indices must not overlap. */
+    PRJM_EVAL_F lowest_index = loop->stride > 0 ? start : start + (iterations - 1) * loop->stride;
+    if (lowest_index + loop->min_offset < 0)
+    {
+        return 0;
+    }
+
+    /* Full batches are executed in groups of PRJM_EVAL_BATCH_WIDTH lanes, one after another. */
+    int32_t batch_size = loop->max_lanes >= PRJM_EVAL_BATCH_WIDTH ? PRJM_EVAL_REGISTER_VECTOR_LOOP_LANES
+                                                                   : loop->max_lanes;
+    projectm_eval_lane_variable lane_variable = { loop->induction_variable, loop->lane_values };
+
+    for (int32_t first = 0; first < iterations; first += batch_size)
+    {
+        int32_t lane_count = iterations - first < batch_size ? iterations - first : batch_size;
+        for (int32_t lane = 0; lane < lane_count; lane++)
+        {
+            loop->lane_values[lane] = start + (first + lane) * loop->stride;
+        }
+        prjm_eval_batch_code_execute(loop->body, PROJECTM_EVAL_PRECISION_DEFAULT, &lane_variable, 1, lane_count, NULL);
+    }
+
+    *loop->induction_variable = start + iterations * loop->stride;
+    return iterations;
+}
+
+void prjm_eval_register_code_execute_instruction(prjm_eval_register_code_t* code,
+                                                 const prjm_eval_register_instruction_t* ip)
+{
+    PRJM_EVAL_F* frame = code->frame;
+    PRJM_EVAL_F** refs = code->refs;
+
+    switch (ip->opcode)
+    {
+        case PRJM_EVAL_REG_MOV:
+            frame[ip->dst] = frame[ip->src1];
+            break;
+
+        case PRJM_EVAL_REG_CALL_NODE:
+        {
+            /* The tree node accesses the context variables directly. */
+            prjm_eval_register_code_store_variables(code);
+            PRJM_EVAL_F value = ip->node->value_func(ip->node);
+            prjm_eval_register_code_load_variables(code);
+            frame[ip->dst] = value;
+            break;
+        }
+
+        case PRJM_EVAL_REG_CALL_NODE_REF:
+        {
+            PRJM_EVAL_F* value_ptr = &frame[ip->src1];
+            *value_ptr = .0;
+            prjm_eval_register_code_store_variables(code);
+            ip->node->func(ip->node, &value_ptr);
+            prjm_eval_register_code_load_variables(code);
+            refs[ip->dst] = frame_reference(code, value_ptr);
+            break;
+        }
+
+        case PRJM_EVAL_REG_VECTOR_LOOP:
+            /* The batch code accesses the context variables directly. */
+            prjm_eval_register_code_store_variables(code);
+            frame[ip->src1] -= execute_vector_loop(ip->vector_loop, frame[ip->src1]);
+            prjm_eval_register_code_load_variables(code);
+            break;
+
+        case PRJM_EVAL_REG_SLOT_REF:
+            refs[ip->dst] = &frame[ip->src1];
+            break;
+
+        case PRJM_EVAL_REG_LOAD_REF:
+            frame[ip->dst] = *refs[ip->src1];
+            break;
+
+        case PRJM_EVAL_REG_STORE_REF:
+            *refs[ip->dst] = frame[ip->src1];
+            break;
+
+        case PRJM_EVAL_REG_MEM_LOAD:
+        {
+            PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                              prjm_eval_math_mem_index(frame[ip->src1]));
+            frame[ip->dst] = mem_addr ? *mem_addr : .0;
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_STORE:
+        {
+            PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                              prjm_eval_math_mem_index(frame[ip->src1]));
+            if (mem_addr)
+            {
+                *mem_addr = frame[ip->src2];
+            }
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_REF:
+        {
+            PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                              prjm_eval_math_mem_index(frame[ip->src1]));
+            if (!mem_addr)
+            {
+                mem_addr = &frame[ip->src2];
+                *mem_addr = .0;
+            }
+            refs[ip->dst] = mem_addr;
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_LOAD_CURSOR:
+        {
+            PRJM_EVAL_F* mem_addr = cursor_address(&code->cursors[ip->cursor], frame[ip->src1]);
+            frame[ip->dst] = mem_addr ? *mem_addr : .0;
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_STORE_CURSOR:
+        {
+            PRJM_EVAL_F* mem_addr = cursor_address(&code->cursors[ip->cursor], frame[ip->src1]);
+            if (mem_addr)
+            {
+                *mem_addr = frame[ip->src2];
+            }
+            break;
+        }
+
+        case PRJM_EVAL_REG_MEM_REF_CURSOR:
+        {
+            PRJM_EVAL_F* mem_addr = cursor_address(&code->cursors[ip->cursor], frame[ip->src1]);
+            if (!mem_addr)
+            {
+                mem_addr = &frame[ip->src2];
+                *mem_addr = .0;
+            }
+            refs[ip->dst] = mem_addr;
+            break;
+        }
+
+        case PRJM_EVAL_REG_CURSOR_RESET:
+            for (int32_t index = 0; index < ip->src2; index++)
+            {
+                code->cursors[ip->cursor + index].remaining = 0;
+            }
+            break;
+
+        case PRJM_EVAL_REG_FREEMBUF:
+            prjm_eval_memory_free_block(ip->memory_buffer, prjm_eval_math_mem_index(frame[ip->src1]));
+            break;
+
+        case PRJM_EVAL_REG_MEMCPY:
+            prjm_eval_memory_copy(ip->memory_buffer, &frame[ip->dst], &frame[ip->src1], &frame[ip->src2]);
+            break;
+
+        case PRJM_EVAL_REG_MEMSET:
+            prjm_eval_memory_set(ip->memory_buffer, &frame[ip->dst], &frame[ip->src1], &frame[ip->src2]);
+            break;
+
+#define PRJM_EVAL_REGISTER_UNARY_CASE(name, expr) \
+        case PRJM_EVAL_REG_ ## name:              \
+        {                                         \
+            PRJM_EVAL_F a = frame[ip->src1];      \
+            frame[ip->dst] = (expr);              \
+            break;                                \
+        }
+
+#define PRJM_EVAL_REGISTER_BINARY_CASE(name, expr) \
+        case PRJM_EVAL_REG_ ## name:               \
+        {                                          \
+            PRJM_EVAL_F a = frame[ip->src1];       \
+            PRJM_EVAL_F b = frame[ip->src2];       \
+            frame[ip->dst] = (expr);               \
+            break;                                 \
+        }
+
+        PRJM_EVAL_REGISTER_UNARY_OPERATIONS(PRJM_EVAL_REGISTER_UNARY_CASE)
+        PRJM_EVAL_REGISTER_BINARY_OPERATIONS(PRJM_EVAL_REGISTER_BINARY_CASE)
+
+#undef PRJM_EVAL_REGISTER_UNARY_CASE
+#undef PRJM_EVAL_REGISTER_BINARY_CASE
+
+        default:
+            /* Control flow instructions can't be executed on their own. */
+            assert(false);
+            break;
+    }
+}
+
+/*
+ * Instruction dispatch, see Bytecode.c. GCC and Clang use computed gotos, other compilers use a switch statement.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define REGISTER_DISPATCH_BEGIN goto *dispatch_table[ip->opcode];
+#define REGISTER_DISPATCH_END
+#define REGISTER_CASE(name) op_ ## name:
+#define REGISTER_DISPATCH() goto *dispatch_table[ip->opcode]
+#else
+#define REGISTER_DISPATCH_BEGIN for (;;) { switch (ip->opcode) {
+#define REGISTER_DISPATCH_END default: break; } }
+#define REGISTER_CASE(name) case PRJM_EVAL_REG_ ## name:
+#define REGISTER_DISPATCH() continue
+#endif
+
+#define REGISTER_NEXT() \
+    ip++;               \
+    REGISTER_DISPATCH()
+
+#define REGISTER_JUMP(target) \
+    ip = instructions + (target); \
+    REGISTER_DISPATCH()
+
+#define REGISTER_UNARY(name, expr)  \
+    REGISTER_CASE(name)             \
+    {                               \
+        PRJM_EVAL_F a = frame[ip->src1]; \
+        frame[ip->dst] = (expr);    \
+        REGISTER_NEXT();            \
+    }
+
+#define REGISTER_BINARY(name, expr) \
+    REGISTER_CASE(name)             \
+    {                               \
+        PRJM_EVAL_F a = frame[ip->src1]; \
+        PRJM_EVAL_F b = frame[ip->src2]; \
+        frame[ip->dst] = (expr);    \
+        REGISTER_NEXT();            \
+    }
+
+PRJM_EVAL_F prjm_eval_register_code_execute(prjm_eval_register_code_t* code)
+{
+    assert(code);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PRJM_EVAL_REGISTER_LABEL(name) &&op_ ## name,
+    static const void* dispatch_table[] = {
+        PRJM_EVAL_REGISTER_OPCODES(PRJM_EVAL_REGISTER_LABEL)
+    };
+#undef PRJM_EVAL_REGISTER_LABEL
+#endif
+
+    const prjm_eval_register_instruction_t* instructions = code->instructions;
+    const prjm_eval_register_instruction_t* ip = instructions;
+    PRJM_EVAL_F* frame = code->frame;
+    PRJM_EVAL_F** refs = code->refs;
+
+    prjm_eval_register_code_load_variables(code);
+
+    REGISTER_DISPATCH_BEGIN
+
+    REGISTER_CASE(HALT)
+    {
+        PRJM_EVAL_F result = frame[code->result];
+        prjm_eval_register_code_store_variables(code);
+        return result;
+    }
+
+    REGISTER_CASE(MOV)
+        frame[ip->dst] = frame[ip->src1];
+        REGISTER_NEXT();
+
+    REGISTER_CASE(JUMP)
+        REGISTER_JUMP(ip->target);
+
+    REGISTER_CASE(JUMP_IF_ZERO)
+        if (frame[ip->src1] == 0)
+        {
+            REGISTER_JUMP(ip->target);
+        }
+        REGISTER_NEXT();
+
+    REGISTER_CASE(AND_TEST)
+        if (fabs(frame[ip->src1]) > close_factor_low)
+        {
+            REGISTER_NEXT();
+        }
+        frame[ip->dst] = 0.0;
+        REGISTER_JUMP(ip->target);
+
+    REGISTER_CASE(OR_TEST)
+        if (fabs(frame[ip->src1]) < close_factor_low)
+        {
+            REGISTER_NEXT();
+        }
+        frame[ip->dst] = 1.0;
+        REGISTER_JUMP(ip->target);
+
+    REGISTER_CASE(LOOP_INIT)
+    {
+        PRJM_EVAL_I loop_count_int = (PRJM_EVAL_I) frame[ip->src1];
+        /* Limit execution count */
+        if (loop_count_int > MAX_LOOP_COUNT)
+        {
+            loop_count_int = MAX_LOOP_COUNT;
+        }
+        frame[ip->dst] = (PRJM_EVAL_F) loop_count_int;
+        REGISTER_NEXT();
+    }
+
+    REGISTER_CASE(LOOP_NEXT)
+        if (frame[ip->src1] <= 0)
+        {
+            REGISTER_JUMP(ip->target);
+        }
+        frame[ip->src1] -= 1;
+        REGISTER_NEXT();
+
+    REGISTER_CASE(WHILE_NEXT)
+        if (fabs(frame[ip->src1]) > close_factor_low && (frame[ip->src2] -= 1) != 0)
+        {
+            REGISTER_JUMP(ip->target);
+        }
+        REGISTER_NEXT();
+
+    REGISTER_CASE(SLOT_REF)
+        refs[ip->dst] = &frame[ip->src1];
+        REGISTER_NEXT();
+
+    REGISTER_CASE(LOAD_REF)
+        frame[ip->dst] = *refs[ip->src1];
+        REGISTER_NEXT();
+
+    REGISTER_CASE(STORE_REF)
+        *refs[ip->dst] = frame[ip->src1];
+        REGISTER_NEXT();
+
+    REGISTER_CASE(MEM_LOAD)
+    {
+        PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                          prjm_eval_math_mem_index(frame[ip->src1]));
+        frame[ip->dst] = mem_addr ? *mem_addr : .0;
+        REGISTER_NEXT();
+    }
+
+    REGISTER_CASE(MEM_STORE)
+    {
+        PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ip->memory_buffer,
+                                                          prjm_eval_math_mem_index(frame[ip->src1]));
+        if (mem_addr)
+        {
+            *mem_addr = frame[ip->src2];
+        }
+        REGISTER_NEXT();
+    }
+
+    REGISTER_CASE(MEM_LOAD_CURSOR)
+    {
+        PRJM_EVAL_F* mem_addr = cursor_address(&code->cursors[ip->cursor], frame[ip->src1]);
+        frame[ip->dst] = mem_addr ? *mem_addr : .0;
+        REGISTER_NEXT();
+    }
+
+    REGISTER_CASE(MEM_STORE_CURSOR)
+    {
+        PRJM_EVAL_F* mem_addr = cursor_address(&code->cursors[ip->cursor], frame[ip->src1]);
+        if (mem_addr)
+        {
+            *mem_addr = frame[ip->src2];
+        }
+        REGISTER_NEXT();
+    }
+
+    /* Rarely used instructions share their implementation with the JIT fallback. */
+    REGISTER_CASE(CALL_NODE)
+    REGISTER_CASE(CALL_NODE_REF)
+    REGISTER_CASE(MEM_REF)
+    REGISTER_CASE(MEM_REF_CURSOR)
+    REGISTER_CASE(CURSOR_RESET)
+    REGISTER_CASE(VECTOR_LOOP)
+    REGISTER_CASE(FREEMBUF)
+    REGISTER_CASE(MEMCPY)
+    REGISTER_CASE(MEMSET)
+        prjm_eval_register_code_execute_instruction(code, ip);
+        REGISTER_NEXT();
+
+    PRJM_EVAL_REGISTER_UNARY_OPERATIONS(REGISTER_UNARY)
+
+    PRJM_EVAL_REGISTER_BINARY_OPERATIONS(REGISTER_BINARY)
+
+    REGISTER_DISPATCH_END
+
+    /* Not reached, all programs end with a HALT instruction. */
+    return .0;
+}
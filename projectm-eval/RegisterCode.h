@@ -0,0 +1,310 @@
+/**
+ * @file RegisterCode.h
+ * @brief Register-based three-address representation of a compiled program and its interpreter.
+ *
+ * Each instruction reads up to two operands from a frame of value slots and writes its result into a third slot,
+ * e.g. "dst = add(src1, src2)". The frame contains all constants used by the program, followed by a copy of each
+ * variable the program accesses and the temporary values. Variables are copied into the frame before execution and
+ * written back afterwards, so all operand accesses are simple indexed loads and stores.
+ *
+ * Assignments to memory locations and other lvalues which aren't plain variables use a separate array of reference
+ * registers, which hold pointers to the assigned location.
+ *
+ * Memory accesses in loop bodies whose index advances by a constant stride in each iteration use memory cursors. A
+ * cursor keeps the address of the next access, so it only has to be looked up again when the index leaves a block.
+ *
+ * loop() bodies whose iterations only depend on each other through an induction variable can be executed as batch code,
+ * with one iteration per lane, see prjm_eval_register_vector_loop_t.
+ */
+#pragma once
+
+#include "CompilerTypes.h"
+
+#include <stdint.h>
+
+/**
+ * @brief List of all register code opcodes.
+ * The comments describe the usage of the instruction's operand fields.
+ */
+#define PRJM_EVAL_REGISTER_OPCODES(OP) \
+    /* Control flow */ \
+    OP(HALT) /* Ends execution. */ \
+    OP(MOV) /* dst = src1 */ \
+    OP(JUMP) /* Jumps to target. */ \
+    OP(JUMP_IF_ZERO) /* Jumps to target if src1 is exactly zero. */ \
+    OP(AND_TEST) /* Short-circuit "&&": if src1 is false, sets dst to 0 and jumps to target. */ \
+    OP(OR_TEST) /* Short-circuit "||": if src1 is true, sets dst to 1 and jumps to target. */ \
+    OP(LOOP_INIT) /* Sets the loop counter dst to the truncated and clamped count src1. */ \
+    OP(LOOP_NEXT) /* Jumps to target if counter src1 is depleted, decrements it otherwise. */ \
+    OP(WHILE_NEXT) /* Jumps to target if src1 is true and the decremented counter src2 is not zero. */ \
+    OP(CALL_NODE) /* dst = value returned by the tree node. */ \
+    OP(CALL_NODE_REF) /* Reference register dst = reference returned by the tree node, src1 is a scratch slot. */ \
+    \
+    /* References */ \
+    OP(SLOT_REF) /* Reference register dst = address of slot src1. */ \
+    OP(LOAD_REF) /* dst = value at reference register src1. */ \
+    OP(STORE_REF) /* Value at reference register dst = src1. */ \
+    \
+    /* Memory access */ \
+    OP(MEM_LOAD) /* dst = memory_buffer[src1] */ \
+    OP(MEM_STORE) /* memory_buffer[src1] = src2 */ \
+    OP(MEM_REF) /* Reference register dst = address of memory_buffer[src1], or of zeroed slot src2 on failure. */ \
+    OP(FREEMBUF) /* Frees the memory block at index src1. */ \
+    OP(MEMCPY) /* Copies src2 items from index src1 to index dst in memory_buffer. All three are read. */ \
+    OP(MEMSET) /* Sets src2 items starting at index dst to src1 in memory_buffer. All three are read. */ \
+    OP(MEM_LOAD_CURSOR) /* Like MEM_LOAD, using the memory cursor instead of memory_buffer. */ \
+    OP(MEM_STORE_CURSOR) /* Like MEM_STORE, using the memory cursor instead of memory_buffer. */ \
+    OP(MEM_REF_CURSOR) /* Like MEM_REF, using the memory cursor instead of memory_buffer. */ \
+    OP(CURSOR_RESET) /* Invalidates src2 memory cursors, starting at cursor. */ \
+    \
+    /* Vectorized loops */ \
+    OP(VECTOR_LOOP) /* Executes all but the last iteration of vector_loop, if possible, and reduces counter src1. */ \
+    \
+    /* Unary operators and functions, dst = op(src1) */ \
+    OP(BOOL) \
+    OP(BNOT) \
+    OP(NEG) \
+    OP(SIN) \
+    OP(COS) \
+    OP(TAN) \
+    OP(ASIN) \
+    OP(ACOS) \
+    OP(ATAN) \
+    OP(SQRT) \
+    OP(EXP) \
+    OP(LOG) \
+    OP(LOG10) \
+    OP(FLOOR) \
+    OP(CEIL) \
+    OP(SQR) \
+    OP(ABS) \
+    OP(SIGN) \
+    OP(RAND) \
+    OP(INVSQRT) \
+    \
+    /* Binary operators and functions, dst = op(src1, src2) */ \
+    OP(EQUAL) \
+    OP(NOTEQUAL) \
+    OP(BELOW) \
+    OP(ABOVE) \
+    OP(BELOWEQ) \
+    OP(ABOVEEQ) \
+    OP(ADD) \
+    OP(SUB) \
+    OP(MUL) \
+    OP(DIV) \
+    OP(DIV_NONZERO) \
+    OP(MOD) \
+    OP(BITWISE_OR) \
+    OP(BITWISE_AND) \
+    OP(BOOLEAN_AND) \
+    OP(BOOLEAN_OR) \
+    OP(POW) \
+    OP(ATAN2) \
+    OP(MIN) \
+    OP(MAX) \
+    OP(SIGMOID)
+
+/**
+ * @brief Scalar implementation of each unary operator, "a" is the operand.
+ * Expanding this list requires IntrinsicMath.h.
+ */
+#define PRJM_EVAL_REGISTER_UNARY_OPERATIONS(OP) \
+    OP(BOOL, fabs(a) > close_factor_low ? 1.0 : 0.0) \
+    OP(BNOT, fabs(a) < close_factor_low ? 1.0 : 0.0) \
+    OP(NEG, -a) \
+    OP(SIN, sin(a)) \
+    OP(COS, cos(a)) \
+    OP(TAN, tan(a)) \
+    OP(ASIN, prjm_eval_math_asin(a)) \
+    OP(ACOS, prjm_eval_math_acos(a)) \
+    OP(ATAN, atan(a)) \
+    OP(SQRT, sqrt(fabs(a))) \
+    OP(EXP, exp(a)) \
+    OP(LOG, prjm_eval_math_log(a)) \
+    OP(LOG10, prjm_eval_math_log10(a)) \
+    OP(FLOOR, floor(a)) \
+    OP(CEIL, ceil(a)) \
+    OP(SQR, a * a) \
+    OP(ABS, fabs(a)) \
+    OP(SIGN, prjm_eval_math_sign(a)) \
+    OP(RAND, prjm_eval_math_rand(a)) \
+    OP(INVSQRT, prjm_eval_math_invsqrt(a))
+
+/**
+ * @brief Scalar implementation of each binary operator, "a" and "b" are the operands.
+ * Expanding this list requires IntrinsicMath.h.
+ */
+#define PRJM_EVAL_REGISTER_BINARY_OPERATIONS(OP) \
+    OP(EQUAL, fabs(a - b) < close_factor_low ? 1.0 : 0.0) \
+    OP(NOTEQUAL, fabs(a - b) > close_factor_low ? 1.0 : 0.0) \
+    OP(BELOW, a < b ? 1.0 : 0.0) \
+    OP(ABOVE, a > b ? 1.0 : 0.0) \
+    OP(BELOWEQ, a <= b ? 1.0 : 0.0) \
+    OP(ABOVEEQ, a >= b ? 1.0 : 0.0) \
+    OP(ADD, a + b) \
+    OP(SUB, a - b) \
+    OP(MUL, a * b) \
+    OP(DIV, prjm_eval_math_div(a, b)) \
+    OP(DIV_NONZERO, prjm_eval_math_div_nonzero(a, b)) \
+    OP(MOD, prjm_eval_math_mod(a, b)) \
+    OP(BITWISE_OR, prjm_eval_math_bitwise_or(a, b)) \
+    OP(BITWISE_AND, prjm_eval_math_bitwise_and(a, b)) \
+    OP(BOOLEAN_AND, fabs(a) > close_factor && fabs(b) > close_factor ? 1.0 : 0.0) \
+    OP(BOOLEAN_OR, fabs(a) > close_factor || fabs(b) > close_factor ? 1.0 : 0.0) \
+    OP(POW, prjm_eval_math_pow(a, b)) \
+    OP(ATAN2, atan2(a, b)) \
+    OP(MIN, a < b ? a : b) \
+    OP(MAX, a > b ? a : b) \
+    OP(SIGMOID, prjm_eval_math_sigmoid(a, b))
+
+#define PRJM_EVAL_REGISTER_ENUM(name) PRJM_EVAL_REG_ ## name,
+
+typedef enum prjm_eval_register_opcode
+{
+    PRJM_EVAL_REGISTER_OPCODES(PRJM_EVAL_REGISTER_ENUM)
+    PRJM_EVAL_REG_OPCODE_COUNT
+} prjm_eval_register_opcode_t;
+
+#undef PRJM_EVAL_REGISTER_ENUM
+
+/**
+ * @brief A single three-address instruction.
+ */
+typedef struct prjm_eval_register_instruction
+{
+    prjm_eval_register_opcode_t opcode; /*!< The operation to execute. */
+    int32_t dst; /*!< Destination slot or reference register. */
+    int32_t src1; /*!< First source slot. */
+    int32_t src2; /*!< Second source slot. */
+    union
+    {
+        int32_t target; /*!< Instruction index of jump targets. */
+        projectm_eval_mem_buffer memory_buffer; /*!< megabuf/gmegabuf memory block. */
+        prjm_eval_exptreenode_t* node; /*!< Tree node executed by the CALL_NODE opcodes. */
+        int32_t cursor; /*!< Memory cursor used by the cursor opcodes. */
+        struct prjm_eval_register_vector_loop* vector_loop; /*!< Loop executed by VECTOR_LOOP. */
+    };
+} prjm_eval_register_instruction_t;
+
+/**
+ * @brief Position of a strided memory access in a loop.
+ * If the index value of an access equals the expected index and accesses remain, the stored address is used and both
+ * are advanced by stride items. Otherwise, the address is looked up as usual, and the cursor is set up for the
+ * following accesses if the index value is an integer.
+ */
+typedef struct prjm_eval_register_cursor
+{
+    PRJM_EVAL_F* address; /*!< The address of the next access. */
+    PRJM_EVAL_F index; /*!< The expected index value of the next access. */
+    PRJM_EVAL_F index_stride; /*!< The stride as a floating-point value. */
+    int32_t stride; /*!< The change of the memory index between two accesses. */
+    int32_t remaining; /*!< Number of accesses which can use address before the index leaves its memory block. */
+    projectm_eval_mem_buffer memory_buffer; /*!< megabuf/gmegabuf memory block. */
+} prjm_eval_register_cursor_t;
+
+/**
+ * @brief Number of iterations a vectorized loop passes to the batch code at once.
+ */
+#define PRJM_EVAL_REGISTER_VECTOR_LOOP_LANES 256
+
+/**
+ * @brief A loop() body which can be executed for many iterations at once.
+ * The iterations of the loop only depend on each other through a single induction variable, which is increased by a
+ * constant stride, and through memory accesses at the induction variable plus a constant offset. Other variables the
+ * body changes are always assigned before they are read. Each iteration is executed by a lane of the batch code, with
+ * the induction variable set to its value at the start of the iteration. Iterations whose memory accesses overlap are
+ * never executed in the same batch.
+ */
+typedef struct prjm_eval_register_vector_loop
+{
+    struct prjm_eval_batch_code* body; /*!< The loop body as batch code. */
+    PRJM_EVAL_F* induction_variable; /*!< The induction variable. */
+    PRJM_EVAL_F stride; /*!< The change of the induction variable in one iteration. */
+    int32_t max_lanes; /*!< The maximum number of iterations executed together. */
+    int32_t min_offset; /*!< The lowest offset of a memory access to a written buffer. */
+    PRJM_EVAL_F lane_values[PRJM_EVAL_REGISTER_VECTOR_LOOP_LANES]; /*!< The induction variable value of each lane. */
+} prjm_eval_register_vector_loop_t;
+
+/**
+ * @brief Options of prjm_eval_register_code_create(), combined with bitwise or.
+ */
+typedef enum prjm_eval_register_option
+{
+    PRJM_EVAL_REGISTER_USE_CURSORS = 1, /*!< Strided memory accesses in loop() bodies use memory cursors. */
+    PRJM_EVAL_REGISTER_VECTORIZE_LOOPS = 2 /*!< Independent iterations of loop() bodies are executed as batches. */
+} prjm_eval_register_option_t;
+
+/**
+ * @brief Maps a frame slot to the variable it mirrors.
+ */
+typedef struct prjm_eval_register_variable
+{
+    int32_t slot; /*!< The frame slot holding the variable value during execution. */
+    PRJM_EVAL_F* var; /*!< The variable in the context. */
+} prjm_eval_register_variable_t;
+
+/**
+ * @brief A program in register code.
+ */
+typedef struct prjm_eval_register_code
+{
+    prjm_eval_register_instruction_t* instructions; /*!< Instructions, the last one is always HALT. */
+    int32_t instruction_count; /*!< Number of instructions. */
+    PRJM_EVAL_F* frame; /*!< The slot frame: constants, variables and temporaries in this order. */
+    int32_t frame_size; /*!< Total number of slots. */
+    int32_t constant_count; /*!< Number of constant slots, starting at slot 0. */
+    prjm_eval_register_variable_t* variables; /*!< Variable slots, directly following the constants. */
+    int32_t variable_count; /*!< Number of variable slots. */
+    PRJM_EVAL_F** refs; /*!< Reference registers. */
+    int32_t ref_count; /*!< Number of reference registers. */
+    prjm_eval_register_cursor_t* cursors; /*!< Memory cursors. */
+    int32_t cursor_count; /*!< Number of memory cursors. */
+    prjm_eval_register_vector_loop_t** vector_loops; /*!< The vectorized loops. */
+    int32_t vector_loop_count; /*!< Number of vectorized loops. */
+    int32_t result; /*!< The slot containing the program's return value after execution. */
+} prjm_eval_register_code_t;
+
+/**
+ * @brief Translates an expression tree into register code.
+ * The tree must stay valid as long as the register code is used, as functions without a register code
+ * representation are executed by calling their tree node function.
+ * @param tree The root node of the program tree.
+ * @param options A combination of prjm_eval_register_option_t flags.
+ * @return The register code or NULL if the tree is empty or an allocation failed.
+ */
+prjm_eval_register_code_t* prjm_eval_register_code_create(prjm_eval_exptreenode_t* tree, int options);
+
+/**
+ * @brief Frees the given register code.
+ * @param code The register code to free.
+ */
+void prjm_eval_register_code_destroy(prjm_eval_register_code_t* code);
+
+/**
+ * @brief Copies the current variable values into their frame slots.
+ * @param code The register code.
+ */
+void prjm_eval_register_code_load_variables(prjm_eval_register_code_t* code);
+
+/**
+ * @brief Writes the values of all variable slots back into the variables.
+ * @param code The register code.
+ */
+void prjm_eval_register_code_store_variables(prjm_eval_register_code_t* code);
+
+/**
+ * @brief Executes a single instruction which doesn't change the control flow.
+ * Used by the interpreter for rarely used instructions and by the JIT for instructions it doesn't translate.
+ * @param code The register code containing the instruction.
+ * @param instruction The instruction to execute.
+ */
+void prjm_eval_register_code_execute_instruction(prjm_eval_register_code_t* code,
+                                                 const prjm_eval_register_instruction_t* instruction);
+
+/**
+ * @brief Executes register code.
+ * @param code The register code to execute.
+ * @return The value of the last executed top-level expression.
+ */
+PRJM_EVAL_F prjm_eval_register_code_execute(prjm_eval_register_code_t* code);
@@ -4,17 +4,14 @@
  */
 #include "TreeFunctions.h"
 
+#include "IntrinsicMath.h"
 #include "MemoryBuffer.h"
 
 #include <math.h>
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
-#if PRJM_F_SIZE == 4
-typedef int32_t PRJM_EVAL_I;
-#else
-typedef int64_t PRJM_EVAL_I;
-#endif
 /**
  * @brief projectM-EvalLib intrinsic Function table.
  * Contains all predefined functions and information about their invocation. Most functions beginning
@@ -112,22 +109,6 @@ static prjm_eval_function_def_t intrinsic_function_table[] = {
         assert(*ret_val); \
         assert(ctx->func)
 
-/* Allowed error for float/double comparisons to exact values */
-#define COMPARE_CLOSEFACTOR 0.00001
-static const PRJM_EVAL_F close_factor = COMPARE_CLOSEFACTOR;
-
-/* These factors are not exactly as close to zero as their ns-eel2 equivalents, but that shouldn't
- * matter too much. In ns-eel2, the value is represented as binary 0x00000000FFFFFFFF for doubles.
- */
-#if PRJM_F_SIZE == 4
-static const PRJM_EVAL_F close_factor_low = 1e-41;
-#else
-static const PRJM_EVAL_F close_factor_low = 1e-300;
-#endif
-
-/* Maximum number of loop iterations */
-#define MAX_LOOP_COUNT 1048576
-
 /**
  * Invokes the expression function of the indexed argument
  */
@@ -163,7 +144,7 @@ void prjm_eval_intrinsic_functions(prjm_eval_intrinsic_function_list_ptr list, u
 }
 
 /* This is Milkdrop's original rand() implementation. */
-static uint32_t prjm_eval_genrand_int32(void)
+uint32_t prjm_eval_genrand_int32(void)
 {
     uint32_t y;
     static uint32_t mag01[2] = { 0x0UL, MATRIX_A };
@@ -243,20 +224,17 @@ prjm_eval_function_decl(var)
 prjm_eval_function_decl(execute_list)
 {
     assert_valid_ctx();
-    assert(ctx->list);
+    assert(ctx->args);
 
     ctx->value = .0;
     PRJM_EVAL_F* value_ptr = &ctx->value;
-    prjm_eval_exptreenode_list_item_t* item = ctx->list;
-    while (item)
+    for (prjm_eval_exptreenode_t** instruction = ctx->args; *instruction; instruction++)
     {
-        assert(item->expr);
-        assert(item->expr->func);
+        assert((*instruction)->func);
 
         ctx->value = .0;
         value_ptr = &ctx->value;
-        item->expr->func(item->expr, &value_ptr);
-        item = item->next;
+        (*instruction)->func(*instruction, &value_ptr);
     }
 
     assign_ret_ref(value_ptr);
@@ -585,11 +563,20 @@ prjm_eval_function_decl(div)
     invoke_arg(0, &val1_ptr);
     invoke_arg(1, &val2_ptr);
 
-    if(fabs(*val2_ptr) < close_factor_low)
-    {
-        assign_ret_val(0.0);
-        return;
-    }
+    assign_ret_val(prjm_eval_math_div(*val1_ptr, *val2_ptr));
+}
+
+prjm_eval_function_decl(div_nonzero)
+{
+    assert_valid_ctx();
+
+    PRJM_EVAL_F val1 = .0;
+    PRJM_EVAL_F val2 = .0;
+    PRJM_EVAL_F* val1_ptr = &val1;
+    PRJM_EVAL_F* val2_ptr = &val2;
+
+    invoke_arg(0, &val1_ptr);
+    invoke_arg(1, &val2_ptr);
 
     assign_ret_val(*val1_ptr / *val2_ptr);
 }
@@ -606,13 +593,7 @@ prjm_eval_function_decl(mod)
     invoke_arg(0, &val1_ptr);
     invoke_arg(1, &val2_ptr);
 
-    PRJM_EVAL_I divisor = (PRJM_EVAL_I) *val2_ptr;
-    if (divisor == 0)
-    {
-        assign_ret_val(0.0);
-        return;
-    }
-    assign_ret_val((PRJM_EVAL_F) ((PRJM_EVAL_I) *val1_ptr % divisor));
+    assign_ret_val(prjm_eval_math_mod(*val1_ptr, *val2_ptr));
 }
 
 prjm_eval_function_decl(boolean_and_op)
@@ -762,13 +743,7 @@ prjm_eval_function_decl(div_op)
     invoke_arg(0, ret_val);
     invoke_arg(1, &val2_ptr);
 
-    if(fabs(*val2_ptr) < close_factor_low)
-    {
-        assign_ret_val(0.0);
-        return;
-    }
-
-    assign_ret_val(**ret_val / *val2_ptr);
+    assign_ret_val(prjm_eval_math_div(**ret_val, *val2_ptr));
 }
 
 prjm_eval_function_decl(bitwise_or_op)
@@ -781,7 +756,7 @@ prjm_eval_function_decl(bitwise_or_op)
     invoke_arg(0, ret_val);
     invoke_arg(1, &val2_ptr);
 
-    assign_ret_val((PRJM_EVAL_F) ((PRJM_EVAL_I)(**ret_val) | (PRJM_EVAL_I)(*val2_ptr)));
+    assign_ret_val(prjm_eval_math_bitwise_or(**ret_val, *val2_ptr));
 }
 
 prjm_eval_function_decl(bitwise_or)
@@ -796,7 +771,7 @@ prjm_eval_function_decl(bitwise_or)
     invoke_arg(0, &val1_ptr);
     invoke_arg(1, &val2_ptr);
 
-    assign_ret_val((PRJM_EVAL_F) ((PRJM_EVAL_I)(*val1_ptr) | (PRJM_EVAL_I)(*val2_ptr)));
+    assign_ret_val(prjm_eval_math_bitwise_or(*val1_ptr, *val2_ptr));
 }
 
 prjm_eval_function_decl(bitwise_and_op)
@@ -809,7 +784,7 @@ prjm_eval_function_decl(bitwise_and_op)
     invoke_arg(0, ret_val);
     invoke_arg(1, &val2_ptr);
 
-    assign_ret_val((PRJM_EVAL_F) ((PRJM_EVAL_I)(**ret_val) & (PRJM_EVAL_I)(*val2_ptr)));
+    assign_ret_val(prjm_eval_math_bitwise_and(**ret_val, *val2_ptr));
 }
 
 prjm_eval_function_decl(bitwise_and)
@@ -824,7 +799,7 @@ prjm_eval_function_decl(bitwise_and)
     invoke_arg(0, &val1_ptr);
     invoke_arg(1, &val2_ptr);
 
-    assign_ret_val((PRJM_EVAL_F) ((PRJM_EVAL_I)(*val1_ptr) & (PRJM_EVAL_I)(*val2_ptr)));
+    assign_ret_val(prjm_eval_math_bitwise_and(*val1_ptr, *val2_ptr));
 }
 
 prjm_eval_function_decl(mod_op)
@@ -837,13 +812,7 @@ prjm_eval_function_decl(mod_op)
     invoke_arg(0, ret_val);
     invoke_arg(1, &val2_ptr);
 
-    PRJM_EVAL_I divisor = (PRJM_EVAL_I) *val2_ptr;
-    if (divisor == 0)
-    {
-        assign_ret_val(0.0);
-        return;
-    }
-    assign_ret_val((PRJM_EVAL_F) ((PRJM_EVAL_I)(**ret_val) % divisor));
+    assign_ret_val(prjm_eval_math_mod(**ret_val, *val2_ptr));
 }
 
 prjm_eval_function_decl(pow_op)
@@ -856,15 +825,7 @@ prjm_eval_function_decl(pow_op)
     invoke_arg(0, ret_val);
     invoke_arg(1, &val2_ptr);
 
-    if(fabs(**ret_val) < close_factor_low && *val2_ptr < 0)
-    {
-        assign_ret_val(.0);
-        return;
-    }
-
-    PRJM_EVAL_F result = pow(**ret_val, *val2_ptr);
-
-    assign_ret_val(isnan(result) ? .0 : result);
+    assign_ret_val(prjm_eval_math_pow(**ret_val, *val2_ptr));
 }
 
 
@@ -914,13 +875,7 @@ prjm_eval_function_decl(asin)
 
     invoke_arg(0, &math_arg_ptr);
 
-    if (*math_arg_ptr < -1.0 || *math_arg_ptr > 1.0)
-    {
-        assign_ret_val(.0);
-        return;
-    }
-
-    assign_ret_val(asin(*math_arg_ptr));
+    assign_ret_val(prjm_eval_math_asin(*math_arg_ptr));
 }
 
 prjm_eval_function_decl(acos)
@@ -932,13 +887,7 @@ prjm_eval_function_decl(acos)
 
     invoke_arg(0, &math_arg_ptr);
 
-    if (*math_arg_ptr < -1.0 || *math_arg_ptr > 1.0)
-    {
-        assign_ret_val(.0);
-        return;
-    }
-
-    assign_ret_val(acos(*math_arg_ptr));
+    assign_ret_val(prjm_eval_math_acos(*math_arg_ptr));
 }
 
 prjm_eval_function_decl(atan)
@@ -992,15 +941,7 @@ prjm_eval_function_decl(pow)
     invoke_arg(0, &math_arg1_ptr);
     invoke_arg(1, &math_arg2_ptr);
 
-    if (fabs(*math_arg1_ptr) < close_factor_low && *math_arg2_ptr < 0)
-    {
-        assign_ret_val(.0);
-        return;
-    }
-
-    PRJM_EVAL_F result = pow(*math_arg1_ptr, *math_arg2_ptr);
-
-    assign_ret_val(isnan(result) ? .0 : result);
+    assign_ret_val(prjm_eval_math_pow(*math_arg1_ptr, *math_arg2_ptr));
 }
 
 prjm_eval_function_decl(exp)
@@ -1024,13 +965,7 @@ prjm_eval_function_decl(log)
 
     invoke_arg(0, &math_arg_ptr);
 
-    if (*math_arg_ptr <= 0.0)
-    {
-        assign_ret_val(.0);
-        return;
-    }
-
-    assign_ret_val(log(*math_arg_ptr));
+    assign_ret_val(prjm_eval_math_log(*math_arg_ptr));
 }
 
 prjm_eval_function_decl(log10)
@@ -1042,13 +977,7 @@ prjm_eval_function_decl(log10)
 
     invoke_arg(0, &math_arg_ptr);
 
-    if (*math_arg_ptr <= 0.0)
-    {
-        assign_ret_val(.0);
-        return;
-    }
-
-    assign_ret_val(log10(*math_arg_ptr));
+    assign_ret_val(prjm_eval_math_log10(*math_arg_ptr));
 }
 
 prjm_eval_function_decl(floor)
@@ -1087,8 +1016,7 @@ prjm_eval_function_decl(sigmoid)
     invoke_arg(0, &math_arg1_ptr);
     invoke_arg(1, &math_arg2_ptr);
 
-    double t = (1 + exp((double) -(*math_arg1_ptr) * (*math_arg2_ptr)));
-    assign_ret_val((PRJM_EVAL_F) (fabs(t) > close_factor ? 1.0 / t : .0));
+    assign_ret_val(prjm_eval_math_sigmoid(*math_arg1_ptr, *math_arg2_ptr));
 }
 
 prjm_eval_function_decl(sqr)
@@ -1154,12 +1082,7 @@ prjm_eval_function_decl(sign)
 
     invoke_arg(0, &value_ptr);
 
-    if (*value_ptr == 0)
-    {
-        (**ret_val) = .0;
-        return;
-    }
-    assign_ret_val((*value_ptr) < .0 ? -1. : 1.);
+    assign_ret_val(prjm_eval_math_sign(*value_ptr));
 }
 
 prjm_eval_function_decl(rand)
@@ -1171,50 +1094,651 @@ prjm_eval_function_decl(rand)
 
     invoke_arg(0, &value_ptr);
 
-    PRJM_EVAL_F rand_max = floor(*value_ptr);
-    if (rand_max < 1.)
+    assign_ret_val(prjm_eval_math_rand(*value_ptr));
+}
+
+prjm_eval_function_decl(invsqrt)
+{
+    assert_valid_ctx();
+
+    ctx->value = .0;
+    PRJM_EVAL_F* value_ptr = &ctx->value;
+
+    invoke_arg(0, &value_ptr);
+
+    assign_ret_val(prjm_eval_math_invsqrt(*value_ptr));
+}
+
+
+/*
+ * Superinstructions
+ *
+ * Fused functions replacing common subtrees. Each one evaluates its arguments in the same order as the subtree it
+ * replaces, so the result is always identical.
+ */
+
+/**
+ * Evaluates an argument of a fused function and returns a pointer to its value.
+ * Variables and constants are read directly from the argument node.
+ */
+static inline PRJM_EVAL_F* evaluate_fused_arg(prjm_eval_exptreenode_t* arg, PRJM_EVAL_F* scratch)
+{
+    assert(arg);
+
+    if (arg->func == prjm_eval_func_var)
     {
-        rand_max = 1.;
+        return arg->var;
     }
 
-    assign_ret_val((PRJM_EVAL_F) (prjm_eval_genrand_int32() * (1.0 / (double) 0xFFFFFFFF) * rand_max));
+    if (arg->func == prjm_eval_func_const)
+    {
+        return &arg->value;
+    }
+
+    arg->func(arg, &scratch);
+    return scratch;
+}
+
+#define compare_select_function(func, condition) \
+    prjm_eval_function_decl(if_ ## func) \
+    { \
+        assert_valid_ctx(); \
+        PRJM_EVAL_F val1 = .0; \
+        PRJM_EVAL_F val2 = .0; \
+        PRJM_EVAL_F* val1_ptr = evaluate_fused_arg(ctx->args[0], &val1); \
+        PRJM_EVAL_F* val2_ptr = evaluate_fused_arg(ctx->args[1], &val2); \
+        PRJM_EVAL_F a = *val1_ptr; \
+        PRJM_EVAL_F b = *val2_ptr; \
+        if (condition) \
+        { \
+            invoke_arg(2, ret_val); \
+            return; \
+        } \
+        invoke_arg(3, ret_val); \
+    }
+
+PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(compare_select_function)
+
+prjm_eval_function_decl(mul_add)
+{
+    assert_valid_ctx();
+
+    PRJM_EVAL_F val1 = .0;
+    PRJM_EVAL_F val2 = .0;
+    PRJM_EVAL_F val3 = .0;
+
+    PRJM_EVAL_F* val1_ptr = evaluate_fused_arg(ctx->args[0], &val1);
+    PRJM_EVAL_F* val2_ptr = evaluate_fused_arg(ctx->args[1], &val2);
+
+    /* The product is calculated before the addend is evaluated, as in "_add(_mul(a, b), c)". */
+    PRJM_EVAL_F product = *val1_ptr * *val2_ptr;
+
+    PRJM_EVAL_F* val3_ptr = evaluate_fused_arg(ctx->args[2], &val3);
+
+    assign_ret_val(product + *val3_ptr);
 }
 
-prjm_eval_function_decl(invsqrt)
+prjm_eval_function_decl(mem_set)
 {
     assert_valid_ctx();
+    assert(ctx->memory_buffer);
 
-    /*
-     * Using fast inverse square root implementation here, same as Milkdrop, except supporting doubles.
-     * See https://en.wikipedia.org/wiki/Fast_inverse_square_root
-     */
-#if PRJM_F_SIZE == 4
-#define INVSQRT_MAGIC_NUMBER 0x5f3759df
-#define INVSQRT_INT uint32_t
-#else
-#define INVSQRT_MAGIC_NUMBER 0x5fe6eb50c7b537a9
-#define INVSQRT_INT uint64_t
-#endif
-
-    union
+    PRJM_EVAL_F index = .0;
+    PRJM_EVAL_F* index_ptr = evaluate_fused_arg(ctx->args[0], &index);
+
+    // Add 0.0001 to avoid using the wrong index due to tiny float rounding errors.
+    PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ctx->memory_buffer, (int32_t) (*index_ptr + 0.0001));
+
+    PRJM_EVAL_F value = .0;
+    PRJM_EVAL_F* value_ptr = evaluate_fused_arg(ctx->args[1], &value);
+
+    if (mem_addr)
+    {
+        *mem_addr = *value_ptr;
+        assign_ret_ref(mem_addr);
+        return;
+    }
+
+    assign_ret_val(*value_ptr);
+}
+
+/*
+ * Operand-kind specialized variants
+ *
+ * The suffixes name the kind of each argument. Variable and constant arguments are read directly from the argument
+ * node instead of calling its node function. Like in the generic functions, values are only read after all
+ * expression arguments were evaluated.
+ */
+#define evaluate_operand_var(argnum, ptr)
+#define evaluate_operand_const(argnum, ptr)
+#define evaluate_operand_expr(argnum, ptr) \
+    PRJM_EVAL_F ptr ## _value = .0; \
+    PRJM_EVAL_F* ptr = &ptr ## _value; \
+    invoke_arg(argnum, &ptr);
+
+#define operand_var(argnum, ptr) (*ctx->args[argnum]->var)
+#define operand_const(argnum, ptr) (ctx->args[argnum]->value)
+#define operand_expr(argnum, ptr) (*ptr)
+
+#define unary_variant(func, kind, impl) \
+    prjm_eval_function_decl(func ## _ ## kind) \
+    { \
+        assert_valid_ctx(); \
+        PRJM_EVAL_F a = operand_ ## kind(0, val1_ptr); \
+        assign_ret_val(impl); \
+    }
+
+#define binary_variant(func, kind1, kind2, impl) \
+    prjm_eval_function_decl(func ## _ ## kind1 ## _ ## kind2) \
+    { \
+        assert_valid_ctx(); \
+        evaluate_operand_ ## kind1(0, val1_ptr) \
+        evaluate_operand_ ## kind2(1, val2_ptr) \
+        PRJM_EVAL_F a = operand_ ## kind1(0, val1_ptr); \
+        PRJM_EVAL_F b = operand_ ## kind2(1, val2_ptr); \
+        assign_ret_val(impl); \
+    }
+
+#define assignment_variant(func, kind, impl) \
+    prjm_eval_function_decl(func ## _var_ ## kind) \
+    { \
+        assert_valid_ctx(); \
+        evaluate_operand_ ## kind(1, val2_ptr) \
+        PRJM_EVAL_F* target = ctx->args[0]->var; \
+        PRJM_EVAL_F a = *target; \
+        PRJM_EVAL_F b = operand_ ## kind(1, val2_ptr); \
+        (void) a; \
+        *target = (impl); \
+        assign_ret_ref(target); \
+    }
+
+#define unary_variants(func, impl) \
+    unary_variant(func, var, impl) \
+    unary_variant(func, const, impl)
+
+#define binary_variants(func, impl) \
+    binary_variant(func, var, var, impl) \
+    binary_variant(func, var, const, impl) \
+    binary_variant(func, var, expr, impl) \
+    binary_variant(func, const, var, impl) \
+    binary_variant(func, const, expr, impl) \
+    binary_variant(func, expr, var, impl) \
+    binary_variant(func, expr, const, impl)
+
+#define assignment_variants(func, impl) \
+    assignment_variant(func, var, impl) \
+    assignment_variant(func, const, impl) \
+    assignment_variant(func, expr, impl)
+
+PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(unary_variants)
+PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(binary_variants)
+PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(assignment_variants)
+
+/**
+ * @brief Variants of a generic function, indexed by the kinds of the first and second argument.
+ */
+typedef struct prjm_eval_function_variants
+{
+    prjm_eval_expr_func_t* generic;
+    prjm_eval_expr_func_t* variants[3][3];
+} prjm_eval_function_variants_t;
+
+#define unary_variants_entry(func, impl) \
+    { prjm_eval_func_ ## func, { \
+        { NULL }, \
+        { prjm_eval_func_ ## func ## _var }, \
+        { prjm_eval_func_ ## func ## _const } } },
+
+#define binary_variants_entry(func, impl) \
+    { prjm_eval_func_ ## func, { \
+        { NULL, prjm_eval_func_ ## func ## _expr_var, prjm_eval_func_ ## func ## _expr_const }, \
+        { prjm_eval_func_ ## func ## _var_expr, prjm_eval_func_ ## func ## _var_var, prjm_eval_func_ ## func ## _var_const }, \
+        { prjm_eval_func_ ## func ## _const_expr, prjm_eval_func_ ## func ## _const_var, NULL } } },
+
+#define assignment_variants_entry(func, impl) \
+    { prjm_eval_func_ ## func, { \
+        { NULL }, \
+        { prjm_eval_func_ ## func ## _var_expr, prjm_eval_func_ ## func ## _var_var, prjm_eval_func_ ## func ## _var_const }, \
+        { NULL } } },
+
+static const prjm_eval_function_variants_t function_variants_table[] = {
+    PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(unary_variants_entry)
+    PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(binary_variants_entry)
+    PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(assignment_variants_entry)
+};
+
+#define FUNCTION_VARIANTS_COUNT (sizeof(function_variants_table) / sizeof(prjm_eval_function_variants_t))
+
+prjm_eval_expr_func_t* prjm_eval_specialized_function(prjm_eval_expr_func_t* func,
+                                                      prjm_eval_operand_kind_t arg1_kind,
+                                                      prjm_eval_operand_kind_t arg2_kind)
+{
+    for (size_t index = 0; index < FUNCTION_VARIANTS_COUNT; index++)
     {
-        PRJM_EVAL_F PRJM_F_val;
-        INVSQRT_INT int_val;
-    } type_conv;
+        if (function_variants_table[index].generic == func)
+        {
+            return function_variants_table[index].variants[arg1_kind][arg2_kind];
+        }
+    }
 
-    static const PRJM_EVAL_F three_halfs = 1.5;
-    static const PRJM_EVAL_F one_half = .5;
+    return NULL;
+}
 
+prjm_eval_expr_func_t* prjm_eval_generic_function(prjm_eval_expr_func_t* func)
+{
+    for (size_t index = 0; index < FUNCTION_VARIANTS_COUNT; index++)
+    {
+        const prjm_eval_function_variants_t* entry = &function_variants_table[index];
+        for (int arg1_kind = 0; arg1_kind < 3; arg1_kind++)
+        {
+            for (int arg2_kind = 0; arg2_kind < 3; arg2_kind++)
+            {
+                if (entry->variants[arg1_kind][arg2_kind] == func)
+                {
+                    return entry->generic;
+                }
+            }
+        }
+    }
 
-    ctx->value = .0;
-    PRJM_EVAL_F* value_ptr = &ctx->value;
+    return func;
+}
 
-    invoke_arg(0, &value_ptr);
+/*
+ * Value calling convention
+ *
+ * These variants return the node value instead of writing it through a result pointer, so they never store temporary
+ * values in the tree. Arguments used as rvalues are evaluated by their value functions, while lvalue arguments, e.g.
+ * the target of a generic assignment, still use the reference-returning node functions.
+ */
+
+/**
+ * Evaluates the indexed argument with its value function.
+ */
+#define evaluate_arg(argnum) \
+    (assert(ctx->args[argnum] && ctx->args[argnum]->value_func), \
+     ctx->args[argnum]->value_func(ctx->args[argnum]))
+
+prjm_eval_value_function_decl(via_ref)
+{
+    assert(ctx);
+    assert(ctx->func);
 
-    PRJM_EVAL_F num2 = (*value_ptr) * one_half;
-    type_conv.PRJM_F_val = (*value_ptr);
-    type_conv.int_val = INVSQRT_MAGIC_NUMBER - (type_conv.int_val >> 1);
-    type_conv.PRJM_F_val = type_conv.PRJM_F_val * (three_halfs - (num2 * type_conv.PRJM_F_val * type_conv.PRJM_F_val));
+    PRJM_EVAL_F value = .0;
+    PRJM_EVAL_F* value_ptr = &value;
+    ctx->func(ctx, &value_ptr);
+
+    return *value_ptr;
+}
+
+static prjm_eval_value_function_decl(const)
+{
+    assert(ctx);
+
+    return ctx->value;
+}
+
+static prjm_eval_value_function_decl(var)
+{
+    assert(ctx);
+    assert(ctx->var);
+
+    return *ctx->var;
+}
+
+static prjm_eval_value_function_decl(execute_list)
+{
+    assert(ctx);
+    assert(ctx->args);
+
+    PRJM_EVAL_F value = .0;
+    for (prjm_eval_exptreenode_t** instruction = ctx->args; *instruction; instruction++)
+    {
+        assert((*instruction)->value_func);
+
+        value = (*instruction)->value_func(*instruction);
+    }
+
+    return value;
+}
+
+static prjm_eval_value_function_decl(execute_loop)
+{
+    assert(ctx);
+
+    PRJM_EVAL_F value = evaluate_arg(0);
+
+    PRJM_EVAL_I loop_count_int = (PRJM_EVAL_I) value;
+    /* Limit execution count */
+    if (loop_count_int > MAX_LOOP_COUNT)
+    {
+        loop_count_int = MAX_LOOP_COUNT;
+    }
+
+    for (PRJM_EVAL_I i = 0; i < loop_count_int; i++)
+    {
+        value = evaluate_arg(1);
+    }
+
+    return value;
+}
+
+static prjm_eval_value_function_decl(execute_while)
+{
+    assert(ctx);
+
+    PRJM_EVAL_F value;
+    PRJM_EVAL_I loop_count_int = MAX_LOOP_COUNT;
+    do
+    {
+        value = evaluate_arg(0);
+    } while (fabs(value) > close_factor_low && --loop_count_int);
+
+    return value;
+}
+
+static prjm_eval_value_function_decl(if)
+{
+    assert(ctx);
+
+    if (evaluate_arg(0) != 0)
+    {
+        return evaluate_arg(1);
+    }
+
+    return evaluate_arg(2);
+}
+
+static prjm_eval_value_function_decl(exec2)
+{
+    assert(ctx);
+
+    evaluate_arg(0);
+    return evaluate_arg(1);
+}
+
+static prjm_eval_value_function_decl(exec3)
+{
+    assert(ctx);
+
+    evaluate_arg(0);
+    evaluate_arg(1);
+    return evaluate_arg(2);
+}
+
+static prjm_eval_value_function_decl(set)
+{
+    assert(ctx);
+
+    /* The target is an lvalue, e.g. a memory location, and needs the reference-returning function. */
+    PRJM_EVAL_F target_value = .0;
+    PRJM_EVAL_F* target = &target_value;
+    ctx->args[0]->func(ctx->args[0], &target);
+
+    PRJM_EVAL_F value = evaluate_arg(1);
+    *target = value;
+
+    return value;
+}
+
+static prjm_eval_value_function_decl(mem)
+{
+    assert(ctx);
+    assert(ctx->memory_buffer);
+
+    // Add 0.0001 to avoid using the wrong index due to tiny float rounding errors.
+    PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ctx->memory_buffer, (int32_t) (evaluate_arg(0) + 0.0001));
+
+    return mem_addr ? *mem_addr : .0;
+}
+
+static prjm_eval_value_function_decl(freembuf)
+{
+    assert(ctx);
+    assert(ctx->memory_buffer);
+
+    PRJM_EVAL_F value = evaluate_arg(0);
+
+    // Add 0.0001 to avoid using the wrong index due to tiny float rounding errors.
+    prjm_eval_memory_free_block(ctx->memory_buffer, (int32_t) (value + 0.0001));
+
+    return value;
+}
+
+static prjm_eval_value_function_decl(boolean_and_op)
+{
+    assert(ctx);
+
+    /* Only evaluates the second argument if the first one is non-zero, see prjm_eval_func_boolean_and_op. */
+    if (fabs(evaluate_arg(0)) > close_factor_low)
+    {
+        return fabs(evaluate_arg(1)) > close_factor_low ? 1.0 : 0.0;
+    }
+
+    return 0.0;
+}
+
+static prjm_eval_value_function_decl(boolean_or_op)
+{
+    assert(ctx);
+
+    /* Only evaluates the second argument if the first one is zero, see prjm_eval_func_boolean_or_op. */
+    if (fabs(evaluate_arg(0)) < close_factor_low)
+    {
+        return fabs(evaluate_arg(1)) > close_factor_low ? 1.0 : 0.0;
+    }
+
+    return 1.0;
+}
+
+/**
+ * Evaluates an argument of a fused function, reading variables and constants directly from the argument node.
+ */
+static inline PRJM_EVAL_F evaluate_fused_value(prjm_eval_exptreenode_t* arg)
+{
+    assert(arg);
+
+    if (arg->func == prjm_eval_func_var)
+    {
+        return *arg->var;
+    }
+
+    if (arg->func == prjm_eval_func_const)
+    {
+        return arg->value;
+    }
+
+    assert(arg->value_func);
+    return arg->value_func(arg);
+}
+
+#define compare_select_value_function(func, condition) \
+    static prjm_eval_value_function_decl(if_ ## func) \
+    { \
+        assert(ctx); \
+        PRJM_EVAL_F a = evaluate_fused_value(ctx->args[0]); \
+        PRJM_EVAL_F b = evaluate_fused_value(ctx->args[1]); \
+        if (condition) \
+        { \
+            return evaluate_arg(2); \
+        } \
+        return evaluate_arg(3); \
+    }
+
+PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(compare_select_value_function)
+
+static prjm_eval_value_function_decl(mul_add)
+{
+    assert(ctx);
+
+    PRJM_EVAL_F a = evaluate_fused_value(ctx->args[0]);
+    PRJM_EVAL_F b = evaluate_fused_value(ctx->args[1]);
+
+    /* The product is calculated before the addend is evaluated, as in "_add(_mul(a, b), c)". */
+    PRJM_EVAL_F product = a * b;
+
+    return product + evaluate_fused_value(ctx->args[2]);
+}
+
+static prjm_eval_value_function_decl(mem_set)
+{
+    assert(ctx);
+    assert(ctx->memory_buffer);
+
+    PRJM_EVAL_F index = evaluate_fused_value(ctx->args[0]);
+
+    // Add 0.0001 to avoid using the wrong index due to tiny float rounding errors.
+    PRJM_EVAL_F* mem_addr = prjm_eval_memory_allocate(ctx->memory_buffer, (int32_t) (index + 0.0001));
+
+    PRJM_EVAL_F value = evaluate_fused_value(ctx->args[1]);
+    if (mem_addr)
+    {
+        *mem_addr = value;
+    }
+
+    return value;
+}
+
+/*
+ * Value-returning generic functions and specialized variants. Expression arguments are evaluated first, variable and
+ * constant arguments are read afterwards.
+ */
+#define evaluate_value_var(argnum, name)
+#define evaluate_value_const(argnum, name)
+#define evaluate_value_expr(argnum, name) \
+    PRJM_EVAL_F name = evaluate_arg(argnum);
+
+#define read_value_var(argnum, name) \
+    PRJM_EVAL_F name = *ctx->args[argnum]->var;
+#define read_value_const(argnum, name) \
+    PRJM_EVAL_F name = ctx->args[argnum]->value;
+#define read_value_expr(argnum, name)
+
+#define unary_value_variant(name, kind, impl) \
+    static prjm_eval_value_function_decl(name) \
+    { \
+        assert(ctx); \
+        evaluate_value_ ## kind(0, a) \
+        read_value_ ## kind(0, a) \
+        return (impl); \
+    }
+
+#define binary_value_variant(name, kind1, kind2, impl) \
+    static prjm_eval_value_function_decl(name) \
+    { \
+        assert(ctx); \
+        evaluate_value_ ## kind1(0, a) \
+        evaluate_value_ ## kind2(1, b) \
+        read_value_ ## kind1(0, a) \
+        read_value_ ## kind2(1, b) \
+        return (impl); \
+    }
+
+#define assignment_value_variant(func, kind, impl) \
+    static prjm_eval_value_function_decl(func ## _var_ ## kind) \
+    { \
+        assert(ctx); \
+        evaluate_value_ ## kind(1, b) \
+        PRJM_EVAL_F* target = ctx->args[0]->var; \
+        PRJM_EVAL_F a = *target; \
+        read_value_ ## kind(1, b) \
+        (void) a; \
+        *target = (impl); \
+        return *target; \
+    }
+
+#define unary_value_variants(func, impl) \
+    unary_value_variant(func, expr, impl) \
+    unary_value_variant(func ## _var, var, impl) \
+    unary_value_variant(func ## _const, const, impl)
+
+#define binary_value_variants(func, impl) \
+    binary_value_variant(func, expr, expr, impl) \
+    binary_value_variant(func ## _var_var, var, var, impl) \
+    binary_value_variant(func ## _var_const, var, const, impl) \
+    binary_value_variant(func ## _var_expr, var, expr, impl) \
+    binary_value_variant(func ## _const_var, const, var, impl) \
+    binary_value_variant(func ## _const_expr, const, expr, impl) \
+    binary_value_variant(func ## _expr_var, expr, var, impl) \
+    binary_value_variant(func ## _expr_const, expr, const, impl)
+
+#define assignment_value_variants(func, impl) \
+    assignment_value_variant(func, var, impl) \
+    assignment_value_variant(func, const, impl) \
+    assignment_value_variant(func, expr, impl)
+
+PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(unary_value_variants)
+PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(binary_value_variants)
+PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(assignment_value_variants)
+
+/**
+ * @brief Maps a reference-returning node function to its value-returning variant.
+ */
+typedef struct prjm_eval_value_function_entry
+{
+    prjm_eval_expr_func_t* func;
+    prjm_eval_value_func_t* value_func;
+} prjm_eval_value_function_entry_t;
+
+#define value_function_entry(name) \
+    { prjm_eval_func_ ## name, prjm_eval_value_ ## name },
+
+#define compare_select_value_entry(func, condition) \
+    value_function_entry(if_ ## func)
+
+#define unary_value_entries(func, impl) \
+    value_function_entry(func) \
+    value_function_entry(func ## _var) \
+    value_function_entry(func ## _const)
+
+#define binary_value_entries(func, impl) \
+    value_function_entry(func) \
+    value_function_entry(func ## _var_var) \
+    value_function_entry(func ## _var_const) \
+    value_function_entry(func ## _var_expr) \
+    value_function_entry(func ## _const_var) \
+    value_function_entry(func ## _const_expr) \
+    value_function_entry(func ## _expr_var) \
+    value_function_entry(func ## _expr_const)
+
+#define assignment_value_entries(func, impl) \
+    value_function_entry(func ## _var_var) \
+    value_function_entry(func ## _var_const) \
+    value_function_entry(func ## _var_expr)
+
+static const prjm_eval_value_function_entry_t value_function_table[] = {
+    value_function_entry(const)
+    value_function_entry(var)
+    value_function_entry(execute_list)
+    value_function_entry(execute_loop)
+    value_function_entry(execute_while)
+    value_function_entry(if)
+    value_function_entry(exec2)
+    value_function_entry(exec3)
+    value_function_entry(set)
+    value_function_entry(mem)
+    value_function_entry(freembuf)
+    value_function_entry(boolean_and_op)
+    value_function_entry(boolean_or_op)
+    PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(compare_select_value_entry)
+    value_function_entry(mul_add)
+    value_function_entry(mem_set)
+    PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(unary_value_entries)
+    PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(binary_value_entries)
+    PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(assignment_value_entries)
+};
+
+#define VALUE_FUNCTION_COUNT (sizeof(value_function_table) / sizeof(prjm_eval_value_function_entry_t))
+
+prjm_eval_value_func_t* prjm_eval_value_function(prjm_eval_expr_func_t* func)
+{
+    for (size_t index = 0; index < VALUE_FUNCTION_COUNT; index++)
+    {
+        if (value_function_table[index].func == func)
+        {
+            return value_function_table[index].value_func;
+        }
+    }
 
-    assign_ret_val(isnan(type_conv.PRJM_F_val) ? 0 : (type_conv.PRJM_F_val));
+    return NULL;
 }
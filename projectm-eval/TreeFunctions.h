@@ -98,3 +98,181 @@ prjm_eval_function_decl(max);
 prjm_eval_function_decl(sign);
 prjm_eval_function_decl(rand);
 prjm_eval_function_decl(invsqrt);
+
+/* Superinstructions, created by the compiler from common subtrees */
+
+/**
+ * @brief Comparison operators with a fused compare-and-select function.
+ * "if_<name>(a, b, then, else)" replaces "if(<name>(a, b), then, else)". The condition uses "a" and "b" as the
+ * compared values. Expanding it requires IntrinsicMath.h.
+ */
+#define PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(OP) \
+    OP(equal, fabs(a - b) < close_factor_low) \
+    OP(notequal, fabs(a - b) > close_factor_low) \
+    OP(below, a < b) \
+    OP(above, a > b) \
+    OP(beloweq, a <= b) \
+    OP(aboveeq, a >= b)
+
+#define PRJM_EVAL_DECLARE_COMPARE_SELECT(func, condition) \
+    prjm_eval_function_decl(if_ ## func);
+
+PRJM_EVAL_COMPARE_SELECT_FUNCTIONS(PRJM_EVAL_DECLARE_COMPARE_SELECT)
+
+#undef PRJM_EVAL_DECLARE_COMPARE_SELECT
+
+prjm_eval_function_decl(mul_add); /* "mul_add(a, b, c)" replaces "a * b + c" and "c + a * b". */
+prjm_eval_function_decl(mem_set); /* "mem_set(index, value)" replaces "megabuf(index) = value". */
+
+/* Range-specialized operators, chosen by the compiler if the argument values are known well enough */
+prjm_eval_function_decl(div_nonzero); /* "div_nonzero(a, b)" replaces "a / b" if b can't be close to zero. */
+
+/* Operand-kind specialized variants */
+
+/**
+ * @brief Kind of a function argument, used to select a specialized function variant.
+ */
+typedef enum prjm_eval_operand_kind
+{
+    PRJM_EVAL_OPERAND_EXPR = 0, /*!< Any expression, evaluated by calling its node function. */
+    PRJM_EVAL_OPERAND_VAR, /*!< A variable, read directly from the argument node. */
+    PRJM_EVAL_OPERAND_CONST /*!< A constant, read directly from the argument node. */
+} prjm_eval_operand_kind_t;
+
+/**
+ * @brief Unary functions with variants for variable and constant arguments.
+ * The implementation uses "a" as the argument value. Expanding it requires IntrinsicMath.h.
+ */
+#define PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(OP) \
+    OP(bnot, fabs(a) < close_factor_low ? 1.0 : 0.0) \
+    OP(neg, -a) \
+    OP(sin, sin(a)) \
+    OP(cos, cos(a)) \
+    OP(tan, tan(a)) \
+    OP(asin, prjm_eval_math_asin(a)) \
+    OP(acos, prjm_eval_math_acos(a)) \
+    OP(atan, atan(a)) \
+    OP(sqrt, sqrt(fabs(a))) \
+    OP(exp, exp(a)) \
+    OP(log, prjm_eval_math_log(a)) \
+    OP(log10, prjm_eval_math_log10(a)) \
+    OP(floor, floor(a)) \
+    OP(ceil, ceil(a)) \
+    OP(sqr, a * a) \
+    OP(abs, fabs(a)) \
+    OP(sign, prjm_eval_math_sign(a)) \
+    OP(rand, prjm_eval_math_rand(a)) \
+    OP(invsqrt, prjm_eval_math_invsqrt(a))
+
+/**
+ * @brief Binary operators and functions with variants for each combination of variable, constant and
+ * expression arguments, except two expressions (the generic function) and two constants (folded by the compiler).
+ * The implementation uses "a" and "b" as the argument values. Expanding it requires IntrinsicMath.h.
+ */
+#define PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(OP) \
+    OP(equal, fabs(a - b) < close_factor_low ? 1.0 : 0.0) \
+    OP(notequal, fabs(a - b) > close_factor_low ? 1.0 : 0.0) \
+    OP(below, a < b ? 1.0 : 0.0) \
+    OP(above, a > b ? 1.0 : 0.0) \
+    OP(beloweq, a <= b ? 1.0 : 0.0) \
+    OP(aboveeq, a >= b ? 1.0 : 0.0) \
+    OP(add, a + b) \
+    OP(sub, a - b) \
+    OP(mul, a * b) \
+    OP(div, prjm_eval_math_div(a, b)) \
+    OP(div_nonzero, a / b) \
+    OP(mod, prjm_eval_math_mod(a, b)) \
+    OP(bitwise_or, prjm_eval_math_bitwise_or(a, b)) \
+    OP(bitwise_and, prjm_eval_math_bitwise_and(a, b)) \
+    OP(boolean_and_func, fabs(a) > close_factor && fabs(b) > close_factor ? 1.0 : 0.0) \
+    OP(boolean_or_func, fabs(a) > close_factor || fabs(b) > close_factor ? 1.0 : 0.0) \
+    OP(atan2, atan2(a, b)) \
+    OP(pow, prjm_eval_math_pow(a, b)) \
+    OP(min, a < b ? a : b) \
+    OP(max, a > b ? a : b) \
+    OP(sigmoid, prjm_eval_math_sigmoid(a, b))
+
+/**
+ * @brief Assignment functions with variants for a variable target and a variable, constant or expression value.
+ * The implementation uses "a" as the current target value and "b" as the assigned value. Expanding it requires
+ * IntrinsicMath.h.
+ */
+#define PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(OP) \
+    OP(set, b) \
+    OP(add_op, a + b) \
+    OP(sub_op, a - b) \
+    OP(mul_op, a * b) \
+    OP(div_op, prjm_eval_math_div(a, b)) \
+    OP(mod_op, prjm_eval_math_mod(a, b)) \
+    OP(bitwise_or_op, prjm_eval_math_bitwise_or(a, b)) \
+    OP(bitwise_and_op, prjm_eval_math_bitwise_and(a, b)) \
+    OP(pow_op, prjm_eval_math_pow(a, b))
+
+#define PRJM_EVAL_DECLARE_UNARY_VARIANTS(func, impl) \
+    prjm_eval_function_decl(func ## _var); \
+    prjm_eval_function_decl(func ## _const);
+
+#define PRJM_EVAL_DECLARE_BINARY_VARIANTS(func, impl) \
+    prjm_eval_function_decl(func ## _var_var); \
+    prjm_eval_function_decl(func ## _var_const); \
+    prjm_eval_function_decl(func ## _var_expr); \
+    prjm_eval_function_decl(func ## _const_var); \
+    prjm_eval_function_decl(func ## _const_expr); \
+    prjm_eval_function_decl(func ## _expr_var); \
+    prjm_eval_function_decl(func ## _expr_const);
+
+#define PRJM_EVAL_DECLARE_ASSIGNMENT_VARIANTS(func, impl) \
+    prjm_eval_function_decl(func ## _var_var); \
+    prjm_eval_function_decl(func ## _var_const); \
+    prjm_eval_function_decl(func ## _var_expr);
+
+PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(PRJM_EVAL_DECLARE_UNARY_VARIANTS)
+PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(PRJM_EVAL_DECLARE_BINARY_VARIANTS)
+PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(PRJM_EVAL_DECLARE_ASSIGNMENT_VARIANTS)
+
+#undef PRJM_EVAL_DECLARE_UNARY_VARIANTS
+#undef PRJM_EVAL_DECLARE_BINARY_VARIANTS
+#undef PRJM_EVAL_DECLARE_ASSIGNMENT_VARIANTS
+
+/**
+ * @brief Returns the variant of a function specialized for the given argument kinds.
+ * @param func The generic function.
+ * @param arg1_kind The kind of the first argument.
+ * @param arg2_kind The kind of the second argument, PRJM_EVAL_OPERAND_EXPR for unary functions.
+ * @return The specialized variant or NULL if there is none for the given combination.
+ */
+prjm_eval_expr_func_t* prjm_eval_specialized_function(prjm_eval_expr_func_t* func,
+                                                      prjm_eval_operand_kind_t arg1_kind,
+                                                      prjm_eval_operand_kind_t arg2_kind);
+
+/**
+ * @brief Returns the generic function of a specialized variant.
+ * Code analyzing or translating expression trees should use this function to identify node functions.
+ * @param func A node function.
+ * @return The generic function if func is a specialized variant, func otherwise.
+ */
+prjm_eval_expr_func_t* prjm_eval_generic_function(prjm_eval_expr_func_t* func);
+
+/* Value calling convention */
+
+/**
+ * @brief Abbreviates the declaration of a node function returning its value.
+ * @param func The name of the function, appended to "prjm_eval_value_".
+ */
+#define prjm_eval_value_function_decl(func) \
+    PRJM_EVAL_F prjm_eval_value_ ## func(struct prjm_eval_exptreenode* ctx)
+
+/**
+ * @brief Evaluates the node by calling its reference-returning node function.
+ * Used for functions without a value-returning variant, e.g. external functions, and for nodes depending on the late
+ * argument dereferencing of the reference-returning functions.
+ */
+prjm_eval_value_function_decl(via_ref);
+
+/**
+ * @brief Returns the value-returning variant of a node function.
+ * The variant evaluates rvalue arguments through their value functions, which must have been assigned before.
+ * @param func A node function.
+ * @return The value-returning variant or NULL if the function has none.
+ */
+prjm_eval_value_func_t* prjm_eval_value_function(prjm_eval_expr_func_t* func);
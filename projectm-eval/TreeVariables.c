@@ -65,3 +65,18 @@ PRJM_EVAL_F* prjm_eval_register_variable(prjm_eval_compiler_context_t* cctx, con
 
     return &var->variable->value;
 }
+
+prjm_eval_variable_def_t* prjm_eval_find_variable(prjm_eval_compiler_context_t* cctx, const PRJM_EVAL_F* value)
+{
+    prjm_eval_variable_entry_t* var = cctx->variables.first;
+    while (var)
+    {
+        if (&var->variable->value == value)
+        {
+            return var->variable;
+        }
+        var = var->next;
+    }
+
+    return NULL;
+}
@@ -4,3 +4,12 @@
 
 PRJM_EVAL_F* prjm_eval_register_variable(prjm_eval_compiler_context_t* cctx,
                                          const char* name);
+
+/**
+ * @brief Returns the definition of a context variable.
+ * @param cctx The context containing the variable.
+ * @param value The value pointer returned by prjm_eval_register_variable().
+ * @return The variable definition or NULL if the pointer doesn't belong to a variable of the context, e.g. if it is
+ *         one of the global reg00 to reg99 variables.
+ */
+prjm_eval_variable_def_t* prjm_eval_find_variable(prjm_eval_compiler_context_t* cctx, const PRJM_EVAL_F* value);
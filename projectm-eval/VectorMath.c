@@ -0,0 +1,513 @@
+/**
+ * @file VectorMath.c
+ * @brief Implements the array math kernels.
+ *
+ * The approximations follow the well-known fdlibm algorithms, reduced to the branch-free core of each function.
+ * Every kernel first computes a block of results in a loop without calls or data-dependent branches, which the
+ * compiler turns into SIMD code for the target's vector width. Arguments outside of the supported range are replaced
+ * by a harmless value in that loop and recomputed with the scalar function in a second pass over the block.
+ *
+ * This file is compiled without fast math optimizations, as the range reductions rely on the exact evaluation order
+ * of their floating-point operations. It is compiled once for each CPU variant, see CpuDispatch.h.
+ */
+#include "VectorMath.h"
+
+#include "CpuDispatch.h"
+#include "IntrinsicMath.h"
+
+#include <float.h>
+#include <string.h>
+
+/**
+ * Number of values processed per block. Limits the stack size needed for the intermediate results.
+ */
+#define VECTOR_BLOCK 64
+
+static const double two_over_pi = 6.36619772367581382433e-01;
+static const double pio2_1 = 1.57079632673412561417e+00; /* First 33 bits of pi/2 */
+static const double pio2_2 = 6.07710050630396597660e-11; /* Second 33 bits of pi/2 */
+static const double pio2_2t = 2.02226624879595063154e-21; /* pi/2 - (pio2_1 + pio2_2) */
+static const double pio2_hi = 1.57079632679489655800e+00;
+static const double pio2_lo = 6.12323399573676603587e-17;
+static const double pio4_hi = 7.85398163397448278999e-01;
+static const double pio4_lo = 3.06161699786838301793e-17;
+static const double pi_hi = 3.14159265358979311600e+00;
+static const double pi_lo = 1.22464679914735317723e-16;
+static const double tan_pio8 = 4.14213562373095034e-01;
+
+static const double ln2_hi = 6.93147180369123816490e-01;
+static const double ln2_lo = 1.90821492927058770002e-10;
+static const double inv_ln2 = 1.44269504088896338700e+00;
+static const double sqrt2 = 1.41421356237309514547e+00;
+
+/* sin(x) = x + x^3 * S(x^2) on [-pi/4, pi/4] */
+static const double S1 = -1.66666666666666324348e-01;
+static const double S2 = 8.33333333332248946124e-03;
+static const double S3 = -1.98412698298579493134e-04;
+static const double S4 = 2.75573137070700676789e-06;
+static const double S5 = -2.50507602534068634195e-08;
+static const double S6 = 1.58969099521155010221e-10;
+
+/* cos(x) = 1 - x^2 / 2 + x^4 * C(x^2) on [-pi/4, pi/4] */
+static const double C1 = 4.16666666666666019037e-02;
+static const double C2 = -1.38888888888741095749e-03;
+static const double C3 = 2.48015872894767294178e-05;
+static const double C4 = -2.75573143513906633035e-07;
+static const double C5 = 2.08757232129817482790e-09;
+static const double C6 = -1.13596475577881948265e-11;
+
+/* Remez polynomial for the exp() remainder on [-ln(2)/2, ln(2)/2] */
+static const double P1 = 1.66666666666666019037e-01;
+static const double P2 = -2.77777777770155933842e-03;
+static const double P3 = 6.61375632143793436117e-05;
+static const double P4 = -1.65339022054652515390e-06;
+static const double P5 = 4.13813679705723846039e-08;
+
+/* log(1 + f) = 2s + s * R(s^2) with s = f / (2 + f) */
+static const double Lg1 = 6.666666666666735130e-01;
+static const double Lg2 = 3.999999999940941908e-01;
+static const double Lg3 = 2.857142874366239149e-01;
+static const double Lg4 = 2.222219843214978396e-01;
+static const double Lg5 = 1.818357216161805012e-01;
+static const double Lg6 = 1.531383769920937332e-01;
+static const double Lg7 = 1.479819860511658591e-01;
+
+/* atan(x) = x - x^3 * T(x^2) on [-7/16, 7/16] */
+static const double aT0 = 3.33333333333329318027e-01;
+static const double aT1 = -1.99999999998764832476e-01;
+static const double aT2 = 1.42857142725034663711e-01;
+static const double aT3 = -1.11111104054623557880e-01;
+static const double aT4 = 9.09088713343650656196e-02;
+static const double aT5 = -7.69187620504482999495e-02;
+static const double aT6 = 6.66107313738753120669e-02;
+static const double aT7 = -5.83357013379057348645e-02;
+static const double aT8 = 4.97687799461593236017e-02;
+static const double aT9 = -3.65315727442169155270e-02;
+static const double aT10 = 1.62858201153657823623e-02;
+
+/* Largest argument handled by the sin/cos range reduction, keeps the quadrant below 2^20. */
+static const double trig_max = 1e6;
+
+/* exp() arguments with a normal, finite result. */
+static const double exp_min = -708.0;
+static const double exp_max = 709.0;
+
+static inline uint64_t double_bits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double bits_double(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Adding 1.5 * 2^52 rounds values below 2^51 to an integer, which then is stored in the lowest mantissa bits.
+ * Unlike conversions to int, this only uses operations available for all SIMD widths.
+ */
+static const double round_shifter = 6755399441055744.0;
+
+/**
+ * Rounds the value to the nearest integer, which is returned in the lowest bits of *shifted_bits.
+ * |value| must be below 2^31.
+ */
+static inline double round_to_integer(double value, uint64_t* shifted_bits)
+{
+    double shifted = value + round_shifter;
+    *shifted_bits = double_bits(shifted);
+    return shifted - round_shifter;
+}
+
+/**
+ * Returns 2^exponent for exponents in the normal range [-1022, 1023], with exponent taken from shifted bits.
+ */
+static inline double power_of_two(uint64_t shifted_bits)
+{
+    return bits_double((shifted_bits + 1023) << 52);
+}
+
+/**
+ * Splits a value into a high part with 26 significant bits and the remainder (Dekker).
+ */
+static inline void split(double value, double* high, double* low)
+{
+    double temp = 134217729.0 * value;
+    *high = temp - (temp - value);
+    *low = value - *high;
+}
+
+/**
+ * Returns sin(x) for quadrant_offset 0 and cos(x) for quadrant_offset 1. |x| must be at most trig_max.
+ */
+static inline double sin_cos_kernel(double x, uint64_t quadrant_offset)
+{
+    uint64_t quadrant;
+    double k = round_to_integer(x * two_over_pi, &quadrant);
+
+    /* Cody-Waite reduction, the first product is exact. */
+    double reduced = x - k * pio2_1;
+    double product = k * pio2_2;
+    double r = reduced - product;
+    double tail = k * pio2_2t - ((reduced - r) - product);
+    r = r - tail;
+
+    double z = r * r;
+    double sin_r = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+
+    double half_z = 0.5 * z;
+    double w = 1.0 - half_z;
+    double cos_r = w + (((1.0 - w) - half_z) + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6))))));
+
+    quadrant += quadrant_offset;
+    /* Select and negate with bit operations, as the compiler won't if-convert integer conditions for SIMD. */
+    uint64_t sin_bits = double_bits(sin_r);
+    uint64_t result = sin_bits ^ ((sin_bits ^ double_bits(cos_r)) & (0 - (quadrant & 1)));
+    return bits_double(result ^ ((quadrant & 2) << 62));
+}
+
+/**
+ * Returns exp(hi - lo), with hi - lo between exp_min and exp_max.
+ * Taking the argument as two parts allows pow() to pass a more precise argument.
+ */
+static inline double exp_kernel(double hi, double lo)
+{
+    uint64_t exponent;
+    double k = round_to_integer(hi * inv_ln2, &exponent);
+
+    double r_hi = hi - k * ln2_hi;
+    double r_lo = k * ln2_lo + lo;
+    double r = r_hi - r_lo;
+
+    double t = r * r;
+    double c = r - t * (P1 + t * (P2 + t * (P3 + t * (P4 + t * P5))));
+    double y = 1.0 - ((r_lo - (r * c) / (2.0 - c)) - r_hi);
+
+    return y * power_of_two(exponent);
+}
+
+/**
+ * Returns log(x) as hi + lo for positive normal x. lo carries the bits lost by rounding hi.
+ */
+static inline void log_kernel(double x, double* hi, double* lo)
+{
+    uint64_t bits = double_bits(x);
+    double m = bits_double((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+
+    /* The biased exponent, converted by placing it in the mantissa of round_shifter. */
+    double exponent = bits_double((bits >> 52) | double_bits(round_shifter)) - (round_shifter + 1023.0);
+
+    /* Keep m in [sqrt(2)/2, sqrt(2)), so f is as small as possible. */
+    double k = exponent + (m > sqrt2 ? 1.0 : 0.0);
+    m = m > sqrt2 ? m * 0.5 : m;
+
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (Lg2 + w * (Lg4 + w * Lg6));
+    double t2 = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7)));
+    double R = t2 + t1;
+
+    /* Exact f * f / 2, as its rounding error would be amplified by large pow() exponents. */
+    double f_hi;
+    double f_lo;
+    split(f, &f_hi, &f_lo);
+    double half_f_sq = 0.5 * f * f;
+    double half_f_sq_lo = 0.5 * (((f_hi * f_hi - 2.0 * half_f_sq) + 2.0 * f_hi * f_lo) + f_lo * f_lo);
+
+    /* log(m) = f - f^2 / 2 + s * (f^2 / 2 + R) */
+    double log_m = f - half_f_sq;
+    double log_m_lo = ((f - log_m) - half_f_sq) - half_f_sq_lo + s * (half_f_sq + R);
+
+    /* Add k * ln(2), k * ln2_hi is exact. */
+    double k_ln2 = k * ln2_hi;
+    double sum = k_ln2 + log_m;
+    double log_m_part = sum - k_ln2;
+    double sum_error = (k_ln2 - (sum - log_m_part)) + (log_m - log_m_part);
+
+    /* Renormalize, so hi holds the correctly rounded sum. */
+    double tail = sum_error + log_m_lo + k * ln2_lo;
+    *hi = sum + tail;
+    *lo = tail - (*hi - sum);
+}
+
+/**
+ * Returns |base|^exponent for positive normal base, or NaN if the result isn't a normal number.
+ */
+static inline double pow_kernel(double base, double exponent)
+{
+    double log_hi;
+    double log_lo;
+    log_kernel(fabs(base), &log_hi, &log_lo);
+
+    /* t = exponent * log(base), as an unevaluated sum of t_hi and t_lo. */
+    double t_hi = exponent * log_hi;
+    double e_hi;
+    double e_lo;
+    double l_hi;
+    double l_lo;
+    split(exponent, &e_hi, &e_lo);
+    split(log_hi, &l_hi, &l_lo);
+    double t_lo = (((e_hi * l_hi - t_hi) + e_hi * l_lo) + e_lo * l_hi) + e_lo * l_lo + exponent * log_lo;
+    double t = t_hi + t_lo;
+    t_lo = t_lo - (t - t_hi);
+    t_hi = t;
+
+    double in_range = t_hi > exp_min && t_hi < exp_max;
+    double result = exp_kernel(in_range ? t_hi : 0.0, in_range ? -t_lo : 0.0);
+
+    return in_range ? result : NAN;
+}
+
+/**
+ * Returns atan(y / x) for 0 <= y <= x, x > 0.
+ */
+static inline double atan_kernel(double y, double x)
+{
+    /* Above tan(pi/8), use atan(z) = pi/4 + atan((z - 1) / (z + 1)) to keep the polynomial argument small. */
+    int upper = y > tan_pio8 * x;
+    double z = upper ? (y - x) / (y + x) : y / x;
+
+    double z2 = z * z;
+    double z4 = z2 * z2;
+    double s1 = z2 * (aT0 + z4 * (aT2 + z4 * (aT4 + z4 * (aT6 + z4 * (aT8 + z4 * aT10)))));
+    double s2 = z4 * (aT1 + z4 * (aT3 + z4 * (aT5 + z4 * (aT7 + z4 * aT9))));
+    double zs = z * (s1 + s2);
+
+    return upper ? pio4_hi - ((zs - pio4_lo) - z) : z - zs;
+}
+
+/**
+ * Returns atan2(y, x) for finite, non-zero x and y.
+ */
+static inline double atan2_kernel(double y, double x)
+{
+    double ax = fabs(x);
+    double ay = fabs(y);
+    int swapped = ay > ax;
+
+    double angle = atan_kernel(swapped ? ax : ay, swapped ? ay : ax);
+    angle = swapped ? pio2_hi - (angle - pio2_lo) : angle;
+    angle = x < 0.0 ? pi_hi - (angle - pi_lo) : angle;
+
+    return y < 0.0 ? -angle : angle;
+}
+
+static inline int trig_in_range(double x)
+{
+    return fabs(x) <= trig_max;
+}
+
+static inline int exp_in_range(double x)
+{
+    return x > exp_min && x < exp_max;
+}
+
+static inline int log_in_range(double x)
+{
+    return x >= DBL_MIN && x <= DBL_MAX;
+}
+
+static inline int atan2_in_range(double y, double x)
+{
+    return fabs(y) >= DBL_MIN && fabs(y) <= DBL_MAX && fabs(x) >= DBL_MIN && fabs(x) <= DBL_MAX;
+}
+
+/**
+ * Returns the exponent if it fits into an int32_t, or 0.5 otherwise.
+ */
+static inline double pow_integer_candidate(double exponent)
+{
+    return fabs(exponent) < 2147483647.0 ? exponent : 0.5;
+}
+
+/**
+ * Returns true if the power can be calculated as exp(exponent * log(|base|)), including the result's sign.
+ */
+static inline int pow_in_range(double base, double exponent)
+{
+    /* Bases close to zero return 0 for negative exponents, see prjm_eval_math_pow(). */
+    double abs_base = fabs(base);
+    int base_ok = abs_base >= DBL_MIN && abs_base >= (double) close_factor_low && abs_base <= DBL_MAX;
+
+    /* Negative bases are only defined for integer exponents. */
+    double candidate = pow_integer_candidate(exponent);
+    int integer_ok = candidate == (double) (int32_t) candidate;
+
+    return base_ok && fabs(exponent) <= DBL_MAX && (base > 0.0 || integer_ok);
+}
+
+/**
+ * Returns the sign of base^exponent for an integer exponent, or 1 for positive bases.
+ */
+static inline double pow_sign(double base, double exponent)
+{
+    /* An integer exponent is odd if half of it isn't an integer. Exponents outside of the int32_t range are
+     * recomputed by the scalar function anyway. */
+    double half = 0.5 * pow_integer_candidate(exponent);
+    double odd = (half + round_shifter) - round_shifter != half ? 1.0 : 0.0;
+    return base < 0.0 ? 1.0 - 2.0 * odd : 1.0;
+}
+
+/**
+ * Defines an array function for a unary kernel. Each block is computed with the argument replaced by safe_value
+ * where in_range is false, then these values are recomputed with the scalar function.
+ */
+#define VECTOR_UNARY_FUNCTION(name, kernel_expression, in_range, safe_value, scalar_expression)     \
+    void PRJM_EVAL_CPU_KERNEL(vector_ ## name)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count) \
+    {                                                                                               \
+        double result[VECTOR_BLOCK];                                                                \
+        for (int offset = 0; offset < count; offset += VECTOR_BLOCK)                                \
+        {                                                                                           \
+            int block_size = count - offset < VECTOR_BLOCK ? count - offset : VECTOR_BLOCK;         \
+            const PRJM_EVAL_F* arguments = src + offset;                                            \
+            for (int index = 0; index < block_size; index++)                                        \
+            {                                                                                       \
+                double x = (double) arguments[index];                                               \
+                x = in_range(x) ? x : (safe_value);                                                 \
+                result[index] = (kernel_expression);                                                \
+            }                                                                                       \
+            for (int index = 0; index < block_size; index++)                                        \
+            {                                                                                       \
+                if (!in_range((double) arguments[index]))                                           \
+                {                                                                                   \
+                    PRJM_EVAL_F a = arguments[index];                                               \
+                    result[index] = (scalar_expression);                                            \
+                }                                                                                   \
+            }                                                                                       \
+            for (int index = 0; index < block_size; index++)                                        \
+            {                                                                                       \
+                dst[offset + index] = (PRJM_EVAL_F) result[index];                                  \
+            }                                                                                       \
+        }                                                                                           \
+    }
+
+VECTOR_UNARY_FUNCTION(sin, sin_cos_kernel(x, 0), trig_in_range, 0.0, sin(a))
+VECTOR_UNARY_FUNCTION(cos, sin_cos_kernel(x, 1), trig_in_range, 0.0, cos(a))
+VECTOR_UNARY_FUNCTION(exp, exp_kernel(x, 0.0), exp_in_range, 0.0, exp(a))
+
+/**
+ * Returns log(x) for positive normal x. Same as log_kernel(), without the extra precision needed by pow().
+ */
+static inline double log_value(double x)
+{
+    uint64_t bits = double_bits(x);
+    double m = bits_double((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    double exponent = bits_double((bits >> 52) | double_bits(round_shifter)) - (round_shifter + 1023.0);
+    double k = exponent + (m > sqrt2 ? 1.0 : 0.0);
+    m = m > sqrt2 ? m * 0.5 : m;
+
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (Lg2 + w * (Lg4 + w * Lg6));
+    double t2 = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7)));
+    double R = t2 + t1;
+    double half_f_sq = 0.5 * f * f;
+
+    return k * ln2_hi - ((half_f_sq - (s * (half_f_sq + R) + k * ln2_lo)) - f);
+}
+
+VECTOR_UNARY_FUNCTION(log, log_value(x), log_in_range, 1.0, prjm_eval_math_log(a))
+
+#undef VECTOR_UNARY_FUNCTION
+
+void PRJM_EVAL_CPU_KERNEL(vector_sqrt)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    /* sqrt() is exact and maps to a SIMD instruction, as this file is compiled without errno support. */
+    for (int index = 0; index < count; index++)
+    {
+        dst[index] = sqrt(fabs(src[index]));
+    }
+}
+
+void PRJM_EVAL_CPU_KERNEL(vector_invsqrt)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count)
+{
+    /* The fast inverse square root only uses integer and basic float operations, so the scalar version vectorizes. */
+    for (int index = 0; index < count; index++)
+    {
+        dst[index] = prjm_eval_math_invsqrt(src[index]);
+    }
+}
+
+void PRJM_EVAL_CPU_KERNEL(vector_pow)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* base, const PRJM_EVAL_F* exponent, int count)
+{
+    double result[VECTOR_BLOCK];
+
+    for (int offset = 0; offset < count; offset += VECTOR_BLOCK)
+    {
+        int block_size = count - offset < VECTOR_BLOCK ? count - offset : VECTOR_BLOCK;
+        const PRJM_EVAL_F* a = base + offset;
+        const PRJM_EVAL_F* b = exponent + offset;
+
+        for (int index = 0; index < block_size; index++)
+        {
+            double x = (double) a[index];
+            double y = (double) b[index];
+            x = fabs(x) >= DBL_MIN && fabs(x) <= DBL_MAX ? x : 1.0;
+            y = fabs(y) <= DBL_MAX ? y : 0.0;
+            result[index] = pow_kernel(x, y) * pow_sign(x, y);
+        }
+
+        /* The kernel returns NaN if the result is out of range. */
+        for (int index = 0; index < block_size; index++)
+        {
+            if (!pow_in_range(a[index], b[index]) || isnan(result[index]))
+            {
+                result[index] = prjm_eval_math_pow(a[index], b[index]);
+            }
+        }
+
+        for (int index = 0; index < block_size; index++)
+        {
+            dst[offset + index] = (PRJM_EVAL_F) result[index];
+        }
+    }
+}
+
+void PRJM_EVAL_CPU_KERNEL(vector_atan2)(PRJM_EVAL_F* dst, const PRJM_EVAL_F* y, const PRJM_EVAL_F* x, int count)
+{
+    double result[VECTOR_BLOCK];
+
+    for (int offset = 0; offset < count; offset += VECTOR_BLOCK)
+    {
+        int block_size = count - offset < VECTOR_BLOCK ? count - offset : VECTOR_BLOCK;
+        const PRJM_EVAL_F* a = y + offset;
+        const PRJM_EVAL_F* b = x + offset;
+
+        for (int index = 0; index < block_size; index++)
+        {
+            double y_value = (double) a[index];
+            double x_value = (double) b[index];
+            int valid = atan2_in_range(y_value, x_value);
+            result[index] = atan2_kernel(valid ? y_value : 1.0, valid ? x_value : 1.0);
+        }
+
+        for (int index = 0; index < block_size; index++)
+        {
+            if (!atan2_in_range((double) a[index], (double) b[index]))
+            {
+                result[index] = atan2(a[index], b[index]);
+            }
+        }
+
+        for (int index = 0; index < block_size; index++)
+        {
+            dst[offset + index] = (PRJM_EVAL_F) result[index];
+        }
+    }
+}
+
+void PRJM_EVAL_CPU_KERNEL(vector_fill)(PRJM_EVAL_F* dst, PRJM_EVAL_F value, int count)
+{
+    for (int index = 0; index < count; index++)
+    {
+        dst[index] = value;
+    }
+}
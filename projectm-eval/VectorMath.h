@@ -0,0 +1,77 @@
+/**
+ * @file VectorMath.h
+ * @brief Array versions of the transcendental intrinsic operations.
+ *
+ * Each kernel evaluates one operation for a whole array of arguments. The kernels are written as branch-free loops
+ * the C compiler vectorizes, using polynomial approximations instead of scalar libm calls. Arguments the
+ * approximations don't cover (NaN, infinities, huge or tiny values) are passed to the scalar implementation
+ * afterwards, so the kernels follow the same rules as the operations in IntrinsicMath.h.
+ *
+ * All kernels compute in double precision. Maximum errors compared to libm, in units in the last place (ulp):
+ * - sin, cos, exp, log: 1 ulp
+ * - atan2: 2 ulp
+ * - pow: 2 ulp if |t| <= 16 with t = exponent * log(base), up to |t| / 4 ulp for larger t
+ * - sqrt: exact
+ * - invsqrt: uses the same approximation as the scalar version. Exact if both are compiled with the same
+ *   floating-point flags, otherwise within 2 ulp, as fast math optimizations may reorder the scalar version.
+ *
+ * The scalar functions are used for sin/cos arguments beyond 1e6, exp/pow results which aren't normal numbers, zero
+ * and subnormal arguments, negative pow bases with fractional exponents, infinities and NaN.
+ *
+ * With PRJM_F_SIZE 4, the double results are rounded to float, which is identical to the scalar result except for
+ * very rare rounding boundary cases.
+ *
+ * The functions call the kernels of the variant selected for the CPU, see CpuDispatch.h. All variants return the
+ * same results.
+ */
+#pragma once
+
+#include "CompilerTypes.h"
+
+/**
+ * @brief Calculates dst[i] = sin(src[i]) for count values.
+ * dst and src may point to the same array.
+ */
+void prjm_eval_vector_sin(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+
+/**
+ * @brief Calculates dst[i] = cos(src[i]) for count values.
+ */
+void prjm_eval_vector_cos(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+
+/**
+ * @brief Calculates dst[i] = exp(src[i]) for count values.
+ */
+void prjm_eval_vector_exp(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+
+/**
+ * @brief Calculates dst[i] = prjm_eval_math_log(src[i]) for count values.
+ */
+void prjm_eval_vector_log(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+
+/**
+ * @brief Calculates dst[i] = sqrt(fabs(src[i])) for count values.
+ */
+void prjm_eval_vector_sqrt(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+
+/**
+ * @brief Calculates dst[i] = prjm_eval_math_invsqrt(src[i]) for count values.
+ */
+void prjm_eval_vector_invsqrt(PRJM_EVAL_F* dst, const PRJM_EVAL_F* src, int count);
+
+/**
+ * @brief Calculates dst[i] = prjm_eval_math_pow(base[i], exponent[i]) for count values.
+ * dst may point to the same array as one of the arguments.
+ */
+void prjm_eval_vector_pow(PRJM_EVAL_F* dst, const PRJM_EVAL_F* base, const PRJM_EVAL_F* exponent, int count);
+
+/**
+ * @brief Calculates dst[i] = atan2(y[i], x[i]) for count values.
+ * dst may point to the same array as one of the arguments.
+ */
+void prjm_eval_vector_atan2(PRJM_EVAL_F* dst, const PRJM_EVAL_F* y, const PRJM_EVAL_F* x, int count);
+
+/**
+ * @brief Sets count values of dst to value.
+ */
+void prjm_eval_vector_fill(PRJM_EVAL_F* dst, PRJM_EVAL_F value, int count);
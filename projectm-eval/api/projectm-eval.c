@@ -3,6 +3,7 @@
 #include "projectm-eval/CompilerTypes.h"
 #include "projectm-eval/MemoryBuffer.h"
 #include "projectm-eval/CompileContext.h"
+#include "projectm-eval/CpuDispatch.h"
 #include "projectm-eval/TreeVariables.h"
 
 projectm_eval_mem_buffer projectm_eval_memory_buffer_create()
@@ -41,16 +42,59 @@ void projectm_eval_context_reset_variables(struct projectm_eval_context* ctx)
     prjm_eval_reset_context_vars(ctx);
 }
 
+void projectm_eval_context_set_tiering_threshold(struct projectm_eval_context* ctx, int threshold)
+{
+    ctx->tiering_threshold = threshold > 0 ? threshold : 0;
+}
+
+void projectm_eval_context_set_simplification(struct projectm_eval_context* ctx, int enabled)
+{
+    ctx->simplify_expressions = enabled != 0;
+}
+
+void projectm_eval_context_set_loop_vectorization(struct projectm_eval_context* ctx, int enabled)
+{
+    ctx->vectorize_loops = enabled != 0;
+}
+
+void projectm_eval_context_set_unroll_limit(struct projectm_eval_context* ctx, int node_limit)
+{
+    ctx->unroll_limit = node_limit > 0 ? node_limit : 0;
+}
+
 PRJM_EVAL_F* projectm_eval_context_register_variable(struct projectm_eval_context* ctx, const char* var_name)
 {
     return prjm_eval_register_variable(ctx, var_name);
 }
 
+int projectm_eval_context_set_output_variables(struct projectm_eval_context* ctx,
+                                               PRJM_EVAL_F* const* variables,
+                                               int variable_count)
+{
+    return prjm_eval_set_output_variables(ctx, variables, variable_count > 0 ? variable_count : 0);
+}
+
+int projectm_eval_context_freeze_variable(struct projectm_eval_context* ctx, PRJM_EVAL_F* var)
+{
+    return prjm_eval_set_variable_frozen(ctx, var, true);
+}
+
+int projectm_eval_context_unfreeze_variable(struct projectm_eval_context* ctx, PRJM_EVAL_F* var)
+{
+    return prjm_eval_set_variable_frozen(ctx, var, false);
+}
+
 struct projectm_eval_code* projectm_eval_code_compile(struct projectm_eval_context* ctx, const char* code)
 {
     return (struct projectm_eval_code*) prjm_eval_compile_code(ctx, code);
 }
 
+struct projectm_eval_code* projectm_eval_code_create_native(struct projectm_eval_context* ctx,
+                                                            const projectm_eval_native_program* program)
+{
+    return (struct projectm_eval_code*) prjm_eval_create_native_code(ctx, program);
+}
+
 void projectm_eval_code_destroy(struct projectm_eval_code* code_handle)
 {
     prjm_eval_destroy_code((prjm_eval_program_t*) code_handle);
@@ -63,19 +107,95 @@ PRJM_EVAL_F projectm_eval_code_execute(struct projectm_eval_code* code_handle)
         return 0.0;
     }
 
-    PRJM_EVAL_F result = 0.0;
-    PRJM_EVAL_F* result_ptr = &result;
-    prjm_eval_program_t* eval_program = (prjm_eval_program_t*)code_handle;
+    return prjm_eval_execute_code((prjm_eval_program_t*) code_handle);
+}
 
-    // Empty program.
-    if (!eval_program->program)
+void projectm_eval_code_execute_batch(struct projectm_eval_code* code_handle,
+                                      const projectm_eval_lane_variable* lane_variables,
+                                      int lane_variable_count,
+                                      int lane_count,
+                                      PRJM_EVAL_F* results)
+{
+    if (!code_handle)
     {
-        return 0.0;
+        return;
     }
 
-    eval_program->program->func(eval_program->program, &result_ptr);
+    prjm_eval_execute_code_batch((prjm_eval_program_t*) code_handle, lane_variables, lane_variable_count, lane_count,
+                                 results);
+}
 
-    return *result_ptr;
+int projectm_eval_code_set_uniform_variables(struct projectm_eval_code* code_handle,
+                                             PRJM_EVAL_F* const* variables,
+                                             int variable_count)
+{
+    if (!code_handle)
+    {
+        return 0;
+    }
+
+    return prjm_eval_set_code_uniform_variables((prjm_eval_program_t*) code_handle, variables,
+                                                variable_count > 0 ? variable_count : 0);
+}
+
+int projectm_eval_code_set_engine(struct projectm_eval_code* code_handle, projectm_eval_engine engine)
+{
+    if (!code_handle)
+    {
+        return 0;
+    }
+
+    return prjm_eval_set_code_engine((prjm_eval_program_t*) code_handle, engine);
+}
+
+projectm_eval_engine projectm_eval_code_get_engine(struct projectm_eval_code* code_handle)
+{
+    if (!code_handle)
+    {
+        return PROJECTM_EVAL_ENGINE_TREE;
+    }
+
+    return ((prjm_eval_program_t*) code_handle)->engine;
+}
+
+int projectm_eval_code_get_eliminated_subexpressions(struct projectm_eval_code* code_handle)
+{
+    if (!code_handle)
+    {
+        return 0;
+    }
+
+    return ((prjm_eval_program_t*) code_handle)->eliminated_subexpression_count;
+}
+
+int projectm_eval_code_set_batch_precision(struct projectm_eval_code* code_handle, projectm_eval_precision precision)
+{
+    if (!code_handle)
+    {
+        return 0;
+    }
+
+    return prjm_eval_set_code_batch_precision((prjm_eval_program_t*) code_handle, precision);
+}
+
+projectm_eval_precision projectm_eval_code_get_batch_precision(struct projectm_eval_code* code_handle)
+{
+    if (!code_handle)
+    {
+        return PROJECTM_EVAL_PRECISION_DEFAULT;
+    }
+
+    return ((prjm_eval_program_t*) code_handle)->batch_precision;
+}
+
+int projectm_eval_set_cpu_level(projectm_eval_cpu_level level)
+{
+    return prjm_eval_cpu_select(level);
+}
+
+projectm_eval_cpu_level projectm_eval_get_cpu_level()
+{
+    return prjm_eval_cpu_level();
 }
 
 const char* projectm_eval_get_error(struct projectm_eval_context* ctx, int* line, int* column)
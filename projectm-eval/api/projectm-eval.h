@@ -42,6 +42,75 @@ struct projectm_eval_code;
  */
 typedef PRJM_EVAL_F** projectm_eval_mem_buffer;
 
+/**
+ * @brief Available execution engines for compiled programs.
+ * All engines follow the evaluation rules of the tree interpreter, including when references returned by function
+ * arguments are read or written, so they produce the same results and only differ in execution speed. Comparisons
+ * involving NaN values are the exception in builds using -ffast-math, as the compiler may then evaluate them differently
+ * in each engine.
+ */
+typedef enum projectm_eval_engine
+{
+    PROJECTM_EVAL_ENGINE_TREE = 0, /*!< Recursively executes the expression tree. The default engine. */
+    PROJECTM_EVAL_ENGINE_BYTECODE = 1, /*!< Executes a flat bytecode program on a stack machine. */
+    PROJECTM_EVAL_ENGINE_REGISTER = 2, /*!< Executes three-address code on a frame of value slots holding all variables. */
+    PROJECTM_EVAL_ENGINE_JIT = 3, /*!< Executes native x86-64 machine code. Only available if built with ENABLE_JIT. */
+    PROJECTM_EVAL_ENGINE_NATIVE = 4 /*!< Executes a precompiled C function, see projectm_eval_code_create_native(). */
+} projectm_eval_engine;
+
+/**
+ * @brief CPU instruction set levels the batch and vector math kernels can be built for.
+ * All levels produce the same results, they only differ in execution speed.
+ */
+typedef enum projectm_eval_cpu_level
+{
+    PROJECTM_EVAL_CPU_GENERIC = 0, /*!< Code using only the instructions enabled by the build's compiler flags. */
+    PROJECTM_EVAL_CPU_SSE2 = 1, /*!< x86-64 baseline with 128-bit SSE2 vectors, used by the generic build on x86-64. */
+    PROJECTM_EVAL_CPU_AVX2 = 2, /*!< x86-64 with 256-bit AVX2 vectors. */
+    PROJECTM_EVAL_CPU_AVX512 = 3 /*!< x86-64 with 512-bit AVX-512F vectors. */
+} projectm_eval_cpu_level;
+
+/**
+ * @brief Arithmetic precision used to execute batches of lanes.
+ * Variables and memory always use PRJM_EVAL_F, only the values computed inside a batch are affected.
+ */
+typedef enum projectm_eval_precision
+{
+    PROJECTM_EVAL_PRECISION_DEFAULT = 0, /*!< Computes with PRJM_EVAL_F, the precision of variables and memory. */
+    PROJECTM_EVAL_PRECISION_FLOAT = 1 /*!< Computes in single precision, doubling the lanes per SIMD instruction. */
+} projectm_eval_precision;
+
+/**
+ * @brief Signature of a program precompiled to C by the projectm-eval-transpile tool.
+ * @param variables Pointers to the values of the variables named in the program description, in the same order.
+ * @param memory The context-local memory buffer (megabuf).
+ * @param global_memory The global memory buffer (gmegabuf).
+ * @return The return value of the last expression on the top-level instruction list of the program.
+ */
+typedef PRJM_EVAL_F (*projectm_eval_native_function)(PRJM_EVAL_F* const* variables,
+                                                    projectm_eval_mem_buffer memory,
+                                                    projectm_eval_mem_buffer global_memory);
+
+/**
+ * @brief Description of a precompiled program, as generated by the projectm-eval-transpile tool.
+ */
+typedef struct projectm_eval_native_program
+{
+    projectm_eval_native_function function; /*!< The generated program function. */
+    const char* const* variable_names; /*!< Names of all variables used by the program. */
+    int variable_count; /*!< Number of entries in variable_names. */
+    int float_size; /*!< The PRJM_F_SIZE the program was compiled with. Must match the library's setting. */
+} projectm_eval_native_program;
+
+/**
+ * @brief Binds a variable to an array of per-lane values for batch execution.
+ */
+typedef struct projectm_eval_lane_variable
+{
+    PRJM_EVAL_F* variable; /*!< The variable, as returned by @a projectm_eval_context_register_variable(). */
+    PRJM_EVAL_F* values; /*!< One value per lane. Read before and overwritten after executing each lane. */
+} projectm_eval_lane_variable;
+
 
 /**
  * @brief Host-defined lock function.
@@ -113,6 +182,51 @@ void projectm_eval_context_free_memory(struct projectm_eval_context* ctx);
  */
 void projectm_eval_context_reset_variables(struct projectm_eval_context* ctx);
 
+/**
+ * @brief Sets the number of executions after which programs are moved to a faster engine.
+ * Programs start with the tree interpreter, which has no translation cost, so code which is executed only a few
+ * times, like init code, is run without delay. Once a program was executed the given number of times, it is
+ * translated for the fastest available engine, i.e. the JIT engine if available, the register engine otherwise.
+ * See @a projectm_eval_engine for the differences between engines. Programs with an engine selected via
+ * @a projectm_eval_code_set_engine() are never moved. Tiering is disabled by default, so programs stay with the tree
+ * interpreter unless the application enables it.
+ * @param ctx The context to change. The threshold applies to code compiled in this context afterwards.
+ * @param threshold The number of executions before moving a program, or 0 to disable automatic engine selection.
+ */
+void projectm_eval_context_set_tiering_threshold(struct projectm_eval_context* ctx, int threshold);
+
+/**
+ * @brief Enables the algebraic simplification of code compiled in this context afterwards.
+ * Costly operations are rewritten into cheaper equivalents, e.g. pow(x, 2) into sqr(x), small integer powers into
+ * multiplications and divisions by constants into multiplications by their reciprocal. Some of these rewrites round
+ * differently, so results may differ in the last bits of the mantissa. Disabled by default.
+ * @param ctx The context to change.
+ * @param enabled Non-zero to enable the simplification, 0 to disable it.
+ */
+void projectm_eval_context_set_simplification(struct projectm_eval_context* ctx, int enabled);
+
+/**
+ * @brief Enables the vectorization of loops in code compiled in this context afterwards.
+ * The register and JIT engines execute the iterations of a loop() in batches, like
+ * @a projectm_eval_code_execute_batch() executes lanes, if the iterations only depend on each other through a variable
+ * increased by a constant, e.g. "megabuf(i) = megabuf(i) * 0.5; i += 1". Memory written by the loop must be indexed by
+ * this variable plus a constant. The batches use vectorized math functions, so results may differ in the last bits of
+ * the mantissa. Disabled by default.
+ * @param ctx The context to change.
+ * @param enabled Non-zero to enable the vectorization, 0 to disable it.
+ */
+void projectm_eval_context_set_loop_vectorization(struct projectm_eval_context* ctx, int enabled);
+
+/**
+ * @brief Sets how much code may be generated by unrolling loops with constant counts, like loop(8, ...).
+ * If the loop body, copied once per iteration, has no more than the given number of expression nodes, the loop is
+ * replaced by these copies. Otherwise, larger loops execute several copies per iteration if these fit into the limit.
+ * Unrolling doesn't change any results. The default limit is 64 nodes.
+ * @param ctx The context to change. The limit applies to code compiled in this context afterwards.
+ * @param node_limit The maximum number of nodes of the copied loop bodies, or 0 to disable unrolling.
+ */
+void projectm_eval_context_set_unroll_limit(struct projectm_eval_context* ctx, int node_limit);
+
 /**
  * @brief Registers a variable and returns the value pointer.
  * Variables can be registered at any time. If the variable doesn't exist yet, it is created, otherwise
@@ -124,6 +238,47 @@ void projectm_eval_context_reset_variables(struct projectm_eval_context* ctx);
  */
 PRJM_EVAL_F* projectm_eval_context_register_variable(struct projectm_eval_context* ctx, const char* var_name);
 
+/**
+ * @brief Declares which variables are read after code compiled in the context was executed.
+ * Outputs are the variables the host reads, e.g. zoom, rot, warp and q1 to q32, and the variables read by other code
+ * compiled in the same context, as well as variables the host binds to lanes in
+ * @a projectm_eval_code_execute_batch(). Code compiled afterwards only keeps assignments to other variables if the
+ * code reads them later, also in its next execution. All other assignments are removed, keeping only the side effects
+ * of the assigned values, e.g. memory changes. reg00 to reg99 and the memory buffers are always kept. By default, all
+ * variables are outputs.
+ * @param ctx The context to change.
+ * @param variables The output variables, as returned by @a projectm_eval_context_register_variable(), or NULL to
+ *                  consider all variables as outputs again. Code which was already compiled isn't changed.
+ * @param variable_count Number of entries in variables.
+ * @return 1 on success, 0 if an allocation failed.
+ */
+int projectm_eval_context_set_output_variables(struct projectm_eval_context* ctx,
+                                               PRJM_EVAL_F* const* variables,
+                                               int variable_count);
+
+/**
+ * @brief Declares a variable as constant for all code compiled in the context.
+ * Code reading the variable is specialized for its current value before it is executed the next time: the variable is
+ * replaced by its value and constant expressions are folded, e.g. "x = meshx * 2" becomes a single assignment of a
+ * constant. If the host changes the value of a frozen variable, affected code is specialized again for the new value
+ * on its next execution, which recompiles it. Freeze only variables which change rarely, e.g. the mesh size or
+ * preset parameters. Code which assigns the variable somewhere isn't specialized for it. Frozen variables must not be
+ * bound to lane values in @a projectm_eval_code_execute_batch().
+ * @param ctx The context the variable belongs to.
+ * @param var The variable, as returned by @a projectm_eval_context_register_variable().
+ * @return 1 on success, 0 if the variable doesn't belong to the context. reg00 to reg99 can't be frozen.
+ */
+int projectm_eval_context_freeze_variable(struct projectm_eval_context* ctx, PRJM_EVAL_F* var);
+
+/**
+ * @brief Removes the constant declaration of a variable made with @a projectm_eval_context_freeze_variable().
+ * Code specialized for the variable is compiled again on its next execution.
+ * @param ctx The context the variable belongs to.
+ * @param var The variable, as returned by @a projectm_eval_context_register_variable().
+ * @return 1 on success, 0 if the variable doesn't belong to the context.
+ */
+int projectm_eval_context_unfreeze_variable(struct projectm_eval_context* ctx, PRJM_EVAL_F* var);
+
 /**
  * @brief Compiled the given code into an executable program.
  * Call @a projectm_eval_get_error() to retrieve the compiler error and location on compilation failure.
@@ -133,6 +288,17 @@ PRJM_EVAL_F* projectm_eval_context_register_variable(struct projectm_eval_contex
  */
 struct projectm_eval_code* projectm_eval_code_compile(struct projectm_eval_context* ctx, const char* code);
 
+/**
+ * @brief Creates a code handle for a program precompiled to C with the projectm-eval-transpile tool.
+ * The variables used by the program are registered in the context, so the precompiled code shares them with any
+ * other code in the context like compiled code would. The program always uses the PROJECTM_EVAL_ENGINE_NATIVE engine.
+ * @param ctx The context to associate the code with.
+ * @param program The program description generated by the tool. Must stay valid as long as the code handle is used.
+ * @return A handle for the precompiled program or NULL if the program was built with a different float size.
+ */
+struct projectm_eval_code* projectm_eval_code_create_native(struct projectm_eval_context* ctx,
+                                                            const projectm_eval_native_program* program);
+
 /**
  * @brief Destroys a previously compiled code handle.
  * Frees only the compiled code, but no associated resources like variables and megabuf contents.
@@ -149,6 +315,120 @@ void projectm_eval_code_destroy(struct projectm_eval_code* code_handle);
  */
 PRJM_EVAL_F projectm_eval_code_execute(struct projectm_eval_code* code_handle);
 
+/**
+ * @brief Executes the code in the given handle once for each of multiple lanes, like a per-point or per-pixel loop.
+ * The result is the same as loading the lane values into the bound variables, executing the code and storing the
+ * variables back into the lane arrays for each lane in turn. The lanes are executed together to make use of SIMD
+ * instructions, which requires that lanes are independent of each other: every variable not bound to lane values
+ * starts with its value from before the call in each lane, and lanes must not read memory (megabuf/gmegabuf) written
+ * by other lanes in the same call. After the call, unbound variables and the bound variables themselves hold the
+ * values of the last lane.
+ * @param code_handle The compiled code to execute.
+ * @param lane_variables The variables with per-lane values.
+ * @param lane_variable_count Number of entries in lane_variables.
+ * @param lane_count Number of lanes to execute, the size of each values array.
+ * @param results If not NULL, receives the return value of the program for each lane.
+ */
+void projectm_eval_code_execute_batch(struct projectm_eval_code* code_handle,
+                                      const projectm_eval_lane_variable* lane_variables,
+                                      int lane_variable_count,
+                                      int lane_count,
+                                      PRJM_EVAL_F* results);
+
+/**
+ * @brief Marks variables as uniform for batch execution of the given code.
+ * Uniform variables have the same value in all lanes of a batch, e.g. per-frame values like time, bass or q1 in
+ * per-point code. Computations which only depend on constants and uniform variables are then executed once per
+ * @a projectm_eval_code_execute_batch() call in a prologue, and the code executed per lane reads their results.
+ * Variables which are assigned by the program can't be uniform and are ignored. If one of the uniform variables is
+ * bound to lane values in a batch call, the batch is executed without the prologue. The results are the same as
+ * without uniform variables, except for the last bits of transcendental functions, which are computed by the scalar
+ * math functions in the prologue.
+ * @param code_handle The compiled code to change.
+ * @param variables The uniform variables, as returned by @a projectm_eval_context_register_variable(). Replaces the
+ *                  uniform variables of previous calls.
+ * @param variable_count Number of entries in variables, 0 to execute all computations per lane again.
+ * @return The number of operations moved into the prologue, 0 if nothing could be hoisted or the code is a
+ *         precompiled native program, -1 if an allocation failed.
+ */
+int projectm_eval_code_set_uniform_variables(struct projectm_eval_code* code_handle,
+                                             PRJM_EVAL_F* const* variables,
+                                             int variable_count);
+
+/**
+ * @brief Returns the number of repeated subexpressions the compiler replaced by a previously computed value.
+ * Identical expressions without side effects, e.g. "sin(time * 0.3)" used in several statements, are computed once
+ * per execution as long as none of the variables they read is assigned in between.
+ * @param code_handle The compiled code.
+ * @return The number of replaced subexpressions, 0 for precompiled native programs.
+ */
+int projectm_eval_code_get_eliminated_subexpressions(struct projectm_eval_code* code_handle);
+
+/**
+ * @brief Selects the arithmetic precision used by @a projectm_eval_code_execute_batch() for the given code.
+ * With PROJECTM_EVAL_PRECISION_FLOAT, lane values and all variables the program uses are converted to float when a
+ * batch starts, all operations are computed in single precision and the values are converted back when the batch
+ * ends. Values which weren't changed by the program keep their exact previous value. This is meant for per-pixel code
+ * with visual results only, where double precision isn't needed. Results differ from the default precision by the
+ * float rounding errors, and may differ in the last bits depending on the CPU level. Executing the code with
+ * @a projectm_eval_code_execute() always uses the default precision.
+ * @param code_handle The compiled code to change.
+ * @param precision The precision to use for batch execution.
+ * @return 1 if the precision was changed, 0 if the code is a precompiled native program, which always uses the
+ *         default precision.
+ */
+int projectm_eval_code_set_batch_precision(struct projectm_eval_code* code_handle, projectm_eval_precision precision);
+
+/**
+ * @brief Returns the arithmetic precision used by @a projectm_eval_code_execute_batch() for the given code.
+ * @param code_handle The compiled code.
+ * @return The batch precision.
+ */
+projectm_eval_precision projectm_eval_code_get_batch_precision(struct projectm_eval_code* code_handle);
+
+/**
+ * @brief Selects the engine used to execute the code in the given handle.
+ * The program is translated for the new engine on first use, so calling this function once after compiling
+ * the code is recommended. Variables and memory contents are shared between all engines, so the engine
+ * can be changed at any time. Selecting an engine disables automatic engine selection for the code. Precompiled
+ * native code can't be translated for other engines.
+ * @param code_handle The compiled code to change.
+ * @param engine The execution engine to use.
+ * @return 1 if the engine was changed, 0 if the program couldn't be translated for the requested engine. In the
+ *         latter case, the previous engine stays active.
+ */
+int projectm_eval_code_set_engine(struct projectm_eval_code* code_handle, projectm_eval_engine engine);
+
+/**
+ * @brief Returns the engine currently used to execute the code in the given handle.
+ * This may change after executing the code if it was moved to a faster engine, see
+ * @a projectm_eval_context_set_tiering_threshold().
+ * @param code_handle The compiled code.
+ * @return The active execution engine.
+ */
+projectm_eval_engine projectm_eval_code_get_engine(struct projectm_eval_code* code_handle);
+
+/**
+ * @brief Selects the kernel variant used by batch execution and other array operations.
+ * By default, the best variant supported by the CPU is selected when the first context is created. The
+ * PROJECTM_EVAL_CPU environment variable ("generic", "sse2", "avx2" or "avx512") limits this default to a lower
+ * level. This function is mainly meant for testing and benchmarking and must not be called while code is
+ * executed in other threads.
+ * @param level The highest instruction set level to use. The best built variant up to this level is selected.
+ * @return 1 if the CPU supports the requested level, 0 if it doesn't. In the latter case, the previous variant stays
+ *         active.
+ */
+int projectm_eval_set_cpu_level(projectm_eval_cpu_level level);
+
+/**
+ * @brief Returns the instruction set level of the active kernel variant.
+ * On x86-64, the generic build uses SSE2 and is selected for both PROJECTM_EVAL_CPU_GENERIC and
+ * PROJECTM_EVAL_CPU_SSE2, reporting the requested level. Without ENABLE_CPU_DISPATCH, the level is therefore at most
+ * PROJECTM_EVAL_CPU_SSE2 on x86-64. On other CPUs, it is always PROJECTM_EVAL_CPU_GENERIC.
+ * @return The active instruction set level.
+ */
+projectm_eval_cpu_level projectm_eval_get_cpu_level();
+
 /**
  * @brief Returns the error message of the last failed compile operation in the given context.
  * The error message is cleared every time new code is compiled.
@@ -0,0 +1,259 @@
+#include "BatchPrecisionTest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+const std::vector<std::string> BatchPrecisionTest::m_laneVariableNames{"x", "y", "rad", "ang", "zoom", "rot",
+                                                                       "dx", "dy", "sx", "sy", "warp"};
+
+void BatchPrecisionTest::SetUp()
+{
+    for (auto* executionContext : {&m_default, &m_float})
+    {
+        executionContext->globalMemory = projectm_eval_memory_buffer_create();
+        executionContext->context = projectm_eval_context_create(executionContext->globalMemory,
+                                                                 &executionContext->globalRegisters);
+
+        *projectm_eval_context_register_variable(executionContext->context, "time") = 100.125;
+        *projectm_eval_context_register_variable(executionContext->context, "bass") = 1.3;
+        *projectm_eval_context_register_variable(executionContext->context, "mid") = 0.9;
+        *projectm_eval_context_register_variable(executionContext->context, "treb") = 1.25;
+
+        // Mesh point coordinates with the motion values at rest, see the ProgramBenchmarks.
+        executionContext->laneValues.assign(m_laneVariableNames.size(), std::vector<PRJM_EVAL_F>(m_laneCount, 1.0));
+        for (int point = 0; point < m_laneCount; point++)
+        {
+            auto x = static_cast<PRJM_EVAL_F>(point % 48) / 47.0;
+            auto y = static_cast<PRJM_EVAL_F>(point / 48) / 35.0;
+            executionContext->laneValues[0][point] = x;
+            executionContext->laneValues[1][point] = y;
+            executionContext->laneValues[2][point] = std::sqrt((x - 0.5) * (x - 0.5) + (y - 0.5) * (y - 0.5)) * 1.4142;
+            executionContext->laneValues[3][point] = std::atan2(y - 0.5, x - 0.5) + 3.14159;
+        }
+    }
+}
+
+void BatchPrecisionTest::TearDown()
+{
+    for (auto* executionContext : {&m_default, &m_float})
+    {
+        projectm_eval_context_destroy(executionContext->context);
+        projectm_eval_memory_buffer_destroy(executionContext->globalMemory);
+    }
+}
+
+BatchPrecisionTest::Accuracy BatchPrecisionTest::MeasureAccuracy(const std::string& code)
+{
+    std::vector<PRJM_EVAL_F> results[2];
+    int index = 0;
+    for (auto* executionContext : {&m_default, &m_float})
+    {
+        auto codeHandle = projectm_eval_code_compile(executionContext->context, code.c_str());
+        EXPECT_NE(codeHandle, nullptr);
+        if (!codeHandle)
+        {
+            return {};
+        }
+
+        auto precision = executionContext == &m_float ? PROJECTM_EVAL_PRECISION_FLOAT
+                                                      : PROJECTM_EVAL_PRECISION_DEFAULT;
+        EXPECT_EQ(projectm_eval_code_set_batch_precision(codeHandle, precision), 1);
+        EXPECT_EQ(projectm_eval_code_get_batch_precision(codeHandle), precision);
+
+        std::vector<projectm_eval_lane_variable> laneVariables;
+        for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+        {
+            laneVariables.push_back({projectm_eval_context_register_variable(executionContext->context,
+                                                                             m_laneVariableNames[variable].c_str()),
+                                     executionContext->laneValues[variable].data()});
+        }
+
+        results[index].resize(m_laneCount);
+        projectm_eval_code_execute_batch(codeHandle, laneVariables.data(), static_cast<int>(laneVariables.size()),
+                                         m_laneCount, results[index].data());
+        index++;
+
+        projectm_eval_code_destroy(codeHandle);
+    }
+
+    Accuracy accuracy;
+    auto compare = [&accuracy](PRJM_EVAL_F expected, PRJM_EVAL_F value, const std::string& name) {
+        double error = std::fabs(static_cast<double>(value) - static_cast<double>(expected));
+        if (error > accuracy.maxAbsoluteError)
+        {
+            accuracy.maxAbsoluteError = error;
+            accuracy.worstVariable = name;
+        }
+        accuracy.maxRelativeError = std::max(accuracy.maxRelativeError,
+                                             error / std::max(1.0, std::fabs(static_cast<double>(expected))));
+    };
+
+    for (int lane = 0; lane < m_laneCount; lane++)
+    {
+        compare(results[0][lane], results[1][lane], "result");
+        for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+        {
+            compare(m_default.laneValues[variable][lane], m_float.laneValues[variable][lane],
+                    m_laneVariableNames[variable]);
+        }
+    }
+
+    return accuracy;
+}
+
+TEST_F(BatchPrecisionTest, SelectPrecision)
+{
+    auto code = projectm_eval_code_compile(m_default.context, "x = x * 2");
+    ASSERT_NE(code, nullptr);
+
+    EXPECT_EQ(projectm_eval_code_get_batch_precision(code), PROJECTM_EVAL_PRECISION_DEFAULT);
+    EXPECT_EQ(projectm_eval_code_set_batch_precision(code, PROJECTM_EVAL_PRECISION_FLOAT), 1);
+    EXPECT_EQ(projectm_eval_code_get_batch_precision(code), PROJECTM_EVAL_PRECISION_FLOAT);
+    EXPECT_EQ(projectm_eval_code_set_batch_precision(code, static_cast<projectm_eval_precision>(42)), 0);
+    EXPECT_EQ(projectm_eval_code_get_batch_precision(code), PROJECTM_EVAL_PRECISION_FLOAT);
+
+    // Single executions always use the default precision.
+    auto* x = projectm_eval_context_register_variable(m_default.context, "x");
+    *x = 1.0 + 1e-12;
+    projectm_eval_code_execute(code);
+    EXPECT_EQ(*x, static_cast<PRJM_EVAL_F>(1.0 + 1e-12) * 2);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(BatchPrecisionTest, UnchangedValuesKeepPrecision)
+{
+    auto code = projectm_eval_code_compile(m_float.context, "dx = x * 2; dy = if(y > 0.5, y, dy); reg01 = t;");
+    ASSERT_NE(code, nullptr);
+    ASSERT_EQ(projectm_eval_code_set_batch_precision(code, PROJECTM_EVAL_PRECISION_FLOAT), 1);
+
+    auto* t = projectm_eval_context_register_variable(m_float.context, "t");
+    auto* time = projectm_eval_context_register_variable(m_float.context, "time");
+    const auto preciseValue = static_cast<PRJM_EVAL_F>(0.1);
+    *t = preciseValue;
+
+    std::vector<PRJM_EVAL_F> x(m_laneCount, preciseValue);
+    std::vector<PRJM_EVAL_F> y(m_laneCount, preciseValue);
+    std::vector<PRJM_EVAL_F> dx(m_laneCount, preciseValue);
+    std::vector<PRJM_EVAL_F> dy(m_laneCount, preciseValue);
+    projectm_eval_lane_variable laneVariables[]{
+        {projectm_eval_context_register_variable(m_float.context, "x"), x.data()},
+        {projectm_eval_context_register_variable(m_float.context, "y"), y.data()},
+        {projectm_eval_context_register_variable(m_float.context, "dx"), dx.data()},
+        {projectm_eval_context_register_variable(m_float.context, "dy"), dy.data()},
+    };
+
+    projectm_eval_code_execute_batch(code, laneVariables, 4, m_laneCount, nullptr);
+
+    // Values only read or not changed by the program keep their exact value, changed values are rounded to float.
+    for (int lane = 0; lane < m_laneCount; lane++)
+    {
+        EXPECT_EQ(x[lane], preciseValue);
+        EXPECT_EQ(y[lane], preciseValue);
+        EXPECT_EQ(dy[lane], preciseValue);
+        EXPECT_EQ(dx[lane], static_cast<PRJM_EVAL_F>(static_cast<float>(preciseValue) * 2.0f));
+    }
+    EXPECT_EQ(*t, preciseValue);
+    EXPECT_EQ(*time, static_cast<PRJM_EVAL_F>(100.125));
+    EXPECT_EQ(m_float.globalRegisters[1], static_cast<PRJM_EVAL_F>(static_cast<float>(preciseValue)));
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(BatchPrecisionTest, MemoryAndReferences)
+{
+    // Memory keeps the storage precision, single precision values are converted on each access.
+    auto code = projectm_eval_code_compile(m_float.context, R"(
+        index = floor(x * 47 + 0.5) + floor(y * 35 + 0.5) * 48;
+        megabuf(index) += x;
+        gmegabuf(index) = (dx = megabuf(index) * 2);
+        (y > 0.5 ? megabuf(index + 2000) : dy) = 3;
+        memset(4000 + index, y, 1);
+        sy = megabuf(4000 + index) + megabuf(index + 2000);
+    )");
+    ASSERT_NE(code, nullptr);
+    ASSERT_EQ(projectm_eval_code_set_batch_precision(code, PROJECTM_EVAL_PRECISION_FLOAT), 1);
+
+    std::vector<projectm_eval_lane_variable> laneVariables;
+    for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+    {
+        laneVariables.push_back({projectm_eval_context_register_variable(m_float.context,
+                                                                         m_laneVariableNames[variable].c_str()),
+                                 m_float.laneValues[variable].data()});
+    }
+    projectm_eval_code_execute_batch(code, laneVariables.data(), static_cast<int>(laneVariables.size()), m_laneCount,
+                                     nullptr);
+
+    auto memoryCode = projectm_eval_code_compile(m_float.context, "gmegabuf(index)");
+    auto* index = projectm_eval_context_register_variable(m_float.context, "index");
+    for (int point = 0; point < m_laneCount; point++)
+    {
+        auto x = static_cast<float>(m_float.laneValues[0][point]);
+        auto y = static_cast<float>(m_float.laneValues[1][point]);
+        *index = point;
+        EXPECT_FLOAT_EQ(static_cast<float>(projectm_eval_code_execute(memoryCode)), x * 2.0f) << "Point " << point;
+        EXPECT_FLOAT_EQ(static_cast<float>(m_float.laneValues[6][point]), x * 2.0f) << "Point " << point;
+        EXPECT_FLOAT_EQ(static_cast<float>(m_float.laneValues[7][point]), y > 0.5f ? 1.0f : 3.0f)
+            << "Point " << point;
+        EXPECT_FLOAT_EQ(static_cast<float>(m_float.laneValues[9][point]), y + (y > 0.5f ? 3.0f : 0.0f))
+            << "Point " << point;
+    }
+
+    projectm_eval_code_destroy(memoryCode);
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(BatchPrecisionTest, ZeroComparisons)
+{
+    // Comparisons against zero and equality tests have exact results in both precisions.
+    EXPECT_EQ(MeasureAccuracy("sx = (x == x); sy = (y != y); dx = (x == 0.5); dy = !(x < 0.5)").maxAbsoluteError, 0.0);
+    EXPECT_EQ(MeasureAccuracy("k = (y < 0.5); warp = !k + !(k == k) * 2; zoom = (x > 0.5) && !k").maxAbsoluteError,
+              0.0);
+    EXPECT_EQ(MeasureAccuracy("n = 0; k = 0; while(n += 1; k = !(n >= x * 8); k); rot = n").maxAbsoluteError, 0.0);
+}
+
+TEST_F(BatchPrecisionTest, AccuracyReport)
+{
+    // Per-pixel code of typical presets, including the code used by the benchmarks. Memory cells are only used by a
+    // single lane, as lanes must be independent.
+    const std::vector<std::pair<std::string, std::string>> corpus{
+        {"Benchmark mesh",
+         "zoom = zoom + 0.05 * sin(rad * 6 + time);"
+         "rot = rot + 0.02 * cos(ang * 3 - time * 0.5);"
+         "dx = dx + if(rad < 0.5, 0.01 * cos(ang), -0.01 * cos(ang));"
+         "dy = dy + if(rad < 0.5, 0.01 * sin(ang), -0.01 * sin(ang));"
+         "warp = warp * 0.8 + if(above(treb, 1.2), 0.3, 0.1);"},
+        {"Memory feedback",
+         "index = floor(x * 47 + 0.5) + floor(y * 35 + 0.5) * 48;"
+         "megabuf(index) = megabuf(index) * 0.9 + zoom * 0.1; zoom = zoom + 0.1 * megabuf(index); megabuf(index)"},
+        {"Audio scaling", "sx = sx * 0.99 + 0.01 * bass; sy = sy * 0.99 + 0.01 * mid; zoom = zoom * (1 + 0.02 * treb)"},
+        {"Transcendentals",
+         "dx = 0.01 * pow(rad, 1.5) * sin(ang * 4 + time); dy = 0.01 * atan2(y - 0.5, x - 0.5) / 3.14159;"
+         "zoom = 1 + 0.1 * exp(-rad * 2) + log(1 + rad) * 0.05; rot = sqrt(rad) * 0.02 * cos(time) + tan(ang) * 0.001"},
+        {"Polar warp",
+         "r = rad * (1 + 0.1 * sin(time * 2 + ang * 5)); a = ang + 0.1 * r;"
+         "dx = r * cos(a) * 0.5 + 0.5 - x; dy = r * sin(a) * 0.5 + 0.5 - y; r"},
+        {"Loop",
+         "v = 0; loop(8, v = v * 0.5 + sin(x * 10 + v) * cos(y * 10 - v)); warp = 1 + v * 0.1; v"},
+    };
+
+    std::cout << "Single precision batch accuracy, " << m_laneCount << " lanes:" << std::endl
+              << std::left << std::setw(24) << "Program" << std::setw(16) << "Max abs error"
+              << std::setw(16) << "Max rel error" << "Worst variable" << std::endl;
+
+    for (const auto& program : corpus)
+    {
+        SCOPED_TRACE(program.first);
+        auto accuracy = MeasureAccuracy(program.second);
+
+        std::cout << std::left << std::setw(24) << program.first << std::setw(16) << std::setprecision(3)
+                  << accuracy.maxAbsoluteError << std::setw(16) << accuracy.maxRelativeError
+                  << accuracy.worstVariable << std::endl;
+        RecordProperty(program.first, std::to_string(accuracy.maxRelativeError));
+
+        // Visual parameters only need a few significant digits, the float rounding errors are far below that.
+        EXPECT_LT(accuracy.maxRelativeError, 1e-4);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compares batch execution in single precision with the default precision.
+ * Both runs use separate contexts with the same initial values. The lanes are the points of a 48x36 mesh, binding the
+ * usual per-pixel variables, while time and the audio values are shared by all lanes.
+ */
+class BatchPrecisionTest : public testing::Test
+{
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Maximum difference between the single and default precision results of a program.
+     */
+    struct Accuracy
+    {
+        double maxAbsoluteError{}; //!< Largest absolute difference of a lane value or result.
+        double maxRelativeError{}; //!< Largest difference relative to the default precision value, at least 1.
+        std::string worstVariable; //!< The variable with the largest absolute difference.
+    };
+
+    /**
+     * @brief Executes the code as a batch in both precisions and returns the differences of the lane values.
+     * @param code The code to check.
+     * @return The measured accuracy.
+     */
+    Accuracy MeasureAccuracy(const std::string& code);
+
+    struct ExecutionContext
+    {
+        struct projectm_eval_context* context{};
+        projectm_eval_mem_buffer globalMemory{};
+        PRJM_EVAL_F globalRegisters[100]{};
+        std::vector<std::vector<PRJM_EVAL_F>> laneValues;
+    };
+
+    ExecutionContext m_default; //!< Context executing batches in the default precision.
+    ExecutionContext m_float; //!< Context executing batches in single precision.
+
+    static const std::vector<std::string> m_laneVariableNames;
+    static constexpr int m_laneCount = 48 * 36;
+};
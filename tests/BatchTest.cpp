@@ -0,0 +1,255 @@
+#include "BatchTest.hpp"
+
+#include <cmath>
+
+const std::vector<std::string> BatchTest::m_laneVariableNames{"i", "x", "y", "z"};
+const std::vector<std::string> BatchTest::m_sharedVariableNames{"a", "b", "n", "t"};
+
+void BatchTest::SetUp()
+{
+    for (auto* executionContext : {&m_scalar, &m_batch})
+    {
+        executionContext->globalMemory = projectm_eval_memory_buffer_create();
+        executionContext->context = projectm_eval_context_create(executionContext->globalMemory,
+                                                                 &executionContext->globalRegisters);
+
+        *projectm_eval_context_register_variable(executionContext->context, "a") = 0.5;
+        *projectm_eval_context_register_variable(executionContext->context, "n") = 3;
+        executionContext->globalRegisters[1] = 2.0;
+    }
+}
+
+void BatchTest::TearDown()
+{
+    for (auto* executionContext : {&m_scalar, &m_batch})
+    {
+        projectm_eval_context_destroy(executionContext->context);
+        projectm_eval_memory_buffer_destroy(executionContext->globalMemory);
+    }
+}
+
+int BatchTest::ExpectSameResults(const std::string& code, int laneCount,
+                                 const std::vector<std::string>& uniformVariableNames)
+{
+    SCOPED_TRACE(code);
+
+    auto scalarCode = projectm_eval_code_compile(m_scalar.context, code.c_str());
+    auto batchCode = projectm_eval_code_compile(m_batch.context, code.c_str());
+    EXPECT_NE(scalarCode, nullptr);
+    EXPECT_NE(batchCode, nullptr);
+    if (!scalarCode || !batchCode)
+    {
+        return 0;
+    }
+
+    std::vector<PRJM_EVAL_F*> uniformVariables;
+    for (const auto& name : uniformVariableNames)
+    {
+        uniformVariables.push_back(projectm_eval_context_register_variable(m_batch.context, name.c_str()));
+    }
+    int hoistedCount = projectm_eval_code_set_uniform_variables(batchCode, uniformVariables.data(),
+                                                                static_cast<int>(uniformVariables.size()));
+    EXPECT_GE(hoistedCount, 0);
+
+    std::vector<std::vector<PRJM_EVAL_F>> scalarValues;
+    std::vector<std::vector<PRJM_EVAL_F>> batchValues;
+    for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+    {
+        std::vector<PRJM_EVAL_F> values;
+        for (int lane = 0; lane < laneCount; lane++)
+        {
+            // The first variable holds the lane index.
+            values.push_back(variable == 0 ? lane : std::sin(static_cast<PRJM_EVAL_F>(lane * 7 + variable * 3)) * (lane % 5));
+        }
+        scalarValues.push_back(values);
+        batchValues.push_back(values);
+    }
+
+    // Reference: load, execute and store each lane in turn.
+    std::vector<PRJM_EVAL_F> scalarResults(laneCount);
+    for (int lane = 0; lane < laneCount; lane++)
+    {
+        for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+        {
+            *projectm_eval_context_register_variable(m_scalar.context, m_laneVariableNames[variable].c_str()) =
+                scalarValues[variable][lane];
+        }
+
+        scalarResults[lane] = projectm_eval_code_execute(scalarCode);
+
+        for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+        {
+            scalarValues[variable][lane] =
+                *projectm_eval_context_register_variable(m_scalar.context, m_laneVariableNames[variable].c_str());
+        }
+    }
+
+    std::vector<projectm_eval_lane_variable> laneVariables;
+    for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+    {
+        laneVariables.push_back({projectm_eval_context_register_variable(m_batch.context,
+                                                                         m_laneVariableNames[variable].c_str()),
+                                 batchValues[variable].data()});
+    }
+
+    std::vector<PRJM_EVAL_F> batchResults(laneCount);
+    projectm_eval_code_execute_batch(batchCode, laneVariables.data(), static_cast<int>(laneVariables.size()),
+                                     laneCount, batchResults.data());
+
+    for (int lane = 0; lane < laneCount; lane++)
+    {
+        EXPECT_DOUBLE_EQ(batchResults[lane], scalarResults[lane]) << "Lane " << lane;
+
+        for (size_t variable = 0; variable < m_laneVariableNames.size(); variable++)
+        {
+            EXPECT_DOUBLE_EQ(batchValues[variable][lane], scalarValues[variable][lane])
+                << "Variable " << m_laneVariableNames[variable] << ", lane " << lane;
+        }
+    }
+
+    for (const auto& name : m_laneVariableNames)
+    {
+        EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_batch.context, name.c_str()),
+                         *projectm_eval_context_register_variable(m_scalar.context, name.c_str()))
+            << "Variable " << name;
+    }
+
+    for (const auto& name : m_sharedVariableNames)
+    {
+        EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_batch.context, name.c_str()),
+                         *projectm_eval_context_register_variable(m_scalar.context, name.c_str()))
+            << "Variable " << name;
+    }
+
+    for (int reg = 0; reg < 100; reg++)
+    {
+        EXPECT_DOUBLE_EQ(m_batch.globalRegisters[reg], m_scalar.globalRegisters[reg]) << "Register " << reg;
+    }
+
+    // Compare memory contents via a separate program, executed by the tree interpreter in both contexts.
+    auto scalarMemoryCode = projectm_eval_code_compile(m_scalar.context, "megabuf(b) + 1000 * gmegabuf(b)");
+    auto batchMemoryCode = projectm_eval_code_compile(m_batch.context, "megabuf(b) + 1000 * gmegabuf(b)");
+    auto* scalarIndex = projectm_eval_context_register_variable(m_scalar.context, "b");
+    auto* batchIndex = projectm_eval_context_register_variable(m_batch.context, "b");
+
+    for (int index = 0; index < 2 * laneCount; index++)
+    {
+        *scalarIndex = index;
+        *batchIndex = index;
+        EXPECT_DOUBLE_EQ(projectm_eval_code_execute(batchMemoryCode), projectm_eval_code_execute(scalarMemoryCode))
+            << "Memory index " << index;
+    }
+
+    projectm_eval_code_destroy(scalarMemoryCode);
+    projectm_eval_code_destroy(batchMemoryCode);
+    projectm_eval_code_destroy(scalarCode);
+    projectm_eval_code_destroy(batchCode);
+
+    return hoistedCount;
+}
+
+TEST_F(BatchTest, Arithmetic)
+{
+    ExpectSameResults("x = x * a + y; y = sin(x) + cos(y) * reg01; z = sqrt(abs(x)) - pow(abs(y), 1.5) % 3; x + y");
+    ExpectSameResults("z = min(x, y) + max(x, y) + sqr(x) / (y + 0.5) + floor(x * 10) + sign(y); -z");
+}
+
+TEST_F(BatchTest, Conditionals)
+{
+    ExpectSameResults("x = if(x > 0, x * 2, y - 1); y = if(above(y, 0.5), sin(y), if(below(x, 0), 1, 2))");
+    ExpectSameResults("z = x > 0 && y > 0; y = (x < 0 || y < 0) + (x == y)");
+    ExpectSameResults("x > 0 ? (z = 1; y = 2) : (z = 3; y); x > 0.5 ? y += 1 : z -= 1;");
+}
+
+TEST_F(BatchTest, Loops)
+{
+    ExpectSameResults("loop(floor(abs(x) * 3), y += 1; z = z * 0.5 + y);");
+    ExpectSameResults("z = 0; while(z += 1; y -= 0.25; y > 0); z");
+    ExpectSameResults("z = 0; loop(n, loop(floor(abs(y) * 2), z += x););");
+}
+
+TEST_F(BatchTest, SharedVariables)
+{
+    // Shared variables written by every lane must keep the value of the last lane.
+    ExpectSameResults("t = x * a; reg02 = t + y; z = t + reg02 + reg01");
+}
+
+TEST_F(BatchTest, Memory)
+{
+    // Each lane uses its own memory cells, as lanes must not depend on each other's writes.
+    ExpectSameResults("megabuf(i * 2) = x; gmegabuf(i * 2 + 1) = y; z = megabuf(i * 2) + gmegabuf(i * 2 + 1)");
+    ExpectSameResults("megabuf(i) += y; x = megabuf(i); z = megabuf(i + 1000000)", 16);
+    ExpectSameResults("y > 0 ? megabuf(i * 2 + 1) = x : gmegabuf(i * 2) = y;");
+}
+
+TEST_F(BatchTest, PartialBatch)
+{
+    for (int laneCount : {1, 5, 15, 16, 17, 100})
+    {
+        SCOPED_TRACE(laneCount);
+        ExpectSameResults("x = if(x > 0, x * 2, y - 1); z = x + y", laneCount);
+    }
+}
+
+TEST_F(BatchTest, EmptyProgram)
+{
+    ExpectSameResults("", 20);
+}
+
+TEST_F(BatchTest, UniformVariables)
+{
+    const std::vector<std::string> uniforms{"a", "n", "reg01"};
+
+    // sin(a * 2), the product with n and the sum with reg01 don't depend on the lanes.
+    EXPECT_EQ(ExpectSameResults("x = x + sin(a * 2) * n; y = y * (reg01 + a * 2)", 37, uniforms), 5);
+    EXPECT_EQ(ExpectSameResults("x = if(a > 0.25, x * cos(a), y); loop(n, z += sqr(a) + x)", 37, uniforms), 3);
+    EXPECT_EQ(ExpectSameResults("z = x > 0 ? (y = a * 3; y + 1) : a * 3 + y", 37, uniforms), 3);
+    EXPECT_EQ(ExpectSameResults("megabuf(i * 2) = a * n + x; z = megabuf(i * 2) + a * n", 37, uniforms), 2);
+
+    // Variables assigned by the program differ per lane and are never hoisted.
+    EXPECT_EQ(ExpectSameResults("a = x; y = a * 2", 37, uniforms), 0);
+    EXPECT_EQ(ExpectSameResults("x = x * a", 37, uniforms), 0);
+    EXPECT_EQ(ExpectSameResults("x = x * a + 1", 37, {}), 0);
+
+    for (int laneCount : {1, 15, 16, 17, 100})
+    {
+        SCOPED_TRACE(laneCount);
+        ExpectSameResults("z = x * sin(a) + y * cos(a) + pow(n, a)", laneCount, uniforms);
+    }
+}
+
+TEST_F(BatchTest, UniformVariableBoundToLanes)
+{
+    auto code = projectm_eval_code_compile(m_batch.context, "z = x * (a + 1)");
+    ASSERT_NE(code, nullptr);
+
+    PRJM_EVAL_F* uniform[] = {projectm_eval_context_register_variable(m_batch.context, "a")};
+    EXPECT_EQ(projectm_eval_code_set_uniform_variables(code, uniform, 1), 1);
+
+    // If the uniform variable is bound to lane values, the lanes compute it themselves.
+    std::vector<PRJM_EVAL_F> a{1, 2, 3};
+    std::vector<PRJM_EVAL_F> x{1, 1, 1};
+    std::vector<PRJM_EVAL_F> z(3);
+    projectm_eval_lane_variable laneVariables[] = {
+        {uniform[0], a.data()},
+        {projectm_eval_context_register_variable(m_batch.context, "x"), x.data()},
+        {projectm_eval_context_register_variable(m_batch.context, "z"), z.data()}};
+
+    projectm_eval_code_execute_batch(code, laneVariables, 3, 3, nullptr);
+    EXPECT_EQ(z, (std::vector<PRJM_EVAL_F>{2, 3, 4}));
+
+    projectm_eval_code_execute_batch(code, laneVariables + 1, 2, 3, nullptr);
+    EXPECT_EQ(z, (std::vector<PRJM_EVAL_F>{4, 4, 4}));
+
+    // Single precision batches copy the hoisted values into their float lanes.
+    *uniform[0] = 4;
+    ASSERT_EQ(projectm_eval_code_set_batch_precision(code, PROJECTM_EVAL_PRECISION_FLOAT), 1);
+    projectm_eval_code_execute_batch(code, laneVariables + 1, 2, 3, nullptr);
+    EXPECT_EQ(z, (std::vector<PRJM_EVAL_F>{5, 5, 5}));
+
+    EXPECT_EQ(projectm_eval_code_set_uniform_variables(code, nullptr, 0), 0);
+    projectm_eval_code_execute_batch(code, laneVariables, 3, 3, nullptr);
+    EXPECT_EQ(z, (std::vector<PRJM_EVAL_F>{2, 3, 4}));
+
+    projectm_eval_code_destroy(code);
+}
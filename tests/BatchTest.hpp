@@ -0,0 +1,45 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compares batch execution with executing the same code once per lane.
+ * The lanes bind the variables i (the lane index), x, y and z, all other variables are shared between the lanes.
+ */
+class BatchTest : public testing::Test
+{
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Runs the code for each lane in both contexts and compares the lane values, results, shared variables
+     *        and memory.
+     * @param code The code to check. Lanes must not depend on each other.
+     * @param laneCount Number of lanes to execute.
+     * @param uniformVariableNames Variables marked as uniform for the batch execution.
+     * @return The number of operations hoisted out of the lanes.
+     */
+    int ExpectSameResults(const std::string& code, int laneCount = 37,
+                          const std::vector<std::string>& uniformVariableNames = {});
+
+    struct ExecutionContext
+    {
+        struct projectm_eval_context* context{};
+        projectm_eval_mem_buffer globalMemory{};
+        PRJM_EVAL_F globalRegisters[100]{};
+    };
+
+    ExecutionContext m_scalar; //!< Context executing one lane after the other.
+    ExecutionContext m_batch; //!< Context executing all lanes in a single batch.
+
+    static const std::vector<std::string> m_laneVariableNames;
+    static const std::vector<std::string> m_sharedVariableNames;
+};
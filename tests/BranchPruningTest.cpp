@@ -0,0 +1,89 @@
+#include "BranchPruningTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+void BranchPruningTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    m_reference.context->prune_branches = false;
+}
+
+int BranchPruningTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return reinterpret_cast<prjm_eval_program_t*>(code)->pruned_branch_count;
+}
+
+TEST_F(BranchPruningTest, ConstantConditions)
+{
+    EXPECT_EQ(ExpectSameResults("if(0, a = 1, b = 2)"), 1);
+    EXPECT_EQ(ExpectSameResults("c = if(1, a = x, b = y) + 1"), 1);
+    EXPECT_EQ(ExpectSameResults("c = if(x, a = 1, b = 2)"), 0);
+
+    // Constant results are evaluated further.
+    EXPECT_EQ(ExpectSameResults("a = if(0, b = 1, 2) * 3 + x"), 2);
+
+    // The remaining branch is still a valid assignment target.
+    EXPECT_EQ(ExpectSameResults("if(1, a, b) = 5; if(0, a, b) += 2"), 2);
+}
+
+TEST_F(BranchPruningTest, ConstantLoopCounts)
+{
+    EXPECT_EQ(ExpectSameResults("a = 1; loop(0, a += 1); loop(-2, a += 2); loop(0.5, a += 3)"), 4);
+    EXPECT_EQ(ExpectSameResults("a = 1; loop(1, a += 1); b = loop(1.9, a *= 2)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = 1; loop(3, a += 1); loop(x, a += 2)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = while(if(0, b += 1, 0)) + x; loop(1, b) = 3"), 3);
+}
+
+TEST_F(BranchPruningTest, LogicalOperators)
+{
+    EXPECT_EQ(ExpectSameResults("a = 0 && (b = 1); c = 1 || (b = 2)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = 1 && (b = x); c = 0 || (b = y)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = x && 1; b = y && 0; c = x || 1"), 3);
+
+    // Side effects of the first argument are kept.
+    EXPECT_EQ(ExpectSameResults("a = (b = x) && 0; c = (b = y) || 1"), 0);
+}
+
+TEST_F(BranchPruningTest, Sequences)
+{
+    EXPECT_EQ(ExpectSameResults("c = exec2(x + 1, a = 2) + exec3(x * 2, a = 1, b = 3)"), 2);
+    EXPECT_EQ(ExpectSameResults("c = exec3(x + y, y, a = 1)"), 1);
+
+    // The second exec3 argument is stored in the variable returned by the first one.
+    EXPECT_EQ(ExpectSameResults("c = exec3(a = 1, x * 2, b = 3) + exec3(a, y + 1, b)"), 0);
+
+    // Lists and loops ignore that location, so they aren't replaced by an argument which would write to it.
+    EXPECT_EQ(ExpectSameResults("a = 2; b = 3; c = exec3(a, loop(0, x), 1) + exec3(b, loop(1.5, y), 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = 2; b = exec3(a, if(0, y, while(-1)), 1); c = while(if(b < 2, b += 1, 0))"), 1);
+
+    // Statements only become removable after pruning their branches.
+    EXPECT_EQ(ExpectSameResults("a = 1; if(0, b = 2, 0); c = 3"), 2);
+}
+
+TEST_F(BranchPruningTest, FrozenCondition)
+{
+    auto* flag = projectm_eval_context_register_variable(m_optimized.context, "flag");
+    *flag = 0;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_optimized.context, flag), 1);
+
+    auto* code = projectm_eval_code_compile(m_optimized.context, "if(flag, a = sin(x), b = cos(x)); c = flag && x");
+    ASSERT_NE(code, nullptr);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(code)->pruned_branch_count, 0);
+
+    // Specialized programs are pruned with the frozen value.
+    projectm_eval_code_execute(code);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(code)->pruned_branch_count, 2);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(BranchPruningTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests the removal of code skipped due to constant conditions and loop counts.
+ * Each program is also compiled in a second context without pruning, and both results are compared.
+ */
+class BranchPruningTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+};
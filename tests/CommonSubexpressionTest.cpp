@@ -0,0 +1,105 @@
+#include "CommonSubexpressionTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+#include <cmath>
+#include <vector>
+
+void CommonSubexpressionTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    m_reference.context->eliminate_common_subexpressions = false;
+    m_inputs.emplace_back("time", 12.25);
+    m_variableNames = {"a", "b", "c", "d", "i", "x", "y", "time"};
+}
+
+int CommonSubexpressionTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return projectm_eval_code_get_eliminated_subexpressions(code);
+}
+
+TEST_F(CommonSubexpressionTest, RepeatedExpressions)
+{
+    EXPECT_EQ(ExpectSameResults("a = sin(time * 0.3) + sin(time * 0.3) * 2 + sin(time * 0.3)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = sqrt(x * x + y * y); b = atan2(y, x) * sqrt(x * x + y * y)"), 1);
+
+    // Subexpressions of a replaced expression are found as well.
+    EXPECT_EQ(ExpectSameResults("a = sqrt(x * x + y * y); b = x * x + y * y; c = sqrt(x * x + y * y)"), 2);
+
+    // Cheap expressions are computed again.
+    EXPECT_EQ(ExpectSameResults("a = x * 2; b = x * 2"), 0);
+}
+
+TEST_F(CommonSubexpressionTest, InterveningWrites)
+{
+    EXPECT_EQ(ExpectSameResults("a = sin(x); x = x + 1; b = sin(x)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = sin(x) + (x = 2; sin(x)) + sin(x)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = sin(x); if(y, x = 2, 0); b = sin(x)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = sin(x); if(y, a, x) = 3; b = sin(x)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = sin(x); c = exec3(x, y * 2, 0); b = sin(x)"), 0);
+
+    // Writes to other variables and memory don't matter.
+    EXPECT_EQ(ExpectSameResults("a = sin(x); y = 2; megabuf(0) = 1; b = sin(x)"), 1);
+}
+
+TEST_F(CommonSubexpressionTest, ConditionalCode)
+{
+    // Values computed in a branch can only be reused in the same branch.
+    EXPECT_EQ(ExpectSameResults("if(y > 0, a = sin(x), b = 1); c = sin(x)"), 0);
+    EXPECT_EQ(ExpectSameResults("if(y < 0, a = sin(x) + sin(x), b = 1); c = sin(x)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = sin(x); if(y < 0, b = sin(x), c = sin(x)); d = (y > 0) && sin(x)"), 3);
+    EXPECT_EQ(ExpectSameResults("a = (y > 0) && sin(x); b = sin(x)"), 0);
+
+    // Loop bodies may change the variables in later iterations.
+    EXPECT_EQ(ExpectSameResults("a = sin(x); loop(3, b += sin(x); x += 0.5)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = sin(x); loop(3, b += sin(x); y += 0.5); c = sin(y) + sin(y)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = 0; while(b += sin(x); a += 1; a < 3); c = sin(x)"), 0);
+}
+
+TEST_F(CommonSubexpressionTest, ImpureExpressions)
+{
+    EXPECT_EQ(ExpectSameResults("a = sin(megabuf(0)); megabuf(0) = 5; b = sin(megabuf(0))"), 0);
+    EXPECT_EQ(ExpectSameResults("megabuf(1) = 2; a = sqr(megabuf(1)) + sqr(megabuf(1))"), 0);
+
+    // Random numbers differ between both contexts, so only the optimization is checked.
+    auto* randomCode = projectm_eval_code_compile(m_optimized.context, "a = sin(rand(10) + x); b = sin(rand(10) + x)");
+    ASSERT_NE(randomCode, nullptr);
+    EXPECT_EQ(projectm_eval_code_get_eliminated_subexpressions(randomCode), 0);
+    projectm_eval_code_destroy(randomCode);
+
+    // Memory indices are values, assignment targets keep their variables.
+    EXPECT_EQ(ExpectSameResults("megabuf(x * x + 1) = 2; a = megabuf(x * x + 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = sqr(x) + 1; (a = sqr(x) + 1) += 2"), 1);
+    EXPECT_EQ(ExpectSameResults("a = sin(x); c = exec3(b, sin(x), 0)"), 0);
+}
+
+TEST_F(CommonSubexpressionTest, FrozenVariables)
+{
+    auto* time = projectm_eval_context_register_variable(m_optimized.context, "time");
+    *time = 1.5;
+    *projectm_eval_context_register_variable(m_optimized.context, "x") = 0.75;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_optimized.context, time), 1);
+
+    auto* code = projectm_eval_code_compile(m_optimized.context, "a = sin(time * 2 + 1) + cos(time * 2 + 1) + x");
+    ASSERT_NE(code, nullptr);
+    EXPECT_EQ(projectm_eval_code_get_eliminated_subexpressions(code), 1);
+
+    // Specialized programs are optimized again, here the expressions were folded into a constant instead.
+    projectm_eval_code_execute(code);
+    EXPECT_EQ(projectm_eval_code_get_eliminated_subexpressions(code), 0);
+    EXPECT_NEAR(*projectm_eval_context_register_variable(m_optimized.context, "a"),
+                std::sin(4.0) + std::cos(4.0) + 0.75, 1e-6);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(CommonSubexpressionTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
@@ -0,0 +1,179 @@
+#include "CpuDispatchTest.hpp"
+
+extern "C"
+{
+#include <projectm-eval/CpuDispatch.h>
+#include <projectm-eval/VectorMath.h>
+}
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+
+void CpuDispatchTest::SetUp()
+{
+    m_previousLevel = projectm_eval_get_cpu_level();
+}
+
+void CpuDispatchTest::TearDown()
+{
+    projectm_eval_set_cpu_level(m_previousLevel);
+}
+
+std::vector<projectm_eval_cpu_level> CpuDispatchTest::SupportedLevels()
+{
+    std::vector<projectm_eval_cpu_level> levels;
+    for (int level = PROJECTM_EVAL_CPU_GENERIC; level <= prjm_eval_cpu_detect(); level++)
+    {
+        levels.push_back(static_cast<projectm_eval_cpu_level>(level));
+    }
+    return levels;
+}
+
+TEST_F(CpuDispatchTest, SelectLevel)
+{
+    auto detected = prjm_eval_cpu_detect();
+    EXPECT_LE(projectm_eval_get_cpu_level(), detected);
+
+    for (int level = PROJECTM_EVAL_CPU_GENERIC; level <= PROJECTM_EVAL_CPU_AVX512; level++)
+    {
+        auto previous = projectm_eval_get_cpu_level();
+        if (level <= detected)
+        {
+            // The selected variant may be lower if no variant was built for the requested level.
+            EXPECT_EQ(projectm_eval_set_cpu_level(static_cast<projectm_eval_cpu_level>(level)), 1);
+            EXPECT_LE(projectm_eval_get_cpu_level(), level);
+
+            // The generic build is the x86-64 baseline, which reports both the generic and the SSE2 level.
+            if (level <= PROJECTM_EVAL_CPU_SSE2)
+            {
+                EXPECT_EQ(projectm_eval_get_cpu_level(), level);
+            }
+        }
+        else
+        {
+            EXPECT_EQ(projectm_eval_set_cpu_level(static_cast<projectm_eval_cpu_level>(level)), 0);
+            EXPECT_EQ(projectm_eval_get_cpu_level(), previous);
+        }
+    }
+}
+
+#ifndef _WIN32
+TEST_F(CpuDispatchTest, EnvironmentOverride)
+{
+    setenv("PROJECTM_EVAL_CPU", "generic", 1);
+    prjm_eval_cpu_select_default();
+    EXPECT_EQ(projectm_eval_get_cpu_level(), PROJECTM_EVAL_CPU_GENERIC);
+
+    if (prjm_eval_cpu_detect() >= PROJECTM_EVAL_CPU_SSE2)
+    {
+        setenv("PROJECTM_EVAL_CPU", "sse2", 1);
+        prjm_eval_cpu_select_default();
+        EXPECT_EQ(projectm_eval_get_cpu_level(), PROJECTM_EVAL_CPU_SSE2);
+    }
+
+    // Unknown names are ignored.
+    setenv("PROJECTM_EVAL_CPU", "mmx", 1);
+    prjm_eval_cpu_select_default();
+    auto unlimited = projectm_eval_get_cpu_level();
+
+    unsetenv("PROJECTM_EVAL_CPU");
+    prjm_eval_cpu_select_default();
+    EXPECT_EQ(projectm_eval_get_cpu_level(), unlimited);
+}
+#endif
+
+TEST_F(CpuDispatchTest, SameKernelResults)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> distribution(-20.0, 20.0);
+
+    // Includes values the kernels pass to the scalar functions.
+    std::vector<PRJM_EVAL_F> arguments1{0.0, -0.0, 1e-300, 1e7, 800.0, -800.0};
+    std::vector<PRJM_EVAL_F> arguments2{0.0, 2.0, -1.5, 0.5, 3.0, -3.0};
+    while (arguments1.size() < 211)
+    {
+        arguments1.push_back(static_cast<PRJM_EVAL_F>(distribution(generator)));
+        arguments2.push_back(static_cast<PRJM_EVAL_F>(distribution(generator)));
+    }
+
+    using Kernel = std::function<void(PRJM_EVAL_F*)>;
+    const int count = static_cast<int>(arguments1.size());
+    const std::vector<Kernel> kernels{
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_sin(dst, arguments1.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_cos(dst, arguments1.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_exp(dst, arguments1.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_log(dst, arguments1.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_sqrt(dst, arguments1.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_invsqrt(dst, arguments1.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_pow(dst, arguments1.data(), arguments2.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_atan2(dst, arguments1.data(), arguments2.data(), count); },
+        [&](PRJM_EVAL_F* dst) { prjm_eval_vector_fill(dst, arguments1[7], count); },
+    };
+
+    for (size_t kernel = 0; kernel < kernels.size(); kernel++)
+    {
+        std::vector<PRJM_EVAL_F> expected(count);
+        ASSERT_EQ(projectm_eval_set_cpu_level(PROJECTM_EVAL_CPU_GENERIC), 1);
+        kernels[kernel](expected.data());
+
+        for (auto level : SupportedLevels())
+        {
+            std::vector<PRJM_EVAL_F> results(count);
+            ASSERT_EQ(projectm_eval_set_cpu_level(level), 1);
+            kernels[kernel](results.data());
+
+            EXPECT_EQ(std::memcmp(results.data(), expected.data(), count * sizeof(PRJM_EVAL_F)), 0)
+                << "Kernel " << kernel << ", level " << level;
+        }
+    }
+}
+
+TEST_F(CpuDispatchTest, SameBatchResults)
+{
+    auto context = projectm_eval_context_create(nullptr, nullptr);
+    auto code = projectm_eval_code_compile(context,
+                                           "y = sin(x) * cos(x * 0.5) + pow(abs(x), 1.5) - atan2(x, 3);"
+                                           "if(x > 0, loop(3, y = y * 0.5 + sqrt(x)), y = exp(x * 0.1) + log(-x));"
+                                           "y * 2 + x / 7");
+    ASSERT_NE(code, nullptr);
+
+    PRJM_EVAL_F* x = projectm_eval_context_register_variable(context, "x");
+    PRJM_EVAL_F* y = projectm_eval_context_register_variable(context, "y");
+
+    const int laneCount = 100;
+    std::vector<PRJM_EVAL_F> expectedY;
+    std::vector<PRJM_EVAL_F> expectedResults;
+
+    for (auto level : SupportedLevels())
+    {
+        std::vector<PRJM_EVAL_F> xValues;
+        for (int lane = 0; lane < laneCount; lane++)
+        {
+            xValues.push_back(static_cast<PRJM_EVAL_F>(lane - 50) * 0.37);
+        }
+        std::vector<PRJM_EVAL_F> yValues(laneCount);
+        std::vector<PRJM_EVAL_F> results(laneCount);
+        std::vector<projectm_eval_lane_variable> laneVariables{{x, xValues.data()}, {y, yValues.data()}};
+
+        ASSERT_EQ(projectm_eval_set_cpu_level(level), 1);
+        projectm_eval_code_execute_batch(code, laneVariables.data(), static_cast<int>(laneVariables.size()),
+                                         laneCount, results.data());
+
+        if (expectedY.empty())
+        {
+            expectedY = yValues;
+            expectedResults = results;
+            continue;
+        }
+
+        EXPECT_EQ(std::memcmp(yValues.data(), expectedY.data(), laneCount * sizeof(PRJM_EVAL_F)), 0)
+            << "Level " << level;
+        EXPECT_EQ(std::memcmp(results.data(), expectedResults.data(), laneCount * sizeof(PRJM_EVAL_F)), 0)
+            << "Level " << level;
+    }
+
+    projectm_eval_code_destroy(code);
+    projectm_eval_context_destroy(context);
+}
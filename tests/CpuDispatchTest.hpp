@@ -0,0 +1,26 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <vector>
+
+/**
+ * @brief Checks the CPU level selection and compares the results of all kernel variants the CPU supports.
+ * The previously active level is restored after each test.
+ */
+class CpuDispatchTest : public testing::Test
+{
+protected:
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Returns all levels supported by the CPU, starting with PROJECTM_EVAL_CPU_GENERIC.
+     */
+    static std::vector<projectm_eval_cpu_level> SupportedLevels();
+
+    projectm_eval_cpu_level m_previousLevel{PROJECTM_EVAL_CPU_GENERIC};
+};
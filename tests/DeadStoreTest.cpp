@@ -0,0 +1,117 @@
+#include "DeadStoreTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+void DeadStoreTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    m_iterations = 3;
+}
+
+int DeadStoreTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return reinterpret_cast<prjm_eval_program_t*>(code)->removed_store_count;
+}
+
+int DeadStoreTest::ExpectSameOutputs(const std::string& code, const std::vector<std::string>& outputNames)
+{
+    std::vector<PRJM_EVAL_F*> outputs;
+    for (const auto& name : outputNames)
+    {
+        outputs.push_back(projectm_eval_context_register_variable(m_optimized.context, name.c_str()));
+    }
+    EXPECT_EQ(projectm_eval_context_set_output_variables(m_optimized.context, outputs.data(),
+                                                         static_cast<int>(outputs.size())), 1);
+
+    // Other variables may differ, as their assignments are removed.
+    m_variableNames = outputNames;
+
+    return ExpectSameResults(code);
+}
+
+TEST_F(DeadStoreTest, UnusedVariables)
+{
+    EXPECT_EQ(ExpectSameOutputs("scratch = sin(x) * 2; zoom = x + 1"), 1);
+    EXPECT_EQ(ExpectSameOutputs("a = x; b = a * 2; c = b + 1; zoom = 1.5"), 3);
+    EXPECT_EQ(ExpectSameOutputs("t = x * 2; rot = t; zoom = t + 1"), 1);
+    EXPECT_EQ(ExpectSameOutputs("t = x * 2; rot = t; zoom = t + 1", {"zoom", "rot"}), 0);
+
+    // Values of removed assignments are still computed if they have side effects.
+    EXPECT_EQ(ExpectSameOutputs("a = (megabuf(1) = x); b = (c = x + 1) * 2; zoom = megabuf(1) + c"), 2);
+
+    // Assignments returning the location exec3 stores into are kept.
+    EXPECT_EQ(ExpectSameOutputs("exec2(a = x * 2, zoom = 2); exec3(b = 1, megabuf(2) = 3, zoom += 1)"), 1);
+}
+
+TEST_F(DeadStoreTest, OverwrittenValues)
+{
+    EXPECT_EQ(ExpectSameOutputs("zoom = 1; zoom = x * 3"), 1);
+    EXPECT_EQ(ExpectSameOutputs("t = 1; zoom = t; t = 2; zoom += t"), 0);
+    EXPECT_EQ(ExpectSameOutputs("t = 1; if(x > 0, t = 2, t = 3); zoom = t"), 1);
+    EXPECT_EQ(ExpectSameOutputs("t = 1; if(x > 0, t = 2, 0); zoom = t"), 0);
+    EXPECT_EQ(ExpectSameOutputs("t = 1; (x > 0) && (t = 2); zoom = t"), 0);
+}
+
+TEST_F(DeadStoreTest, NextExecution)
+{
+    // Variables read before they are assigned get their value from the previous execution.
+    EXPECT_EQ(ExpectSameOutputs("zoom = t; t = x + 1"), 0);
+    EXPECT_EQ(ExpectSameOutputs("frame += 1; zoom = 1 + 0.1 * frame"), 0);
+    EXPECT_EQ(ExpectSameOutputs("t = 0; zoom = t; t = x + 1; zoom += 1"), 1);
+}
+
+TEST_F(DeadStoreTest, Loops)
+{
+    EXPECT_EQ(ExpectSameOutputs("i = 0; loop(4, megabuf(i) = i * x; i += 1); zoom = megabuf(2)"), 0);
+    EXPECT_EQ(ExpectSameOutputs("s = 0; t = 0; loop(4, t = s; s += x); zoom = t"), 0);
+    EXPECT_EQ(ExpectSameOutputs("t = 5; loop(4, t = x; u = t * 2); zoom = t"), 1);
+    EXPECT_EQ(ExpectSameOutputs("i = 0; while(megabuf(i) = x; i += 1; i < 4); zoom = i"), 0);
+}
+
+TEST_F(DeadStoreTest, KeptStores)
+{
+    // Global registers, memory and the return value are always kept.
+    EXPECT_EQ(ExpectSameOutputs("reg00 = x; gmegabuf(3) = x * 2; zoom = 1"), 0);
+    EXPECT_EQ(ExpectSameOutputs("zoom = 1; scratch = x"), 0);
+
+    // References are read after the following arguments were evaluated.
+    EXPECT_EQ(ExpectSameOutputs("a = 1; zoom = a + (a = 2; 0); a = 7; zoom *= 2"), 1);
+    EXPECT_EQ(ExpectSameOutputs("if(x > 0, a, b) = 3; zoom = a + b"), 0);
+
+    // exec3 stores its second argument in the variable returned by the first one.
+    EXPECT_EQ(ExpectSameOutputs("a = 1; b = exec3(a, x * 2, 0); zoom = a"), 1);
+}
+
+TEST_F(DeadStoreTest, ResetOutputs)
+{
+    auto* zoom = projectm_eval_context_register_variable(m_optimized.context, "zoom");
+    ASSERT_EQ(projectm_eval_context_set_output_variables(m_optimized.context, &zoom, 1), 1);
+
+    auto* code = projectm_eval_code_compile(m_optimized.context, "scratch = x; zoom = 2");
+    ASSERT_NE(code, nullptr);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(code)->removed_store_count, 1);
+    projectm_eval_code_destroy(code);
+
+    ASSERT_EQ(projectm_eval_context_set_output_variables(m_optimized.context, nullptr, 0), 1);
+
+    code = projectm_eval_code_compile(m_optimized.context, "scratch = x; zoom = 2");
+    ASSERT_NE(code, nullptr);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(code)->removed_store_count, 0);
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(DeadStoreTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameOutputs(code, {"a", "b", "c", "i"});
+    }
+
+    // exec3 stores into the variable of an unused assignment, which must not become its value's variable.
+    EXPECT_EQ(ExpectSameOutputs("i = 5; exec3(c = i, 7, 0); megabuf(0) = i", {"a", "b"}), 0);
+    EXPECT_EQ(ExpectSameOutputs("i = 5; c = 1; exec3(if(x, c = i, 0), 7, 0); reg00 = i", {"a", "b"}), 1);
+    EXPECT_EQ(ExpectSameOutputs("i = 5; exec3(exec2(0, c = i), 7, 0); gmegabuf(0) = i + c", {"a", "b"}), 0);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests the removal of assignments to variables which aren't outputs.
+ * Each program is also compiled in a second context without output variables, and the outputs of both are compared.
+ */
+class DeadStoreTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+
+    /**
+     * @brief Compiles the code in both contexts and compares return values, outputs and memory of a few executions.
+     * @param code The code to check.
+     * @param outputNames The output variables of the optimized context.
+     * @return The number of removed assignments in the optimized context.
+     */
+    int ExpectSameOutputs(const std::string& code, const std::vector<std::string>& outputNames = {"zoom"});
+};
@@ -0,0 +1,157 @@
+#include "DifferentialTest.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void DifferentialTest::SetUp()
+{
+    for (auto* executionContext : {&m_optimized, &m_reference})
+    {
+        executionContext->globalMemory = projectm_eval_memory_buffer_create();
+        executionContext->context = projectm_eval_context_create(executionContext->globalMemory,
+                                                                 &executionContext->globalRegisters);
+        projectm_eval_context_set_tiering_threshold(executionContext->context, 0);
+    }
+}
+
+void DifferentialTest::TearDown()
+{
+    for (auto* executionContext : {&m_optimized, &m_reference})
+    {
+        projectm_eval_context_destroy(executionContext->context);
+        projectm_eval_memory_buffer_destroy(executionContext->globalMemory);
+    }
+}
+
+void DifferentialTest::SetIterationInputs(int)
+{
+}
+
+void DifferentialTest::SetVariable(const std::string& name, PRJM_EVAL_F value)
+{
+    for (auto* executionContext : {&m_optimized, &m_reference})
+    {
+        *projectm_eval_context_register_variable(executionContext->context, name.c_str()) = value;
+    }
+}
+
+void DifferentialTest::ExpectSameValue(PRJM_EVAL_F optimized, PRJM_EVAL_F reference, const std::string& description)
+{
+    if (m_relativeTolerance != 0.0 && std::isfinite(reference))
+    {
+        EXPECT_NEAR(optimized, reference, m_relativeTolerance * std::max(std::fabs(optimized), std::fabs(reference)))
+            << description;
+    }
+    else if (m_exactValues)
+    {
+        EXPECT_EQ(optimized, reference) << description;
+    }
+    else
+    {
+        EXPECT_DOUBLE_EQ(optimized, reference) << description;
+    }
+}
+
+int DifferentialTest::ExpectSameResults(const std::string& code)
+{
+    SCOPED_TRACE(code);
+
+    for (const auto& input : m_inputs)
+    {
+        SetVariable(input.first, input.second);
+    }
+
+    auto* optimizedCode = projectm_eval_code_compile(m_optimized.context, code.c_str());
+    auto* referenceCode = projectm_eval_code_compile(m_reference.context, code.c_str());
+    EXPECT_NE(optimizedCode, nullptr);
+    EXPECT_NE(referenceCode, nullptr);
+    if (!optimizedCode || !referenceCode)
+    {
+        projectm_eval_code_destroy(optimizedCode);
+        projectm_eval_code_destroy(referenceCode);
+        return -1;
+    }
+
+    EXPECT_EQ(projectm_eval_code_set_engine(optimizedCode, m_optimizedEngine), 1);
+    EXPECT_EQ(projectm_eval_code_set_engine(referenceCode, m_referenceEngine), 1);
+    EXPECT_EQ(CountOptimizations(referenceCode), 0);
+
+    for (int iteration = 0; iteration < m_iterations; iteration++)
+    {
+        SetIterationInputs(iteration);
+
+        auto iterationName = ", iteration " + std::to_string(iteration);
+        ExpectSameValue(projectm_eval_code_execute(optimizedCode), projectm_eval_code_execute(referenceCode),
+                        "Result" + iterationName);
+        for (const auto& name : m_variableNames)
+        {
+            ExpectSameValue(*projectm_eval_context_register_variable(m_optimized.context, name.c_str()),
+                            *projectm_eval_context_register_variable(m_reference.context, name.c_str()),
+                            "Variable " + name + iterationName);
+        }
+        for (int reg = 0; reg < 100; reg++)
+        {
+            ExpectSameValue(m_optimized.globalRegisters[reg], m_reference.globalRegisters[reg],
+                            "Register " + std::to_string(reg) + iterationName);
+        }
+    }
+
+    // Compare memory contents via separate programs, so rounding differences of both buffers aren't mixed.
+    for (const auto* memoryProgram : {"megabuf(memoryindex)", "gmegabuf(memoryindex)"})
+    {
+        auto* optimizedMemoryCode = projectm_eval_code_compile(m_optimized.context, memoryProgram);
+        auto* referenceMemoryCode = projectm_eval_code_compile(m_reference.context, memoryProgram);
+        auto* optimizedIndex = projectm_eval_context_register_variable(m_optimized.context, "memoryindex");
+        auto* referenceIndex = projectm_eval_context_register_variable(m_reference.context, "memoryindex");
+
+        for (int index = 0; index < m_memorySize; index++)
+        {
+            *optimizedIndex = index;
+            *referenceIndex = index;
+            ExpectSameValue(projectm_eval_code_execute(optimizedMemoryCode),
+                            projectm_eval_code_execute(referenceMemoryCode),
+                            std::string(memoryProgram) + ", index " + std::to_string(index));
+        }
+
+        projectm_eval_code_destroy(optimizedMemoryCode);
+        projectm_eval_code_destroy(referenceMemoryCode);
+    }
+
+    int optimizationCount = CountOptimizations(optimizedCode);
+
+    projectm_eval_code_destroy(optimizedCode);
+    projectm_eval_code_destroy(referenceCode);
+
+    return optimizationCount;
+}
+
+const std::vector<std::string>& DifferentialTest::EdgeCasePrograms()
+{
+    static const std::vector<std::string> programs{
+        // Assignments inside conditions.
+        "b = 1.49; a = if(b > 1 && exec2(b = 0, 1), 1 / b, 5); c = b",
+        "a = 0; c = if((a = x * 2) > 1, a + 1, a - 1) + if(a = 0, 3, 4); b = (c += 1) > 2 || (a = 7)",
+        "i = 0; a = 0; while((i += 1) < 5 && (a += i) < 100); b = i",
+        "a = 1; b = if(a < 2, a = 3, a = 4) + if(a > 2, 1 / a, 0); c = !(a -= 3) + a",
+
+        // Assignments inside loop bodies.
+        "a = 0; b = 1; loop(4, a += b * x; b = if(b > 2, b, b + 1); c = a * 2)",
+        "i = 0; a = 0; loop(3, loop(2, i += 1; a += i * y); a *= 0.5); b = i",
+        "a = x; loop(5, megabuf(3) += a; a = megabuf(3) * 0.5); b = megabuf(3)",
+        "i = 0; loop(6, megabuf(i) = i * x; gmegabuf(i + 8) = megabuf(i) + y; i += 1); a = megabuf(5) + gmegabuf(13)",
+
+        // Reference arguments of exec2(), exec3(), memcpy() and memset().
+        "a = 2; i = exec3(a, -1, 3); b = a; c = i",
+        "i = 0; a = exec2(i = 3, i * 2) + exec3(i += 1, i, i * x); b = i",
+        "a = 2; b = 3; c = exec3(a, loop(0, x), 1) + exec3(b, loop(1.5, y), 1)",
+        "megabuf(1) = 3; megabuf(2) = 4; a = memcpy(10, 1, 2); b = megabuf(11); c = memset(20, x, 3) + megabuf(22)",
+        "megabuf(5) = 2; a = 0; memcpy(exec2(a = 24, a), 5, 1); b = megabuf(24) + a",
+        "i = 0; loop(3, megabuf(i + 12) = i + 1; i += 1); a = memcpy(i = 16, 12, 3) + i; b = megabuf(17)",
+
+        // Comparisons close to the equality threshold and tests against zero.
+        "a = (x + 0.000001 == x) + (y == y * (1 + 1e-7)) * 2; b = !(x * 1e-12) + !(1e-300 * y); c = if(x - 0.75, 1, 2)",
+        "i = 0; a = 0; while(a += x * 0.1; i += 1; i < 10 && abs(a - 0.75) > 0.00001); b = (a == 0.75) + (a != 0.75)",
+        "a = 0.1 + 0.2; b = (a == 0.3) + (a > 0.3) * 2 + (a >= 0.3) * 4; c = band(a != 0.3, x <= 0.75)",
+    };
+    return programs;
+}
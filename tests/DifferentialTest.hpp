@@ -0,0 +1,85 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Base fixture for optimization tests, comparing code compiled in an optimizing context with the same code
+ *        compiled in a reference context.
+ * Derived fixtures configure both contexts in SetUp() and return the statistic of their optimization from
+ * CountOptimizations(). Tiering is disabled in both contexts, so each program keeps the engine selected for it.
+ */
+class DifferentialTest : public testing::Test
+{
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Compiles the code in both contexts and compares return values, variables, registers and memory of a few
+     *        executions.
+     * The reference code must not report any optimizations.
+     * @param code The code to check.
+     * @return The number of optimizations reported for the code in the optimizing context, or -1 if it didn't compile.
+     */
+    int ExpectSameResults(const std::string& code);
+
+    /**
+     * @brief Returns the number of optimizations applied to the compiled code.
+     * @param code The compiled code.
+     * @return The statistic of the tested optimization.
+     */
+    virtual int CountOptimizations(struct projectm_eval_code* code) = 0;
+
+    /**
+     * @brief Sets input variables before each execution. The default implementation keeps the values of m_inputs.
+     * @param iteration The index of the next execution.
+     */
+    virtual void SetIterationInputs(int iteration);
+
+    /**
+     * @brief Sets a variable to the same value in both contexts.
+     * @param name The variable name.
+     * @param value The new value.
+     */
+    void SetVariable(const std::string& name, PRJM_EVAL_F value);
+
+    /**
+     * @brief Programs covering cases which are easy to get wrong in a tree pass or engine: assignments inside
+     *        conditions and loop bodies, reference arguments of exec2(), exec3() and memcpy(), and comparisons near
+     *        the equality threshold.
+     * The programs only assign the variables a, b, c and i, and the first 32 memory cells.
+     * @return The program sources.
+     */
+    static const std::vector<std::string>& EdgeCasePrograms();
+
+    struct ExecutionContext
+    {
+        struct projectm_eval_context* context{};
+        projectm_eval_mem_buffer globalMemory{};
+        PRJM_EVAL_F globalRegisters[100]{};
+    };
+
+    ExecutionContext m_optimized; //!< Context applying the tested optimization.
+    ExecutionContext m_reference; //!< Context compiling the code without it.
+
+    projectm_eval_engine m_optimizedEngine{PROJECTM_EVAL_ENGINE_TREE}; //!< Engine executing the optimized code.
+    projectm_eval_engine m_referenceEngine{PROJECTM_EVAL_ENGINE_TREE}; //!< Engine executing the reference code.
+    std::vector<std::pair<std::string, PRJM_EVAL_F>> m_inputs{{"x", 0.75}, {"y", -1.5}}; //!< Set before compiling.
+    std::vector<std::string> m_variableNames{"a", "b", "c", "i", "x", "y"}; //!< Variables compared after executions.
+    int m_iterations{2}; //!< Number of consecutive executions.
+    int m_memorySize{32}; //!< Number of compared megabuf and gmegabuf cells, starting at index 0.
+    bool m_exactValues{false}; //!< If true, values must be identical instead of differing by at most 4 ulps.
+    double m_relativeTolerance{0.0}; //!< If nonzero, the allowed difference relative to the larger finite value.
+
+private:
+
+    void ExpectSameValue(PRJM_EVAL_F optimized, PRJM_EVAL_F reference, const std::string& description);
+};
@@ -0,0 +1,461 @@
+#include "EngineTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+#include <projectm-eval/TreeFunctions.h>
+}
+
+const std::vector<std::string> EngineTest::m_variableNames{"a", "b", "c", "i", "n", "x", "y", "z"};
+
+void EngineTest::SetUp()
+{
+    for (auto* executionContext : {&m_tree, &m_engine})
+    {
+        executionContext->globalMemory = projectm_eval_memory_buffer_create();
+        executionContext->context = projectm_eval_context_create(executionContext->globalMemory,
+                                                                 &executionContext->globalRegisters);
+    }
+
+    m_tree.context->fuse_superinstructions = false;
+    m_tree.context->prune_branches = false;
+    m_tree.context->hoist_loop_invariants = false;
+    m_tree.context->eliminate_common_subexpressions = false;
+    m_tree.context->specialize_value_ranges = false;
+    projectm_eval_context_set_unroll_limit(m_tree.context, 0);
+    projectm_eval_context_set_tiering_threshold(m_tree.context, 0);
+}
+
+void EngineTest::TearDown()
+{
+    for (auto* executionContext : {&m_tree, &m_engine})
+    {
+        projectm_eval_context_destroy(executionContext->context);
+        projectm_eval_memory_buffer_destroy(executionContext->globalMemory);
+    }
+}
+
+void EngineTest::ExpectSameResults(const std::string& code, int iterations)
+{
+    SCOPED_TRACE(code);
+
+    auto treeCode = projectm_eval_code_compile(m_tree.context, code.c_str());
+    auto engineCode = projectm_eval_code_compile(m_engine.context, code.c_str());
+    ASSERT_NE(treeCode, nullptr);
+    ASSERT_NE(engineCode, nullptr);
+
+    // Execute the reference tree with the reference-returning node functions only.
+    auto* treeProgram = reinterpret_cast<prjm_eval_program_t*>(treeCode)->program;
+    if (treeProgram)
+    {
+        treeProgram->value_func = prjm_eval_value_via_ref;
+    }
+
+    ASSERT_EQ(projectm_eval_code_set_engine(engineCode, GetParam()), 1);
+    ASSERT_EQ(projectm_eval_code_get_engine(engineCode), GetParam());
+    ASSERT_EQ(projectm_eval_code_get_engine(treeCode), PROJECTM_EVAL_ENGINE_TREE);
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        auto treeResult = projectm_eval_code_execute(treeCode);
+        auto engineResult = projectm_eval_code_execute(engineCode);
+        EXPECT_DOUBLE_EQ(engineResult, treeResult) << "Iteration " << iteration;
+
+        for (const auto& name : m_variableNames)
+        {
+            EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_engine.context, name.c_str()),
+                             *projectm_eval_context_register_variable(m_tree.context, name.c_str()))
+                << "Variable " << name << ", iteration " << iteration;
+        }
+
+        for (int reg = 0; reg < 100; reg++)
+        {
+            EXPECT_DOUBLE_EQ(m_engine.globalRegisters[reg], m_tree.globalRegisters[reg]) << "Register " << reg;
+        }
+    }
+
+    // Compare memory contents via a separate program, executed by the tree interpreter in both contexts.
+    auto treeMemoryCode = projectm_eval_code_compile(m_tree.context, "megabuf(i) + 1000 * gmegabuf(i)");
+    auto engineMemoryCode = projectm_eval_code_compile(m_engine.context, "megabuf(i) + 1000 * gmegabuf(i)");
+    auto* treeIndex = projectm_eval_context_register_variable(m_tree.context, "i");
+    auto* engineIndex = projectm_eval_context_register_variable(m_engine.context, "i");
+
+    for (int index = 0; index < 32; index++)
+    {
+        *treeIndex = index;
+        *engineIndex = index;
+        EXPECT_DOUBLE_EQ(projectm_eval_code_execute(engineMemoryCode), projectm_eval_code_execute(treeMemoryCode))
+            << "Memory index " << index;
+    }
+
+    projectm_eval_code_destroy(treeMemoryCode);
+    projectm_eval_code_destroy(engineMemoryCode);
+    projectm_eval_code_destroy(treeCode);
+    projectm_eval_code_destroy(engineCode);
+}
+
+TEST_P(EngineTest, EngineSelection)
+{
+    auto code = projectm_eval_code_compile(m_engine.context, "x = 5; x * 2");
+    ASSERT_NE(code, nullptr);
+
+    EXPECT_EQ(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_TREE);
+    EXPECT_EQ(projectm_eval_code_set_engine(code, GetParam()), 1);
+    EXPECT_EQ(projectm_eval_code_get_engine(code), GetParam());
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 10.0);
+
+    EXPECT_EQ(projectm_eval_code_set_engine(code, PROJECTM_EVAL_ENGINE_TREE), 1);
+    EXPECT_EQ(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_TREE);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 10.0);
+
+    projectm_eval_code_destroy(code);
+}
+
+#ifndef PRJM_EVAL_ENABLE_JIT
+TEST_P(EngineTest, UnavailableEngine)
+{
+    auto code = projectm_eval_code_compile(m_engine.context, "x = 5; x * 2");
+    ASSERT_NE(code, nullptr);
+
+    ASSERT_EQ(projectm_eval_code_set_engine(code, GetParam()), 1);
+    EXPECT_EQ(projectm_eval_code_set_engine(code, PROJECTM_EVAL_ENGINE_JIT), 0);
+    EXPECT_EQ(projectm_eval_code_get_engine(code), GetParam());
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 10.0);
+
+    projectm_eval_code_destroy(code);
+}
+#endif
+
+TEST_P(EngineTest, EmptyProgram)
+{
+    auto code = projectm_eval_code_compile(m_engine.context, "");
+    ASSERT_NE(code, nullptr);
+
+    EXPECT_EQ(projectm_eval_code_set_engine(code, GetParam()), 1);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 0.0);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_P(EngineTest, Arithmetic)
+{
+    ExpectSameResults("x = 3; y = 4.5; x + y * 2 - x / y");
+    ExpectSameResults("x = 7; y = 0; x / y + x % y + (x % 3)");
+    ExpectSameResults("x = -2.5; y = 3; x ^ y + pow(y, x) + pow(0, -1)");
+    ExpectSameResults("x = 13.7; y = 6.2; (x | y) + (x & y) * 100");
+    ExpectSameResults("x = 1.5; -x + -(-x) + sqr(x)");
+    ExpectSameResults("x += 1; y -= 2; z *= 1.5; a /= 2; b %= 3; c |= 4; i &= 7; n ^= 2; x + y + z");
+    ExpectSameResults("x = 10; y = 3; x += y; x -= y * 2; x *= 3; x /= 4; x %= 5; x |= 8; x &= 12; x ^= 2");
+}
+
+TEST_P(EngineTest, MathFunctions)
+{
+    ExpectSameResults("x = 0.3; sin(x) + cos(x) + tan(x) + asin(x) + acos(x) + atan(x) + atan2(x, 2)");
+    ExpectSameResults("x = -4.2; sqrt(x) + exp(x / 4) + log(x) + log(-x) + log10(-x) + abs(x) + sign(x)");
+    ExpectSameResults("x = 2.7; floor(x) + ceil(x) + int(-x) + invsqrt(x) + sigmoid(x, 2)");
+    ExpectSameResults("x = 5; y = 3; min(x, y) * 10 + max(x, y) + asin(x) + acos(-x)");
+}
+
+TEST_P(EngineTest, Comparisons)
+{
+    ExpectSameResults("x = 1; y = 2; (x == y) + (x != y) * 2 + (x < y) * 4 + (x > y) * 8 + (x <= y) * 16 + (x >= y) * 32");
+    ExpectSameResults("x = 0.000001; y = 0; equal(x, y) + below(x, y) * 2 + above(x, y) * 4 + bnot(y) * 8 + !x * 16");
+    ExpectSameResults("x = 0.5; y = 0; band(x, y) + bor(x, y) * 2 + band(x, 1) * 4 + bor(0, 0) * 8");
+}
+
+TEST_P(EngineTest, ShortCircuit)
+{
+    ExpectSameResults("x = 0; (x && (y = 5)) + 10 * (x || (z = 3))");
+    ExpectSameResults("x = 2; (x && (y = 5)) + 10 * (x || (z = 3)) + 100 * (y && 0)");
+    ExpectSameResults("a = (x = 1) && (y = 0) && (z = 7); b = (x = 0) || (y = 0) || (z = 0.5); a + b");
+}
+
+TEST_P(EngineTest, ControlStructures)
+{
+    ExpectSameResults("x = 1; if(x, y = 2, z = 3); if(x - 1, y = 4, z = 5); if(x, y, z)");
+    ExpectSameResults("n = 10; x = 0; loop(n, x += 2; y = x * 2)");
+    ExpectSameResults("n = 0; loop(n, x += 1)");
+    ExpectSameResults("n = -3.5; loop(n, x += 1)");
+    ExpectSameResults("loop(2.9, x += 1)");
+    ExpectSameResults("loop(5, x += 1; loop(x, y += 1))");
+    ExpectSameResults("x = 0; while(x += 1; x < 10); y = while(z -= 1; 0); x + y");
+    ExpectSameResults("i = 0; while(i += 1; megabuf(i) = i * i; i < 20)");
+    ExpectSameResults("exec2(x = 3, y = x * 2) + exec3(x += 1, y += 1, z = x + y)");
+    ExpectSameResults("x = (y = 3; z = 4; y + z); (a = 1; b = 2)");
+}
+
+TEST_P(EngineTest, Assignments)
+{
+    ExpectSameResults("x = y = z = 4; a = (b = 2) + (c = 3)");
+    ExpectSameResults("(x = 5) += 1; (y += 2) *= 3; if(x > 5, a, b) = 7");
+    ExpectSameResults("x = 1; y = (x += 2) + (x += 3)");
+    ExpectSameResults("reg00 = 5; reg01 += reg00; reg99 = reg01 * 2");
+    ExpectSameResults("exec2(x = 1, y) = 9; loop(2, z) = 3; while(0) = 4");
+    ExpectSameResults("x = 1; (x + 1) = 5; a = ((x + 2) = 7) + 1");
+}
+
+TEST_P(EngineTest, EvaluationOrder)
+{
+    // Variable values are read after all arguments are evaluated.
+    ExpectSameResults("x = 1; y = x + (x = 5)");
+    ExpectSameResults("x = 1; y = x * (x += 2; x)");
+    ExpectSameResults("x = 2; y = (x; a) - (a = 10)");
+    ExpectSameResults("x = 2; y = min(x, x = 1) + max(x, (x = 3)) * 10 + atan2(x, x = 0.5)");
+    ExpectSameResults("x = 1; y = (x = 2) + (x = 3)");
+    ExpectSameResults("i = 3; megabuf(1) = 2; y = megabuf(1) + (megabuf(1) = 5)");
+    ExpectSameResults("x = 1; y = if(x, x, 2) + (x = 8)");
+    ExpectSameResults("x = 4; y = sqr(x) + (x = 2)");
+    ExpectSameResults("x = 2; y = (x + 1) * (x = 3); z = x * 2 + (x = 1); a = if(x < (x = 5), x, -x) * 2");
+    ExpectSameResults("x = 3; y = loop(0, x += 1) + loop(x - 5, 1); z = while(x -= 1) + exec3(a, b, x = 4)");
+}
+
+TEST_P(EngineTest, ReferenceArguments)
+{
+    // exec3 evaluates its second argument into the location returned by the first one.
+    ExpectSameResults("i = 1; x = exec3(i, -1, 3)");
+    ExpectSameResults("i = 1; megabuf(0) += exec3(i, -1, 3)");
+    ExpectSameResults("x = exec3(megabuf(2), y * 2, 1) + exec3(if(a, b, c), 5, 2); z = exec3(i, exec2(a, 4), 0)");
+    ExpectSameResults("x = 2; exec3(exec3(a, b, x), freembuf(-1), 1); y = exec3(c, if(x > 1, 7, a), 0)");
+
+    // memcpy and memset return a reference to their destination argument.
+    ExpectSameResults("megabuf(0) = 0.84; megabuf(1) = 7; memcpy(megabuf(0), 1, 3)");
+    ExpectSameResults("megabuf(0) = 0.84; megabuf(1) = 7; x = memcpy(megabuf(0), 1, 3) + 1");
+    ExpectSameResults("megabuf(3) = 3; y = memset(megabuf(3), 9, 5); z = memset(if(y, megabuf(10), a), y, 2)");
+
+    // The result location of a while loop body isn't reset between iterations.
+    ExpectSameResults("n = 0; x = 5; y = while(if(n < 2, exec2(n += 1, x), 0))");
+    ExpectSameResults("n = 0; x = 5; y = while(n += 1; if(n < 3, x, 0))");
+}
+
+TEST_P(EngineTest, Superinstructions)
+{
+    // Compound assignments
+    ExpectSameResults("x = 1; y = 2; x = x + 3; y = 0.5 * y; z = z - x; a = 2 ^ a; b = b / x; c = c % 3");
+    ExpectSameResults("x = 1; x = x + (x = 5); y = 2; y = (y = 3) * y; z = 4; z = (z += 1; 2) - z");
+
+    // Multiply-add
+    ExpectSameResults("a = 1.5; b = 2; c = 0.25; x = a * b + c; y = c + a * b; z = sqr(a) * (b + 1) + sin(c)");
+    ExpectSameResults("a = 2; b = 3; x = a * b + (a = 5); y = a + a * (a = 7); z = (a = 1; b) * b + b");
+
+    // Compare-and-select
+    ExpectSameResults("x = 1; y = 2; a = if(x < y, 3, 4); b = if(x > y, 3, 4); c = if(x == y, 3, x != y)");
+    ExpectSameResults("x = 2; y = 2; a = if(x <= y, 3, 4); b = if(above(x, y), 3, 4); c = if(x >= y, x, y)");
+    ExpectSameResults("x = 1; if(x < (x = 3), y = 1, z = 2); if(below(x, 5), y, z) = 7; a = if(x < 2, 0, 1)");
+
+    // Indexed store
+    ExpectSameResults("i = 3; megabuf(i) = 5; gmegabuf(i + 1) = megabuf(i) * 2; x = (megabuf(2) = 7) + 1");
+    ExpectSameResults("i = 3; megabuf(i) = (i = 4); megabuf(i) = megabuf(i) + 1; megabuf(1) += 1");
+    ExpectSameResults("megabuf(-1) = 5; x = (megabuf(-5) = 3); (megabuf(2) = 4) += 1; y = megabuf(2)");
+}
+
+TEST_P(EngineTest, CommonSubexpressions)
+{
+    ExpectSameResults("x = 0.3; y = 2; a = sin(x * 2) + sin(x * 2) * y; b = sqrt(x * x + y * y); c = sqrt(x * x + y * y)");
+    ExpectSameResults("x = 0.3; a = sin(x) * 2; x += 1; b = sin(x) * 2; c = sin(x) * 2 + (x = 4; sin(x) * 2)");
+    ExpectSameResults("x = 1; y = 2; a = x * y + 1; if(x, b = x * y + 1, c = x * y + 1); d = if(y, x * y + 1, 0)");
+    ExpectSameResults("x = 0.5; n = 0; loop(4, a += sqr(x) / 3; n += sqr(x) / 3; x += 0.25); b = sqr(x) / 3");
+    ExpectSameResults("x = 3; megabuf(x * x + 1) = 2; y = megabuf(x * x + 1) * (x * x + 1)");
+}
+
+TEST_P(EngineTest, BranchPruning)
+{
+    ExpectSameResults("x = 2; if(0, a = 1, b = 2); c = if(1, x, y) * 2; if(1, a, b) = 4; loop(0.5, y += 1) + loop(1, z = 3)");
+    ExpectSameResults("x = 0.5; a = 0 && (b = 1); c = 1 && x; y = 0 || (z = 2); b = exec3(x + 1, y, z = 4)");
+    ExpectSameResults("x = 1; a = exec3(x + 1, 7, 2); b = exec3(c = 3, y, 1) + exec2(y, z = 1)");
+}
+
+TEST_P(EngineTest, LoopInvariants)
+{
+    ExpectSameResults("x = 0.5; i = 0; loop(8, megabuf(i) = sin(x * 3) * i + cos(y) * 2; i += 1); a = megabuf(7)");
+    ExpectSameResults("x = 2; i = 0; while(n = 0; loop(3, a += sqrt(x) * i + sqrt(x); n += 1); i += 1; i < 4)");
+    ExpectSameResults("x = 1; loop(4, a += sin(x); b += sin(x) * a; if(a > 1.5, x = 0.25, 0))");
+}
+
+TEST_P(EngineTest, LoopUnrolling)
+{
+    ExpectSameResults("i = 0; loop(8, megabuf(i) = i * 2; i += 1); a = megabuf(7) + loop(3, b += i)");
+    ExpectSameResults("i = 0; loop(1003, megabuf(i) = sqr(i) * 0.5; i += 1); a = megabuf(1002)");
+    ExpectSameResults("n = 0; loop(20, loop(5, n += 1); x += n); loop(2, a += 1; b) = 3; c = loop(2.5, y -= 1)");
+}
+
+TEST_P(EngineTest, StridedMemoryAccess)
+{
+    ExpectSameResults("i = 65500; loop(100, megabuf(i) = i; gmegabuf(i + 1) += megabuf(i - 2); i += 2); "
+                      "a = megabuf(65534) + megabuf(65536) + gmegabuf(65599)");
+    ExpectSameResults("i = 3; loop(8, x = megabuf(i - 3); megabuf(i) = x + 1; (megabuf(i) += 1) *= 2; i -= 1); "
+                      "b = megabuf(0) + megabuf(1)");
+    ExpectSameResults("i = 0.5; n = 0; loop(6, megabuf(i + n) = 2; a += megabuf(i + n); i += 1); b = megabuf(4)");
+}
+
+TEST_P(EngineTest, VectorizedLoops)
+{
+    projectm_eval_context_set_loop_vectorization(m_engine.context, 1);
+
+    ExpectSameResults("i = 0; loop(200, megabuf(i) = i * 0.5 + 1; gmegabuf(i + 3) = megabuf(i) * 2; i += 1); "
+                      "a = megabuf(150)");
+    ExpectSameResults("i = 0; loop(64, megabuf(i) = i; i += 1); i = 31; n = 2; "
+                      "b = loop(40, c = megabuf(i - 8) * n; megabuf(i) = if(c > 30, c, -c); i -= 1)");
+    ExpectSameResults("i = 5; loop(100, megabuf(i) = megabuf(i - 5) + 1; i += 1); x = megabuf(20)");
+}
+
+TEST_P(EngineTest, ValueRanges)
+{
+    ExpectSameResults("x = 3; y = -2; a = x / 4 + x / (abs(y) + 1) + if(y != 0, x / y, 0); b = (y < -1) && (c = x / y); x /= 2");
+    ExpectSameResults("x = 0.5; y = 0; a = if(y == 0, 0, x / y) + band(x > 0, y < 1) + bor(x < 0, !y); b = floor(floor(x) + 1)");
+    ExpectSameResults("i = 1; loop(4, a += 5 / i; b = bor(a > 10, i > 2) && (c = b / 2); i -= 1)");
+}
+
+TEST_P(EngineTest, Simplification)
+{
+    projectm_eval_context_set_simplification(m_tree.context, 1);
+    projectm_eval_context_set_simplification(m_engine.context, 1);
+
+    ExpectSameResults("x = 1.5; y = -2; a = x ^ 2 + pow(y, 3) + pow(x + y, 4) + pow(y, -1); x ^= 2");
+    ExpectSameResults("x = 3; y = 0.5; a = x / 4 + y / 3 * 1 + (0 - x) * -1; b = -(-y); x /= 8; y = abs(-x) + sqr(abs(y))");
+    ExpectSameResults("x = 2; a = 0; loop(4, a += sqr(sqrt(x)) + sqrt(x) * sqrt(x) + x * 1; x += 0 + 0.5)");
+}
+
+TEST_P(EngineTest, Memory)
+{
+    ExpectSameResults("i = 0; loop(16, megabuf(i) = i * 2; gmegabuf(i) = i + 0.5; i += 1)");
+    ExpectSameResults("megabuf(3) = 7; megabuf(3) += 2; megabuf(3) *= megabuf(3); gmem[4] = 2; gmem[4] ^= 3");
+    ExpectSameResults("megabuf(1.99999) = 3; megabuf(-1) = 5; y = megabuf(-1) + megabuf(2)");
+    ExpectSameResults("memset(4, 3.5, 8); memcpy(1, 4, 6); x = memcpy(20, 0, 4) + memset(0, 1, 2)");
+    ExpectSameResults("megabuf(10) = 1; freembuf(0); x = megabuf(10)");
+    ExpectSameResults("x = 4; memset(x, 2, x = 6)");
+    ExpectSameResults("x = 2; memcpy(x, 5, (x = 8; 3))");
+}
+
+TEST_P(EngineTest, Mandelbrot)
+{
+    ExpectSameResults(R"(
+        size_x = 8;
+        size_y = 4;
+        pos_x = 0;
+        loop(size_x,
+            pos_y = 0;
+            loop(size_y,
+                x0 = -2.00 + ((0.47 - -2.00) / size_x) * pos_x;
+                y0 = -1.12 + ((1.12 - -1.12) / size_y) * pos_y;
+                x = 0;
+                y = 0;
+                n = 0;
+                while(
+                    z = sqr(x) - sqr(y) + x0;
+                    y = 2*x*y + y0;
+                    x = z;
+                    n += 1;
+                    sqr(x) + sqr(y) <= 4 && n < 100
+                );
+                megabuf(pos_x * size_y + pos_y) = n;
+                pos_y += 1
+            );
+            pos_x += 1
+        );
+    )", 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, EngineTest, testing::Values(PROJECTM_EVAL_ENGINE_TREE,
+                                                                 PROJECTM_EVAL_ENGINE_BYTECODE,
+                                                                 PROJECTM_EVAL_ENGINE_REGISTER
+#ifdef PRJM_EVAL_ENABLE_JIT
+                                                                 , PROJECTM_EVAL_ENGINE_JIT
+#endif
+                                                                 ));
+
+TEST(TieredExecution, PromotesFrequentlyExecutedCode)
+{
+    auto* context = projectm_eval_context_create(nullptr, nullptr);
+    projectm_eval_context_set_tiering_threshold(context, 3);
+
+    auto* code = projectm_eval_code_compile(context, "x += 1; megabuf(x) = x * 2");
+    ASSERT_NE(code, nullptr);
+    auto* x = projectm_eval_context_register_variable(context, "x");
+
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 2.0);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 4.0);
+    EXPECT_EQ(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_TREE);
+
+    // The program state is kept when switching the engine.
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 6.0);
+#ifdef PRJM_EVAL_ENABLE_JIT
+    EXPECT_EQ(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_JIT);
+#else
+    EXPECT_EQ(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_REGISTER);
+#endif
+
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 8.0);
+    EXPECT_DOUBLE_EQ(*x, 4.0);
+
+    projectm_eval_code_destroy(code);
+    projectm_eval_context_destroy(context);
+}
+
+TEST(TieredExecution, KeepsSelectedEngine)
+{
+    auto* context = projectm_eval_context_create(nullptr, nullptr);
+    projectm_eval_context_set_tiering_threshold(context, 2);
+
+    auto* selectedCode = projectm_eval_code_compile(context, "x += 1");
+    ASSERT_NE(selectedCode, nullptr);
+    ASSERT_EQ(projectm_eval_code_set_engine(selectedCode, PROJECTM_EVAL_ENGINE_BYTECODE), 1);
+
+    projectm_eval_context_set_tiering_threshold(context, 0);
+    auto* untieredCode = projectm_eval_code_compile(context, "y += 1");
+    ASSERT_NE(untieredCode, nullptr);
+
+    for (int iteration = 0; iteration < 10; iteration++)
+    {
+        projectm_eval_code_execute(selectedCode);
+        projectm_eval_code_execute(untieredCode);
+    }
+
+    EXPECT_EQ(projectm_eval_code_get_engine(selectedCode), PROJECTM_EVAL_ENGINE_BYTECODE);
+    EXPECT_EQ(projectm_eval_code_get_engine(untieredCode), PROJECTM_EVAL_ENGINE_TREE);
+    EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(context, "x"), 10.0);
+    EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(context, "y"), 10.0);
+
+    projectm_eval_code_destroy(selectedCode);
+    projectm_eval_code_destroy(untieredCode);
+    projectm_eval_context_destroy(context);
+}
+
+TEST(TieredExecution, DisabledByDefault)
+{
+    auto* context = projectm_eval_context_create(nullptr, nullptr);
+
+    auto* code = projectm_eval_code_compile(context, "x += 1");
+    ASSERT_NE(code, nullptr);
+
+    for (int iteration = 0; iteration < 100; iteration++)
+    {
+        projectm_eval_code_execute(code);
+    }
+
+    EXPECT_EQ(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_TREE);
+
+    projectm_eval_code_destroy(code);
+    projectm_eval_context_destroy(context);
+}
+
+TEST(TieredExecution, PromotionKeepsResults)
+{
+    auto* context = projectm_eval_context_create(nullptr, nullptr);
+    projectm_eval_context_set_tiering_threshold(context, 2);
+
+    // Both the memcpy result and the exec3 store depend on reference arguments.
+    auto* code = projectm_eval_code_compile(context,
+                                            "megabuf(0) = 0.84; megabuf(1) = 7; i = 1;"
+                                            "megabuf(2) += exec3(i, -1, 3); memcpy(megabuf(0), 1, 3) + i");
+    ASSERT_NE(code, nullptr);
+    auto* i = projectm_eval_context_register_variable(context, "i");
+
+    for (int iteration = 0; iteration < 4; iteration++)
+    {
+        EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 6.0) << "Iteration " << iteration;
+        EXPECT_DOUBLE_EQ(*i, -1.0) << "Iteration " << iteration;
+    }
+    EXPECT_NE(projectm_eval_code_get_engine(code), PROJECTM_EVAL_ENGINE_TREE);
+
+    projectm_eval_code_destroy(code);
+    projectm_eval_context_destroy(context);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs the same code with the tree interpreter and another engine and compares the results.
+ * The test parameter is the engine to compare against the tree interpreter. The reference tree is compiled without
+ * superinstruction fusion and executed with the reference-returning node functions, so the optimized tree and the
+ * value-returning node functions can be tested as well.
+ */
+class EngineTest : public testing::TestWithParam<projectm_eval_engine>
+{
+public:
+
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Compiles and executes the code in both contexts and compares result, variables and memory.
+     * @param code The code to check.
+     * @param iterations Number of consecutive executions.
+     */
+    void ExpectSameResults(const std::string& code, int iterations = 3);
+
+    struct ExecutionContext
+    {
+        struct projectm_eval_context* context{};
+        projectm_eval_mem_buffer globalMemory{};
+        PRJM_EVAL_F globalRegisters[100]{};
+    };
+
+    ExecutionContext m_tree; //!< Context used to execute the unoptimized reference tree.
+    ExecutionContext m_engine; //!< Context used to execute the tested engine.
+
+    static const std::vector<std::string> m_variableNames;
+};
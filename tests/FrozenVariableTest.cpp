@@ -0,0 +1,280 @@
+#include "FrozenVariableTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+#include <projectm-eval/TreeFunctions.h>
+}
+
+namespace {
+
+int CountNodeReads(const prjm_eval_exptreenode_t* node, const PRJM_EVAL_F* var)
+{
+    if (!node)
+    {
+        return 0;
+    }
+
+    int count = node->func == prjm_eval_func_var && node->var == var ? 1 : 0;
+    if (node->args)
+    {
+        for (int index = 0; node->args[index]; index++)
+        {
+            count += CountNodeReads(node->args[index], var);
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+void FrozenVariableTest::SetUp()
+{
+    m_globalMemory = projectm_eval_memory_buffer_create();
+    m_context = projectm_eval_context_create(m_globalMemory, &m_globalRegisters);
+    projectm_eval_context_set_tiering_threshold(m_context, 0);
+}
+
+void FrozenVariableTest::TearDown()
+{
+    projectm_eval_context_destroy(m_context);
+    projectm_eval_memory_buffer_destroy(m_globalMemory);
+}
+
+int FrozenVariableTest::CountVariableReads(struct projectm_eval_code* code, const PRJM_EVAL_F* var)
+{
+    return CountNodeReads(reinterpret_cast<prjm_eval_program_t*>(code)->program, var);
+}
+
+TEST_F(FrozenVariableTest, FoldsFrozenVariable)
+{
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    auto* meshy = projectm_eval_context_register_variable(m_context, "meshy");
+    *meshx = 48;
+    *meshy = 36;
+
+    auto* code = projectm_eval_code_compile(m_context, "meshx * 2 + 1");
+    ASSERT_NE(code, nullptr);
+    EXPECT_EQ(CountVariableReads(code, meshx), 1);
+
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 97.0);
+    EXPECT_EQ(CountVariableReads(code, meshx), 0);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(code)->program->func, prjm_eval_func_const);
+
+    // Only the expressions using the frozen variable are folded.
+    auto* mixedCode = projectm_eval_code_compile(m_context, "x = meshx * 2 + meshy;");
+    ASSERT_NE(mixedCode, nullptr);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(mixedCode), 132.0);
+    EXPECT_EQ(CountVariableReads(mixedCode, meshx), 0);
+    EXPECT_EQ(CountVariableReads(mixedCode, meshy), 1);
+    EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_context, "x"), 132.0);
+
+    projectm_eval_code_destroy(code);
+    projectm_eval_code_destroy(mixedCode);
+}
+
+TEST_F(FrozenVariableTest, SpecializesAgainOnValueChange)
+{
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    *meshx = 48;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+
+    auto* code = projectm_eval_code_compile(m_context, "x = 1 / meshx; y = x * 3;");
+    ASSERT_NE(code, nullptr);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 3.0 / 48.0);
+    EXPECT_EQ(CountVariableReads(code, meshx), 0);
+
+    *meshx = 64;
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 3.0 / 64.0);
+    EXPECT_EQ(CountVariableReads(code, meshx), 0);
+
+    // Unfreezing restores the original program, reading the variable on each execution again.
+    ASSERT_EQ(projectm_eval_context_unfreeze_variable(m_context, meshx), 1);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 3.0 / 64.0);
+    EXPECT_EQ(CountVariableReads(code, meshx), 1);
+
+    *meshx = 32;
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 3.0 / 32.0);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(FrozenVariableTest, IgnoresAssignedVariables)
+{
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    *meshx = 4;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+
+    auto* code = projectm_eval_code_compile(m_context, "y = meshx * 2; meshx += 1;");
+    ASSERT_NE(code, nullptr);
+    projectm_eval_code_execute(code);
+    EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_context, "y"), 8.0);
+    projectm_eval_code_execute(code);
+    EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_context, "y"), 10.0);
+    EXPECT_EQ(CountVariableReads(code, meshx), 2);
+
+    // Memory indices aren't assigned, only the memory they refer to.
+    *meshx = 7;
+    auto* memoryCode = projectm_eval_code_compile(m_context, "megabuf(meshx) = 5; megabuf(7);");
+    ASSERT_NE(memoryCode, nullptr);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(memoryCode), 5.0);
+    EXPECT_EQ(CountVariableReads(memoryCode, meshx), 0);
+
+    projectm_eval_code_destroy(code);
+    projectm_eval_code_destroy(memoryCode);
+}
+
+TEST_F(FrozenVariableTest, IgnoresStoredLocations)
+{
+    auto* x = projectm_eval_context_register_variable(m_context, "x");
+    auto* y = projectm_eval_context_register_variable(m_context, "y");
+    auto* b = projectm_eval_context_register_variable(m_context, "b");
+    *x = 1;
+
+    // The variable returned by exec3's second argument decides where the value is stored, so it isn't replaced.
+    for (const char* program : {"b = 0; exec3(b, y, 1)",
+                                "b = 0; exec3(b, if(x, y, 2), 1)",
+                                "b = 0; exec3(b, loop(2, y), 1)"})
+    {
+        SCOPED_TRACE(program);
+
+        *y = 3;
+        auto* code = projectm_eval_code_compile(m_context, program);
+        ASSERT_NE(code, nullptr);
+        projectm_eval_code_execute(code);
+        PRJM_EVAL_F unfrozenValue = *b;
+
+        ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, y), 1);
+        projectm_eval_code_execute(code);
+        EXPECT_DOUBLE_EQ(*b, unfrozenValue);
+        EXPECT_DOUBLE_EQ(*b, 0.0);
+        EXPECT_GT(CountVariableReads(code, y), 0);
+        ASSERT_EQ(projectm_eval_context_unfreeze_variable(m_context, y), 1);
+
+        projectm_eval_code_destroy(code);
+    }
+}
+
+TEST_F(FrozenVariableTest, KeepsCompileError)
+{
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    *meshx = 2;
+
+    auto* code = projectm_eval_code_compile(m_context, "x = meshx * 3");
+    ASSERT_NE(code, nullptr);
+    EXPECT_EQ(projectm_eval_code_compile(m_context, "x = (meshx"), nullptr);
+    int line = 0;
+    int column = 0;
+    const char* error = projectm_eval_get_error(m_context, &line, &column);
+    ASSERT_NE(error, nullptr);
+    std::string message = error;
+
+    // Specializing the program parses its source again, which must not touch the error of the failed compilation.
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 6.0);
+    EXPECT_EQ(CountVariableReads(code, meshx), 0);
+
+    int specializedLine = 0;
+    int specializedColumn = 0;
+    error = projectm_eval_get_error(m_context, &specializedLine, &specializedColumn);
+    ASSERT_NE(error, nullptr);
+    EXPECT_EQ(error, message);
+    EXPECT_EQ(specializedLine, line);
+    EXPECT_EQ(specializedColumn, column);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(FrozenVariableTest, OnlyContextVariables)
+{
+    PRJM_EVAL_F other{};
+    EXPECT_EQ(projectm_eval_context_freeze_variable(m_context, &m_globalRegisters[0]), 0);
+    EXPECT_EQ(projectm_eval_context_freeze_variable(m_context, &other), 0);
+    EXPECT_EQ(projectm_eval_context_unfreeze_variable(m_context, &other), 0);
+}
+
+TEST_F(FrozenVariableTest, KeepsEngine)
+{
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    *meshx = 10;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+
+    for (auto engine : {PROJECTM_EVAL_ENGINE_BYTECODE, PROJECTM_EVAL_ENGINE_REGISTER})
+    {
+        *meshx = 10;
+        auto* code = projectm_eval_code_compile(m_context, "i = 0; loop(meshx, i += 2); i + meshx");
+        ASSERT_NE(code, nullptr);
+        ASSERT_EQ(projectm_eval_code_set_engine(code, engine), 1);
+
+        EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 30.0);
+        EXPECT_EQ(projectm_eval_code_get_engine(code), engine);
+
+        *meshx = 20;
+        EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 60.0);
+        EXPECT_EQ(projectm_eval_code_get_engine(code), engine);
+        EXPECT_EQ(CountVariableReads(code, meshx), 0);
+
+        projectm_eval_code_destroy(code);
+    }
+}
+
+TEST_F(FrozenVariableTest, KeepsPassOptions)
+{
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    auto* x = projectm_eval_context_register_variable(m_context, "x");
+    *meshx = 3;
+    *x = 3;
+
+    auto* code = projectm_eval_code_compile(m_context, "y = x / (abs(meshx) + 1) + x / 2");
+    ASSERT_NE(code, nullptr);
+    auto* program = reinterpret_cast<prjm_eval_program_t*>(code);
+    EXPECT_EQ(program->specialized_operation_count, 2);
+
+    // Specializing again uses the passes the program was compiled with, not the context's current ones.
+    m_context->specialize_value_ranges = false;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(code), 2.25);
+    EXPECT_EQ(CountVariableReads(code, meshx), 0);
+    EXPECT_EQ(program->specialized_operation_count, 2);
+
+    projectm_eval_code_destroy(code);
+}
+
+TEST_F(FrozenVariableTest, BatchExecution)
+{
+    constexpr int laneCount = 5;
+
+    auto* meshx = projectm_eval_context_register_variable(m_context, "meshx");
+    auto* x = projectm_eval_context_register_variable(m_context, "x");
+    auto* time = projectm_eval_context_register_variable(m_context, "time");
+    *meshx = 4;
+    *time = 2;
+    ASSERT_EQ(projectm_eval_context_freeze_variable(m_context, meshx), 1);
+
+    auto* code = projectm_eval_code_compile(m_context, "x = x * meshx + time;");
+    ASSERT_NE(code, nullptr);
+    ASSERT_EQ(projectm_eval_code_set_uniform_variables(code, &time, 1), 0);
+
+    PRJM_EVAL_F values[laneCount];
+    PRJM_EVAL_F results[laneCount];
+    projectm_eval_lane_variable laneVariable{x, values};
+
+    for (PRJM_EVAL_F meshxValue : {4.0, 8.0})
+    {
+        *meshx = meshxValue;
+        for (int lane = 0; lane < laneCount; lane++)
+        {
+            values[lane] = lane;
+        }
+
+        projectm_eval_code_execute_batch(code, &laneVariable, 1, laneCount, results);
+        for (int lane = 0; lane < laneCount; lane++)
+        {
+            EXPECT_DOUBLE_EQ(values[lane], lane * meshxValue + 2.0) << "Lane " << lane;
+            EXPECT_DOUBLE_EQ(results[lane], lane * meshxValue + 2.0) << "Lane " << lane;
+        }
+        EXPECT_EQ(CountVariableReads(code, meshx), 0);
+    }
+
+    projectm_eval_code_destroy(code);
+}
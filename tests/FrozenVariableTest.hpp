@@ -0,0 +1,31 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <string>
+
+/**
+ * @brief Tests the specialization of programs for frozen variables.
+ */
+class FrozenVariableTest : public testing::Test
+{
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Counts the nodes in the current tree of the code which read the given variable.
+     * @param code The compiled code.
+     * @param var The variable to look for.
+     * @return The number of variable nodes reading var.
+     */
+    static int CountVariableReads(struct projectm_eval_code* code, const PRJM_EVAL_F* var);
+
+    struct projectm_eval_context* m_context{};
+    projectm_eval_mem_buffer m_globalMemory{};
+    PRJM_EVAL_F m_globalRegisters[100]{};
+};
@@ -0,0 +1,83 @@
+#include "LoopInvariantTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+void LoopInvariantTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    m_reference.context->hoist_loop_invariants = false;
+    m_variableNames.emplace_back("j");
+}
+
+int LoopInvariantTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return reinterpret_cast<prjm_eval_program_t*>(code)->hoisted_expression_count;
+}
+
+TEST_F(LoopInvariantTest, InvariantExpressions)
+{
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(4, gmegabuf(i) = sin(x) * 2 + i; i += 1); b = gmegabuf(3)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; while(a += cos(y) * 3; i += 1; i < 5)"), 1);
+
+    // Identical expressions share one hidden variable.
+    m_optimized.context->eliminate_common_subexpressions = false;
+    m_reference.context->eliminate_common_subexpressions = false;
+    EXPECT_EQ(ExpectSameResults("loop(3, a += sin(x); b += sin(x) * a)"), 2);
+    m_optimized.context->eliminate_common_subexpressions = true;
+
+    // Expressions in conditional code are computed in front of the loop as well.
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(3, if(a > 1, b += sqrt(x), c += 1); a += 1)"), 1);
+
+    // Cheap expressions stay in the loop.
+    EXPECT_EQ(ExpectSameResults("loop(3, a += x)"), 0);
+}
+
+TEST_F(LoopInvariantTest, AssignedVariables)
+{
+    EXPECT_EQ(ExpectSameResults("loop(4, a += sin(x); x += 0.5)"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(4, a += sin(x); if(a > 1, x = 2, 0))"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(x = 3, a += sqrt(x))"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(4, a += sin(x); if(a > 1, x, b) = 3)"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(4, a += sin(x); c = exec3(x, y * 2, 0))"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; while(a += sin(i); i += 1; i < 3)"), 0);
+
+    // The value stored by exec3 can't be replaced by a variable without losing the store.
+    EXPECT_EQ(ExpectSameResults("loop(4, c = exec3(b, sin(x), 0); a += b)"), 0);
+
+    // Only variables of the subexpression matter.
+    EXPECT_EQ(ExpectSameResults("loop(4, a += sin(x) * y; y += 1)"), 1);
+}
+
+TEST_F(LoopInvariantTest, NestedLoops)
+{
+    // sin(x) and cos(y) leave both loops, the expression using i only the inner one.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(3, j = 0; loop(2, a += sin(x) + i * cos(y); j += 1); i += 1)"), 3);
+
+    // Loop targets and loops inside the body are handled as well.
+    EXPECT_EQ(ExpectSameResults("loop(2, a += 1; b) = sqrt(x) * 2"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(2, loop(2, a += 1); b += sqrt(a) * x)"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(2, loop(2, a += sqrt(x)); b += 1)"), 1);
+}
+
+TEST_F(LoopInvariantTest, ImpureExpressions)
+{
+    EXPECT_EQ(ExpectSameResults("loop(3, a += gmegabuf(0) * 2; gmegabuf(0) = a)"), 0);
+    EXPECT_EQ(ExpectSameResults("loop(3, gmegabuf(1) += 1; a += sqr(gmegabuf(1)))"), 0);
+
+    // Random numbers differ between both contexts, so only the optimization is checked.
+    auto* randomCode = projectm_eval_code_compile(m_optimized.context, "loop(3, a += sin(rand(10)) * x)");
+    ASSERT_NE(randomCode, nullptr);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(randomCode)->hoisted_expression_count, 0);
+    projectm_eval_code_destroy(randomCode);
+}
+
+TEST_F(LoopInvariantTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests moving loop-invariant expressions out of loop() and while() bodies.
+ * Each program is also compiled in a second context without code motion, and both results are compared.
+ */
+class LoopInvariantTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+};
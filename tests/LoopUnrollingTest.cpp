@@ -0,0 +1,72 @@
+#include "LoopUnrollingTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+void LoopUnrollingTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    projectm_eval_context_set_unroll_limit(m_reference.context, 0);
+    m_variableNames.emplace_back("j");
+}
+
+int LoopUnrollingTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return reinterpret_cast<prjm_eval_program_t*>(code)->unrolled_loop_count;
+}
+
+TEST_F(LoopUnrollingTest, SmallLoops)
+{
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(4, a += x)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, gmegabuf(i) = i * x; i += 1); b = gmegabuf(7)"), 1);
+
+    // The last body copy returns the loop value, also as an assignment target.
+    EXPECT_EQ(ExpectSameResults("b = loop(3, a += 2) + loop(2.7, c += 1)"), 2);
+    EXPECT_EQ(ExpectSameResults("loop(3, a += 1; b) = 5"), 1);
+
+    // Unrolled inner loops are part of the outer loop's size.
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(2, loop(3, a += 1); b += a)"), 2);
+}
+
+TEST_F(LoopUnrollingTest, LargeLoops)
+{
+    // The body is repeated 8 times per iteration, and 4 times if 8 copies and the remainder don't fit.
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(1000, a += x * 2 + 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(1003, a += x * 2 + 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(301, gmegabuf(i) = sin(i) * y; i += 1); b = gmegabuf(300)"), 1);
+
+    // Counts above the maximum loop count are clamped.
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(2000000, a += 1)"), 1);
+}
+
+TEST_F(LoopUnrollingTest, RemainingLoops)
+{
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(x * 8, a += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = 0; while(a += 1; a < 4)"), 0);
+
+    // Counts below one return the count value.
+    projectm_eval_context_set_unroll_limit(m_optimized.context, 1000);
+    m_optimized.context->prune_branches = false;
+    m_reference.context->prune_branches = false;
+    EXPECT_EQ(ExpectSameResults("b = loop(0.5, a += 1) + loop(-2, a += 1); c = loop(1, a += 1)"), 1);
+}
+
+TEST_F(LoopUnrollingTest, SizeLimit)
+{
+    projectm_eval_context_set_unroll_limit(m_optimized.context, 12);
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(4, a += sin(x) * 2)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(4, a += sin(a) * 2 + cos(a) * 3 + 1)"), 0);
+
+    projectm_eval_context_set_unroll_limit(m_optimized.context, 0);
+    EXPECT_EQ(ExpectSameResults("a = 0; loop(4, a += x)"), 0);
+}
+
+TEST_F(LoopUnrollingTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests unrolling loop() calls with constant counts.
+ * Each program is also compiled in a second context without unrolling, and both results are compared.
+ */
+class LoopUnrollingTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+};
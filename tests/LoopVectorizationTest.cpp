@@ -0,0 +1,109 @@
+#include "LoopVectorizationTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+#include <projectm-eval/RegisterCode.h>
+}
+
+void LoopVectorizationTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    for (auto* executionContext : {&m_optimized, &m_reference})
+    {
+        projectm_eval_context_set_unroll_limit(executionContext->context, 0);
+    }
+
+    projectm_eval_context_set_loop_vectorization(m_optimized.context, 1);
+    m_optimizedEngine = PROJECTM_EVAL_ENGINE_REGISTER;
+    m_referenceEngine = PROJECTM_EVAL_ENGINE_REGISTER;
+    m_variableNames.emplace_back("j");
+    m_variableNames.emplace_back("t");
+    m_memorySize = 400;
+}
+
+int LoopVectorizationTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    auto* registerProgram = reinterpret_cast<prjm_eval_program_t*>(code)->register_code;
+    return registerProgram ? registerProgram->vector_loop_count : 0;
+}
+
+TEST_F(LoopVectorizationTest, IndependentIterations)
+{
+    // Fill, scale and blend loops.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(300, megabuf(i) = sin(i * 0.1) * x + sqrt(i); i += 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(300, megabuf(i) = i; i += 1); "
+                                "i = 0; a = loop(300, megabuf(i) *= 0.5; i += 1)"), 2);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(300, megabuf(i) = i; gmegabuf(i) = cos(i); i += 1); "
+                                "i = 0; a = loop(300, megabuf(i) = megabuf(i) * 0.9 + gmegabuf(i) * 0.1; i += 1)"),
+              2);
+
+    // Conditional code is executed per lane, variables assigned before they are read are private to the iteration.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(250, t = pow(i, 0.7) * y; megabuf(i + 50) = if(t < -10, t, abs(t)); "
+                                "gmegabuf(i) = i % 3 && t; i += 1); a = t"), 1);
+
+    // Increments in the middle of the body, backwards and strided loops.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(120, megabuf(i) = i; i += 1; megabuf(i + 200) = -i; i += 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 399; loop(400, megabuf(i) = exp(i * 0.01); i -= 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 1; loop(100, megabuf(i) = megabuf(i - 1) + 1; i += 2)"), 1);
+
+    // Read-only memory may be accessed at any index.
+    EXPECT_EQ(ExpectSameResults("j = 7; i = 0; loop(100, gmegabuf(i) = megabuf(i * 2 + j); i += 1)"), 1);
+}
+
+TEST_F(LoopVectorizationTest, MemoryDependencies)
+{
+    // Iterations accessing the same location are only executed together if they are far enough apart.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i + 1) = megabuf(i) + 1; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 1; loop(100, megabuf(i) = megabuf(i + 1) + 1; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i + 2) = 1; megabuf(i) = 2; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i + 5) = megabuf(i) + 1; i += 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i + 40) = megabuf(i) + 1; i += 1)"), 1);
+
+    // Written memory must be accessed at the induction variable plus a constant.
+    EXPECT_EQ(ExpectSameResults("j = 3; i = 0; loop(100, megabuf(i + j) = megabuf(i) + 1; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i) = megabuf(i * 2) + 1; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i) = megabuf(i + 0.5) + 1; i += 1)"), 0);
+}
+
+TEST_F(LoopVectorizationTest, LoopCarriedVariables)
+{
+    EXPECT_EQ(ExpectSameResults("i = 0; a = 0; loop(100, a += megabuf(i) + i; megabuf(i) = 1; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; t = 5; loop(100, megabuf(i) = t; t = i; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; t = 5; loop(100, if(i > 50, t = i, 0); megabuf(i) = 1; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; j = 0; loop(100, megabuf(i) = j; i += 1; j += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i) = 1; i += 1; if(i > 4, i += 1, 0))"), 0);
+
+    // Functions with state and nested loops aren't vectorized.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i) = loop(2, b += 1); i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, memset(i * 2, i, 2); megabuf(i) = 1; i += 1)"), 0);
+
+    // Random numbers differ between both contexts, so only the vectorization is checked.
+    auto* randomCode = projectm_eval_code_compile(m_optimized.context, "i = 0; loop(100, megabuf(i) = rand(5); i += 1)");
+    ASSERT_NE(randomCode, nullptr);
+    ASSERT_EQ(projectm_eval_code_set_engine(randomCode, PROJECTM_EVAL_ENGINE_REGISTER), 1);
+    EXPECT_EQ(reinterpret_cast<prjm_eval_program_t*>(randomCode)->register_code->vector_loop_count, 0);
+    projectm_eval_code_destroy(randomCode);
+}
+
+TEST_F(LoopVectorizationTest, ScalarFallback)
+{
+    // These loops are vectorized, but executed one iteration after another with these start values and counts.
+    EXPECT_EQ(ExpectSameResults("i = 0.5; loop(100, megabuf(i) = i; i += 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = -5; loop(100, megabuf(i) = i + 100; i += 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 40; loop(100, megabuf(i) = i + 100; i -= 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; a = loop(10, megabuf(i) = i; i += 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; c = -5; a = loop(c, megabuf(i) = i; i += 1)"), 1);
+
+    // The loop count is evaluated once.
+    EXPECT_EQ(ExpectSameResults("i = 0; c = 64; a = loop(c, megabuf(i) = c; c = i; i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; c = 64; a = loop(c, megabuf(i) = i; b = c; i += 1)"), 1);
+}
+
+TEST_F(LoopVectorizationTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
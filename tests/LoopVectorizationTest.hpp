@@ -0,0 +1,18 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests the batch execution of independent loop iterations by the register code.
+ * Each program is executed by the register code interpreter with and, in a second context, without loop vectorization.
+ * The return values, variables and memory contents must be identical, except for rounding differences of the vectorized
+ * math functions. Loop unrolling is disabled, so the loop bodies are vectorized as written.
+ */
+class LoopVectorizationTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+};
@@ -0,0 +1,97 @@
+#include "MemoryCursorTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+#include <projectm-eval/RegisterCode.h>
+}
+
+void MemoryCursorTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    for (auto* executionContext : {&m_optimized, &m_reference})
+    {
+        projectm_eval_context_set_unroll_limit(executionContext->context, 0);
+    }
+
+    m_optimizedEngine = PROJECTM_EVAL_ENGINE_REGISTER;
+    m_variableNames.emplace_back("j");
+}
+
+int MemoryCursorTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    auto* registerProgram = reinterpret_cast<prjm_eval_program_t*>(code)->register_code;
+    return registerProgram ? registerProgram->cursor_count : 0;
+}
+
+TEST_F(MemoryCursorTest, StridedAccesses)
+{
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(100, megabuf(i) = i * x; i += 1); a = megabuf(99) + megabuf(50)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 10; loop(10, a += gmegabuf(i) + gmegabuf(i + 1); i = i + 2)"), 2);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(20, megabuf(i + 3) = megabuf(i - 1) + 1; megabuf(1 + i) += 2; i += 1); "
+                                "a = megabuf(19) + megabuf(21)"), 3);
+
+    // Offsets may also be variables which aren't changed in the loop.
+    EXPECT_EQ(ExpectSameResults("i = 0; j = 7; loop(10, megabuf(j + i) = i; i += 1); a = megabuf(16)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; j = 7; loop(10, megabuf(j + i) = i; i += 1; j += 1); a = megabuf(25)"), 0);
+
+    // Backwards, and with several increments of the same variable.
+    EXPECT_EQ(ExpectSameResults("i = 40; loop(40, megabuf(i) = i; i -= 1); a = megabuf(1) + megabuf(40)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; j = 0; loop(30, megabuf(i) = j; i += 1; megabuf(i + 100) = j; i += 2; "
+                                "j += 1); a = megabuf(87) + megabuf(190)"), 2);
+}
+
+TEST_F(MemoryCursorTest, BlockBoundaries)
+{
+    // Memory is allocated in blocks of 65536 items, cursors look up the address again in the next block.
+    EXPECT_EQ(ExpectSameResults("i = 65530; loop(12, megabuf(i) = i; i += 1); a = megabuf(65535) + megabuf(65536)"),
+              1);
+    EXPECT_EQ(ExpectSameResults("i = 65540; loop(12, megabuf(i) = i; i -= 3); a = megabuf(65537) + megabuf(65534)"),
+              1);
+
+    // Indices outside of the memory return 0 and aren't followed.
+    EXPECT_EQ(ExpectSameResults("i = -3; loop(6, megabuf(i) = i + 10; a += megabuf(i); i += 1); b = megabuf(0)"), 2);
+    EXPECT_EQ(ExpectSameResults("i = 8388605; loop(6, megabuf(i) = 1; a += megabuf(i) + 1; i += 1)"), 2);
+}
+
+TEST_F(MemoryCursorTest, FractionalIndices)
+{
+    // Only integer index values are followed, others are looked up for each access.
+    EXPECT_EQ(ExpectSameResults("i = 0.5; loop(8, megabuf(i) += 1; i += 1); a = megabuf(0) + megabuf(7)"), 1);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i + 0.99995) = i; i += 1); a = megabuf(1) + megabuf(8)"), 1);
+
+    // The accesses use the current index value, even if it no longer follows the stride.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; i += 1; i = i + 1); a = megabuf(6) + megabuf(7)"), 1);
+}
+
+TEST_F(MemoryCursorTest, NonInductionVariables)
+{
+    EXPECT_EQ(ExpectSameResults("i = 1; loop(8, megabuf(i) = 1; i *= 2)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; i += x)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; i += 0.5; i += 0.5)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; i += 1; if(i > 4, i += 1, 0))"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; a = (i += 1))"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; c = exec3(i, i + 1, 0); i += 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i * 2) = 1; i += 1); a = megabuf(14)"), 0);
+
+    // Assignments to unknown locations may change any variable.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, megabuf(i) = 1; if(x, a, b) = 2; i += 1)"), 0);
+}
+
+TEST_F(MemoryCursorTest, ConditionalAccesses)
+{
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, if(i % 2, megabuf(i) = 1, 0); i += 1); a = megabuf(3)"), 0);
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(8, a += x > 0 && megabuf(i); i += 1)"), 0);
+
+    // Nested loops get their own cursors.
+    EXPECT_EQ(ExpectSameResults("i = 0; loop(4, j = 0; loop(4, megabuf(i * 4 + j) = i + j; j += 1); gmegabuf(i) = 1; "
+                                "i += 1); a = megabuf(15) + gmegabuf(3)"), 2);
+}
+
+TEST_F(MemoryCursorTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests memory cursors for strided memory accesses in loops.
+ * Each program is executed by the register code interpreter and, in a second context, by the tree interpreter, and
+ * both results are compared. Loop unrolling is disabled, so each access in the code gets at most one cursor.
+ */
+class MemoryCursorTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+};
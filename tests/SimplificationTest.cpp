@@ -0,0 +1,112 @@
+#include "SimplificationTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+#include <limits>
+
+namespace {
+
+/* Rewrites which round differently may be off by one unit in the last place. */
+const double roundingTolerance = 4.0 * std::numeric_limits<PRJM_EVAL_F>::epsilon();
+
+const PRJM_EVAL_F inputValues[] = {-1e6, -3.5, -1.0, -0.3, -0.0, 0.0, 1e-20, 0.1, 0.75, 1.0, 2.0, 7.25, 1234.5};
+
+} // namespace
+
+void SimplificationTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    projectm_eval_context_set_simplification(m_optimized.context, 1);
+    m_iterations = static_cast<int>(sizeof(inputValues) / sizeof(*inputValues));
+    m_exactValues = true;
+}
+
+int SimplificationTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return reinterpret_cast<prjm_eval_program_t*>(code)->simplified_expression_count;
+}
+
+void SimplificationTest::SetIterationInputs(int iteration)
+{
+    PRJM_EVAL_F x = inputValues[iteration];
+    SetVariable("a", 0.5);
+    SetVariable("x", x);
+    SetVariable("y", 1.5 - x);
+}
+
+int SimplificationTest::ExpectSameResults(const std::string& code, double relativeTolerance)
+{
+    m_relativeTolerance = relativeTolerance;
+
+    return DifferentialTest::ExpectSameResults(code);
+}
+
+TEST_F(SimplificationTest, Powers)
+{
+    EXPECT_EQ(ExpectSameResults("a = pow(x, 2)", roundingTolerance), 1);
+    EXPECT_EQ(ExpectSameResults("a = (x + y) ^ 2", roundingTolerance), 1);
+    EXPECT_EQ(ExpectSameResults("a = pow(x, 3)", roundingTolerance), 1);
+    EXPECT_EQ(ExpectSameResults("a = pow(x * y, 4)", roundingTolerance), 1);
+    EXPECT_EQ(ExpectSameResults("a = pow(x, -1)", roundingTolerance), 1);
+    EXPECT_EQ(ExpectSameResults("a = pow(x, 1)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = pow(x, 0)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = x; a ^= 2", roundingTolerance), 1);
+
+    // Other exponents and bases which would be evaluated twice are kept.
+    EXPECT_EQ(ExpectSameResults("a = pow(x, 2.5) + pow(x, y)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = pow(x + y, 3) + pow(x + 1, 0)"), 0);
+    EXPECT_EQ(ExpectSameResults("megabuf(0) = x; megabuf(0) ^= 2; a = megabuf(0)"), 0);
+}
+
+TEST_F(SimplificationTest, DivisionByConstant)
+{
+    EXPECT_EQ(ExpectSameResults("a = x / 4 + y / -0.5"), 2);
+    EXPECT_EQ(ExpectSameResults("a = x; a /= 8"), 1);
+    EXPECT_EQ(ExpectSameResults("a = x / 3 + y / 0.7", roundingTolerance), 2);
+    EXPECT_EQ(ExpectSameResults("a = x / 1"), 2);
+
+    // Divisors hitting the zero check are kept.
+    EXPECT_EQ(ExpectSameResults("a = x / 0 + y / 1e-320 + x / y"), 0);
+}
+
+TEST_F(SimplificationTest, Identities)
+{
+    EXPECT_EQ(ExpectSameResults("a = x * 1 + 1 * y"), 2);
+    EXPECT_EQ(ExpectSameResults("a = sin(x + 0) + cos(0 + y) + (x - 0)"), 3);
+    EXPECT_EQ(ExpectSameResults("a = -(-x)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = x * -1 + -1 * y + (0 - x)"), 3);
+
+    // Variables must not be read later than the value they replace.
+    EXPECT_EQ(ExpectSameResults("a = (x * 1) + (x = 5)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = (x + 0) * 2 + sin(y)"), 1);
+    EXPECT_EQ(ExpectSameResults("a = if(y > 0, x * 1, 2)"), 0);
+}
+
+TEST_F(SimplificationTest, SignAndRoots)
+{
+    EXPECT_EQ(ExpectSameResults("a = abs(-x) + sqr(abs(y)) + sqrt(-x) + abs(abs(y))"), 4);
+    EXPECT_EQ(ExpectSameResults("a = abs(sqr(x)) + sqrt(abs(x * y))"), 2);
+    EXPECT_EQ(ExpectSameResults("a = sqr(sqrt(x))", roundingTolerance), 1);
+    EXPECT_EQ(ExpectSameResults("a = sqrt(x) * sqrt(x)", roundingTolerance), 1);
+
+    // invsqrt() is an approximation, which no rule rewrites into or out of.
+    EXPECT_EQ(ExpectSameResults("a = 1 / sqrt(abs(x) + 1) + 1 / invsqrt(x + 2)"), 0);
+}
+
+TEST_F(SimplificationTest, Disabled)
+{
+    projectm_eval_context_set_simplification(m_optimized.context, 0);
+
+    EXPECT_EQ(ExpectSameResults("a = pow(x, 2) + x / 4 + x * 1"), 0);
+}
+
+TEST_F(SimplificationTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code, roundingTolerance);
+    }
+}
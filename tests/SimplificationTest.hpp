@@ -0,0 +1,27 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests the algebraic simplification rules.
+ * Each program is also compiled in a second context without the simplification, and the results of both are compared
+ * for a range of input values.
+ */
+class SimplificationTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+
+    void SetIterationInputs(int iteration) override;
+
+    /**
+     * @brief Compiles the code in both contexts and compares the results for different x and y.
+     * @param code The code to check.
+     * @param relativeTolerance The allowed difference relative to the larger value. 0 requires identical values.
+     * @return The number of rewrites applied in the simplifying context.
+     */
+    int ExpectSameResults(const std::string& code, double relativeTolerance = 0.0);
+};
@@ -0,0 +1,215 @@
+#include "TranspilerTest.hpp"
+
+#include "TranspilerControlFlow.h"
+#include "TranspilerNoVariables.h"
+#include "TranspilerPerPixel.h"
+#include "TranspilerReferences.h"
+
+#include <fstream>
+#include <sstream>
+
+void TranspilerTest::SetUp()
+{
+    for (auto* executionContext : {&m_tree, &m_native})
+    {
+        executionContext->globalMemory = projectm_eval_memory_buffer_create();
+        executionContext->context = projectm_eval_context_create(executionContext->globalMemory,
+                                                                 &executionContext->globalRegisters);
+    }
+}
+
+void TranspilerTest::TearDown()
+{
+    for (auto* executionContext : {&m_tree, &m_native})
+    {
+        projectm_eval_context_destroy(executionContext->context);
+        projectm_eval_memory_buffer_destroy(executionContext->globalMemory);
+    }
+}
+
+void TranspilerTest::ExpectSameResults(const projectm_eval_native_program& program, const std::string& fileName,
+                                       int iterations)
+{
+    SCOPED_TRACE(fileName);
+
+    std::ifstream file(std::string(PROJECTM_TEST_DATA_DIR) + "/" + fileName);
+    ASSERT_TRUE(file.good());
+    std::stringstream code;
+    code << file.rdbuf();
+
+    auto treeCode = projectm_eval_code_compile(m_tree.context, code.str().c_str());
+    auto nativeCode = projectm_eval_code_create_native(m_native.context, &program);
+    ASSERT_NE(treeCode, nullptr);
+    ASSERT_NE(nativeCode, nullptr);
+
+    ASSERT_EQ(projectm_eval_code_set_engine(treeCode, PROJECTM_EVAL_ENGINE_TREE), 1);
+    ASSERT_EQ(projectm_eval_code_get_engine(nativeCode), PROJECTM_EVAL_ENGINE_NATIVE);
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        auto treeResult = projectm_eval_code_execute(treeCode);
+        auto nativeResult = projectm_eval_code_execute(nativeCode);
+        EXPECT_DOUBLE_EQ(nativeResult, treeResult) << "Iteration " << iteration;
+
+        for (int index = 0; index < program.variable_count; index++)
+        {
+            const char* name = program.variable_names[index];
+            EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_native.context, name),
+                             *projectm_eval_context_register_variable(m_tree.context, name))
+                << "Variable " << name << ", iteration " << iteration;
+        }
+
+        for (int reg = 0; reg < 100; reg++)
+        {
+            EXPECT_DOUBLE_EQ(m_native.globalRegisters[reg], m_tree.globalRegisters[reg]) << "Register " << reg;
+        }
+    }
+
+    // Compare memory contents via a separate program, executed by the tree interpreter in both contexts.
+    auto treeMemoryCode = projectm_eval_code_compile(m_tree.context, "megabuf(i) + 1000 * gmegabuf(i)");
+    auto nativeMemoryCode = projectm_eval_code_compile(m_native.context, "megabuf(i) + 1000 * gmegabuf(i)");
+    auto* treeIndex = projectm_eval_context_register_variable(m_tree.context, "i");
+    auto* nativeIndex = projectm_eval_context_register_variable(m_native.context, "i");
+
+    for (int index = 0; index < 1100; index++)
+    {
+        *treeIndex = index;
+        *nativeIndex = index;
+        EXPECT_DOUBLE_EQ(projectm_eval_code_execute(nativeMemoryCode), projectm_eval_code_execute(treeMemoryCode))
+            << "Memory index " << index;
+    }
+
+    projectm_eval_code_destroy(treeMemoryCode);
+    projectm_eval_code_destroy(nativeMemoryCode);
+    projectm_eval_code_destroy(treeCode);
+    projectm_eval_code_destroy(nativeCode);
+}
+
+TEST_F(TranspilerTest, PerPixel)
+{
+    for (auto* executionContext : {&m_tree, &m_native})
+    {
+        *projectm_eval_context_register_variable(executionContext->context, "x") = 0.3;
+        *projectm_eval_context_register_variable(executionContext->context, "y") = 0.7;
+        *projectm_eval_context_register_variable(executionContext->context, "rad") = 0.4;
+        *projectm_eval_context_register_variable(executionContext->context, "ang") = 1.2;
+        *projectm_eval_context_register_variable(executionContext->context, "time") = 10.5;
+        *projectm_eval_context_register_variable(executionContext->context, "treb") = 1.3;
+    }
+
+    ExpectSameResults(TranspilerPerPixel, "TranspilerPerPixel.eel");
+}
+
+TEST_F(TranspilerTest, ControlFlow)
+{
+    ExpectSameResults(TranspilerControlFlow, "TranspilerControlFlow.eel");
+}
+
+TEST_F(TranspilerTest, ReferenceArguments)
+{
+    // exec3() and while() store values in variables and memory returned by a previous argument or iteration.
+    ExpectSameResults(TranspilerReferences, "TranspilerReferences.eel");
+}
+
+TEST_F(TranspilerTest, NoVariables)
+{
+    // Only memory is used, so the generated program has no variable name table.
+    EXPECT_EQ(TranspilerNoVariables.variable_count, 0);
+    EXPECT_EQ(TranspilerNoVariables.variable_names, nullptr);
+
+    ExpectSameResults(TranspilerNoVariables, "TranspilerNoVariables.eel");
+}
+
+TEST_F(TranspilerTest, SharesContextVariables)
+{
+    auto nativeCode = projectm_eval_code_create_native(m_native.context, &TranspilerPerPixel);
+    ASSERT_NE(nativeCode, nullptr);
+
+    auto* zoom = projectm_eval_context_register_variable(m_native.context, "zoom");
+    auto* time = projectm_eval_context_register_variable(m_native.context, "time");
+    *zoom = 1.0;
+    *time = 0.0;
+
+    projectm_eval_code_execute(nativeCode);
+    EXPECT_DOUBLE_EQ(*zoom, 1.0);
+
+    // The tree interpreter sees the changes made by the precompiled program and vice versa.
+    auto treeCode = projectm_eval_code_compile(m_native.context, "zoom * 2");
+    ASSERT_NE(treeCode, nullptr);
+    EXPECT_DOUBLE_EQ(projectm_eval_code_execute(treeCode), 2.0);
+
+    // Precompiled programs can't be translated for other engines.
+    EXPECT_EQ(projectm_eval_code_set_engine(nativeCode, PROJECTM_EVAL_ENGINE_TREE), 0);
+    EXPECT_EQ(projectm_eval_code_set_engine(nativeCode, PROJECTM_EVAL_ENGINE_NATIVE), 1);
+    EXPECT_EQ(projectm_eval_code_set_engine(treeCode, PROJECTM_EVAL_ENGINE_NATIVE), 0);
+
+    projectm_eval_code_destroy(treeCode);
+    projectm_eval_code_destroy(nativeCode);
+}
+
+TEST_F(TranspilerTest, BatchExecution)
+{
+    std::ifstream file(std::string(PROJECTM_TEST_DATA_DIR) + "/TranspilerPerPixel.eel");
+    ASSERT_TRUE(file.good());
+    std::stringstream code;
+    code << file.rdbuf();
+
+    auto treeCode = projectm_eval_code_compile(m_tree.context, code.str().c_str());
+    auto nativeCode = projectm_eval_code_create_native(m_native.context, &TranspilerPerPixel);
+    ASSERT_NE(treeCode, nullptr);
+    ASSERT_NE(nativeCode, nullptr);
+
+    // Precompiled programs always compute in the precision they were compiled with.
+    EXPECT_EQ(projectm_eval_code_set_batch_precision(nativeCode, PROJECTM_EVAL_PRECISION_FLOAT), 0);
+    EXPECT_EQ(projectm_eval_code_set_batch_precision(nativeCode, PROJECTM_EVAL_PRECISION_DEFAULT), 1);
+
+    // Precompiled programs are executed once per lane, which must match the batch code of the compiled program.
+    constexpr int laneCount = 20;
+    PRJM_EVAL_F treeValues[3][laneCount];
+    PRJM_EVAL_F nativeValues[3][laneCount];
+    for (int lane = 0; lane < laneCount; lane++)
+    {
+        treeValues[0][lane] = nativeValues[0][lane] = lane / 32.0;
+        treeValues[1][lane] = nativeValues[1][lane] = lane * 0.05;
+        treeValues[2][lane] = nativeValues[2][lane] = 1.0 - lane * 0.01;
+    }
+
+    projectm_eval_lane_variable treeLaneVariables[3]{
+        {projectm_eval_context_register_variable(m_tree.context, "x"), treeValues[0]},
+        {projectm_eval_context_register_variable(m_tree.context, "rad"), treeValues[1]},
+        {projectm_eval_context_register_variable(m_tree.context, "zoom"), treeValues[2]}};
+    projectm_eval_lane_variable nativeLaneVariables[3]{
+        {projectm_eval_context_register_variable(m_native.context, "x"), nativeValues[0]},
+        {projectm_eval_context_register_variable(m_native.context, "rad"), nativeValues[1]},
+        {projectm_eval_context_register_variable(m_native.context, "zoom"), nativeValues[2]}};
+
+    PRJM_EVAL_F treeResults[laneCount];
+    PRJM_EVAL_F nativeResults[laneCount];
+    projectm_eval_code_execute_batch(treeCode, treeLaneVariables, 3, laneCount, treeResults);
+    projectm_eval_code_execute_batch(nativeCode, nativeLaneVariables, 3, laneCount, nativeResults);
+
+    for (int lane = 0; lane < laneCount; lane++)
+    {
+        EXPECT_DOUBLE_EQ(nativeResults[lane], treeResults[lane]) << "Lane " << lane;
+        EXPECT_DOUBLE_EQ(nativeValues[2][lane], treeValues[2][lane]) << "Lane " << lane;
+    }
+
+    // Variables without lane values start each lane with the same value and keep the value of the last lane.
+    for (const char* name : {"rot", "dx", "warp"})
+    {
+        EXPECT_DOUBLE_EQ(*projectm_eval_context_register_variable(m_native.context, name),
+                         *projectm_eval_context_register_variable(m_tree.context, name))
+            << "Variable " << name;
+    }
+
+    projectm_eval_code_destroy(treeCode);
+    projectm_eval_code_destroy(nativeCode);
+}
+
+TEST_F(TranspilerTest, FloatSizeMismatch)
+{
+    projectm_eval_native_program program = TranspilerPerPixel;
+    program.float_size = PRJM_F_SIZE == 4 ? 8 : 4;
+
+    EXPECT_EQ(projectm_eval_code_create_native(m_native.context, &program), nullptr);
+}
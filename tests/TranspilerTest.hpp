@@ -0,0 +1,40 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <projectm-eval/api/projectm-eval.h>
+
+#include <string>
+
+/**
+ * @brief Compares programs precompiled by projectm-eval-transpile with the same code run by the tree interpreter.
+ * The tested programs are translated at build time from the files in the test data directory.
+ */
+class TranspilerTest : public testing::Test
+{
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /**
+     * @brief Executes the precompiled program and the code from the data file in separate contexts and compares
+     *        result, variables and memory.
+     * @param program The precompiled program.
+     * @param fileName The file in the test data directory the program was generated from.
+     * @param iterations Number of consecutive executions.
+     */
+    void ExpectSameResults(const projectm_eval_native_program& program, const std::string& fileName,
+                           int iterations = 3);
+
+    struct ExecutionContext
+    {
+        struct projectm_eval_context* context{};
+        projectm_eval_mem_buffer globalMemory{};
+        PRJM_EVAL_F globalRegisters[100]{};
+    };
+
+    ExecutionContext m_tree; //!< Context used to execute the tree.
+    ExecutionContext m_native; //!< Context used to execute the precompiled program.
+};
@@ -162,15 +162,11 @@ TEST_F(TreeFunctions, ExecuteList)
     setNode2->args[0] = varNode2;
     setNode2->args[1] = constNode2;
 
-    auto* listItem = new prjm_eval_exptreenode_list_item_t{};
-    listItem->expr = setNode1;
-    listItem->next = new prjm_eval_exptreenode_list_item_t{};
-    listItem->next->expr = setNode2;
-
     // Executor
-    auto* listNode = CreateEmptyNode(1);
+    auto* listNode = CreateEmptyNode(2);
     listNode->func = prjm_eval_func_execute_list;
-    listNode->list = listItem;
+    listNode->args[0] = setNode1;
+    listNode->args[1] = setNode2;
 
     m_treeNodes.push_back(listNode);
 
@@ -2295,3 +2291,226 @@ TEST_F(TreeFunctions, InverseSquareRootFunction)
     invsqrtNode->func(invsqrtNode, &valuePointer);
     EXPECT_PRJM_F_EQ(*valuePointer, -INFINITY) << "invsqrt(-1.0)";
 }
+
+TEST_F(TreeFunctions, SpecializedBinaryFunction)
+{
+    // Expression: "x + 2"
+    prjm_eval_variable_def_t* var1;
+    auto* varNode1 = CreateVariableNode("x", 5., &var1);
+    auto* constNode = CreateConstantNode(2.0);
+
+    auto* addNode = CreateEmptyNode(2);
+    addNode->func = prjm_eval_func_add;
+    addNode->args[0] = varNode1;
+    addNode->args[1] = constNode;
+
+    m_treeNodes.push_back(addNode);
+
+    prjm_eval_exptreenode_specialize(addNode);
+
+    EXPECT_EQ(addNode->func, prjm_eval_func_add_var_const);
+    EXPECT_EQ(prjm_eval_generic_function(addNode->func), prjm_eval_func_add);
+
+    PRJM_EVAL_F value{};
+    PRJM_EVAL_F* valuePointer = &value;
+    addNode->func(addNode, &valuePointer);
+    EXPECT_PRJM_F_EQ(*valuePointer, 7.0) << "5 + 2";
+
+    var1->value = -3.0;
+    addNode->func(addNode, &valuePointer);
+    EXPECT_PRJM_F_EQ(*valuePointer, -1.0) << "-3 + 2";
+}
+
+TEST_F(TreeFunctions, SpecializedAssignmentFunction)
+{
+    // Expression: "x += (x = 5)"
+    prjm_eval_variable_def_t* var1;
+    auto* varNode1 = CreateVariableNode("x", 1., &var1);
+    auto* varNode2 = CreateEmptyNode(0);
+    varNode2->func = prjm_eval_func_var;
+    varNode2->var = &var1->value;
+    auto* constNode = CreateConstantNode(5.0);
+
+    auto* setNode = CreateEmptyNode(2);
+    setNode->func = prjm_eval_func_set;
+    setNode->args[0] = varNode2;
+    setNode->args[1] = constNode;
+
+    auto* addopNode = CreateEmptyNode(2);
+    addopNode->func = prjm_eval_func_add_op;
+    addopNode->args[0] = varNode1;
+    addopNode->args[1] = setNode;
+
+    m_treeNodes.push_back(addopNode);
+
+    prjm_eval_exptreenode_specialize(addopNode);
+
+    EXPECT_EQ(addopNode->func, prjm_eval_func_add_op_var_expr);
+    EXPECT_EQ(setNode->func, prjm_eval_func_set_var_const);
+
+    PRJM_EVAL_F value{};
+    PRJM_EVAL_F* valuePointer = &value;
+    addopNode->func(addopNode, &valuePointer);
+
+    // The target must be read after the assigned value was evaluated.
+    EXPECT_PRJM_F_EQ(*valuePointer, 10.0);
+    EXPECT_PRJM_F_EQ(var1->value, 10.0);
+    EXPECT_EQ(valuePointer, &var1->value);
+}
+
+TEST_F(TreeFunctions, ValueFunctionDoesNotWriteTree)
+{
+    // Test expression: "loop(42, x += 1)" with x starting at 0.
+    prjm_eval_variable_def_t* varX;
+    auto* varNodeX = CreateVariableNode("x", 0.f, &varX);
+    auto* constNode1 = CreateConstantNode(1.0f);
+    auto* constNode42 = CreateConstantNode(42.0f);
+
+    auto* incrementNode1 = CreateEmptyNode(2);
+    incrementNode1->func = prjm_eval_func_add_op;
+    incrementNode1->args[0] = varNodeX;
+    incrementNode1->args[1] = constNode1;
+
+    auto* loopNode = CreateEmptyNode(2);
+    loopNode->func = prjm_eval_func_execute_loop;
+    loopNode->args[0] = constNode42;
+    loopNode->args[1] = incrementNode1;
+    loopNode->value = 123.0f;
+
+    m_treeNodes.push_back(loopNode);
+
+    prjm_eval_exptreenode_specialize(loopNode);
+    prjm_eval_exptreenode_assign_value_functions(loopNode);
+
+    EXPECT_NE(loopNode->value_func, prjm_eval_value_via_ref);
+    EXPECT_EQ(incrementNode1->value_func, prjm_eval_value_function(prjm_eval_func_add_op_var_const));
+
+    EXPECT_PRJM_F_EQ(loopNode->value_func(loopNode), 42.);
+    EXPECT_PRJM_F_EQ(varX->value, 42.);
+
+    // The temporary value of the loop node must not be used.
+    EXPECT_PRJM_F_EQ(loopNode->value, 123.);
+}
+
+TEST_F(TreeFunctions, ValueFunctionWithLateRead)
+{
+    // Expression: "x + (x = 5)"
+    prjm_eval_variable_def_t* var1;
+    auto* varNode1 = CreateVariableNode("x", 1., &var1);
+    auto* varNode2 = CreateEmptyNode(0);
+    varNode2->func = prjm_eval_func_var;
+    varNode2->var = &var1->value;
+    auto* constNode = CreateConstantNode(5.0);
+
+    auto* setNode = CreateEmptyNode(2);
+    setNode->func = prjm_eval_func_set;
+    setNode->args[0] = varNode2;
+    setNode->args[1] = constNode;
+
+    auto* addNode = CreateEmptyNode(2);
+    addNode->func = prjm_eval_func_add;
+    addNode->args[0] = varNode1;
+    addNode->args[1] = setNode;
+
+    m_treeNodes.push_back(addNode);
+
+    prjm_eval_exptreenode_assign_value_functions(addNode);
+
+    // The first argument is dereferenced after the assignment, which only the reference-returning function does.
+    EXPECT_EQ(addNode->value_func, prjm_eval_value_via_ref);
+    EXPECT_EQ(setNode->value_func, prjm_eval_value_function(prjm_eval_func_set));
+
+    EXPECT_PRJM_F_EQ(addNode->value_func(addNode), 10.0);
+    EXPECT_PRJM_F_EQ(var1->value, 5.0);
+}
+
+TEST_F(TreeFunctions, ValueFunctionWithIndirectStore)
+{
+    // Expression: "exec3(x, -1, 3)"
+    prjm_eval_variable_def_t* var1;
+    auto* varNode = CreateVariableNode("x", 1., &var1);
+
+    auto* execNode = CreateEmptyNode(3);
+    execNode->func = prjm_eval_func_exec3;
+    execNode->args[0] = varNode;
+    execNode->args[1] = CreateConstantNode(-1.0);
+    execNode->args[2] = CreateConstantNode(3.0);
+
+    m_treeNodes.push_back(execNode);
+
+    prjm_eval_exptreenode_assign_value_functions(execNode);
+
+    // The second argument is written into the variable returned by the first one.
+    EXPECT_TRUE(prjm_eval_exptreenode_stores_through_reference(execNode));
+    EXPECT_EQ(execNode->value_func, prjm_eval_value_via_ref);
+
+    EXPECT_PRJM_F_EQ(execNode->value_func(execNode), 3.0);
+    EXPECT_PRJM_F_EQ(var1->value, -1.0);
+
+    // A plain value as first argument only receives the second one.
+    execNode->args[0] = CreateConstantNode(2.0);
+    m_treeNodes.push_back(varNode);
+
+    prjm_eval_exptreenode_assign_value_functions(execNode);
+
+    EXPECT_FALSE(prjm_eval_exptreenode_stores_through_reference(execNode));
+    EXPECT_EQ(execNode->value_func, prjm_eval_value_function(prjm_eval_func_exec3));
+}
+
+TEST_F(TreeFunctions, PackedTree)
+{
+    // Expression list ("x = y * 2; x + y")
+    prjm_eval_variable_def_t* varX;
+    prjm_eval_variable_def_t* varY;
+    auto* varNodeX1 = CreateVariableNode("x", 0., &varX);
+    auto* varNodeY1 = CreateVariableNode("y", 3., &varY);
+
+    auto* mulNode = CreateEmptyNode(2);
+    mulNode->func = prjm_eval_func_mul;
+    mulNode->args[0] = varNodeY1;
+    mulNode->args[1] = CreateConstantNode(2.0);
+
+    auto* setNode = CreateEmptyNode(2);
+    setNode->func = prjm_eval_func_set;
+    setNode->args[0] = varNodeX1;
+    setNode->args[1] = mulNode;
+
+    auto* addNode = CreateEmptyNode(2);
+    addNode->func = prjm_eval_func_add;
+    addNode->args[0] = CreateEmptyNode(0);
+    addNode->args[0]->func = prjm_eval_func_var;
+    addNode->args[0]->var = &varX->value;
+    addNode->args[1] = CreateEmptyNode(0);
+    addNode->args[1]->func = prjm_eval_func_var;
+    addNode->args[1]->var = &varY->value;
+
+    auto* listNode = CreateEmptyNode(2);
+    listNode->func = prjm_eval_func_execute_list;
+    listNode->args[0] = setNode;
+    listNode->args[1] = addNode;
+
+    // The original tree is freed by the pack function.
+    auto* packedNode = prjm_eval_exptreenode_pack(listNode);
+    ASSERT_NE(packedNode, nullptr);
+
+    // Nodes and argument arrays are placed in evaluation order.
+    auto* blockStart = reinterpret_cast<char*>(packedNode);
+    auto* packedSet = packedNode->args[0];
+    auto* packedMul = packedSet->args[1];
+    auto* packedAdd = packedNode->args[1];
+    EXPECT_EQ(reinterpret_cast<char*>(packedNode->args), blockStart + sizeof(prjm_eval_exptreenode_t));
+    EXPECT_EQ(reinterpret_cast<char*>(packedSet), reinterpret_cast<char*>(packedNode->args + 3));
+    EXPECT_LT(packedSet, packedMul);
+    EXPECT_LT(packedMul, packedAdd);
+    EXPECT_EQ(packedMul->func, prjm_eval_func_mul);
+    EXPECT_EQ(packedAdd->args[0]->var, &varX->value);
+
+    PRJM_EVAL_F value{};
+    PRJM_EVAL_F* valuePointer = &value;
+    packedNode->func(packedNode, &valuePointer);
+
+    EXPECT_PRJM_F_EQ(*valuePointer, 9.0);
+    EXPECT_PRJM_F_EQ(varX->value, 6.0);
+
+    free(packedNode);
+}
@@ -0,0 +1,79 @@
+#include "ValueRangeTest.hpp"
+
+extern "C" {
+#include <projectm-eval/CompilerTypes.h>
+}
+
+void ValueRangeTest::SetUp()
+{
+    DifferentialTest::SetUp();
+
+    m_reference.context->specialize_value_ranges = false;
+    m_inputs.emplace_back("z", 0);
+    m_variableNames.emplace_back("z");
+}
+
+int ValueRangeTest::CountOptimizations(struct projectm_eval_code* code)
+{
+    return reinterpret_cast<prjm_eval_program_t*>(code)->specialized_operation_count;
+}
+
+TEST_F(ValueRangeTest, NonzeroDivisors)
+{
+    EXPECT_EQ(ExpectSameResults("a = x / 2"), 1);
+    EXPECT_EQ(ExpectSameResults("a = x / (abs(y) + 1) + x / (sqr(y) + 0.5) + x / (cos(y) - 2)"), 3);
+    EXPECT_EQ(ExpectSameResults("b = 4; a = x / b; b /= 2"), 2);
+    EXPECT_EQ(ExpectSameResults("a = x; a /= 4; c = 2; c /= -x"), 1);
+
+    // Values which may be zero or close to zero keep the check.
+    EXPECT_EQ(ExpectSameResults("a = x / y + x / z + x / sin(y) + x / exp(y)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = x / 1e-20 + x / (abs(y) + 1e-9)"), 0);
+}
+
+TEST_F(ValueRangeTest, Conditions)
+{
+    EXPECT_EQ(ExpectSameResults("a = if(y != 0, x / y, 0) + if(z == 0, 0, x / z) + if(!(y == 0), x / y, 1)"), 3);
+    EXPECT_EQ(ExpectSameResults("a = if(y < -1, x / y, 1) + if(0.5 < x, 1 / x, 2) + if(y > 0, x / y, 3)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = if(x >= 0.5 && y <= -1, x / y + y / x, 0) + if(x < 0.5 || y > -1, 0, 1 / x)"), 3);
+    EXPECT_EQ(ExpectSameResults("a = (y < -1) && (b = x / y); c = (z == 0) || (b = x / z)"), 2);
+
+    // Refinements end with the branch, and assignments in the branch replace them.
+    EXPECT_EQ(ExpectSameResults("if(y != 0, a = 1, a = 2); b = x / y"), 0);
+    EXPECT_EQ(ExpectSameResults("a = if(y != 0, (y = z; x / y), 0)"), 0);
+    EXPECT_EQ(ExpectSameResults("a = if(y != 0, x / y + x / (y = z), 0)"), 1);
+
+    // The comparison may read an older value than the one assigned later in the same condition.
+    EXPECT_EQ(ExpectSameResults("b = 1.49; a = if(b > 1 && exec2(b = 0, 1), 1 / b, 5)"), 0);
+    EXPECT_EQ(ExpectSameResults("b = 1.49; c = b > 1 && exec2(b = 0, 1) && (a = x / b)"), 0);
+    EXPECT_EQ(ExpectSameResults("b = 1.49; a = if(!(b <= 1 || exec2(b = 0, 0)), x / b, 5)"), 0);
+    EXPECT_EQ(ExpectSameResults("b = 1.49; a = if(b > 1 && exec2(c = 0, 1), x / b, 5)"), 1);
+}
+
+TEST_F(ValueRangeTest, Loops)
+{
+    // Variables assigned in the loop are unknown in the body, unless the loop is unrolled.
+    EXPECT_EQ(ExpectSameResults("b = 1; loop(y + 5, a = x / b; b = b - 1)"), 0);
+    EXPECT_EQ(ExpectSameResults("b = 1; loop(3, a = x / b; b = b - 1)"), 2);
+    EXPECT_EQ(ExpectSameResults("b = 1; c = 3; while(a += x / b; b -= 0.5; c -= 1; c > 0)"), 0);
+    EXPECT_EQ(ExpectSameResults("b = 2; loop(y + 5, a += x / b; c -= 1)"), 1);
+
+    EXPECT_EQ(ExpectSameResults("b = 2; loop(y + 5, b -= 1); a = x / b"), 0);
+}
+
+TEST_F(ValueRangeTest, IntegersAndBooleans)
+{
+    EXPECT_EQ(ExpectSameResults("a = floor(floor(x) + 1) + ceil(floor(y) * 2) + floor(x % 3) + ceil(sign(y))"), 4);
+    EXPECT_EQ(ExpectSameResults("a = floor(b = floor(y)); c = ceil(b - 1)"), 2);
+    EXPECT_EQ(ExpectSameResults("a = floor(x) + ceil(y * 2) + floor(x * 0.5)"), 0);
+
+    EXPECT_EQ(ExpectSameResults("a = band(x > 0, y < 0) + bor(x < 0, !y) + band(1, z == 0)"), 3);
+    EXPECT_EQ(ExpectSameResults("a = band(x > 0, y) + bor(x, y > 0) + band(2, x < 1)"), 0);
+}
+
+TEST_F(ValueRangeTest, EdgeCases)
+{
+    for (const auto& code : EdgeCasePrograms())
+    {
+        ExpectSameResults(code);
+    }
+}
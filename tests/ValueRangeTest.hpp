@@ -0,0 +1,16 @@
+#pragma once
+
+#include "DifferentialTest.hpp"
+
+/**
+ * @brief Tests which operations are specialized for the inferred ranges of their arguments.
+ * Each program is also compiled in a second context without the optimization, and both results are compared.
+ */
+class ValueRangeTest : public DifferentialTest
+{
+protected:
+
+    void SetUp() override;
+
+    int CountOptimizations(struct projectm_eval_code* code) override;
+};
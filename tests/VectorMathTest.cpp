@@ -0,0 +1,241 @@
+#include "VectorMathTest.hpp"
+
+extern "C"
+{
+#include <projectm-eval/IntrinsicMath.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+int64_t VectorMathTest::UlpDistance(PRJM_EVAL_F value, PRJM_EVAL_F expected)
+{
+    if (value == expected || (std::isnan(value) && std::isnan(expected)))
+    {
+        return 0;
+    }
+    if (std::isnan(value) || std::isnan(expected))
+    {
+        return std::numeric_limits<int64_t>::max();
+    }
+
+    // Values with different signs are never close enough.
+    if (std::signbit(value) != std::signbit(expected))
+    {
+        return std::numeric_limits<int64_t>::max();
+    }
+
+#if PRJM_F_SIZE == 4
+    int32_t valueBits;
+    int32_t expectedBits;
+#else
+    int64_t valueBits;
+    int64_t expectedBits;
+#endif
+    std::memcpy(&valueBits, &value, sizeof(valueBits));
+    std::memcpy(&expectedBits, &expected, sizeof(expectedBits));
+
+    return std::abs(static_cast<int64_t>(valueBits) - static_cast<int64_t>(expectedBits));
+}
+
+std::vector<PRJM_EVAL_F> VectorMathTest::RandomValues(double min, double max, int count)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> distribution(min, max);
+
+    std::vector<PRJM_EVAL_F> values;
+    for (int index = 0; index < count; index++)
+    {
+        values.push_back(static_cast<PRJM_EVAL_F>(distribution(generator)));
+    }
+
+    return values;
+}
+
+std::vector<PRJM_EVAL_F> VectorMathTest::SpecialValues()
+{
+    const auto infinity = std::numeric_limits<PRJM_EVAL_F>::infinity();
+    const auto denormal = std::numeric_limits<PRJM_EVAL_F>::denorm_min();
+
+    return {0.0, -0.0, 1.0, -1.0, 0.5, -2.0, 3.0, 1e-320, denormal, -denormal, infinity, -infinity,
+            std::numeric_limits<PRJM_EVAL_F>::quiet_NaN(), std::numeric_limits<PRJM_EVAL_F>::max(),
+            std::numeric_limits<PRJM_EVAL_F>::lowest(), std::numeric_limits<PRJM_EVAL_F>::min(), 1e7, -1e7,
+            710.0, -710.0, 700.0, -700.0, 1e-300};
+}
+
+void VectorMathTest::ExpectWithinUlp(UnaryKernel kernel, const std::function<PRJM_EVAL_F(PRJM_EVAL_F)>& scalar,
+                                     const std::vector<PRJM_EVAL_F>& arguments, int64_t maxUlp)
+{
+#if PRJM_F_SIZE == 4
+    maxUlp = 1;
+#endif
+
+    std::vector<PRJM_EVAL_F> results(arguments.size());
+    kernel(results.data(), arguments.data(), static_cast<int>(arguments.size()));
+
+    for (size_t index = 0; index < arguments.size(); index++)
+    {
+        PRJM_EVAL_F expected = scalar(arguments[index]);
+        EXPECT_LE(UlpDistance(results[index], expected), maxUlp)
+            << "Argument " << arguments[index] << ": " << results[index] << " instead of " << expected;
+    }
+
+    // The kernels must also work in place.
+    std::vector<PRJM_EVAL_F> inPlace = arguments;
+    kernel(inPlace.data(), inPlace.data(), static_cast<int>(inPlace.size()));
+    for (size_t index = 0; index < arguments.size(); index++)
+    {
+        EXPECT_EQ(UlpDistance(inPlace[index], results[index]), 0) << "Argument " << arguments[index];
+    }
+}
+
+void VectorMathTest::ExpectWithinUlp(BinaryKernel kernel,
+                                     const std::function<PRJM_EVAL_F(PRJM_EVAL_F, PRJM_EVAL_F)>& scalar,
+                                     const std::vector<PRJM_EVAL_F>& arguments1,
+                                     const std::vector<PRJM_EVAL_F>& arguments2,
+                                     const std::function<int64_t(PRJM_EVAL_F, PRJM_EVAL_F)>& maxUlp)
+{
+    ASSERT_EQ(arguments1.size(), arguments2.size());
+
+    std::vector<PRJM_EVAL_F> results(arguments1.size());
+    kernel(results.data(), arguments1.data(), arguments2.data(), static_cast<int>(arguments1.size()));
+
+    for (size_t index = 0; index < arguments1.size(); index++)
+    {
+        PRJM_EVAL_F expected = scalar(arguments1[index], arguments2[index]);
+#if PRJM_F_SIZE == 4
+        int64_t allowedUlp = 1;
+#else
+        int64_t allowedUlp = maxUlp(arguments1[index], arguments2[index]);
+#endif
+        EXPECT_LE(UlpDistance(results[index], expected), allowedUlp)
+            << "Arguments " << arguments1[index] << ", " << arguments2[index] << ": " << results[index]
+            << " instead of " << expected;
+    }
+}
+
+TEST_F(VectorMathTest, Sin)
+{
+    auto sin = [](PRJM_EVAL_F value) -> PRJM_EVAL_F { return std::sin(value); };
+    ExpectWithinUlp(prjm_eval_vector_sin, sin, RandomValues(-10.0, 10.0), 1);
+    ExpectWithinUlp(prjm_eval_vector_sin, sin, RandomValues(-1e6, 1e6), 1);
+    ExpectWithinUlp(prjm_eval_vector_sin, sin, RandomValues(-1e-6, 1e-6), 1);
+    ExpectWithinUlp(prjm_eval_vector_sin, sin, SpecialValues(), 1);
+}
+
+TEST_F(VectorMathTest, Cos)
+{
+    auto cos = [](PRJM_EVAL_F value) -> PRJM_EVAL_F { return std::cos(value); };
+    ExpectWithinUlp(prjm_eval_vector_cos, cos, RandomValues(-10.0, 10.0), 1);
+    ExpectWithinUlp(prjm_eval_vector_cos, cos, RandomValues(-1e6, 1e6), 1);
+    ExpectWithinUlp(prjm_eval_vector_cos, cos, SpecialValues(), 1);
+}
+
+TEST_F(VectorMathTest, Exp)
+{
+    auto exp = [](PRJM_EVAL_F value) -> PRJM_EVAL_F { return std::exp(value); };
+    ExpectWithinUlp(prjm_eval_vector_exp, exp, RandomValues(-700.0, 700.0), 1);
+    ExpectWithinUlp(prjm_eval_vector_exp, exp, RandomValues(-1.0, 1.0), 1);
+    ExpectWithinUlp(prjm_eval_vector_exp, exp, SpecialValues(), 1);
+}
+
+TEST_F(VectorMathTest, Log)
+{
+    ExpectWithinUlp(prjm_eval_vector_log, prjm_eval_math_log, RandomValues(0.0, 2.0), 1);
+    ExpectWithinUlp(prjm_eval_vector_log, prjm_eval_math_log, RandomValues(0.999, 1.001), 1);
+    ExpectWithinUlp(prjm_eval_vector_log, prjm_eval_math_log, RandomValues(-1e300, 1e300), 1);
+    ExpectWithinUlp(prjm_eval_vector_log, prjm_eval_math_log, SpecialValues(), 1);
+}
+
+TEST_F(VectorMathTest, Sqrt)
+{
+    auto sqrt = [](PRJM_EVAL_F value) -> PRJM_EVAL_F { return std::sqrt(std::fabs(value)); };
+    ExpectWithinUlp(prjm_eval_vector_sqrt, sqrt, RandomValues(-1e6, 1e6), 0);
+    ExpectWithinUlp(prjm_eval_vector_sqrt, sqrt, SpecialValues(), 0);
+}
+
+TEST_F(VectorMathTest, InvSqrt)
+{
+    // The scalar version may be reordered by fast math optimizations, the kernel never is.
+    ExpectWithinUlp(prjm_eval_vector_invsqrt, prjm_eval_math_invsqrt, RandomValues(0.0, 100.0), 2);
+    ExpectWithinUlp(prjm_eval_vector_invsqrt, prjm_eval_math_invsqrt, SpecialValues(), 2);
+}
+
+TEST_F(VectorMathTest, Pow)
+{
+    // The error grows with t = exponent * log(base), as the kernel calculates exp(t).
+    auto maxUlp = [](PRJM_EVAL_F base, PRJM_EVAL_F exponent) -> int64_t {
+        double t = std::fabs(exponent * std::log(std::fabs(base)));
+        if (!std::isfinite(t) || t <= 16.0)
+        {
+            return 2;
+        }
+        return static_cast<int64_t>(std::min(t / 4.0, 1e18));
+    };
+
+    auto bases = RandomValues(0.0, 10.0);
+    auto exponents = RandomValues(-4.0, 4.0);
+    ExpectWithinUlp(prjm_eval_vector_pow, prjm_eval_math_pow, bases, exponents, maxUlp);
+
+    // Negative bases with integer and fractional exponents.
+    bases = RandomValues(-10.0, 10.0);
+    exponents = RandomValues(-20.0, 20.0);
+    for (size_t index = 0; index < exponents.size(); index += 2)
+    {
+        exponents[index] = std::floor(exponents[index]);
+    }
+    ExpectWithinUlp(prjm_eval_vector_pow, prjm_eval_math_pow, bases, exponents, maxUlp);
+
+    bases = RandomValues(0.0, 2.0);
+    exponents = RandomValues(-300.0, 300.0);
+    ExpectWithinUlp(prjm_eval_vector_pow, prjm_eval_math_pow, bases, exponents, maxUlp);
+
+    std::vector<PRJM_EVAL_F> specialBases;
+    std::vector<PRJM_EVAL_F> specialExponents;
+    for (auto base : SpecialValues())
+    {
+        for (auto exponent : SpecialValues())
+        {
+            specialBases.push_back(base);
+            specialExponents.push_back(exponent);
+        }
+    }
+    ExpectWithinUlp(prjm_eval_vector_pow, prjm_eval_math_pow, specialBases, specialExponents, maxUlp);
+}
+
+TEST_F(VectorMathTest, Atan2)
+{
+    auto atan2 = [](PRJM_EVAL_F y, PRJM_EVAL_F x) -> PRJM_EVAL_F { return std::atan2(y, x); };
+    auto maxUlp = [](PRJM_EVAL_F, PRJM_EVAL_F) -> int64_t { return 2; };
+
+    auto y = RandomValues(-10.0, 10.0);
+    auto x = RandomValues(-10.0, 10.0);
+    std::reverse(x.begin(), x.end());
+    ExpectWithinUlp(prjm_eval_vector_atan2, atan2, y, x, maxUlp);
+
+    std::vector<PRJM_EVAL_F> specialY;
+    std::vector<PRJM_EVAL_F> specialX;
+    for (auto yValue : SpecialValues())
+    {
+        for (auto xValue : SpecialValues())
+        {
+            specialY.push_back(yValue);
+            specialX.push_back(xValue);
+        }
+    }
+    ExpectWithinUlp(prjm_eval_vector_atan2, atan2, specialY, specialX, maxUlp);
+}
+
+TEST_F(VectorMathTest, PartialBlocks)
+{
+    // Array sizes which aren't a multiple of the kernels' block size.
+    for (int count : {1, 3, 63, 65, 130})
+    {
+        auto arguments = RandomValues(-5.0, 5.0, count);
+        ExpectWithinUlp(prjm_eval_vector_sin, [](PRJM_EVAL_F value) -> PRJM_EVAL_F { return std::sin(value); },
+                        arguments, 1);
+    }
+}
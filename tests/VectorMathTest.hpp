@@ -0,0 +1,53 @@
+#pragma once
+
+extern "C"
+{
+#include <projectm-eval/VectorMath.h>
+}
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Compares the array math kernels with the scalar implementations.
+ */
+class VectorMathTest : public testing::Test
+{
+protected:
+    using UnaryKernel = void (*)(PRJM_EVAL_F*, const PRJM_EVAL_F*, int);
+    using BinaryKernel = void (*)(PRJM_EVAL_F*, const PRJM_EVAL_F*, const PRJM_EVAL_F*, int);
+
+    /**
+     * @brief Returns the distance between two values in units in the last place. NaN equals NaN.
+     */
+    static int64_t UlpDistance(PRJM_EVAL_F value, PRJM_EVAL_F expected);
+
+    /**
+     * @brief Returns count pseudo-random values between min and max, always the same for each call.
+     */
+    static std::vector<PRJM_EVAL_F> RandomValues(double min, double max, int count = 10000);
+
+    /**
+     * @brief Special arguments like zeros, infinities, NaN and subnormal values.
+     */
+    static std::vector<PRJM_EVAL_F> SpecialValues();
+
+    /**
+     * @brief Checks that the kernel results are within the given error of the scalar function.
+     * With PRJM_F_SIZE 4, the results must be within 1 ulp of a float instead.
+     */
+    static void ExpectWithinUlp(UnaryKernel kernel, const std::function<PRJM_EVAL_F(PRJM_EVAL_F)>& scalar,
+                                const std::vector<PRJM_EVAL_F>& arguments, int64_t maxUlp);
+
+    /**
+     * @brief Checks that the kernel results are within the error returned by maxUlp for each argument pair.
+     */
+    static void ExpectWithinUlp(BinaryKernel kernel,
+                                const std::function<PRJM_EVAL_F(PRJM_EVAL_F, PRJM_EVAL_F)>& scalar,
+                                const std::vector<PRJM_EVAL_F>& arguments1,
+                                const std::vector<PRJM_EVAL_F>& arguments2,
+                                const std::function<int64_t(PRJM_EVAL_F, PRJM_EVAL_F)>& maxUlp);
+};
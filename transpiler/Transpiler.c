@@ -0,0 +1,986 @@
+#include "Transpiler.h"
+
+#include <projectm-eval/ExpressionTree.h>
+#include <projectm-eval/TreeFunctions.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A growing string buffer for the generated function body.
+ */
+typedef struct
+{
+    char* data; /*!< The zero-terminated string. */
+    size_t length; /*!< The string length, excluding the terminator. */
+    size_t capacity; /*!< The allocated size of data. */
+} transpiler_buffer_t;
+
+/**
+ * @brief The C expression holding the result of a node.
+ * Results are read through this expression only after the parent node evaluated all of its arguments, so variable
+ * and memory references are read late, exactly like the reference-returning tree functions do.
+ */
+typedef struct
+{
+    char expression[64]; /*!< A constant literal or an lvalue, e.g. "(*v0)", "(*p1)" or "t2". */
+    bool is_lvalue; /*!< False for constant literals, which need a temporary if used as a reference. */
+} transpiler_value_t;
+
+/**
+ * @brief The state of a single translation.
+ */
+typedef struct
+{
+    prjm_eval_compiler_context_t* cctx; /*!< The context the program was compiled in. */
+    transpiler_buffer_t code; /*!< The statements of the function body. */
+    int indent; /*!< The current statement indentation level. */
+    int value_count; /*!< Number of PRJM_EVAL_F temporaries "tN". */
+    int pointer_count; /*!< Number of PRJM_EVAL_F* temporaries "pN". */
+    int counter_count; /*!< Number of loop counters "cN". */
+    PRJM_EVAL_F** variables; /*!< The variable pointers used by the program, in order of first use. */
+    char** variable_names; /*!< The names of the used variables. */
+    int variable_count; /*!< Number of used variables. */
+    const char* error; /*!< The error message, if the translation failed. */
+} transpiler_t;
+
+static void append(transpiler_buffer_t* buffer, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if (buffer->length + length + 1 > buffer->capacity)
+    {
+        buffer->capacity = (buffer->length + length + 1) * 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, length + 1, format, args);
+    va_end(args);
+
+    buffer->length += length;
+}
+
+/**
+ * Appends an indented statement line to the function body.
+ */
+static void emit_line(transpiler_t* transpiler, const char* format, ...)
+{
+    char line[512];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    append(&transpiler->code, "%*s%s\n", (transpiler->indent + 1) * 4, "", line);
+}
+
+static void new_value(transpiler_t* transpiler, transpiler_value_t* result)
+{
+    snprintf(result->expression, sizeof(result->expression), "t%d", transpiler->value_count++);
+    result->is_lvalue = true;
+}
+
+static void new_pointer(transpiler_t* transpiler, char* name, size_t name_size)
+{
+    snprintf(name, name_size, "p%d", transpiler->pointer_count++);
+}
+
+static void dereference(const char* pointer, transpiler_value_t* result)
+{
+    snprintf(result->expression, sizeof(result->expression), "(*%s)", pointer);
+    result->is_lvalue = true;
+}
+
+/**
+ * Stores a constant in a temporary, so the value can be used as a reference.
+ */
+static void make_lvalue(transpiler_t* transpiler, transpiler_value_t* value)
+{
+    if (value->is_lvalue)
+    {
+        return;
+    }
+
+    transpiler_value_t temp;
+    new_value(transpiler, &temp);
+    emit_line(transpiler, "%s = %s;", temp.expression, value->expression);
+    *value = temp;
+}
+
+static void format_constant(PRJM_EVAL_F value, transpiler_value_t* result)
+{
+    result->is_lvalue = false;
+
+    if (isnan(value))
+    {
+        snprintf(result->expression, sizeof(result->expression), "NAN");
+        return;
+    }
+
+    if (isinf(value))
+    {
+        snprintf(result->expression, sizeof(result->expression), value > 0 ? "INFINITY" : "(-INFINITY)");
+        return;
+    }
+
+    char number[48];
+    snprintf(number, sizeof(number), "%.17g", (double) value);
+
+    /* Keep the literal a floating-point number. */
+    const char* suffix = strpbrk(number, ".e") ? "" : ".0";
+
+    snprintf(result->expression, sizeof(result->expression), value < 0 ? "(%s%s)" : "%s%s", number, suffix);
+}
+
+static int variable_index(transpiler_t* transpiler, PRJM_EVAL_F* variable)
+{
+    for (int index = 0; index < transpiler->variable_count; index++)
+    {
+        if (transpiler->variables[index] == variable)
+        {
+            return index;
+        }
+    }
+
+    char name[8] = { 0 };
+    const char* variable_name = NULL;
+
+    PRJM_EVAL_F (* global_variables)[100] = transpiler->cctx->global_variables;
+    if (global_variables && variable >= *global_variables && variable < *global_variables + 100)
+    {
+        snprintf(name, sizeof(name), "reg%02d", (int) (variable - *global_variables));
+        variable_name = name;
+    }
+
+    for (prjm_eval_variable_entry_t* entry = transpiler->cctx->variables.first;
+         entry && !variable_name; entry = entry->next)
+    {
+        if (&entry->variable->value == variable)
+        {
+            variable_name = entry->variable->name;
+        }
+    }
+
+    if (!variable_name)
+    {
+        return -1;
+    }
+
+    transpiler->variables = realloc(transpiler->variables, (transpiler->variable_count + 1) * sizeof(PRJM_EVAL_F*));
+    transpiler->variable_names = realloc(transpiler->variable_names,
+                                         (transpiler->variable_count + 1) * sizeof(char*));
+    transpiler->variables[transpiler->variable_count] = variable;
+    transpiler->variable_names[transpiler->variable_count] = strdup(variable_name);
+
+    return transpiler->variable_count++;
+}
+
+static const char* memory_buffer_name(transpiler_t* transpiler, projectm_eval_mem_buffer buffer)
+{
+    if (buffer == transpiler->cctx->memory)
+    {
+        return "memory";
+    }
+
+    if (buffer == transpiler->cctx->global_memory)
+    {
+        return "global_memory";
+    }
+
+    return NULL;
+}
+
+static bool emit_node(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result);
+
+static bool emit_into(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, const char* pointer);
+
+/**
+ * Emits the argument list in order. The last argument is the result, an empty list returns 0.
+ */
+static bool emit_sequence(transpiler_t* transpiler, prjm_eval_exptreenode_t** args, transpiler_value_t* result)
+{
+    format_constant(.0, result);
+
+    for (prjm_eval_exptreenode_t** arg = args; arg && *arg; arg++)
+    {
+        if (!emit_node(transpiler, *arg, result))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Emits a branch of a conditional, pointing the given pointer to its result.
+ */
+static bool emit_branch(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, const char* pointer)
+{
+    transpiler_value_t value;
+
+    transpiler->indent++;
+    if (!emit_node(transpiler, node, &value))
+    {
+        return false;
+    }
+    make_lvalue(transpiler, &value);
+    emit_line(transpiler, "%s = &%s;", pointer, value.expression);
+    transpiler->indent--;
+
+    return true;
+}
+
+static bool emit_if(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result)
+{
+    transpiler_value_t condition;
+    if (!emit_node(transpiler, node->args[0], &condition))
+    {
+        return false;
+    }
+
+    char pointer[16];
+    new_pointer(transpiler, pointer, sizeof(pointer));
+
+    emit_line(transpiler, "if (%s != 0)", condition.expression);
+    emit_line(transpiler, "{");
+    if (!emit_branch(transpiler, node->args[1], pointer))
+    {
+        return false;
+    }
+    emit_line(transpiler, "}");
+    emit_line(transpiler, "else");
+    emit_line(transpiler, "{");
+    if (!emit_branch(transpiler, node->args[2], pointer))
+    {
+        return false;
+    }
+    emit_line(transpiler, "}");
+
+    dereference(pointer, result);
+    return true;
+}
+
+static bool emit_loop(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result)
+{
+    transpiler_value_t count;
+    if (!emit_node(transpiler, node->args[0], &count))
+    {
+        return false;
+    }
+    make_lvalue(transpiler, &count);
+
+    char pointer[16];
+    new_pointer(transpiler, pointer, sizeof(pointer));
+    int counter = transpiler->counter_count++;
+
+    /* With no iterations, the loop returns its count argument. */
+    emit_line(transpiler, "%s = &%s;", pointer, count.expression);
+    emit_line(transpiler, "c%d = (PRJM_EVAL_I) %s;", counter, count.expression);
+    emit_line(transpiler, "if (c%d > MAX_LOOP_COUNT)", counter);
+    emit_line(transpiler, "{");
+    emit_line(transpiler, "    c%d = MAX_LOOP_COUNT;", counter);
+    emit_line(transpiler, "}");
+    emit_line(transpiler, "for (; c%d > 0; c%d--)", counter, counter);
+    emit_line(transpiler, "{");
+    if (!emit_branch(transpiler, node->args[1], pointer))
+    {
+        return false;
+    }
+    emit_line(transpiler, "}");
+
+    dereference(pointer, result);
+    return true;
+}
+
+static bool emit_while(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result)
+{
+    char pointer[16];
+    new_pointer(transpiler, pointer, sizeof(pointer));
+    int counter = transpiler->counter_count++;
+
+    emit_line(transpiler, "c%d = MAX_LOOP_COUNT;", counter);
+
+    /* The body result location isn't reset between iterations, so a value may be stored in the previous reference. */
+    bool stores_through_reference = prjm_eval_exptreenode_stores_through_reference(node);
+    if (stores_through_reference)
+    {
+        transpiler_value_t value;
+        new_value(transpiler, &value);
+        emit_line(transpiler, "%s = .0;", value.expression);
+        emit_line(transpiler, "%s = &%s;", pointer, value.expression);
+    }
+
+    emit_line(transpiler, "do");
+    emit_line(transpiler, "{");
+    if (stores_through_reference)
+    {
+        transpiler->indent++;
+        if (!emit_into(transpiler, node->args[0], pointer))
+        {
+            return false;
+        }
+        transpiler->indent--;
+    }
+    else if (!emit_branch(transpiler, node->args[0], pointer))
+    {
+        return false;
+    }
+    emit_line(transpiler, "} while (fabs(*%s) > close_factor_low && --c%d);", pointer, counter);
+
+    dereference(pointer, result);
+    return true;
+}
+
+/**
+ * Emits the short-circuiting && and || operators.
+ */
+static bool emit_boolean_op(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, bool is_and,
+                            transpiler_value_t* result)
+{
+    transpiler_value_t first;
+    if (!emit_node(transpiler, node->args[0], &first))
+    {
+        return false;
+    }
+
+    new_value(transpiler, result);
+
+    emit_line(transpiler, "if (fabs(%s) %s close_factor_low)", first.expression, is_and ? ">" : "<");
+    emit_line(transpiler, "{");
+    transpiler->indent++;
+    transpiler_value_t second;
+    if (!emit_node(transpiler, node->args[1], &second))
+    {
+        return false;
+    }
+    emit_line(transpiler, "%s = fabs(%s) > close_factor_low ? 1.0 : 0.0;", result->expression, second.expression);
+    transpiler->indent--;
+    emit_line(transpiler, "}");
+    emit_line(transpiler, "else");
+    emit_line(transpiler, "{");
+    emit_line(transpiler, "    %s = %s;", result->expression, is_and ? "0.0" : "1.0");
+    emit_line(transpiler, "}");
+
+    return true;
+}
+
+static bool emit_mem(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result)
+{
+    const char* buffer = memory_buffer_name(transpiler, node->memory_buffer);
+    if (!buffer)
+    {
+        transpiler->error = "Memory access to an unknown buffer.";
+        return false;
+    }
+
+    transpiler_value_t index;
+    if (!emit_node(transpiler, node->args[0], &index))
+    {
+        return false;
+    }
+
+    char pointer[16];
+    new_pointer(transpiler, pointer, sizeof(pointer));
+    transpiler_value_t fallback;
+    new_value(transpiler, &fallback);
+
+    emit_line(transpiler, "%s = prjm_eval_memory_allocate(%s, prjm_eval_math_mem_index(%s));",
+              pointer, buffer, index.expression);
+    emit_line(transpiler, "if (!%s)", pointer);
+    emit_line(transpiler, "{");
+    emit_line(transpiler, "    %s = .0;", fallback.expression);
+    emit_line(transpiler, "    %s = &%s;", pointer, fallback.expression);
+    emit_line(transpiler, "}");
+
+    dereference(pointer, result);
+    return true;
+}
+
+static bool emit_freembuf(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result)
+{
+    const char* buffer = memory_buffer_name(transpiler, node->memory_buffer);
+    if (!buffer)
+    {
+        transpiler->error = "Memory access to an unknown buffer.";
+        return false;
+    }
+
+    if (!emit_node(transpiler, node->args[0], result))
+    {
+        return false;
+    }
+
+    emit_line(transpiler, "prjm_eval_memory_free_block(%s, prjm_eval_math_mem_index(%s));",
+              buffer, result->expression);
+    return true;
+}
+
+/**
+ * Emits memcpy() and memset(), which both take pointers to their three arguments.
+ */
+static bool emit_mem_function(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, const char* function,
+                              transpiler_value_t* result)
+{
+    const char* buffer = memory_buffer_name(transpiler, node->memory_buffer);
+    if (!buffer)
+    {
+        transpiler->error = "Memory access to an unknown buffer.";
+        return false;
+    }
+
+    transpiler_value_t args[3];
+    for (int arg = 0; arg < 3; arg++)
+    {
+        if (!emit_node(transpiler, node->args[arg], &args[arg]))
+        {
+            return false;
+        }
+        make_lvalue(transpiler, &args[arg]);
+    }
+
+    char pointer[16];
+    new_pointer(transpiler, pointer, sizeof(pointer));
+
+    emit_line(transpiler, "%s = %s(%s, &%s, &%s, &%s);", pointer, function, buffer,
+              args[0].expression, args[1].expression, args[2].expression);
+
+    dereference(pointer, result);
+    return true;
+}
+
+/**
+ * Emits a unary or binary operation using the implementation from the specialization tables in TreeFunctions.h.
+ */
+static bool emit_operation(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, int arg_count,
+                           const char* impl, transpiler_value_t* result)
+{
+    transpiler_value_t args[2];
+    for (int arg = 0; arg < arg_count; arg++)
+    {
+        if (!emit_node(transpiler, node->args[arg], &args[arg]))
+        {
+            return false;
+        }
+    }
+
+    new_value(transpiler, result);
+
+    if (arg_count == 1)
+    {
+        emit_line(transpiler, "{ PRJM_EVAL_F a = %s; %s = %s; }", args[0].expression, result->expression, impl);
+    }
+    else
+    {
+        emit_line(transpiler, "{ PRJM_EVAL_F a = %s; PRJM_EVAL_F b = %s; %s = %s; }",
+                  args[0].expression, args[1].expression, result->expression, impl);
+    }
+
+    return true;
+}
+
+/**
+ * Emits an assignment, which stores the result in its first argument and returns a reference to it.
+ */
+static bool emit_assignment(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, const char* impl,
+                            transpiler_value_t* result)
+{
+    if (!emit_node(transpiler, node->args[0], result))
+    {
+        return false;
+    }
+    make_lvalue(transpiler, result);
+
+    transpiler_value_t value;
+    if (!emit_node(transpiler, node->args[1], &value))
+    {
+        return false;
+    }
+
+    if (!strcmp(impl, "b"))
+    {
+        emit_line(transpiler, "%s = %s;", result->expression, value.expression);
+    }
+    else
+    {
+        emit_line(transpiler, "{ PRJM_EVAL_F a = %s; PRJM_EVAL_F b = %s; %s = %s; }",
+                  result->expression, value.expression, result->expression, impl);
+    }
+
+    return true;
+}
+
+/**
+ * Returns the C implementation of an assignment function, or NULL if func isn't an assignment.
+ */
+static const char* assignment_impl(prjm_eval_expr_func_t* func)
+{
+#define ASSIGNMENT_IMPL(name, impl) \
+    if (func == prjm_eval_func_ ## name) \
+    { \
+        return #impl; \
+    }
+
+    PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(ASSIGNMENT_IMPL)
+
+#undef ASSIGNMENT_IMPL
+
+    return NULL;
+}
+
+/**
+ * Emits the first two arguments of exec3(). Both are evaluated into the same result location, so if the first one
+ * returns a variable or memory reference, a value returned by the second one is stored there.
+ */
+static bool emit_exec3_arguments(transpiler_t* transpiler, prjm_eval_exptreenode_t* node)
+{
+    transpiler_value_t value;
+
+    if (!prjm_eval_exptreenode_stores_through_reference(node))
+    {
+        for (int arg = 0; arg < 2; arg++)
+        {
+            if (!emit_node(transpiler, node->args[arg], &value))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    char pointer[16];
+    new_pointer(transpiler, pointer, sizeof(pointer));
+    new_value(transpiler, &value);
+
+    emit_line(transpiler, "%s = .0;", value.expression);
+    emit_line(transpiler, "%s = &%s;", pointer, value.expression);
+
+    for (int arg = 0; arg < 2; arg++)
+    {
+        if (!emit_into(transpiler, node->args[arg], pointer))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Emits a node which receives its result location from the parent, like the tree functions do. Nodes returning a
+ * reference point the given pointer to it, all others store their value where the pointer currently points to.
+ */
+static bool emit_into(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, const char* pointer)
+{
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+    const char* impl = assignment_impl(func);
+    transpiler_value_t value;
+
+    if (func == prjm_eval_func_if)
+    {
+        if (!emit_node(transpiler, node->args[0], &value))
+        {
+            return false;
+        }
+
+        emit_line(transpiler, "if (%s != 0)", value.expression);
+        for (int arg = 1; arg < 3; arg++)
+        {
+            if (arg == 2)
+            {
+                emit_line(transpiler, "else");
+            }
+            emit_line(transpiler, "{");
+            transpiler->indent++;
+            if (!emit_into(transpiler, node->args[arg], pointer))
+            {
+                return false;
+            }
+            transpiler->indent--;
+            emit_line(transpiler, "}");
+        }
+        return true;
+    }
+
+    if (func == prjm_eval_func_exec2)
+    {
+        if (!emit_node(transpiler, node->args[0], &value))
+        {
+            return false;
+        }
+        return emit_into(transpiler, node->args[1], pointer);
+    }
+
+    if (func == prjm_eval_func_exec3)
+    {
+        if (!emit_exec3_arguments(transpiler, node))
+        {
+            return false;
+        }
+        return emit_into(transpiler, node->args[2], pointer);
+    }
+
+    if (func == prjm_eval_func_mem)
+    {
+        const char* buffer = memory_buffer_name(transpiler, node->memory_buffer);
+        if (!buffer)
+        {
+            transpiler->error = "Memory access to an unknown buffer.";
+            return false;
+        }
+
+        if (!emit_node(transpiler, node->args[0], &value))
+        {
+            return false;
+        }
+
+        char address[16];
+        new_pointer(transpiler, address, sizeof(address));
+
+        /* Out-of-range accesses store a zero instead of returning a reference. */
+        emit_line(transpiler, "%s = prjm_eval_memory_allocate(%s, prjm_eval_math_mem_index(%s));",
+                  address, buffer, value.expression);
+        emit_line(transpiler, "if (%s)", address);
+        emit_line(transpiler, "{");
+        emit_line(transpiler, "    %s = %s;", pointer, address);
+        emit_line(transpiler, "}");
+        emit_line(transpiler, "else");
+        emit_line(transpiler, "{");
+        emit_line(transpiler, "    *%s = .0;", pointer);
+        emit_line(transpiler, "}");
+        return true;
+    }
+
+    if (func == prjm_eval_func_freembuf)
+    {
+        const char* buffer = memory_buffer_name(transpiler, node->memory_buffer);
+        if (!buffer)
+        {
+            transpiler->error = "Memory access to an unknown buffer.";
+            return false;
+        }
+
+        if (!emit_into(transpiler, node->args[0], pointer))
+        {
+            return false;
+        }
+
+        emit_line(transpiler, "prjm_eval_memory_free_block(%s, prjm_eval_math_mem_index(*%s));", buffer, pointer);
+        return true;
+    }
+
+    if (impl)
+    {
+        /* The assignment target replaces the result location, which then receives the assigned value. */
+        if (!emit_into(transpiler, node->args[0], pointer) ||
+            !emit_node(transpiler, node->args[1], &value))
+        {
+            return false;
+        }
+
+        if (!strcmp(impl, "b"))
+        {
+            emit_line(transpiler, "*%s = %s;", pointer, value.expression);
+        }
+        else
+        {
+            emit_line(transpiler, "{ PRJM_EVAL_F a = *%s; PRJM_EVAL_F b = %s; *%s = %s; }",
+                      pointer, value.expression, pointer, impl);
+        }
+        return true;
+    }
+
+    if (!emit_node(transpiler, node, &value))
+    {
+        return false;
+    }
+
+    if (func == prjm_eval_func_var ||
+        func == prjm_eval_func_execute_list ||
+        func == prjm_eval_func_execute_loop ||
+        func == prjm_eval_func_execute_while ||
+        func == prjm_eval_func_memcpy ||
+        func == prjm_eval_func_memset)
+    {
+        make_lvalue(transpiler, &value);
+        emit_line(transpiler, "%s = &%s;", pointer, value.expression);
+    }
+    else
+    {
+        emit_line(transpiler, "*%s = %s;", pointer, value.expression);
+    }
+
+    return true;
+}
+
+static bool emit_node(transpiler_t* transpiler, prjm_eval_exptreenode_t* node, transpiler_value_t* result)
+{
+    assert(node);
+
+    prjm_eval_expr_func_t* func = prjm_eval_generic_function(node->func);
+
+    if (func == prjm_eval_func_const)
+    {
+        format_constant(node->value, result);
+        return true;
+    }
+
+    if (func == prjm_eval_func_var)
+    {
+        int index = variable_index(transpiler, node->var);
+        if (index < 0)
+        {
+            transpiler->error = "Variable is not registered in the context.";
+            return false;
+        }
+
+        snprintf(result->expression, sizeof(result->expression), "(*v%d)", index);
+        result->is_lvalue = true;
+        return true;
+    }
+
+    if (func == prjm_eval_func_execute_list || func == prjm_eval_func_exec2)
+    {
+        return emit_sequence(transpiler, node->args, result);
+    }
+
+    if (func == prjm_eval_func_exec3)
+    {
+        if (!emit_exec3_arguments(transpiler, node))
+        {
+            return false;
+        }
+        return emit_node(transpiler, node->args[2], result);
+    }
+
+    if (func == prjm_eval_func_if)
+    {
+        return emit_if(transpiler, node, result);
+    }
+
+    if (func == prjm_eval_func_execute_loop)
+    {
+        return emit_loop(transpiler, node, result);
+    }
+
+    if (func == prjm_eval_func_execute_while)
+    {
+        return emit_while(transpiler, node, result);
+    }
+
+    if (func == prjm_eval_func_boolean_and_op || func == prjm_eval_func_boolean_or_op)
+    {
+        return emit_boolean_op(transpiler, node, func == prjm_eval_func_boolean_and_op, result);
+    }
+
+    if (func == prjm_eval_func_mem)
+    {
+        return emit_mem(transpiler, node, result);
+    }
+
+    if (func == prjm_eval_func_freembuf)
+    {
+        return emit_freembuf(transpiler, node, result);
+    }
+
+    if (func == prjm_eval_func_memcpy)
+    {
+        return emit_mem_function(transpiler, node, "prjm_eval_memory_copy", result);
+    }
+
+    if (func == prjm_eval_func_memset)
+    {
+        return emit_mem_function(transpiler, node, "prjm_eval_memory_set", result);
+    }
+
+#define EMIT_UNARY(name, impl) \
+    if (func == prjm_eval_func_ ## name) \
+    { \
+        return emit_operation(transpiler, node, 1, #impl, result); \
+    }
+#define EMIT_BINARY(name, impl) \
+    if (func == prjm_eval_func_ ## name) \
+    { \
+        return emit_operation(transpiler, node, 2, #impl, result); \
+    }
+#define EMIT_ASSIGNMENT(name, impl) \
+    if (func == prjm_eval_func_ ## name) \
+    { \
+        return emit_assignment(transpiler, node, #impl, result); \
+    }
+
+    PRJM_EVAL_SPECIALIZED_UNARY_FUNCTIONS(EMIT_UNARY)
+    PRJM_EVAL_SPECIALIZED_BINARY_FUNCTIONS(EMIT_BINARY)
+    PRJM_EVAL_SPECIALIZED_ASSIGNMENT_FUNCTIONS(EMIT_ASSIGNMENT)
+
+#undef EMIT_UNARY
+#undef EMIT_BINARY
+#undef EMIT_ASSIGNMENT
+
+    /* Fused superinstructions and externally added functions have no C implementation. */
+    transpiler->error = "The program uses a function which can't be translated to C.";
+    return false;
+}
+
+static void write_declarations(FILE* source, const char* type, const char* prefix, int count)
+{
+    for (int index = 0; index < count; index += 8)
+    {
+        fprintf(source, "    %s ", type);
+        for (int entry = index; entry < count && entry < index + 8; entry++)
+        {
+            fprintf(source, "%s%s%d = 0", entry > index ? ", " : "", prefix, entry);
+        }
+        fprintf(source, ";\n");
+    }
+}
+
+/**
+ * Marks the temporaries as used, as results of control structures are often only assigned.
+ */
+static void write_unused_markers(FILE* source, char prefix, int count)
+{
+    for (int index = 0; index < count; index += 8)
+    {
+        fprintf(source, "   ");
+        for (int entry = index; entry < count && entry < index + 8; entry++)
+        {
+            fprintf(source, " (void) %c%d;", prefix, entry);
+        }
+        fprintf(source, "\n");
+    }
+}
+
+static void write_source(transpiler_t* transpiler, const transpiler_value_t* result, const char* symbol,
+                         const char* header_name, FILE* source)
+{
+    fprintf(source, "/* Generated by projectm-eval-transpile. Do not edit. */\n"
+                    "#include \"%s\"\n"
+                    "\n"
+                    "#include <projectm-eval/IntrinsicMath.h>\n"
+                    "#include <projectm-eval/MemoryBuffer.h>\n"
+                    "\n", header_name);
+
+    if (transpiler->variable_count > 0)
+    {
+        fprintf(source, "static const char* const %s_variable_names[] = {\n", symbol);
+        for (int index = 0; index < transpiler->variable_count; index++)
+        {
+            fprintf(source, "    \"%s\",\n", transpiler->variable_names[index]);
+        }
+        fprintf(source, "};\n\n");
+    }
+
+    int indent = (int) strlen("static PRJM_EVAL_F _function(") + (int) strlen(symbol);
+    fprintf(source, "static PRJM_EVAL_F %s_function(PRJM_EVAL_F* const* variables,\n"
+                    "%*sprojectm_eval_mem_buffer memory,\n"
+                    "%*sprojectm_eval_mem_buffer global_memory)\n"
+                    "{\n", symbol, indent, "", indent, "");
+
+    for (int index = 0; index < transpiler->variable_count; index++)
+    {
+        fprintf(source, "    PRJM_EVAL_F* const v%d = variables[%d]; /* %s */\n",
+                index, index, transpiler->variable_names[index]);
+    }
+    write_declarations(source, "PRJM_EVAL_F", "t", transpiler->value_count);
+    write_declarations(source, "PRJM_EVAL_F", "*p", transpiler->pointer_count);
+    write_declarations(source, "PRJM_EVAL_I", "c", transpiler->counter_count);
+
+    fprintf(source, "\n"
+                    "    (void) variables;\n"
+                    "    (void) memory;\n"
+                    "    (void) global_memory;\n");
+    write_unused_markers(source, 'p', transpiler->pointer_count);
+
+    fprintf(source, "\n"
+                    "%s"
+                    "\n"
+                    "    return %s;\n"
+                    "}\n"
+                    "\n", transpiler->code.data ? transpiler->code.data : "", result->expression);
+
+    fprintf(source, "const projectm_eval_native_program %s = {\n"
+                    "    %s_function,\n", symbol, symbol);
+    if (transpiler->variable_count > 0)
+    {
+        fprintf(source, "    %s_variable_names,\n", symbol);
+    }
+    else
+    {
+        fprintf(source, "    0,\n");
+    }
+    fprintf(source, "    %d,\n"
+                    "    PRJM_F_SIZE\n"
+                    "};\n", transpiler->variable_count);
+}
+
+static void write_header(const char* symbol, FILE* header)
+{
+    fprintf(header, "/* Generated by projectm-eval-transpile. Do not edit. */\n"
+                    "#pragma once\n"
+                    "\n"
+                    "#include <projectm-eval.h>\n"
+                    "\n"
+                    "#ifdef __cplusplus\n"
+                    "extern \"C\" {\n"
+                    "#endif\n"
+                    "\n"
+                    "extern const projectm_eval_native_program %s;\n"
+                    "\n"
+                    "#ifdef __cplusplus\n"
+                    "}\n"
+                    "#endif\n", symbol);
+}
+
+int prjm_eval_transpile_program(prjm_eval_program_t* program, const char* symbol, const char* header_name,
+                                FILE* source, FILE* header, const char** error)
+{
+    assert(program);
+    assert(symbol);
+    assert(header_name);
+    assert(source);
+    assert(header);
+
+    transpiler_t transpiler = { 0 };
+    transpiler.cctx = program->cctx;
+
+    transpiler_value_t result;
+    format_constant(.0, &result);
+
+    bool success = true;
+
+    /* Empty programs have no tree and always return 0. */
+    if (program->program)
+    {
+        success = emit_node(&transpiler, program->program, &result);
+    }
+
+    if (success)
+    {
+        write_source(&transpiler, &result, symbol, header_name, source);
+        write_header(symbol, header);
+    }
+    else if (error)
+    {
+        *error = transpiler.error;
+    }
+
+    for (int index = 0; index < transpiler.variable_count; index++)
+    {
+        free(transpiler.variable_names[index]);
+    }
+    free(transpiler.variable_names);
+    free(transpiler.variables);
+    free(transpiler.code.data);
+
+    return success;
+}
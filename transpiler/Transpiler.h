@@ -0,0 +1,27 @@
+/**
+ * @file Transpiler.h
+ * @brief Translates compiled expression trees into C source code.
+ *
+ * The generated code calls the same helpers from IntrinsicMath.h and MemoryBuffer.h as the execution engines, so
+ * it calculates the same results as the tree interpreter. It accesses variables through the pointers passed by
+ * the library, see projectm_eval_code_create_native().
+ */
+#pragma once
+
+#include <projectm-eval/CompilerTypes.h>
+
+#include <stdio.h>
+
+/**
+ * @brief Writes the C source and header files for a compiled program.
+ * The source file defines a projectm_eval_native_program with the given symbol name, the header file declares it.
+ * @param program The compiled program. Must be compiled without superinstruction fusion.
+ * @param symbol The C identifier of the generated program description.
+ * @param header_name The file name used to include the header in the generated source.
+ * @param source The file to write the C source code to.
+ * @param header The file to write the header to.
+ * @param error Receives an error message if the program can't be translated.
+ * @return 1 if the files were written successfully, 0 if the program can't be translated.
+ */
+int prjm_eval_transpile_program(prjm_eval_program_t* program, const char* symbol, const char* header_name,
+                                FILE* source, FILE* header, const char** error);
@@ -0,0 +1,147 @@
+/**
+ * @file main.c
+ * @brief Command line interface of the projectm-eval-transpile tool.
+ *
+ * Usage: projectm-eval-transpile <input file> <output source> <output header> <symbol name>
+ *
+ * Compiles the expression code from the input file and writes it as a C function, wrapped in a
+ * projectm_eval_native_program with the given symbol name. See the ReadMe.md file for details.
+ */
+#include "Transpiler.h"
+
+#include <projectm-eval.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* The tool is single-threaded and doesn't need to lock the memory buffers. */
+void projectm_eval_memory_host_lock_mutex()
+{
+}
+
+void projectm_eval_memory_host_unlock_mutex()
+{
+}
+
+static char* read_file(const char* file_name)
+{
+    FILE* file = fopen(file_name, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* code = NULL;
+    if (size >= 0)
+    {
+        code = malloc(size + 1);
+        size_t read = fread(code, 1, size, file);
+        code[read] = 0;
+    }
+
+    fclose(file);
+
+    return code;
+}
+
+static const char* file_name_part(const char* path)
+{
+    const char* name = path;
+    for (const char* current = path; *current; current++)
+    {
+        if (*current == '/' || *current == '\\')
+        {
+            name = current + 1;
+        }
+    }
+
+    return name;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 5)
+    {
+        fprintf(stderr, "Usage: %s <input file> <output source> <output header> <symbol name>\n", argv[0]);
+        return 1;
+    }
+
+    const char* input_file = argv[1];
+    const char* source_file = argv[2];
+    const char* header_file = argv[3];
+    const char* symbol = argv[4];
+
+    char* code = read_file(input_file);
+    if (!code)
+    {
+        fprintf(stderr, "%s: Could not read file.\n", input_file);
+        return 1;
+    }
+
+    /* A separate register array is used, so reg00 to reg99 can be told apart from named variables. */
+    PRJM_EVAL_F global_variables[100] = { 0 };
+    struct projectm_eval_context* context = projectm_eval_context_create(NULL, &global_variables);
+
+    /* The C compiler selects instructions itself, superinstructions would only hide the original functions. */
+    ((prjm_eval_compiler_context_t*) context)->fuse_superinstructions = false;
+
+    struct projectm_eval_code* program = projectm_eval_code_compile(context, code);
+    free(code);
+
+    if (!program)
+    {
+        int line = 0;
+        int column = 0;
+        const char* error = projectm_eval_get_error(context, &line, &column);
+        fprintf(stderr, "%s:%d:%d: %s\n", input_file, line, column, error);
+        projectm_eval_context_destroy(context);
+        return 1;
+    }
+
+    int result = 1;
+    FILE* source = fopen(source_file, "w");
+    FILE* header = fopen(header_file, "w");
+
+    if (source && header)
+    {
+        const char* error = NULL;
+        if (prjm_eval_transpile_program((prjm_eval_program_t*) program, symbol, file_name_part(header_file),
+                                        source, header, &error))
+        {
+            result = 0;
+        }
+        else
+        {
+            fprintf(stderr, "%s: %s\n", input_file, error);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "Could not open the output files.\n");
+    }
+
+    if (source)
+    {
+        fclose(source);
+    }
+    if (header)
+    {
+        fclose(header);
+    }
+
+    /* Don't leave incomplete files behind, so the build system runs the tool again. */
+    if (result != 0)
+    {
+        remove(source_file);
+        remove(header_file);
+    }
+
+    projectm_eval_code_destroy(program);
+    projectm_eval_context_destroy(context);
+
+    return result;
+}